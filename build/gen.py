@@ -663,10 +663,13 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/command_outputs.cc',
         'src/gn/command_path.cc',
         'src/gn/command_refs.cc',
+        'src/gn/command_serve.cc',
         'src/gn/commands.cc',
         'src/gn/compile_commands_writer.cc',
+        'src/gn/compiled_substitution.cc',
         'src/gn/rust_project_writer.cc',
         'src/gn/config.cc',
+        'src/gn/config_fragment_cache.cc',
         'src/gn/config_values.cc',
         'src/gn/config_values_extractors.cc',
         'src/gn/config_values_generator.cc',
@@ -677,7 +680,11 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/eclipse_writer.cc',
         'src/gn/err.cc',
         'src/gn/escape.cc',
+        'src/gn/escape_scanner.cc',
         'src/gn/exec_process.cc',
+        'src/gn/exec_script_cache.cc',
+        'src/gn/execution_record.cc',
+        'src/gn/file_system_cache.cc',
         'src/gn/filesystem_utils.cc',
         'src/gn/file_writer.cc',
         'src/gn/frameworks_utils.cc',
@@ -703,6 +710,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/function_write_file.cc',
         'src/gn/functions.cc',
         'src/gn/functions_target.cc',
+        'src/gn/gen_inputs_manifest.cc',
         'src/gn/general_tool.cc',
         'src/gn/generated_file_target_generator.cc',
         'src/gn/graph/src/module.cc',
@@ -715,6 +723,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/group_target_generator.cc',
         'src/gn/header_checker.cc',
         'src/gn/import_manager.cc',
+        'src/gn/incremental_gen_state.cc',
         'src/gn/inherited_libraries.cc',
         "src/gn/innerapis_publicinfo_generator.cc",
         'src/gn/input_conversion.cc',
@@ -728,6 +737,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/lib_file.cc',
         'src/gn/loader.cc',
         'src/gn/location.cc',
+        'src/gn/memory_stats.cc',
         'src/gn/metadata.cc',
         'src/gn/metadata_walk.cc',
         'src/gn/ninja_action_target_writer.cc',
@@ -737,10 +747,12 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/ninja_c_binary_target_writer.cc',
         'src/gn/ninja_copy_target_writer.cc',
         'src/gn/ninja_create_bundle_target_writer.cc',
+        'src/gn/ninja_file_manifest.cc',
         'src/gn/ninja_generated_file_target_writer.cc',
         'src/gn/ninja_group_target_writer.cc',
         'src/gn/ninja_module_writer_util.cc',
         'src/gn/ninja_outputs_writer.cc',
+        'src/gn/ninja_rule_spool.cc',
         'src/gn/ninja_rust_binary_target_writer.cc',
         'src/gn/ninja_target_command_util.cc',
         'src/gn/ninja_target_writer.cc',
@@ -761,7 +773,9 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/path_output.cc',
         'src/gn/pattern.cc',
         'src/gn/pool.cc',
+        'src/gn/python_worker.cc',
         'src/gn/qt_creator_writer.cc',
+        'src/gn/query_server.cc',
         'src/gn/resolved_target_data.cc',
         'src/gn/runtime_deps.cc',
         'src/gn/rust_substitution_type.cc',
@@ -788,6 +802,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/swift_values_generator.cc',
         'src/gn/swift_variables.cc',
         'src/gn/switches.cc',
+        'src/gn/synthetic_project.cc',
         'src/gn/target.cc',
         'src/gn/target_generator.cc',
         'src/gn/template.cc',
@@ -811,6 +826,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/util/msg_loop.cc',
         'src/util/semaphore.cc',
         'src/util/sys_info.cc',
+        'src/util/task_stats.cc',
         'src/util/ticks.cc',
         'src/util/worker_pool.cc',
       ]},
@@ -819,6 +835,13 @@ def WriteGNNinja(path, platform, host, options, args_list):
   executables = {
       'gn': {'sources': [ 'src/gn/gn_main.cc' ], 'libs': []},
 
+      'gn_benchmarks': {
+        'sources': [
+          'src/gn/escape_benchmark.cc',
+          'src/gn/gn_benchmarks.cc',
+          'src/util/worker_pool_benchmark.cc',
+        ], 'libs': []},
+
       'gn_unittests': { 'sources': [
         'src/base/sha2_unittest.cc',
         'src/gn/action_target_generator_unittest.cc',
@@ -831,14 +854,20 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/command_format_unittest.cc',
         'src/gn/commands_unittest.cc',
         'src/gn/compile_commands_writer_unittest.cc',
+        'src/gn/compiled_substitution_unittest.cc',
+        'src/gn/config_fragment_cache_unittest.cc',
         'src/gn/config_unittest.cc',
         'src/gn/config_values_extractors_unittest.cc',
         'src/gn/desc_builder_unittest.cc',
         'src/gn/escape_unittest.cc',
         'src/gn/exec_process_unittest.cc',
+        'src/gn/exec_script_cache_unittest.cc',
+        'src/gn/execution_record_unittest.cc',
+        'src/gn/file_system_cache_unittest.cc',
         'src/gn/filesystem_utils_unittest.cc',
         'src/gn/file_writer_unittest.cc',
         'src/gn/frameworks_utils_unittest.cc',
+        'src/gn/function_exec_script_unittest.cc',
         'src/gn/function_filter_unittest.cc',
         'src/gn/function_filter_labels_unittest.cc',
         'src/gn/function_foreach_unittest.cc',
@@ -858,8 +887,10 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/functions_target_rust_unittest.cc',
         'src/gn/functions_target_unittest.cc',
         'src/gn/functions_unittest.cc',
+        'src/gn/gen_inputs_manifest_unittest.cc',
         'src/gn/hash_table_base_unittest.cc',
         'src/gn/header_checker_unittest.cc',
+        'src/gn/incremental_gen_state_unittest.cc',
         'src/gn/input_conversion_unittest.cc',
         'src/gn/json_project_writer_unittest.cc',
         'src/gn/rust_project_writer_unittest.cc',
@@ -867,6 +898,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/label_pattern_unittest.cc',
         'src/gn/label_unittest.cc',
         'src/gn/loader_unittest.cc',
+        'src/gn/memory_stats_unittest.cc',
         'src/gn/metadata_unittest.cc',
         'src/gn/metadata_walk_unittest.cc',
         'src/gn/ninja_action_target_writer_unittest.cc',
@@ -876,9 +908,11 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/ninja_c_binary_target_writer_unittest.cc',
         'src/gn/ninja_copy_target_writer_unittest.cc',
         'src/gn/ninja_create_bundle_target_writer_unittest.cc',
+        'src/gn/ninja_file_manifest_unittest.cc',
         'src/gn/ninja_generated_file_target_writer_unittest.cc',
         'src/gn/ninja_group_target_writer_unittest.cc',
         'src/gn/ninja_outputs_writer_unittest.cc',
+        'src/gn/ninja_rule_spool_unittest.cc',
         'src/gn/ninja_rust_binary_target_writer_unittest.cc',
         'src/gn/ninja_target_command_util_unittest.cc',
         'src/gn/ninja_target_writer_unittest.cc',
@@ -891,25 +925,31 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/path_output_unittest.cc',
         'src/gn/pattern_unittest.cc',
         'src/gn/pointer_set_unittest.cc',
+        'src/gn/python_worker_unittest.cc',
+        'src/gn/query_server_unittest.cc',
         'src/gn/resolved_target_data_unittest.cc',
         'src/gn/resolved_target_deps_unittest.cc',
         'src/gn/runtime_deps_unittest.cc',
+        'src/gn/scheduler_unittest.cc',
         'src/gn/scope_per_file_provider_unittest.cc',
         'src/gn/scope_unittest.cc',
         'src/gn/setup_unittest.cc',
         'src/gn/source_dir_unittest.cc',
         'src/gn/source_file_unittest.cc',
+        'src/gn/string_atom_map_unittest.cc',
         'src/gn/string_atom_unittest.cc',
         'src/gn/string_output_buffer_unittest.cc',
         'src/gn/string_utils_unittest.cc',
         'src/gn/substitution_pattern_unittest.cc',
         'src/gn/substitution_writer_unittest.cc',
+        'src/gn/synthetic_project_unittest.cc',
         'src/gn/target_public_pair_unittest.cc',
         'src/gn/target_unittest.cc',
         'src/gn/template_unittest.cc',
         'src/gn/test_with_scheduler.cc',
         'src/gn/test_with_scope.cc',
         'src/gn/tokenizer_unittest.cc',
+        'src/gn/trace_unittest.cc',
         'src/gn/unique_vector_unittest.cc',
         'src/gn/value_unittest.cc',
         'src/gn/vector_utils_unittest.cc',
@@ -921,6 +961,8 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/xml_element_writer_unittest.cc',
         'src/util/atomic_write_unittest.cc',
         'src/util/sys_info_unittest.cc',
+        'src/util/task_stats_unittest.cc',
+        'src/util/worker_pool_unittest.cc',
         'src/util/test/gn_test.cc',
       ], 'libs': []},
   }
@@ -982,6 +1024,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
   # we just build static libraries that GN needs
   executables['gn']['libs'].extend(static_libraries.keys())
   executables['gn_unittests']['libs'].extend(static_libraries.keys())
+  executables['gn_benchmarks']['libs'].extend(static_libraries.keys())
 
   WriteGenericNinja(path, static_libraries, executables, cxx, ar, ld,
                     platform, host, options, args_list,
@@ -4,6 +4,7 @@
 
 #include "gn/args.h"
 
+#include "gn/execution_record.h"
 #include "gn/settings.h"
 #include "gn/source_file.h"
 #include "gn/string_utils.h"
@@ -103,7 +104,8 @@ Args::Args(const Args& other)
       all_overrides_(other.all_overrides_),
       declared_arguments_per_toolchain_(
           other.declared_arguments_per_toolchain_),
-      toolchain_overrides_(other.toolchain_overrides_) {}
+      toolchain_overrides_(other.toolchain_overrides_),
+      restored_declarations_(other.restored_declarations_) {}
 
 Args::~Args() = default;
 
@@ -198,6 +200,9 @@ void Args::SetupRootScope(Scope* dest,
 bool Args::DeclareArgs(const Scope::KeyValueMap& args,
                        Scope* scope_to_set,
                        Err* err) const {
+  if (ExecutionRecord* record = ExecutionRecord::Current())
+    record->AddDeclaredArgs(args);
+
   std::lock_guard<std::mutex> lock(lock_);
 
   Scope::KeyValueMap& declared_arguments(
@@ -271,11 +276,25 @@ bool Args::DeclareArgs(const Scope::KeyValueMap& args,
   return true;
 }
 
+void Args::AddRestoredDeclarations(
+    const std::vector<std::string>& names) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  restored_declarations_.insert(names.begin(), names.end());
+}
+
 bool Args::VerifyAllOverridesUsed(Err* err) const {
   std::lock_guard<std::mutex> lock(lock_);
   Scope::KeyValueMap unused_overrides(all_overrides_);
   for (const auto& map_pair : declared_arguments_per_toolchain_)
     RemoveDeclaredOverrides(map_pair.second, &unused_overrides);
+  for (Scope::KeyValueMap::iterator override = unused_overrides.begin();
+       override != unused_overrides.end();) {
+    if (restored_declarations_.find(override->first) ==
+        restored_declarations_.end())
+      ++override;
+    else
+      unused_overrides.erase(override++);
+  }
 
   if (unused_overrides.empty())
     return true;
@@ -9,8 +9,10 @@
 #include <mutex>
 #include <optional>
 #include <set>
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "gn/scope.h"
 
@@ -80,6 +82,10 @@ class Args {
                    Scope* scope_to_set,
                    Err* err) const;
 
+  // Records that build files "gn gen --incremental" didn't execute again
+  // declared these arguments when they were last executed.
+  void AddRestoredDeclarations(const std::vector<std::string>& names) const;
+
   // Checks to see if any of the overrides ever used were never declared as
   // arguments. If there are, this returns false and sets the error.
   bool VerifyAllOverridesUsed(Err* err) const;
@@ -148,6 +154,10 @@ class Args {
   // we see an argument declaration.
   mutable ArgumentsPerToolchain toolchain_overrides_;
 
+  // See AddRestoredDeclarations(). Only their names are known, which is
+  // enough for VerifyAllOverridesUsed().
+  mutable std::set<std::string, std::less<>> restored_declarations_;
+
   SourceFileSet build_args_dependency_files_;
 
   Args& operator=(const Args&) = delete;
@@ -7,8 +7,12 @@
 #include <utility>
 
 #include "base/files/file_util.h"
+#include "gn/exec_script_cache.h"
 #include "gn/filesystem_utils.h"
+#include "gn/incremental_gen_state.h"
+#include "gn/ninja_file_manifest.h"
 #include "gn/ohos_components.h"
+#include "gn/python_worker.h"
 
 BuildSettings::BuildSettings() = default;
 
@@ -25,6 +29,8 @@ BuildSettings::BuildSettings(const BuildSettings& other)
       build_dir_(other.build_dir_),
       build_args_(other.build_args_) {}
 
+BuildSettings::~BuildSettings() = default;
+
 void BuildSettings::SetRootTargetLabel(const Label& r) {
   root_target_label_ = r;
 }
@@ -95,6 +101,25 @@ void BuildSettings::ItemDefined(std::unique_ptr<Item> item) const {
     item_defined_callback_(std::move(item));
 }
 
+void BuildSettings::set_exec_script_cache(
+    std::unique_ptr<ExecScriptCache> cache) {
+  exec_script_cache_ = std::move(cache);
+}
+
+void BuildSettings::set_ninja_file_manifest(
+    std::unique_ptr<NinjaFileManifest> manifest) {
+  ninja_file_manifest_ = std::move(manifest);
+}
+
+void BuildSettings::set_incremental_gen_state(
+    std::unique_ptr<IncrementalGenState> state) {
+  incremental_gen_state_ = std::move(state);
+}
+
+void BuildSettings::set_python_worker_pool(
+    std::unique_ptr<PythonWorkerPool> pool) {
+  python_worker_pool_ = std::move(pool);
+}
 
 void BuildSettings::SetOhosComponentsInfo(OhosComponents *ohos_components)
 {
@@ -20,9 +20,13 @@
 #include "gn/source_file.h"
 #include "gn/version.h"
 
+class ExecScriptCache;
+class IncrementalGenState;
 class Item;
+class NinjaFileManifest;
 class OhosComponent;
 class OhosComponents;
+class PythonWorkerPool;
 
 // Settings for one build, which is one toplevel output directory. There
 // may be multiple Settings objects that refer to this, one for each toolchain.
@@ -33,6 +37,7 @@ class BuildSettings {
 
   BuildSettings();
   BuildSettings(const BuildSettings& other);
+  ~BuildSettings();
 
   // Root target label.
   const Label& root_target_label() const { return root_target_label_; }
@@ -164,6 +169,33 @@ class BuildSettings {
     exec_script_allowlist_ = std::move(list);
   }
 
+  // The cache of exec_script() results, or null if caching is disabled.
+  ExecScriptCache* exec_script_cache() const {
+    return exec_script_cache_.get();
+  }
+  void set_exec_script_cache(std::unique_ptr<ExecScriptCache> cache);
+
+  // The record of the ninja files written by the previous "gn gen", used to
+  // skip rewriting unchanged ones. Null when not generating ninja files.
+  NinjaFileManifest* ninja_file_manifest() const {
+    return ninja_file_manifest_.get();
+  }
+  void set_ninja_file_manifest(std::unique_ptr<NinjaFileManifest> manifest);
+
+  // What "gn gen --incremental" keeps from the previous run, or null when not
+  // generating incrementally.
+  IncrementalGenState* incremental_gen_state() const {
+    return incremental_gen_state_.get();
+  }
+  void set_incremental_gen_state(std::unique_ptr<IncrementalGenState> state);
+
+  // The pool of Python processes used to run scripts, or null if scripts
+  // should each be run in a new process.
+  PythonWorkerPool* python_worker_pool() const {
+    return python_worker_pool_.get();
+  }
+  void set_python_worker_pool(std::unique_ptr<PythonWorkerPool> pool);
+
   const OhosComponent *GetOhosComponentByName(const std::string &component_name) const;
 
   bool isOhosIndepCompilerEnable() const;
@@ -201,6 +233,10 @@ private:
   PrintCallback print_callback_;
 
   std::unique_ptr<SourceFileSet> exec_script_allowlist_;
+  std::unique_ptr<ExecScriptCache> exec_script_cache_;
+  std::unique_ptr<NinjaFileManifest> ninja_file_manifest_;
+  std::unique_ptr<IncrementalGenState> incremental_gen_state_;
+  std::unique_ptr<PythonWorkerPool> python_worker_pool_;
 
   BuildSettings& operator=(const BuildSettings&) = delete;
   bool ohos_components_support_ = false;
@@ -18,6 +18,7 @@
 #include "gn/settings.h"
 #include "gn/target.h"
 #include "gn/trace.h"
+#include "util/msg_loop.h"
 
 namespace {
 
@@ -55,13 +56,21 @@ bool RecursiveFindCycle(const BuilderRecord* search_in,
 
 }  // namespace
 
-Builder::Builder(Loader* loader) : loader_(loader) {}
+Builder::Builder(Loader* loader)
+    : loader_(loader), main_loop_(MsgLoop::Current()) {}
 
 Builder::~Builder() = default;
 
 void Builder::ItemDefined(std::unique_ptr<Item> item) {
   ScopedTrace trace(TraceItem::TRACE_DEFINE_TARGET, item->label());
   trace.SetToolchain(item->settings()->toolchain_label());
+  const Target* target = TracingEnabled() ? item->AsTarget() : nullptr;
+  if (target) {
+    trace.AddFlow(TraceItem::FLOW_STEP, target->label());
+    trace.AddArg("type",
+                 Target::GetStringForOutputType(target->output_type()));
+    trace.AddArg("sources", static_cast<int64_t>(target->sources().size()));
+  }
 
   BuilderRecord::ItemType type = BuilderRecord::TypeOfItem(item.get());
 
@@ -73,21 +82,45 @@ void Builder::ItemDefined(std::unique_ptr<Item> item) {
     return;
   }
 
-  // Check that it's not been already defined.
-  if (record->item()) {
-    bool with_toolchain =
-        item->settings()->ShouldShowToolchain({&item->label()});
-    err =
-        Err(item->defined_from(), "Duplicate definition.",
-            "The item\n  " + item->label().GetUserVisibleName(with_toolchain) +
-                "\nwas already defined.");
-    err.AppendSubErr(
-        Err(record->item()->defined_from(), "Previous definition:"));
+  BuilderRecordSet waiting_on_definition;
+  {
+    std::lock_guard<std::mutex> lock(record->mutex());
+
+    // Check that it's not been already defined.
+    if (record->item()) {
+      bool with_toolchain =
+          item->settings()->ShouldShowToolchain({&item->label()});
+      err = Err(
+          item->defined_from(), "Duplicate definition.",
+          "The item\n  " + item->label().GetUserVisibleName(with_toolchain) +
+              "\nwas already defined.");
+      err.AppendSubErr(
+          Err(record->item()->defined_from(), "Previous definition:"));
+    } else {
+      record->set_item(std::move(item));
+      // Dependencies added below may get resolved by other threads right
+      // away. Don't let that resolve this record before all of them are
+      // known.
+      record->HoldResolution();
+      // Records that start waiting on this one to be defined after this
+      // point will see it's defined (see BuilderRecord::AddValidationDep()).
+      waiting_on_definition = std::move(record->waiting_on_definition());
+      record->waiting_on_definition().clear();
+    }
+  }
+  if (err.has_error()) {
     g_scheduler->FailWithError(err);
     return;
   }
 
-  record->set_item(std::move(item));
+  // Records validated by this one only needed it to be defined.
+  for (auto it = waiting_on_definition.begin(); it.valid(); ++it) {
+    BuilderRecord* waiting = *it;
+    if (waiting->OnDefinedDep(record) && !ResolveItem(waiting, &err)) {
+      g_scheduler->FailWithError(err);
+      return;
+    }
+  }
 
   // Do target-specific dependency setup. This will also schedule dependency
   // loads for targets that are required.
@@ -109,7 +142,7 @@ void Builder::ItemDefined(std::unique_ptr<Item> item) {
     return;
   }
 
-  if (record->can_resolve()) {
+  if (record->ReleaseResolution()) {
     if (!ResolveItem(record, &err)) {
       g_scheduler->FailWithError(err);
       return;
@@ -260,6 +293,7 @@ bool Builder::TargetDefined(BuilderRecord* record, Err* err) {
       !AddDeps(record, target->own_all_dependent_configs(), err) ||
       !AddDeps(record, target->own_public_configs(), err) ||
       !AddGenDeps(record, target->gen_deps(), err) ||
+      !AddValidationDeps(record, target->validations(), err) ||
       !AddPoolDep(record, target, err) || !AddToolchainDep(record, target, err))
     return false;
 
@@ -316,7 +350,8 @@ bool Builder::ToolchainDefined(BuilderRecord* record, Err* err) {
       toolchain->settings()->default_toolchain_label() == toolchain->label())
     RecursiveSetShouldGenerate(record, true);
 
-  loader_->ToolchainLoaded(toolchain);
+  Loader* loader = loader_;
+  RunOnMainThread([loader, toolchain]() { loader->ToolchainLoaded(toolchain); });
   return true;
 }
 
@@ -395,6 +430,7 @@ bool Builder::AddDeps(BuilderRecord* record,
     if (!dep_record)
       return false;
     record->AddDep(dep_record);
+    AddLoadPriorityHint(dep_record);
   }
   return true;
 }
@@ -408,6 +444,7 @@ bool Builder::AddDeps(BuilderRecord* record,
     if (!dep_record)
       return false;
     record->AddDep(dep_record);
+    AddLoadPriorityHint(dep_record);
   }
   return true;
 }
@@ -421,6 +458,7 @@ bool Builder::AddDeps(BuilderRecord* record,
     if (!dep_record)
       return false;
     record->AddDep(dep_record);
+    AddLoadPriorityHint(dep_record);
   }
   return true;
 }
@@ -481,20 +519,31 @@ bool Builder::AddValidationDeps(BuilderRecord* record,
 }
 
 void Builder::RecursiveSetShouldGenerate(BuilderRecord* record, bool force) {
-  if (!record->should_generate()) {
+  // The flag is set and the dependencies copied under the record's lock. A
+  // thread defining the record concurrently adds its deps under the same lock
+  // before checking the flag, so each dependency is reached by one of us.
+  bool was_set;
+  std::vector<BuilderRecord*> deps;
+  {
+    std::lock_guard<std::mutex> lock(record->mutex());
+    was_set = record->should_generate();
+    if (was_set && !force)
+      return;  // Already set and we're not required to iterate dependencies.
+
     // This function can encounter cycles because gen_deps aren't a DAG. Setting
     // the should_generate flag before iterating avoids infinite recursion in
     // that case.
     record->set_should_generate(true);
+    deps.reserve(record->all_deps().size());
+    for (auto it = record->all_deps().begin(); it.valid(); ++it)
+      deps.push_back(*it);
+  }
 
-    // This may have caused the item to go into "resolved and generated" state.
+  // This may have caused the item to go into "resolved and generated" state.
+  if (!was_set)
     CheckAndTriggerWrite(record);
-  } else if (!force) {
-    return;  // Already set and we're not required to iterate dependencies.
-  }
 
-  for (auto it = record->all_deps().begin(); it.valid(); ++it) {
-    BuilderRecord* cur = *it;
+  for (BuilderRecord* cur : deps) {
     if (!cur->should_generate()) {
       ScheduleItemLoadIfNecessary(cur);
       RecursiveSetShouldGenerate(cur, false);
@@ -504,7 +553,28 @@ void Builder::RecursiveSetShouldGenerate(BuilderRecord* record, bool force) {
 
 void Builder::ScheduleItemLoadIfNecessary(BuilderRecord* record) {
   const ParseNode* origin = record->originally_referenced_from();
-  loader_->Load(record->label(), origin ? origin->GetRange() : LocationRange());
+  RunOnMainThread([loader = loader_, label = record->label(),
+                   range = origin ? origin->GetRange() : LocationRange()]() {
+    loader->Load(label, range);
+  });
+}
+
+void Builder::RunOnMainThread(std::function<void()> task) {
+  if (!main_loop_ || MsgLoop::Current() == main_loop_)
+    task();
+  else
+    main_loop_->PostTask(std::move(task));
+}
+
+void Builder::AddLoadPriorityHint(const BuilderRecord* dep_record) {
+  {
+    std::lock_guard<std::mutex> lock(dep_record->mutex());
+    if (dep_record->item())
+      return;
+  }
+  RunOnMainThread([loader = loader_, label = dep_record->label()]() {
+    loader->AddLoadPriorityHint(label);
+  });
 }
 
 bool Builder::ResolveItem(BuilderRecord* record, Err* err) {
@@ -542,40 +612,31 @@ bool Builder::ResolveItem(BuilderRecord* record, Err* err) {
   return CompleteItemResolution(record, err);
 }
 
-void Builder::ScheduleTargetOnResolve(BuilderRecord* record) {
-  DCHECK(g_scheduler);
-
-  g_scheduler->IncrementWorkCount();
-  g_scheduler->ScheduleWork([this, record]() {
-    Err err;
-    bool success = record->item()->AsTarget()->OnResolved(&err);
-    DCHECK(success == !err.has_error());
-
-    g_scheduler->task_runner()->PostTask(
-        [this, record, err]() { CompleteAsyncTargetResolution(record, err); });
-  });
-}
-
-void Builder::CompleteAsyncTargetResolution(BuilderRecord* record,
-                                            const Err& err) {
-  if (err.has_error()) {
-    g_scheduler->FailWithError(err);
-  } else {
-    Err next_err;
-    if (!CompleteItemResolution(record, &next_err)) {
-      g_scheduler->FailWithError(next_err);
-    }
-  }
-  g_scheduler->DecrementWorkCount();
-}
-
 bool Builder::CompleteItemResolution(BuilderRecord* record, Err* err) {
-  record->set_resolved(true);
+  // Records that start waiting on this one after this point will see it's
+  // resolved (see BuilderRecord::AddDep()).
+  BuilderRecordSet waiting_deps;
+  BuilderRecordSet waiting_for_writing;
+  {
+    std::lock_guard<std::mutex> lock(record->mutex());
+    record->set_resolved(true);
+    waiting_deps = std::move(record->waiting_on_resolution());
+    record->waiting_on_resolution().clear();
+    waiting_for_writing =
+        std::move(record->waiting_on_resolution_for_writing());
+    record->waiting_on_resolution_for_writing().clear();
+  }
 
   CheckAndTriggerWrite(record);
 
+  // Records validated by this one can be written once it's resolved.
+  for (auto it = waiting_for_writing.begin(); it.valid(); ++it) {
+    BuilderRecord* waiting = *it;
+    if (waiting->OnResolvedValidationDep(record))
+      CheckAndTriggerWrite(waiting);
+  }
+
   // Recursively update everybody waiting on this item to be resolved.
-  const BuilderRecordSet waiting_deps = record->waiting_on_resolution();
   for (auto it = waiting_deps.begin(); it.valid(); ++it) {
     BuilderRecord* waiting = *it;
     if (waiting->OnResolvedDep(record)) {
@@ -583,7 +644,6 @@ bool Builder::CompleteItemResolution(BuilderRecord* record, Err* err) {
         return false;
     }
   }
-  record->waiting_on_resolution().clear();
 
   return true;
 }
@@ -607,7 +667,12 @@ bool Builder::ResolveValidationDeps(LabelTargetVector* deps, Err* err) {
 
     // We only need the item to be defined, not resolved.
     BuilderRecord* record = GetRecord(cur.label);
-    if (!record || !record->item()) {
+    bool defined = false;
+    if (record) {
+      std::lock_guard<std::mutex> lock(record->mutex());
+      defined = !!record->item();
+    }
+    if (!defined) {
       *err = Err(cur.origin, "Item not found",
                  "\"" + cur.label.GetUserVisibleName(true) +
                      "\" doesn't\n"
@@ -696,10 +761,19 @@ bool Builder::ResolvePools(Toolchain* toolchain, Err* err) {
 }
 
 void Builder::CheckAndTriggerWrite(BuilderRecord* record) {
-  if (record->resolved() && record->should_generate() && record->can_write() &&
-      resolved_and_generated_callback_) {
-    resolved_and_generated_callback_(record);
+  if (!resolved_and_generated_callback_)
+    return;
+
+  // The resolving thread and a thread setting should_generate may both get
+  // here; only the first one runs the callback.
+  {
+    std::lock_guard<std::mutex> lock(record->mutex());
+    if (!record->resolved() || !record->should_generate() ||
+        !record->can_write() || record->write_triggered())
+      return;
+    record->set_write_triggered();
   }
+  resolved_and_generated_callback_(record);
 }
 
 std::string Builder::CheckForCircularDependencies(
@@ -18,10 +18,20 @@
 class ActionValues;
 class Err;
 class Loader;
+class MsgLoop;
 class ParseNode;
 
-// The builder assembles the dependency tree. It is not threadsafe and runs on
-// the main thread only. See also BuilderRecord.
+// The builder assembles the dependency tree. See also BuilderRecord.
+//
+// Items are defined from whichever thread loaded them, and each item is
+// resolved on the thread that defines or resolves its last unresolved
+// dependency. The record map is sharded, each record has its own lock and
+// the unresolved dependency counts are atomic. No two locks are ever held at
+// once. Calls into the Loader, which isn't threadsafe, are posted to the
+// thread that created the Builder.
+//
+// The query functions (GetItem, GetAllRecords, CheckForBadItems, ...) must
+// only be used once no items are being defined.
 class Builder {
  public:
   using ResolvedGeneratedCallback = std::function<void(const BuilderRecord*)>;
@@ -30,7 +40,8 @@ class Builder {
   ~Builder();
 
   // The resolved callback is called when a target has been both resolved and
-  // marked generated. This will be executed only on the main thread.
+  // marked generated. This may be executed on any thread, exactly once per
+  // record.
   void set_resolved_and_generated_callback(
       const ResolvedGeneratedCallback& cb) {
     resolved_and_generated_callback_ = cb;
@@ -121,11 +132,18 @@ class Builder {
 
   void ScheduleItemLoadIfNecessary(BuilderRecord* record);
 
+  // Runs |task| now if called on the Builder's main thread, or posts it there
+  // otherwise.
+  void RunOnMainThread(std::function<void()> task);
+
+  // Called when a record starts waiting on |dep_record|. If its item isn't
+  // defined yet, tells the loader so the file defining it can be loaded
+  // before files nobody waits on.
+  void AddLoadPriorityHint(const BuilderRecord* dep_record);
+
   // This takes a BuilderRecord with resolved dependencies, and fills in the
   // target's Label*Vectors with the resolved pointers.
   bool ResolveItem(BuilderRecord* record, Err* err);
-  void ScheduleTargetOnResolve(BuilderRecord* record);
-  void CompleteAsyncTargetResolution(BuilderRecord* record, const Err& err);
   bool CompleteItemResolution(BuilderRecord* record, Err* err);
 
   // Fills in the pointers in the given vector based on the labels. We assume
@@ -151,6 +169,9 @@ class Builder {
   // Non owning pointer.
   Loader* loader_;
 
+  // The loop of the thread that created the Builder, if any.
+  MsgLoop* main_loop_;
+
   BuilderRecordMap records_;
 
   ResolvedGeneratedCallback resolved_and_generated_callback_;
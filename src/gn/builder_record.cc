@@ -63,8 +63,18 @@ BuilderRecord::ItemType BuilderRecord::TypeOfItem(const Item* item) {
 }
 
 void BuilderRecord::AddDep(BuilderRecord* record) {
-  if (all_deps_.add(record) && !record->resolved()) {
-    unresolved_count_ += 1;
+  // The two locks are taken one after the other, never together, so threads
+  // adding opposite edges can't deadlock. Checking |resolved_| and
+  // registering with |record| under its lock means that either it resolves
+  // later and notifies us, or it was already resolved and we don't wait.
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!all_deps_.add(record))
+      return;
+  }
+  std::lock_guard<std::mutex> lock(record->mutex_);
+  if (!record->resolved_) {
+    unresolved_count_++;
     record->waiting_on_resolution_.add(this);
   }
 }
@@ -72,6 +82,7 @@ void BuilderRecord::AddDep(BuilderRecord* record) {
 void BuilderRecord::AddGenDep(BuilderRecord* record) {
   // Records don't have to wait on resolution of their gen deps, since all they
   // need to do is propagate should_generate to them.
+  std::lock_guard<std::mutex> lock(mutex_);
   all_deps_.insert(record);
 }
 
@@ -84,33 +95,44 @@ void BuilderRecord::AddValidationDep(BuilderRecord* record) {
   // 3. They block writing if they are unresolved. This prevents race conditions
   //    where we might write the ninja file before the validation output path
   //    is computed.
-  all_deps_.add(record);
-  if (validation_deps_.add(record)) {
-    if (!record->item()) {
-      unresolved_count_ += 1;
-      record->waiting_on_definition_.add(this);
-    }
-    if (!record->resolved()) {
-      unresolved_validation_count_ += 1;
-      record->waiting_on_resolution_for_writing_.add(this);
-    }
+  // The locks are taken one after the other, as in AddDep().
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    all_deps_.add(record);
+    if (!validation_deps_.add(record))
+      return;
+  }
+  std::lock_guard<std::mutex> lock(record->mutex_);
+  if (!record->item_) {
+    unresolved_count_++;
+    record->waiting_on_definition_.add(this);
+  }
+  if (!record->resolved_) {
+    unresolved_validation_count_++;
+    record->waiting_on_resolution_for_writing_.add(this);
   }
 }
 
 bool BuilderRecord::OnDefinedDep(const BuilderRecord* dep) {
-  DCHECK(all_deps_.contains(const_cast<BuilderRecord*>(dep)));
+  // As in OnResolvedDep(), |all_deps_| may still be growing.
   DCHECK(unresolved_count_ > 0);
   return --unresolved_count_ == 0;
 }
 
 bool BuilderRecord::OnResolvedDep(const BuilderRecord* dep) {
-  DCHECK(all_deps_.contains(const_cast<BuilderRecord*>(dep)));
+  // |all_deps_| may still be growing on the thread defining this record, so
+  // it can't be checked here.
+  DCHECK(unresolved_count_ > 0);
+  return --unresolved_count_ == 0;
+}
+
+bool BuilderRecord::ReleaseResolution() {
   DCHECK(unresolved_count_ > 0);
   return --unresolved_count_ == 0;
 }
 
 bool BuilderRecord::OnResolvedValidationDep(const BuilderRecord* dep) {
-  DCHECK(validation_deps_.contains(const_cast<BuilderRecord*>(dep)));
+  // As in OnResolvedDep(), |validation_deps_| may still be growing.
   DCHECK(unresolved_validation_count_ > 0);
   return --unresolved_validation_count_ == 0;
 }
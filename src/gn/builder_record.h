@@ -5,7 +5,9 @@
 #ifndef TOOLS_GN_BUILDER_RECORD_H_
 #define TOOLS_GN_BUILDER_RECORD_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 #include "gn/item.h"
@@ -26,6 +28,10 @@ class ParseNode;
 //
 // You can also have null item pointers when the target is not required for
 // the current build (should_generate is false).
+//
+// Records are shared by the threads defining items. The item, the flags and
+// the record sets are guarded by mutex(); the flags are atomic so they can
+// also be peeked at without it. See Builder for the locking protocol.
 class BuilderRecord {
  public:
   using BuilderRecordSet = PointerSet<BuilderRecord>;
@@ -65,6 +71,8 @@ class BuilderRecord {
     return originally_referenced_from_;
   }
 
+  std::mutex& mutex() const { return mutex_; }
+
   bool should_generate() const { return should_generate_; }
   void set_should_generate(bool sg) { should_generate_ = sg; }
 
@@ -77,6 +85,18 @@ class BuilderRecord {
     return resolved_ && unresolved_validation_count_ == 0;
   }
 
+  // Whether the builder has already reported this record as resolved and
+  // generated. Guarded by mutex().
+  bool write_triggered() const { return write_triggered_; }
+  void set_write_triggered() { write_triggered_ = true; }
+
+  // Holds back resolution while the dependencies of a newly defined item are
+  // being added, since other threads may resolve those dependencies (and
+  // decrement the unresolved count) in the meantime. ReleaseResolution()
+  // returns true if the record can now be resolved.
+  void HoldResolution() { unresolved_count_++; }
+  bool ReleaseResolution();
+
   // All records this one is depending on. Note that this includes gen_deps for
   // targets, which can have cycles.
   BuilderRecordSet& all_deps() { return all_deps_; }
@@ -140,14 +160,17 @@ class BuilderRecord {
 
  private:
   ItemType type_;
-  bool should_generate_ = false;
-  bool resolved_ = false;
+  std::atomic<bool> should_generate_{false};
+  std::atomic<bool> resolved_{false};
+  bool write_triggered_ = false;
   Label label_;
   std::unique_ptr<Item> item_;
   const ParseNode* originally_referenced_from_ = nullptr;
 
-  size_t unresolved_count_ = 0;
-  size_t unresolved_validation_count_ = 0;
+  mutable std::mutex mutex_;
+
+  std::atomic<size_t> unresolved_count_{0};
+  std::atomic<size_t> unresolved_validation_count_{0};
   BuilderRecordSet all_deps_;
   BuilderRecordSet validation_deps_;
   BuilderRecordSet waiting_on_resolution_;
@@ -5,6 +5,9 @@
 #ifndef SRC_GN_BUILDER_RECORD_MAP_H_
 #define SRC_GN_BUILDER_RECORD_MAP_H_
 
+#include <mutex>
+#include <utility>
+
 #include "gn/builder_record.h"
 #include "gn/hash_table_base.h"
 
@@ -26,19 +29,25 @@ struct BuilderRecordNode {
   size_t hash_value() const { return record->label().hash(); }
 };
 
-class BuilderRecordMap : public HashTableBase<BuilderRecordNode> {
+// The map is split into shards, each with its own lock, so that workers
+// defining items in parallel rarely contend. find() and try_emplace() are
+// thread-safe. Iteration is not, and must only happen once no other thread
+// is modifying the map.
+class BuilderRecordMap {
  public:
-  using NodeType = BuilderRecordNode;
+  static constexpr size_t kShardCount = 32;
 
-  ~BuilderRecordMap() {
-    for (auto it = NodeBegin(); it.valid(); ++it) {
-      delete it->record;
-    }
-  }
+  BuilderRecordMap() = default;
+  ~BuilderRecordMap() = default;
+
+  bool empty() const { return size() == 0; }
+  size_t size() const;
 
   // Find BuilderRecord matching |label| or return nullptr.
   BuilderRecord* find(const Label& label) const {
-    return Lookup(label)->record;
+    const Shard& shard = ShardFor(label);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.table.find(label);
   }
 
   // Try to find BuilderRecord matching |label|, and create one if
@@ -47,34 +56,131 @@ class BuilderRecordMap : public HashTableBase<BuilderRecordNode> {
   std::pair<bool, BuilderRecord*> try_emplace(const Label& label,
                                               const ParseNode* request_from,
                                               BuilderRecord::ItemType type) {
-    NodeType* node = Lookup(label);
-    if (node->is_valid()) {
-      return {false, node->record};
+    Shard& shard = ShardFor(label);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.table.try_emplace(label, request_from, type);
+  }
+
+ private:
+  // One unlocked Label -> BuilderRecord hash table.
+  class Table : public HashTableBase<BuilderRecordNode> {
+   public:
+    using NodeType = BuilderRecordNode;
+    using HashTableBase<BuilderRecordNode>::NodeIterator;
+
+    ~Table() {
+      for (auto it = NodeBegin(); it.valid(); ++it) {
+        delete it->record;
+      }
+    }
+
+    BuilderRecord* find(const Label& label) const {
+      return Lookup(label)->record;
     }
-    BuilderRecord* record = new BuilderRecord(type, label, request_from);
-    node->record = record;
-    UpdateAfterInsert(false);
-    return {true, record};
+
+    std::pair<bool, BuilderRecord*> try_emplace(const Label& label,
+                                                const ParseNode* request_from,
+                                                BuilderRecord::ItemType type) {
+      NodeType* node = Lookup(label);
+      if (node->is_valid()) {
+        return {false, node->record};
+      }
+      BuilderRecord* record = new BuilderRecord(type, label, request_from);
+      node->record = record;
+      UpdateAfterInsert(false);
+      return {true, record};
+    }
+
+    NodeIterator begin() const { return NodeBegin(); }
+
+   private:
+    NodeType* Lookup(const Label& label) const {
+      return NodeLookup(label.hash(), [&label](const NodeType* node) {
+        return node->record->label() == label;
+      });
+    }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    Table table;
+  };
+
+  // Shards are picked by the high bits of the hash since the tables use the
+  // low ones.
+  static size_t ShardIndex(const Label& label) {
+    return (label.hash() >> 16) % kShardCount;
+  }
+  Shard& ShardFor(const Label& label) { return shards_[ShardIndex(label)]; }
+  const Shard& ShardFor(const Label& label) const {
+    return shards_[ShardIndex(label)];
   }
 
+ public:
   // Iteration support
-  struct const_iterator : public NodeIterator {
+  class const_iterator {
+   public:
+    const_iterator(const Shard* shard, const Shard* shards_end)
+        : shard_(shard), shards_end_(shards_end) {
+      if (shard_ != shards_end_)
+        node_ = shard_->table.begin();
+      SkipEmptyShards();
+    }
+
     const BuilderRecord& operator*() const { return *node_->record; }
     BuilderRecord& operator*() { return *node_->record; }
 
     const BuilderRecord* operator->() const { return node_->record; }
     BuilderRecord* operator->() { return node_->record; }
+
+    const_iterator& operator++() {
+      ++node_;
+      SkipEmptyShards();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return shard_ == other.shard_ && node_ == other.node_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    void SkipEmptyShards() {
+      while (shard_ != shards_end_ && !node_.valid()) {
+        ++shard_;
+        node_ = shard_ != shards_end_ ? shard_->table.begin()
+                                      : Table::NodeIterator();
+      }
+    }
+
+    const Shard* shard_;
+    const Shard* shards_end_;
+    Table::NodeIterator node_;
   };
 
-  const_iterator begin() const { return {NodeBegin()}; }
-  const_iterator end() const { return {NodeEnd()}; }
+  const_iterator begin() const {
+    return {shards_, shards_ + kShardCount};
+  }
+  const_iterator end() const {
+    return {shards_ + kShardCount, shards_ + kShardCount};
+  }
 
  private:
-  NodeType* Lookup(const Label& label) const {
-    return NodeLookup(label.hash(), [&label](const NodeType* node) {
-      return node->record->label() == label;
-    });
-  }
+  Shard shards_[kShardCount];
+
+  BuilderRecordMap(const BuilderRecordMap&) = delete;
+  BuilderRecordMap& operator=(const BuilderRecordMap&) = delete;
 };
 
+inline size_t BuilderRecordMap::size() const {
+  size_t result = 0;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    result += shard.table.size();
+  }
+  return result;
+}
+
 #endif  // SRC_GN_BUILDER_RECORD_MAP_H_
@@ -3,7 +3,9 @@
 // found in the LICENSE file.
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include "gn/builder.h"
 #include "gn/config.h"
@@ -88,6 +90,22 @@ class BuilderTest : public TestWithScheduler {
     return tc;
   }
 
+  // Defines the items of each list on its own thread, all at once, then runs
+  // the loads the threads posted.
+  void DefineOnThreads(
+      std::vector<std::vector<std::unique_ptr<Item>>>* per_thread) {
+    std::vector<std::thread> threads;
+    for (auto& items : *per_thread) {
+      threads.emplace_back([this, &items]() {
+        for (auto& item : items)
+          builder_.ItemDefined(std::move(item));
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    MsgLoop::Current()->RunUntilIdleForTesting();
+  }
+
  protected:
   scoped_refptr<MockLoader> loader_;
   Builder builder_;
@@ -377,4 +395,117 @@ TEST_F(BuilderTest, ConfigLoad) {
 }
 
 
+// Items may be defined from several threads at once, in any order. Each must
+// get resolved and reported exactly once.
+TEST_F(BuilderTest, DefineOnSeveralThreads) {
+  constexpr int kTargetCount = 200;
+  constexpr int kThreadCount = 4;
+  SourceDir toolchain_dir = settings_.toolchain_label().dir();
+  std::string toolchain_name = settings_.toolchain_label().name();
+
+  std::atomic<int> written(0);
+  builder_.set_resolved_and_generated_callback(
+      [&written](const BuilderRecord* record) {
+        if (record->type() == BuilderRecord::ITEM_TARGET)
+          written++;
+      });
+
+  DefineToolchain();
+
+  // Each target depends on the next three.
+  std::vector<Label> labels;
+  for (int i = 0; i < kTargetCount; i++) {
+    labels.emplace_back(SourceDir("//t" + std::to_string(i) + "/"), "t",
+                        toolchain_dir, toolchain_name);
+  }
+  std::vector<std::vector<std::unique_ptr<Item>>> per_thread(kThreadCount);
+  for (int i = 0; i < kTargetCount; i++) {
+    auto target = std::make_unique<Target>(&settings_, labels[i]);
+    target->set_output_type(Target::STATIC_LIBRARY);
+    target->visibility().SetPublic();
+    for (int dep = i + 1; dep < std::min(i + 4, kTargetCount); dep++)
+      target->public_deps().push_back(LabelTargetPair(labels[dep]));
+    per_thread[i % kThreadCount].push_back(std::move(target));
+  }
+  // Have half the threads define their items leaves first.
+  for (int i = 0; i < kThreadCount; i += 2)
+    std::reverse(per_thread[i].begin(), per_thread[i].end());
+  DefineOnThreads(&per_thread);
+
+  EXPECT_FALSE(scheduler().is_failed());
+  for (const Label& label : labels) {
+    const BuilderRecord* record = builder_.GetRecord(label);
+    ASSERT_TRUE(record);
+    EXPECT_TRUE(record->resolved()) << label.GetUserVisibleName(false);
+    EXPECT_TRUE(record->waiting_on_resolution().empty());
+  }
+  EXPECT_EQ(kTargetCount, written.load());
+  Err err;
+  EXPECT_TRUE(builder_.CheckForBadItems(&err));
+}
+
+// Same with gen_deps and validations, which are added to both records too.
+// Validations only need to be defined for the target to resolve, and resolved
+// for it to be written.
+TEST_F(BuilderTest, DefineWithGenDepsAndValidationsOnSeveralThreads) {
+  constexpr int kTargetCount = 200;
+  constexpr int kThreadCount = 4;
+  SourceDir toolchain_dir = settings_.toolchain_label().dir();
+  std::string toolchain_name = settings_.toolchain_label().name();
+
+  std::atomic<int> written(0);
+  builder_.set_resolved_and_generated_callback(
+      [&written](const BuilderRecord* record) {
+        if (record->type() == BuilderRecord::ITEM_TARGET)
+          written++;
+      });
+
+  DefineToolchain();
+
+  // Each target depends on the next one, has the one after as a gen_dep and
+  // is validated by the previous one, which makes a cycle.
+  std::vector<Label> labels;
+  for (int i = 0; i < kTargetCount; i++) {
+    labels.emplace_back(SourceDir("//t" + std::to_string(i) + "/"), "t",
+                        toolchain_dir, toolchain_name);
+  }
+  std::vector<std::vector<std::unique_ptr<Item>>> per_thread(kThreadCount);
+  for (int i = 0; i < kTargetCount; i++) {
+    auto target = std::make_unique<Target>(&settings_, labels[i]);
+    target->set_output_type(Target::GROUP);
+    target->visibility().SetPublic();
+    if (i + 1 < kTargetCount)
+      target->public_deps().push_back(LabelTargetPair(labels[i + 1]));
+    if (i + 2 < kTargetCount)
+      target->gen_deps().push_back(LabelTargetPair(labels[i + 2]));
+    if (i > 0)
+      target->validations().push_back(LabelTargetPair(labels[i - 1]));
+    per_thread[i % kThreadCount].push_back(std::move(target));
+  }
+  for (int i = 0; i < kThreadCount; i += 2)
+    std::reverse(per_thread[i].begin(), per_thread[i].end());
+  DefineOnThreads(&per_thread);
+
+  EXPECT_FALSE(scheduler().is_failed());
+  for (int i = 0; i < kTargetCount; i++) {
+    const BuilderRecord* record = builder_.GetRecord(labels[i]);
+    ASSERT_TRUE(record);
+    EXPECT_TRUE(record->resolved()) << i;
+    EXPECT_TRUE(record->can_write()) << i;
+    EXPECT_TRUE(record->waiting_on_definition().empty());
+    EXPECT_TRUE(record->waiting_on_resolution_for_writing().empty());
+    if (i + 2 < kTargetCount) {
+      EXPECT_TRUE(record->all_deps().contains(
+          const_cast<BuilderRecord*>(builder_.GetRecord(labels[i + 2]))));
+    }
+    if (i > 0) {
+      EXPECT_TRUE(record->validation_deps().contains(
+          const_cast<BuilderRecord*>(builder_.GetRecord(labels[i - 1]))));
+    }
+  }
+  EXPECT_EQ(kTargetCount, written.load());
+  Err err;
+  EXPECT_TRUE(builder_.CheckForBadItems(&err));
+}
+
 }  // namespace gn_builder_unittest
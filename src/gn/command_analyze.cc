@@ -118,9 +118,8 @@ int RunAnalyze(const std::vector<std::string>& args) {
     }
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  Setup* setup = LoadBuildGraph(args[0], false);
+  if (!setup)
     return 1;
 
   Err err;
@@ -630,25 +630,6 @@ Examples
       each one was set from.
 )";
 
-class PrintCallbackHolder {
- public:
-  PrintCallbackHolder() {}
-  ~PrintCallbackHolder() {
-    if (_settings.has_value()) {
-      _settings.value()->swap_print_callback(_callback.value());
-    }
-  }
-  void SwapCallbacks(BuildSettings* settings,
-                     BuildSettings::PrintCallback new_callback) {
-    _settings = settings;
-    _callback = settings->swap_print_callback(new_callback);
-  }
-
- private:
-  std::optional<BuildSettings*> _settings;
-  std::optional<BuildSettings::PrintCallback> _callback;
-};
-
 int RunDesc(const std::vector<std::string>& args) {
   if (args.size() != 2 && args.size() != 3) {
     Err(Location(), "Unknown command format. See \"gn help desc\"",
@@ -658,21 +639,10 @@ int RunDesc(const std::vector<std::string>& args) {
   }
   const base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-
+  // Silence all output while running desc if outputting to json.
   bool json = cmdline->GetSwitchValueString("format") == "json";
-  PrintCallbackHolder print_callback_holder;
-  if (json) {
-    // Silence all output while running desc if outputting to json.
-    BuildSettings* settings = &setup->build_settings();
-    print_callback_holder.SwapCallbacks(settings,
-                                        [](const std::string& str) {});
-  }
-
-  if (!setup->DoSetup(args[0], false))
-    return 1;
-  if (!setup->Run())
+  Setup* setup = LoadBuildGraph(args[0], json);
+  if (!setup)
     return 1;
 
   // Resolve target(s) and config from inputs.
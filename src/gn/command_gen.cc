@@ -4,7 +4,10 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+#include <iterator>
 #include <mutex>
+#include <set>
 #include <thread>
 #include <unordered_map>
 
@@ -18,9 +21,16 @@
 #include "gn/compile_commands_writer.h"
 #include "gn/eclipse_writer.h"
 #include "gn/filesystem_utils.h"
+#include "gn/gen_inputs_manifest.h"
+#include "gn/incremental_gen_state.h"
+#include "gn/input_file_manager.h"
 #include "gn/json_project_writer.h"
 #include "gn/label_pattern.h"
+#include "gn/memory_stats.h"
+#include "gn/ninja_build_writer.h"
+#include "gn/ninja_file_manifest.h"
 #include "gn/ninja_outputs_writer.h"
+#include "gn/ninja_rule_spool.h"
 #include "gn/ninja_target_writer.h"
 #include "gn/ninja_tools.h"
 #include "gn/ninja_writer.h"
@@ -34,6 +44,7 @@
 #include "gn/target.h"
 #include "gn/visual_studio_writer.h"
 #include "gn/xcode_writer.h"
+#include "util/atomic_write.h"
 
 namespace commands {
 
@@ -55,12 +66,14 @@ const char kSwitchIdeValueWinSdk[] = "winsdk";
 const char kSwitchIdeValueXcode[] = "xcode";
 const char kSwitchIdeValueJson[] = "json";
 const char kSwitchIdeRootTarget[] = "ide-root-target";
+const char kSwitchIncremental[] = "incremental";
 const char kSwitchNinjaExecutable[] = "ninja-executable";
 const char kSwitchNinjaExtraArgs[] = "ninja-extra-args";
 const char kSwitchNinjaOutputsFile[] = "ninja-outputs-file";
 const char kSwitchNinjaOutputsScript[] = "ninja-outputs-script";
 const char kSwitchNinjaOutputsScriptArgs[] = "ninja-outputs-script-args";
 const char kSwitchNoDeps[] = "no-deps";
+const char kSwitchStreamNinja[] = "stream-ninja";
 const char kSwitchSln[] = "sln";
 const char kSwitchXcodeProject[] = "xcode-project";
 const char kSwitchXcodeBuildSystem[] = "xcode-build-system";
@@ -81,16 +94,26 @@ const char kSwitchFilterWithData[] = "filter-with-data";
 // A map type used to implement --ide=ninja_outputs
 using NinjaOutputsMap = NinjaOutputsWriter::MapType;
 
+// Default for the amount of rules each thread buffers with --stream-ninja.
+const int kDefaultStreamNinjaChunkMiB = 4;
+
 // Collects Ninja rules for each toolchain. The lock protects the rules
 struct TargetWriteInfo {
   // Set this to true to populate |ninja_outputs_map| below.
   bool want_ninja_outputs = false;
 
+  // Collects the rules instead of |rules| when set, see --stream-ninja.
+  std::unique_ptr<NinjaRuleSpool> spool;
+
   std::mutex lock;
   NinjaWriter::PerToolchainRules rules;
 
   NinjaOutputsMap ninja_outputs_map;
 
+  // Provides the rules of targets that didn't change when set, see
+  // --incremental. Owned by the build settings.
+  IncrementalGenState* incremental = nullptr;
+
   std::unique_ptr<ResolvedTargetData> resolved =
       std::make_unique<ResolvedTargetData>();
 
@@ -104,8 +127,26 @@ void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
   std::vector<OutputFile>* ninja_outputs =
       write_info->want_ninja_outputs ? &target_ninja_outputs : nullptr;
 
+  const std::string* unchanged_rule =
+      write_info->incremental
+          ? write_info->incremental->GetUnchangedRules(target)
+          : nullptr;
   std::string rule =
-      NinjaTargetWriter::RunAndWriteFile(target, resolved, ninja_outputs);
+      unchanged_rule
+          ? *unchanged_rule
+          : NinjaTargetWriter::RunAndWriteFile(target, resolved, ninja_outputs);
+  if (MemoryStatsEnabled())
+    AddPendingNinjaBytes(StringHeapBytes(rule));
+
+  if (write_info->spool) {
+    write_info->spool->Add(target, std::move(rule));
+    if (write_info->want_ninja_outputs) {
+      std::lock_guard<std::mutex> lock(write_info->lock);
+      write_info->ninja_outputs_map.emplace(target,
+                                            std::move(target_ninja_outputs));
+    }
+    return;
+  }
 
   {
     std::lock_guard<std::mutex> lock(write_info->lock);
@@ -123,7 +164,9 @@ void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
   }
 }
 
-// Called on the main thread.
+// Called by the Builder on whichever thread resolved the record, possibly
+// several at once, and exactly once per record. It only posts the write, so
+// it touches no shared state of its own.
 void ItemResolvedAndGeneratedCallback(TargetWriteInfo* write_info,
                                       const BuilderRecord* record) {
   const Item* item = record->item();
@@ -491,6 +534,57 @@ bool RunNinjaPostProcessTools(const BuildSettings* build_settings,
   return true;
 }
 
+// Skips a regeneration of |build_dir| if none of the inputs of the previous
+// gen changed contents. Returns true if it did, after touching
+// build.ninja.stamp so that ninja considers the build files up to date.
+bool SkipUnchangedRegeneration(const base::FilePath& build_dir) {
+  GenInputsManifest manifest(build_dir);
+  if (!base::PathExists(build_dir.AppendASCII("build.ninja")) ||
+      !manifest.Load() || !manifest.InputsUnchanged()) {
+    return false;
+  }
+
+  if (util::WriteFileAtomically(build_dir.AppendASCII("build.ninja.stamp"),
+                                "", 0) != 0) {
+    return false;
+  }
+  // Saves the new modification times of the inputs that were only touched.
+  manifest.Save();
+  return true;
+}
+
+// Identifies the invocations whose incremental state can be reused: the
+// same GN binary generating the same build directory with the same switches,
+// except the ones that only change what is printed. This is the command line
+// ninja regenerates with, so running "gn gen" by hand with the same switches
+// matches too.
+std::string GetIncrementalGenKey(const BuildSettings& build_settings) {
+  static const char* const kDiagnosticSwitches[] = {
+      switches::kColor,   switches::kMemstats, switches::kNoColor,
+      switches::kThreads, switches::kTime,     switches::kTracelog,
+      switches::kVerbose,
+  };
+
+  base::CommandLine cmdline = GetSelfInvocationCommandLine(&build_settings);
+  std::string key = GenInputsManifest::GetGeneratorKey();
+  key.push_back('\n');
+  key.append(FilePathToUTF8(
+      build_settings.GetFullPath(build_settings.build_dir())));
+  for (const auto& [name, value] : cmdline.GetSwitches()) {
+    if (std::find(std::begin(kDiagnosticSwitches),
+                  std::end(kDiagnosticSwitches),
+                  name) != std::end(kDiagnosticSwitches))
+      continue;
+    key.append("\n--" + name + "=");
+    key.append(base::CommandLine::StringTypeToUTF8(value));
+  }
+  for (const auto& arg : cmdline.GetArgs()) {
+    key.push_back('\n');
+    key.append(base::CommandLine::StringTypeToUTF8(arg));
+  }
+  return key;
+}
+
 bool WriteIgnoreFile(Setup& setup, Err* err) {
   // Write a .gitignore file that causes the build directory to be ignored.
   base::FilePath output_path =
@@ -523,6 +617,18 @@ const char kGen_Help[] =
   the same as running "gn check --check-system".  See "gn help check" for
   documentation on that mode.
 
+  Ninja files whose contents don't change aren't rewritten, so that ninja
+  doesn't consider them dirty. The hash, size and modification time of each
+  ninja file written are recorded in "ninja_files.manifest" in the output
+  directory, so that the next run only needs to stat the unchanged files
+  instead of reading them back.
+
+  Similarly, the contents of the files read by the gen are recorded in
+  "gen_inputs.manifest". When ninja re-runs GN because some of them are newer
+  than the build files, GN only re-hashes the ones whose modification time
+  changed. If they all still have the same contents, it touches
+  build.ninja.stamp and exits without regenerating anything.
+
   See "gn help switches" for the common command-line switches.
 
 General options
@@ -540,6 +646,32 @@ General options
       option requires a ninja executable of at least version 1.10.0. It can be
       provided by the --ninja-executable switch. Also see "gn help clean_stale".
 
+  --stream-ninja[=<MiB>]
+      Don't keep the rules of all targets in memory until the toolchain ninja
+      files are written. Each thread buffers up to <MiB> (default 4) of rules
+      and moves them to temporary files in the build directory, which are
+      merged into the toolchain ninja files at the end. This bounds the memory
+      the rules take for very large builds, at the cost of writing them twice.
+      The output is the same either way.
+
+  --incremental
+      Reuse what the previous run did for what can't have changed. Only the
+      build files whose own contents, imports or read_file() inputs changed,
+      or whose glob_files() or path_exists() results may have changed, are
+      executed again: the items the other build files defined are restored
+      from their recorded values. A changed build file defining a toolchain
+      makes all build files execute again. The ninja rules are only generated
+      again for the targets defined by changed files and for the targets and
+      configs depending on them. The separate ninja files of the other
+      targets are left alone.
+      What each build file did, the rules of each target and the graph of the
+      items are kept in "incremental_gen.state" in the output directory. A
+      change to any other input, like args.gn or the inputs of exec_script(),
+      as well as a different GN binary or command line, makes the whole gen
+      run again. The results of exec_script() and getenv() are otherwise
+      assumed not to change. Not supported with --stream-ninja or
+      --ninja-outputs-file.
+
 IDE options
 
   GN optionally generates files for IDE. Files won't be overwritten if their
@@ -757,6 +889,14 @@ int RunGen(const std::vector<std::string>& args) {
     return 1;
   }
 
+  // Ninja runs the regeneration from the build directory, which is the
+  // argument, when any input of the previous gen is newer than its output.
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kRegeneration) &&
+      SkipUnchangedRegeneration(UTF8ToFilePath(args[0]))) {
+    return 0;
+  }
+
   // Deliberately leaked to avoid expensive process teardown.
   Setup* setup = new Setup();
   // Generate an empty args.gn file if it does not exists
@@ -774,6 +914,35 @@ int RunGen(const std::vector<std::string>& args) {
       setup->set_check_system_includes(true);
   }
 
+  const base::FilePath build_dir = setup->build_settings().GetFullPath(
+      setup->build_settings().build_dir());
+
+  // The previous state must be loaded while the inputs manifest of the
+  // previous run still tells which inputs changed since.
+  TargetWriteInfo write_info;
+  std::string incremental_key;
+  if (command_line->HasSwitch(kSwitchIncremental) &&
+      !command_line->HasSwitch(kSwitchStreamNinja) &&
+      !command_line->HasSwitch(kSwitchNinjaOutputsFile)) {
+    incremental_key = GetIncrementalGenKey(setup->build_settings());
+    auto incremental =
+        std::make_unique<IncrementalGenState>(&setup->build_settings());
+    GenInputsManifest previous_inputs(build_dir);
+    if (previous_inputs.Load()) {
+      std::set<base::FilePath> changed_inputs;
+      previous_inputs.GetChangedInputs(&changed_inputs);
+      incremental->Load(incremental_key, changed_inputs);
+    }
+    write_info.incremental = incremental.get();
+    setup->build_settings().set_incremental_gen_state(std::move(incremental));
+  }
+
+  // The inputs of the previous gen no longer describe the build directory
+  // once this one starts writing to it. The manifest and the incremental
+  // state are saved again if this gen succeeds.
+  GenInputsManifest::Delete(build_dir);
+  IncrementalGenState::Delete(build_dir);
+
   // If this is a regeneration, replace existing build.ninja and build.ninja.d
   // with just enough for ninja to call GN and regenerate ninja files. This
   // removes any potential soon-to-be-dangling references and ensures that
@@ -785,10 +954,36 @@ int RunGen(const std::vector<std::string>& args) {
   }
 
   // Cause the load to also generate the ninja files for each target.
-  TargetWriteInfo write_info;
   write_info.want_ninja_outputs =
       command_line->HasSwitch(kSwitchNinjaOutputsFile);
+  if (command_line->HasSwitch(kSwitchStreamNinja)) {
+    std::string value = command_line->GetSwitchValueString(kSwitchStreamNinja);
+    int chunk_mib = kDefaultStreamNinjaChunkMiB;
+    if (!value.empty() &&
+        (!base::StringToInt(value, &chunk_mib) || chunk_mib < 1)) {
+      Err(Location(), "Invalid --stream-ninja value.",
+          "Expected the number of MiB of rules to buffer per thread, got \"" +
+              value + "\".")
+          .PrintToStdout();
+      return 1;
+    }
+    write_info.spool = std::make_unique<NinjaRuleSpool>(
+        setup->build_settings().GetFullPath(
+            setup->build_settings().build_dir()),
+        static_cast<size_t>(chunk_mib) * 1024 * 1024);
+  }
+
+  // Target ninja files are written during the load, so the manifest of the
+  // previous run must be loaded first.
+  {
+    auto manifest = std::make_unique<NinjaFileManifest>(
+        setup->build_settings().GetFullPath(
+            setup->build_settings().build_dir()));
+    manifest->Load();
+    setup->build_settings().set_ninja_file_manifest(std::move(manifest));
+  }
 
+  setup->set_resolved_target_data(write_info.resolved.get());
   setup->builder().set_resolved_and_generated_callback(
       [&write_info](const BuilderRecord* record) {
         ItemResolvedAndGeneratedCallback(&write_info, record);
@@ -815,12 +1010,31 @@ int RunGen(const std::vector<std::string>& args) {
 
   Err err;
   // Write the root ninja files.
-  if (!NinjaWriter::RunAndWriteFiles(&setup->build_settings(), setup->builder(),
-                                     write_info.rules, &err)) {
+  bool written =
+      write_info.spool
+          ? NinjaWriter::RunAndWriteFiles(&setup->build_settings(),
+                                          setup->builder(),
+                                          write_info.spool.get(), &err)
+          : NinjaWriter::RunAndWriteFiles(&setup->build_settings(),
+                                          setup->builder(), write_info.rules,
+                                          &err);
+  if (!written) {
     err.PrintToStdout();
     return 1;
   }
 
+  NinjaFileManifest* manifest = setup->build_settings().ninja_file_manifest();
+  if (!manifest->Save()) {
+    Err(Location(), "Could not write the ninja file manifest.",
+        "The next run will compare all ninja files with their new contents.")
+        .PrintNonfatalToStdout();
+  }
+  if (command_line->HasSwitch(switches::kVerbose)) {
+    OutputString(base::StringPrintf(
+        "Skipped %d unchanged ninja files, checked %d others\n",
+        manifest->skipped_count(), manifest->checked_count()));
+  }
+
   if (!RunNinjaPostProcessTools(
           &setup->build_settings(),
           command_line->GetSwitchValuePath(switches::kNinjaExecutable),
@@ -893,12 +1107,43 @@ int RunGen(const std::vector<std::string>& args) {
     return 1;
   }
 
+  // Only record the inputs once everything was written.
+  GenInputsManifest inputs_manifest(setup->build_settings().GetFullPath(
+      setup->build_settings().build_dir()));
+  inputs_manifest.RecordInputs(GetGenInputFiles());
+  if (!inputs_manifest.Save()) {
+    Err(Location(), "Could not write the gen inputs manifest.",
+        "The next regeneration won't be skipped even if no input changed.")
+        .PrintNonfatalToStdout();
+  }
+
+  if (write_info.incremental) {
+    if (!write_info.incremental->Save(
+            incremental_key, setup->builder().GetAllResolvedItems(),
+            g_scheduler->GetGenDependencyReaders(), write_info.rules)) {
+      Err(Location(), "Could not write the incremental gen state.",
+          "The next run will generate the rules of all targets.")
+          .PrintNonfatalToStdout();
+    }
+    if (command_line->HasSwitch(switches::kVerbose)) {
+      OutputString(
+          base::StringPrintf("Restored %d unchanged build files\n",
+                             write_info.incremental->restored_count()));
+      OutputString(
+          base::StringPrintf("Reused the rules of %d unchanged targets\n",
+                             write_info.incremental->reused_count()));
+    }
+  }
+
+  setup->SampleMemoryStats("write");
+
   TickDelta elapsed_time = timer.Elapsed();
 
   if (!command_line->HasSwitch(switches::kQuiet)) {
     OutputString("Done. ", DECORATION_GREEN);
 
-    size_t targets_collected = 0;
+    size_t targets_collected =
+        write_info.spool ? write_info.spool->GetRuleCount() : 0;
     for (const auto& rules : write_info.rules)
       targets_collected += rules.second.size();
 
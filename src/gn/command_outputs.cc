@@ -74,11 +74,8 @@ int RunOutputs(const std::vector<std::string>& args) {
     return 1;
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false))
-    return 1;
-  if (!setup->Run())
+  Setup* setup = LoadBuildGraph(args[0], false);
+  if (!setup)
     return 1;
 
   std::vector<std::string> inputs(args.begin() + 1, args.end());
@@ -148,7 +145,7 @@ int RunOutputs(const std::vector<std::string>& args) {
 
   // Print.
   for (const OutputFile& output_file : outputs)
-    printf("%s\n", output_file.value().c_str());
+    OutputString(output_file.value() + "\n");
   return 0;
 }
 
@@ -330,11 +330,8 @@ int RunPath(const std::vector<std::string>& args) {
     return 1;
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false))
-    return 1;
-  if (!setup->Run())
+  Setup* setup = LoadBuildGraph(args[0], false);
+  if (!setup)
     return 1;
 
   const Target* target1 = ResolveTargetFromCommandLineString(setup, args[1]);
@@ -381,9 +381,8 @@ int RunRefs(const std::vector<std::string>& args) {
   }
   bool default_toolchain_only = cmdline->HasSwitch(switches::kDefaultToolchain);
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  Setup* setup = LoadBuildGraph(args[0], false);
+  if (!setup)
     return 1;
 
   // The inputs are everything but the first arg (which is the build dir).
@@ -0,0 +1,118 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "gn/commands.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/query_server.h"
+#include "gn/standard_out.h"
+#include "gn/switches.h"
+
+namespace commands {
+
+namespace {
+
+const char kSwitchSocket[] = "socket";
+
+// How often the inputs of the build are checked for changes while no client
+// is connected.
+const int kInputPollIntervalMs = 1000;
+
+// How long a connected client may send nothing before it is disconnected, so
+// that one that hangs doesn't keep the others waiting forever.
+const int kClientTimeoutMs = 10000;
+
+const char kDefaultSocketName[] = "gn.sock";
+
+}  // namespace
+
+const char kServe[] = "serve";
+const char kServe_HelpShort[] =
+    "serve: Answer queries from a build graph kept in memory.";
+const char kServe_Help[] =
+    R"(gn serve <out_dir> [--socket=<path>]
+
+  Loads the build graph of the given build directory and keeps it in memory,
+  then answers the queries of the clients connecting to a Unix domain socket.
+  Commands like "gn desc" and "gn refs" load the whole build every time they
+  run, which can take a long time on large projects. Answering them from the
+  loaded graph typically takes milliseconds.
+
+  The files read while loading the build are checked for changes before each
+  query, and every second while idle. If any changed contents, the build is
+  loaded again from scratch. gn serve doesn't write ninja files: ninja still
+  regenerates them when it needs to (see "gn help gen" for --incremental).
+
+  gn serve stops when a client asks it to, and isn't supported on Windows.
+
+  --socket=<path>
+      Where to create the socket. Defaults to "gn.sock" in the build
+      directory.
+
+Protocol
+
+  Each request is a JSON object on a line of its own. "command" is one of
+  "analyze", "desc", "outputs", "path" or "refs", and "args" are the arguments
+  and switches the command takes on the command line, without the build
+  directory. Relative paths are relative to the directory gn serve runs in.
+  The input of analyze must be a file.
+
+  The response to each request is a JSON object on a line of its own, with the
+  exit code of the command and what it would have printed.
+
+  The "stop" command makes the server exit after answering it. A client can
+  send several requests on the same connection, and other clients wait until it
+  closes it. A client that sends nothing for 10 seconds is disconnected.
+
+Example
+
+  gn serve out/Debug &
+
+  echo '{"command": "refs", "args": ["//base", "--as=output"]}' | \
+      socat - UNIX-CONNECT:out/Debug/gn.sock
+      {"exit_code":0,"output":"obj/base/base_unittests.stamp\n"}
+
+  echo '{"command": "stop"}' | socat - UNIX-CONNECT:out/Debug/gn.sock
+)";
+
+int RunServe(const std::vector<std::string>& args) {
+  if (args.size() != 1) {
+    Err(Location(), "Unknown command format. See \"gn help serve\"",
+        "Usage: \"gn serve <out_dir>\"")
+        .PrintToStdout();
+    return 1;
+  }
+
+  const base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
+  bool quiet = cmdline->HasSwitch(switches::kQuiet);
+
+  base::ElapsedTimer timer;
+  QueryServer server(args[0], *cmdline);
+  if (!server.Load())
+    return 1;
+
+  base::FilePath socket_path = cmdline->GetSwitchValuePath(kSwitchSocket);
+  if (socket_path.empty())
+    socket_path = server.GetBuildDir().AppendASCII(kDefaultSocketName);
+
+  if (!quiet) {
+    OutputString("Loaded the build graph in " +
+                 base::Int64ToString(timer.Elapsed().InMilliseconds()) +
+                 "ms, serving on " + FilePathToUTF8(socket_path) + "\n");
+  }
+
+  Err err;
+  if (!server.Serve(socket_path, kInputPollIntervalMs, kClientTimeoutMs,
+                    &err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace commands
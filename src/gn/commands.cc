@@ -17,14 +17,17 @@
 #include "gn/builder.h"
 #include "gn/config_values_extractors.h"
 #include "gn/filesystem_utils.h"
+#include "gn/input_file_manager.h"
 #include "gn/item.h"
 #include "gn/label.h"
 #include "gn/label_pattern.h"
 #include "gn/ninja_build_writer.h"
+#include "gn/scheduler.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
 #include "gn/switches.h"
 #include "gn/target.h"
+#include "gn/vector_utils.h"
 #include "util/atomic_write.h"
 #include "util/build_config.h"
 
@@ -32,6 +35,9 @@ namespace commands {
 
 namespace {
 
+// The Setup that LoadBuildGraph() returns while "gn serve" answers a query.
+Setup* resident_setup = nullptr;
+
 // Like above but the input string can be a pattern that matches multiple
 // targets. If the input does not parse as a pattern, prints and error and
 // returns false. If the pattern is valid, fills the vector (which might be
@@ -390,6 +396,7 @@ const CommandInfoMap& GetCommands() {
     INSERT_COMMAND(Outputs)
     INSERT_COMMAND(Path)
     INSERT_COMMAND(Refs)
+    INSERT_COMMAND(Serve)
     INSERT_COMMAND(CleanStale)
 
 #undef INSERT_COMMAND
@@ -423,6 +430,12 @@ CommandSwitches CommandSwitches::Set(CommandSwitches new_switches) {
   return result;
 }
 
+// static
+bool CommandSwitches::InitFromCommandLine(const base::CommandLine& cmdline,
+                                          CommandSwitches* switches) {
+  return switches->InitFrom(cmdline);
+}
+
 bool CommandSwitches::InitFrom(const base::CommandLine& cmdline) {
   CommandSwitches result;
   result.initialized_ = true;
@@ -556,6 +569,34 @@ bool PrepareForRegeneration(const BuildSettings* settings) {
   return true;
 }
 
+Setup* LoadBuildGraph(const std::string& build_dir, bool silence_print) {
+  if (resident_setup)
+    return resident_setup;
+
+  // Deliberately leaked to avoid expensive process teardown.
+  Setup* setup = new Setup;
+  if (silence_print)
+    setup->build_settings().set_print_callback([](const std::string&) {});
+  if (!setup->DoSetup(build_dir, false) || !setup->Run())
+    return nullptr;
+  return setup;
+}
+
+void SetResidentSetup(Setup* setup) {
+  resident_setup = setup;
+}
+
+std::vector<base::FilePath> GetGenInputFiles() {
+  std::vector<base::FilePath> other_files = g_scheduler->GetGenDependencies();
+  const InputFileManager* input_file_manager =
+      g_scheduler->input_file_manager();
+  VectorSetSorter<base::FilePath> sorter(
+      input_file_manager->GetInputFileCount() + other_files.size());
+  input_file_manager->AddAllPhysicalInputFileNamesToVectorSetSorter(&sorter);
+  sorter.Add(other_files.begin(), other_files.end());
+  return sorter.AsVector();
+}
+
 const Target* ResolveTargetFromCommandLineString(
     Setup* setup,
     const std::string& label_string) {
@@ -25,6 +25,7 @@ class Toolchain;
 
 namespace base {
 class CommandLine;
+class FilePath;
 }  // namespace base
 
 // Each "Run" command returns the value we should return from main().
@@ -98,6 +99,11 @@ extern const char kRefs_HelpShort[];
 extern const char kRefs_Help[];
 int RunRefs(const std::vector<std::string>& args);
 
+extern const char kServe[];
+extern const char kServe_HelpShort[];
+extern const char kServe_Help[];
+int RunServe(const std::vector<std::string>& args);
+
 extern const char kCleanStale[];
 extern const char kCleanStale_HelpShort[];
 extern const char kCleanStale_Help[];
@@ -208,6 +214,12 @@ class CommandSwitches {
   // the previous value.
   static CommandSwitches Set(CommandSwitches new_switches);
 
+  // Initialize |switches| from a given command line, e.g. the one of a query
+  // answered by "gn serve". On failure return false after printing an error
+  // message.
+  static bool InitFromCommandLine(const base::CommandLine& cmdline,
+                                  CommandSwitches* switches);
+
  private:
   bool is_initialized() const { return initialized_; }
 
@@ -250,6 +262,24 @@ class CommandSwitches {
 // On error, returns false.
 bool PrepareForRegeneration(const BuildSettings* settings);
 
+// Returns a Setup that has loaded the build graph of |build_dir|, or null
+// after printing the error. Commands that only query the graph use this. It
+// normally loads the build into a new Setup, which is leaked to avoid
+// expensive process teardown. While "gn serve" answers a query, it returns the
+// Setup the server keeps loaded instead, see SetResidentSetup().
+//
+// With |silence_print|, print() calls in build files don't print anything
+// while loading.
+Setup* LoadBuildGraph(const std::string& build_dir, bool silence_print);
+
+// Makes LoadBuildGraph() return |setup| instead of loading the build, until
+// this is called again with null.
+void SetResidentSetup(Setup* setup);
+
+// Returns the absolute paths of the files read while loading the build, as
+// listed in build.ninja.d.
+std::vector<base::FilePath> GetGenInputFiles();
+
 // Given a setup that has already been run and some command-line input,
 // resolves that input as a target label and returns the corresponding target.
 // On failure, returns null and prints the error to the standard output.
@@ -12,6 +12,7 @@
 #include "gn/builder.h"
 #include "gn/c_substitution_type.h"
 #include "gn/c_tool.h"
+#include "gn/compiled_substitution.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
 #include "gn/escape.h"
@@ -283,6 +284,7 @@ void OutputJSON(const BuildSettings* build_settings,
 
     CompileFlags flags;
     SetupCompileFlags(target, path_output, opts, resolved, flags);
+    SubstitutionExpanderCache expanders;
 
     for (const auto& source : target->sources()) {
       // If this source is not a C/C++/ObjC/ObjC++ source (not header) file,
@@ -295,7 +297,8 @@ void OutputJSON(const BuildSettings* build_settings,
         continue;
 
       const char* tool_name = Tool::kToolNone;
-      if (!target->GetOutputFilesForSource(source, &tool_name, &tool_outputs))
+      if (!target->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                           &expanders))
         continue;
 
       if (!first) {
@@ -0,0 +1,199 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/compiled_substitution.h"
+
+#include "base/logging.h"
+#include "gn/build_settings.h"
+#include "gn/filesystem_utils.h"
+#include "gn/output_file.h"
+#include "gn/settings.h"
+#include "gn/source_dir.h"
+#include "gn/source_file.h"
+#include "gn/substitution_list.h"
+#include "gn/substitution_pattern.h"
+#include "gn/substitution_writer.h"
+#include "gn/target.h"
+
+namespace {
+
+// Appends literal text to |pattern|, merging it with a preceding literal.
+void AppendLiteral(std::string_view literal,
+                   CompiledSubstitutionList::Pattern* pattern) {
+  if (literal.empty())
+    return;
+  if (!pattern->empty() && !pattern->back().type)
+    pattern->back().literal.append(literal);
+  else
+    pattern->push_back({nullptr, std::string(literal)});
+}
+
+}  // namespace
+
+CompiledSubstitutionList::CompiledSubstitutionList() = default;
+
+CompiledSubstitutionList::CompiledSubstitutionList(
+    const SubstitutionList& list) {
+  patterns_.reserve(list.list().size());
+  for (const SubstitutionPattern& pattern : list.list())
+    patterns_.push_back(CompilePattern(pattern));
+}
+
+CompiledSubstitutionList::~CompiledSubstitutionList() = default;
+
+CompiledSubstitutionList::CompiledSubstitutionList(
+    CompiledSubstitutionList&&) = default;
+CompiledSubstitutionList& CompiledSubstitutionList::operator=(
+    CompiledSubstitutionList&&) = default;
+
+// static
+CompiledSubstitutionList::Pattern CompiledSubstitutionList::CompilePattern(
+    const SubstitutionPattern& pattern) {
+  Pattern result;
+  for (const auto& range : pattern.ranges()) {
+    if (range.type == &SubstitutionLiteral)
+      AppendLiteral(range.literal, &result);
+    else
+      result.push_back({range.type, std::string()});
+  }
+  return result;
+}
+
+SubstitutionExpander::SubstitutionExpander(
+    const Target* target,
+    const Settings* settings,
+    const CompiledSubstitutionList& list,
+    Mode mode)
+    : target_(target), settings_(settings), mode_(mode) {
+  DCHECK(target_ || mode_ == SOURCE);
+
+  patterns_.reserve(list.patterns().size());
+  std::string value;
+  for (const CompiledSubstitutionList::Pattern& pattern : list.patterns()) {
+    CompiledSubstitutionList::Pattern& bound = patterns_.emplace_back();
+    for (const CompiledSubstitutionList::Step& step : pattern) {
+      if (!step.type) {
+        AppendLiteral(step.literal, &bound);
+      } else if (mode_ == COMPILER &&
+                 SubstitutionWriter::GetTargetSubstitution(target_, step.type,
+                                                           &value)) {
+        AppendLiteral(value, &bound);
+      } else {
+        bound.push_back(step);
+      }
+    }
+  }
+}
+
+SubstitutionExpander::~SubstitutionExpander() = default;
+
+void SubstitutionExpander::AppendForSource(size_t index,
+                                           const SourceFile& source,
+                                           std::string* out) const {
+  for (const CompiledSubstitutionList::Step& step : patterns_[index]) {
+    if (!step.type)
+      out->append(step.literal);
+    else
+      AppendSourceSubstitution(step.type, source, out);
+  }
+}
+
+void SubstitutionExpander::ApplyToSourceAsOutputFiles(
+    const SourceFile& source,
+    std::vector<OutputFile>* output) const {
+  for (size_t i = 0; i < patterns_.size(); i++) {
+    if (mode_ == COMPILER) {
+      // Compiler outputs are already relative to the build directory.
+      OutputFile& result = output->emplace_back();
+      AppendForSource(i, source, &result.value());
+      continue;
+    }
+
+    buffer_.clear();
+    AppendForSource(i, source, &buffer_);
+    CHECK(!buffer_.empty() && buffer_[0] == '/')
+        << "The result of the pattern for \"" << source.value()
+        << "\" was not a path beginning in \"/\" or \"//\".";
+    output->push_back(
+        OutputFile(settings_->build_settings(), SourceFile(buffer_)));
+  }
+}
+
+void SubstitutionExpander::AppendSourceSubstitution(const Substitution* type,
+                                                    const SourceFile& source,
+                                                    std::string* out) const {
+  // The parts of the file name are the most common substitutions, and don't
+  // depend on the mode.
+  const std::string& value = source.value();
+  if (type == &SubstitutionSourceNamePart) {
+    out->append(FindFilenameNoExtension(&value));
+    return;
+  }
+  if (type == &SubstitutionSourceFilePart) {
+    if (!value.empty())
+      out->append(value, value.rfind('/') + 1);
+    return;
+  }
+  if (type == &SubstitutionSource && mode_ == SOURCE) {
+    out->append(value);
+    return;
+  }
+
+  if (mode_ == COMPILER) {
+    out->append(SubstitutionWriter::GetSourceSubstitution(
+        target_, settings_, source, type, SubstitutionWriter::OUTPUT_RELATIVE,
+        settings_->build_settings()->build_dir()));
+  } else {
+    out->append(SubstitutionWriter::GetSourceSubstitution(
+        target_, settings_, source, type, SubstitutionWriter::OUTPUT_ABSOLUTE,
+        SourceDir()));
+  }
+}
+
+SubstitutionExpanderCache::SubstitutionExpanderCache() = default;
+
+SubstitutionExpanderCache::~SubstitutionExpanderCache() = default;
+
+const SubstitutionExpander& SubstitutionExpanderCache::Get(
+    const Target* target,
+    const Settings* settings,
+    const CompiledSubstitutionList& list,
+    SubstitutionExpander::Mode mode) {
+  if (const SubstitutionExpander* expander = Find(target, &list))
+    return *expander;
+  Entry& entry = entries_.emplace_back();
+  entry.list = &list;
+  entry.expander =
+      std::make_unique<SubstitutionExpander>(target, settings, list, mode);
+  return *entry.expander;
+}
+
+const SubstitutionExpander& SubstitutionExpanderCache::Get(
+    const Target* target,
+    const Settings* settings,
+    const SubstitutionList& list,
+    SubstitutionExpander::Mode mode) {
+  if (const SubstitutionExpander* expander = Find(target, &list))
+    return *expander;
+  Entry& entry = entries_.emplace_back();
+  entry.list = &list;
+  entry.compiled = std::make_unique<CompiledSubstitutionList>(list);
+  entry.expander = std::make_unique<SubstitutionExpander>(
+      target, settings, *entry.compiled, mode);
+  return *entry.expander;
+}
+
+const SubstitutionExpander* SubstitutionExpanderCache::Find(
+    const Target* target,
+    const void* list) {
+  DCHECK(!target_ || target_ == target);
+  target_ = target;
+
+  // A target uses few tools, so a linear search is fine.
+  for (const Entry& entry : entries_) {
+    if (entry.list == list)
+      return entry.expander.get();
+  }
+  return nullptr;
+}
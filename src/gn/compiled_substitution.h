@@ -0,0 +1,152 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_COMPILED_SUBSTITUTION_H_
+#define TOOLS_GN_COMPILED_SUBSTITUTION_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gn/substitution_type.h"
+
+class OutputFile;
+class Settings;
+class SourceFile;
+class SubstitutionList;
+class SubstitutionPattern;
+class Target;
+
+// The patterns of a SubstitutionList split into literal text and
+// substitutions, with adjacent literals merged. The patterns of a tool are
+// compiled once per toolchain, and can then be expanded for any target and
+// source without looking at the ranges of the SubstitutionPatterns again.
+class CompiledSubstitutionList {
+ public:
+  struct Step {
+    // Null for literal text.
+    const Substitution* type = nullptr;
+    std::string literal;
+  };
+  using Pattern = std::vector<Step>;
+
+  CompiledSubstitutionList();
+  explicit CompiledSubstitutionList(const SubstitutionList& list);
+  ~CompiledSubstitutionList();
+
+  CompiledSubstitutionList(CompiledSubstitutionList&&);
+  CompiledSubstitutionList& operator=(CompiledSubstitutionList&&);
+
+  static Pattern CompilePattern(const SubstitutionPattern& pattern);
+
+  const std::vector<Pattern>& patterns() const { return patterns_; }
+
+ private:
+  std::vector<Pattern> patterns_;
+
+  CompiledSubstitutionList(const CompiledSubstitutionList&) = delete;
+  CompiledSubstitutionList& operator=(const CompiledSubstitutionList&) =
+      delete;
+};
+
+// A CompiledSubstitutionList bound to a target. The substitutions that only
+// depend on the target are replaced by their values when it is created, so
+// expanding the patterns for a source just appends literal text and parts of
+// the source to a buffer.
+//
+// The expansions are the same as the SubstitutionWriter ones named below.
+class SubstitutionExpander {
+ public:
+  enum Mode {
+    // Like SubstitutionWriter::ApplyListToCompilerAsOutputFile. Requires a
+    // target.
+    COMPILER,
+
+    // Like SubstitutionWriter::ApplyListToSourceAsOutputFile, used for the
+    // outputs of action_foreach and copy targets. The target can be null.
+    SOURCE,
+  };
+
+  SubstitutionExpander(const Target* target,
+                       const Settings* settings,
+                       const CompiledSubstitutionList& list,
+                       Mode mode);
+  ~SubstitutionExpander();
+
+  size_t size() const { return patterns_.size(); }
+
+  // Appends the expansion of the pattern at |index| for |source| to |out|.
+  void AppendForSource(size_t index,
+                       const SourceFile& source,
+                       std::string* out) const;
+
+  // Appends the expansions of all patterns for |source| to |output|.
+  void ApplyToSourceAsOutputFiles(const SourceFile& source,
+                                  std::vector<OutputFile>* output) const;
+
+ private:
+  void AppendSourceSubstitution(const Substitution* type,
+                                const SourceFile& source,
+                                std::string* out) const;
+
+  const Target* target_;
+  const Settings* settings_;
+  Mode mode_;
+
+  // The compiled patterns with the target substitutions replaced.
+  std::vector<CompiledSubstitutionList::Pattern> patterns_;
+
+  // Reused for each expansion in SOURCE mode, which needs the text before it
+  // becomes an OutputFile.
+  mutable std::string buffer_;
+
+  SubstitutionExpander(const SubstitutionExpander&) = delete;
+  SubstitutionExpander& operator=(const SubstitutionExpander&) = delete;
+};
+
+// Keeps the SubstitutionExpanders created for one target, so that the callers
+// handling all the sources of a target bind the patterns of each tool once.
+class SubstitutionExpanderCache {
+ public:
+  SubstitutionExpanderCache();
+  ~SubstitutionExpanderCache();
+
+  // Returns the expander for |list| bound to |target|. All calls must pass
+  // the same target.
+  const SubstitutionExpander& Get(const Target* target,
+                                  const Settings* settings,
+                                  const CompiledSubstitutionList& list,
+                                  SubstitutionExpander::Mode mode);
+
+  // Same for a list that isn't compiled yet, like the outputs of an
+  // action_foreach target. It is compiled on the first call.
+  const SubstitutionExpander& Get(const Target* target,
+                                  const Settings* settings,
+                                  const SubstitutionList& list,
+                                  SubstitutionExpander::Mode mode);
+
+ private:
+  struct Entry {
+    // The list passed to Get().
+    const void* list;
+
+    // Set for lists compiled by the cache.
+    std::unique_ptr<CompiledSubstitutionList> compiled;
+
+    std::unique_ptr<SubstitutionExpander> expander;
+  };
+
+  const SubstitutionExpander* Find(const Target* target, const void* list);
+
+  const Target* target_ = nullptr;
+  std::vector<Entry> entries_;
+
+  SubstitutionExpanderCache(const SubstitutionExpanderCache&) = delete;
+  SubstitutionExpanderCache& operator=(const SubstitutionExpanderCache&) =
+      delete;
+};
+
+#endif  // TOOLS_GN_COMPILED_SUBSTITUTION_H_
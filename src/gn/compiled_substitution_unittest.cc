@@ -0,0 +1,147 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "gn/c_tool.h"
+#include "gn/compiled_substitution.h"
+#include "gn/err.h"
+#include "gn/output_file.h"
+#include "gn/source_file.h"
+#include "gn/substitution_list.h"
+#include "gn/substitution_writer.h"
+#include "gn/target.h"
+#include "gn/test_with_scope.h"
+#include "util/build_config.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::vector<SourceFile> GetSources() {
+  return {
+      SourceFile("//foo/bar/file.cc"),
+      SourceFile("//foo/bar/file.tar.gz"),
+      SourceFile("//foo/noext"),
+      SourceFile("//root.cc"),
+      SourceFile("//out/Debug/gen/generated.cc"),
+#if defined(OS_WIN)
+      SourceFile("/C:/abs/dir/file.cc"),
+#else
+      SourceFile("/abs/dir/file.cc"),
+#endif
+  };
+}
+
+}  // namespace
+
+TEST(CompiledSubstitution, Compile) {
+  CompiledSubstitutionList compiled(SubstitutionList::MakeForTest(
+      "a{{source_name_part}}b{{source_file_part}}", "literal", ""));
+  ASSERT_EQ(3u, compiled.patterns().size());
+
+  const CompiledSubstitutionList::Pattern& first = compiled.patterns()[0];
+  ASSERT_EQ(4u, first.size());
+  EXPECT_EQ(nullptr, first[0].type);
+  EXPECT_EQ("a", first[0].literal);
+  EXPECT_EQ(&SubstitutionSourceNamePart, first[1].type);
+  EXPECT_EQ("b", first[2].literal);
+  EXPECT_EQ(&SubstitutionSourceFilePart, first[3].type);
+
+  ASSERT_EQ(1u, compiled.patterns()[1].size());
+  EXPECT_EQ("literal", compiled.patterns()[1][0].literal);
+  EXPECT_TRUE(compiled.patterns()[2].empty());
+}
+
+TEST(CompiledSubstitution, Compiler) {
+  TestWithScope setup;
+  Err err;
+
+  Target target(setup.settings(), Label(SourceDir("//foo/bar/"), "baz"));
+  target.set_output_type(Target::STATIC_LIBRARY);
+  target.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  SubstitutionList list = SubstitutionList::MakeForTest(
+      "{{target_out_dir}}/{{label_name}}/{{source_name_part}}.o",
+      "{{source_out_dir}}/{{source_file_part}}.d",
+      "{{source}} {{source_dir}} {{source_root_relative_dir}}",
+      "{{source_gen_dir}}/{{target_output_name}}{{root_gen_dir}}");
+  SubstitutionExpander expander(&target, setup.settings(),
+                                CompiledSubstitutionList(list),
+                                SubstitutionExpander::COMPILER);
+  ASSERT_EQ(4u, expander.size());
+
+  // The target substitutions and the literals around them are merged.
+  std::string first;
+  expander.AppendForSource(0, SourceFile("//foo/bar/file.cc"), &first);
+  EXPECT_EQ("obj/foo/bar/baz/file.o", first);
+
+  for (const SourceFile& source : GetSources()) {
+    std::vector<OutputFile> expected;
+    SubstitutionWriter::ApplyListToCompilerAsOutputFile(&target, source, list,
+                                                        &expected);
+    std::vector<OutputFile> actual;
+    expander.ApplyToSourceAsOutputFiles(source, &actual);
+    EXPECT_EQ(expected, actual) << source.value();
+  }
+}
+
+TEST(CompiledSubstitution, Source) {
+  TestWithScope setup;
+  Err err;
+
+  Target target(setup.settings(), Label(SourceDir("//foo/bar/"), "baz"));
+  target.set_output_type(Target::ACTION_FOREACH);
+  target.SetToolchain(setup.toolchain());
+
+  SubstitutionList list = SubstitutionList::MakeForTest(
+      "{{source_gen_dir}}/{{source_name_part}}.h",
+      "//out/Debug/{{source_file_part}}",
+      "{{source_out_dir}}/{{source_target_relative}}",
+      "{{source}}.stamp");
+  SubstitutionExpander expander(&target, setup.settings(),
+                                CompiledSubstitutionList(list),
+                                SubstitutionExpander::SOURCE);
+
+  for (const SourceFile& source : GetSources()) {
+    std::vector<OutputFile> expected;
+    SubstitutionWriter::ApplyListToSourceAsOutputFile(
+        &target, setup.settings(), list, source, &expected);
+    std::vector<OutputFile> actual;
+    expander.ApplyToSourceAsOutputFiles(source, &actual);
+    EXPECT_EQ(expected, actual) << source.value();
+  }
+}
+
+TEST(CompiledSubstitution, Cache) {
+  TestWithScope setup;
+  Err err;
+
+  Target target(setup.settings(), Label(SourceDir("//foo/bar/"), "baz"));
+  target.set_output_type(Target::SOURCE_SET);
+  target.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  const Tool* tool = setup.toolchain()->GetTool(CTool::kCToolCxx);
+  SubstitutionExpanderCache expanders;
+  const SubstitutionExpander& expander =
+      expanders.Get(&target, setup.settings(), tool->compiled_outputs(),
+                    SubstitutionExpander::COMPILER);
+  EXPECT_EQ(&expander,
+            &expanders.Get(&target, setup.settings(), tool->compiled_outputs(),
+                           SubstitutionExpander::COMPILER));
+
+  // GetOutputFilesForSource gives the same result with or without a cache.
+  for (const SourceFile& source : GetSources()) {
+    const char* tool_type = nullptr;
+    std::vector<OutputFile> expected;
+    bool expected_result =
+        target.GetOutputFilesForSource(source, &tool_type, &expected);
+    std::vector<OutputFile> actual;
+    EXPECT_EQ(expected_result, target.GetOutputFilesForSource(
+                                   source, &tool_type, &actual, &expanders));
+    EXPECT_EQ(expected, actual) << source.value();
+  }
+}
@@ -6,6 +6,7 @@
 #define TOOLS_GN_CONFIG_H_
 
 #include "base/logging.h"
+#include "gn/config_fragment_cache.h"
 #include "gn/config_values.h"
 #include "gn/item.h"
 #include "gn/label_ptr.h"
@@ -51,6 +52,10 @@ class Config : public Item {
   const UniqueVector<LabelConfigPair>& configs() const { return configs_; }
   UniqueVector<LabelConfigPair>& configs() { return configs_; }
 
+  // Text written to ninja files for the resolved values, shared by the
+  // targets using this config. Filled in while targets are written.
+  ConfigFragmentCache& fragment_cache() const { return fragment_cache_; }
+
  private:
   ConfigValues own_values_;
 
@@ -62,6 +67,8 @@ class Config : public Item {
 
   UniqueVector<LabelConfigPair> configs_;
 
+  mutable ConfigFragmentCache fragment_cache_;
+
   Config(const Config&) = delete;
   Config& operator=(const Config&) = delete;
 };
@@ -0,0 +1,67 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/config_fragment_cache.h"
+
+#include <utility>
+
+struct ConfigFragmentCache::Entry {
+  const void* values;
+  const char* writer;
+  EscapeOptions options;
+  std::string current_dir;
+  ConfigFragment fragment;
+  Entry* next;
+};
+
+ConfigFragmentCache::ConfigFragmentCache() = default;
+
+ConfigFragmentCache::~ConfigFragmentCache() {
+  Entry* entry = head_.load(std::memory_order_relaxed);
+  while (entry) {
+    Entry* next = entry->next;
+    delete entry;
+    entry = next;
+  }
+}
+
+// static
+bool ConfigFragmentCache::Matches(const Entry& entry,
+                                  const void* values,
+                                  const ConfigFragmentKey& key) {
+  return entry.values == values && entry.writer == key.writer &&
+         entry.options.mode == key.options.mode &&
+         entry.options.platform == key.options.platform &&
+         entry.options.inhibit_quoting == key.options.inhibit_quoting &&
+         entry.current_dir == key.current_dir;
+}
+
+const ConfigFragment* ConfigFragmentCache::Find(
+    const void* values,
+    const ConfigFragmentKey& key) const {
+  for (const Entry* entry = head_.load(std::memory_order_acquire); entry;
+       entry = entry->next) {
+    if (Matches(*entry, values, key))
+      return &entry->fragment;
+  }
+  return nullptr;
+}
+
+const ConfigFragment& ConfigFragmentCache::Add(const void* values,
+                                               const ConfigFragmentKey& key,
+                                               ConfigFragment fragment) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (const ConfigFragment* existing = Find(values, key))
+    return *existing;
+
+  Entry* entry =
+      new Entry{values,
+                key.writer,
+                key.options,
+                std::string(key.current_dir),
+                std::move(fragment),
+                head_.load(std::memory_order_relaxed)};
+  head_.store(entry, std::memory_order_release);
+  return entry->fragment;
+}
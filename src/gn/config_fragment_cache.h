@@ -0,0 +1,76 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_CONFIG_FRAGMENT_CACHE_H_
+#define TOOLS_GN_CONFIG_FRAGMENT_CACHE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gn/escape.h"
+
+// The text written to a ninja file for one list of values of a config, e.g.
+// " -DFOO -DBAR" for its defines.
+struct ConfigFragment {
+  std::string text;
+
+  // End offset in |text| of the text for every value, so that writers that
+  // skip duplicate values can take the values one at a time.
+  std::vector<size_t> ends;
+};
+
+// Identifies how the values were written, besides which values they are.
+struct ConfigFragmentKey {
+  // Names the writer, compared by address. Use a string constant.
+  const char* writer = nullptr;
+
+  EscapeOptions options;
+
+  // The directory paths were written relative to, for writers that rebase
+  // paths. Empty otherwise.
+  std::string_view current_dir;
+};
+
+// Holds the fragments computed for the resolved values of a Config. Configs
+// are shared by many targets, so every target writing the same list with the
+// same writer can reuse the text instead of escaping and rebasing it again.
+//
+// Lookups don't lock, and can run on any thread.
+class ConfigFragmentCache {
+ public:
+  ConfigFragmentCache();
+  ~ConfigFragmentCache();
+
+  // Returns the fragment added for the list at |values| and |key|, or null.
+  const ConfigFragment* Find(const void* values,
+                             const ConfigFragmentKey& key) const;
+
+  // Adds the fragment for the list at |values| and |key|. If another thread
+  // added it first, that one is kept. Returns the fragment in the cache.
+  const ConfigFragment& Add(const void* values,
+                            const ConfigFragmentKey& key,
+                            ConfigFragment fragment);
+
+ private:
+  struct Entry;
+
+  static bool Matches(const Entry& entry,
+                      const void* values,
+                      const ConfigFragmentKey& key);
+
+  // Singly linked list of entries, which are never removed. New entries are
+  // pushed to the front under |lock_|.
+  std::atomic<Entry*> head_{nullptr};
+  std::mutex lock_;
+
+  ConfigFragmentCache(const ConfigFragmentCache&) = delete;
+  ConfigFragmentCache& operator=(const ConfigFragmentCache&) = delete;
+};
+
+#endif  // TOOLS_GN_CONFIG_FRAGMENT_CACHE_H_
@@ -0,0 +1,61 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/config_fragment_cache.h"
+#include "util/test/test.h"
+
+namespace {
+
+const char kWriter[] = "writer";
+const char kOtherWriter[] = "other_writer";
+
+ConfigFragment MakeFragment(const std::string& text) {
+  ConfigFragment fragment;
+  fragment.text = text;
+  fragment.ends.push_back(text.size());
+  return fragment;
+}
+
+}  // namespace
+
+TEST(ConfigFragmentCache, FindAndAdd) {
+  ConfigFragmentCache cache;
+  int values = 0;
+  int other_values = 0;
+
+  ConfigFragmentKey key;
+  key.writer = kWriter;
+  key.options.mode = ESCAPE_NINJA_COMMAND;
+  EXPECT_FALSE(cache.Find(&values, key));
+
+  const ConfigFragment& added = cache.Add(&values, key, MakeFragment(" -a"));
+  EXPECT_EQ(" -a", added.text);
+  EXPECT_EQ(&added, cache.Find(&values, key));
+
+  // Adding the same key again keeps the first fragment.
+  EXPECT_EQ(&added, &cache.Add(&values, key, MakeFragment(" -b")));
+  EXPECT_EQ(" -a", cache.Find(&values, key)->text);
+
+  // Every part of the key distinguishes fragments.
+  EXPECT_FALSE(cache.Find(&other_values, key));
+
+  ConfigFragmentKey other_writer = key;
+  other_writer.writer = kOtherWriter;
+  EXPECT_FALSE(cache.Find(&values, other_writer));
+
+  ConfigFragmentKey other_mode = key;
+  other_mode.options.mode = ESCAPE_COMPILATION_DATABASE;
+  EXPECT_FALSE(cache.Find(&values, other_mode));
+
+  ConfigFragmentKey other_quoting = key;
+  other_quoting.options.inhibit_quoting = true;
+  EXPECT_FALSE(cache.Find(&values, other_quoting));
+
+  ConfigFragmentKey other_dir = key;
+  other_dir.current_dir = "//out/Debug/";
+  EXPECT_FALSE(cache.Find(&values, other_dir));
+  cache.Add(&values, other_dir, MakeFragment(" -Ifoo"));
+  EXPECT_EQ(" -Ifoo", cache.Find(&values, other_dir)->text);
+  EXPECT_EQ(" -a", cache.Find(&values, key)->text);
+}
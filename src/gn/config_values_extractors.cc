@@ -8,6 +8,8 @@
 
 namespace {
 
+const char kEscapedStringWriter[] = "escaped_string";
+
 class EscapedStringWriter {
  public:
   explicit EscapedStringWriter(const EscapeOptions& escape_options)
@@ -30,6 +32,10 @@ void RecursiveTargetConfigStringsToStream(
     const std::vector<std::string>& (ConfigValues::*getter)() const,
     const EscapeOptions& escape_options,
     std::ostream& out) {
-  RecursiveTargetConfigToStream(config, target, getter,
-                                EscapedStringWriter(escape_options), out);
+  ConfigFragmentKey key;
+  key.writer = kEscapedStringWriter;
+  key.options = escape_options;
+  RecursiveTargetConfigToStreamCached(config, target, getter,
+                                      EscapedStringWriter(escape_options), key,
+                                      out);
 }
@@ -8,10 +8,13 @@
 #include <stddef.h>
 
 #include <ostream>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "gn/config.h"
+#include "gn/config_fragment_cache.h"
 #include "gn/config_values.h"
 #include "gn/target.h"
 
@@ -107,6 +110,60 @@ inline void RecursiveTargetConfigToStream(
   }
 }
 
+// Like RecursiveTargetConfigToStream, but the text |writer| produces for the
+// values of each config is computed once and reused for all targets using the
+// config. |key| must identify everything that text depends on besides the
+// values themselves. The values on the target itself are written directly.
+template <typename T, class Writer>
+inline void RecursiveTargetConfigToStreamCached(
+    RecursiveWriterConfig config,
+    const Target* target,
+    const std::vector<T>& (ConfigValues::*getter)() const,
+    const Writer& writer,
+    const ConfigFragmentKey& key,
+    std::ostream& out) {
+  std::set<T> seen;
+  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+    const std::vector<T>& values = ((iter.cur()).*getter)();
+    if (values.empty())
+      continue;
+
+    const Config* cur_config = iter.GetCurrentConfig();
+    if (!cur_config) {
+      for (const T& value : values) {
+        if (config == kRecursiveWriterKeepDuplicates ||
+            seen.insert(value).second)
+          writer(value, out);
+      }
+      continue;
+    }
+
+    ConfigFragmentCache& cache = cur_config->fragment_cache();
+    const ConfigFragment* fragment = cache.Find(&values, key);
+    if (!fragment) {
+      ConfigFragment computed;
+      std::ostringstream stream;
+      for (const T& value : values) {
+        writer(value, stream);
+        computed.ends.push_back(static_cast<size_t>(stream.tellp()));
+      }
+      computed.text = stream.str();
+      fragment = &cache.Add(&values, key, std::move(computed));
+    }
+
+    if (config == kRecursiveWriterKeepDuplicates) {
+      out.write(fragment->text.data(), fragment->text.size());
+      continue;
+    }
+    size_t begin = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+      if (seen.insert(values[i]).second)
+        out.write(fragment->text.data() + begin, fragment->ends[i] - begin);
+      begin = fragment->ends[i];
+    }
+  }
+}
+
 // Writes the values out as strings with no transformation.
 void RecursiveTargetConfigStringsToStream(
     RecursiveWriterConfig config,
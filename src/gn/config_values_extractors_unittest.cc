@@ -147,3 +147,81 @@ TEST(ConfigValuesExtractors, IncludeOrdering) {
             "//target/ //target/config/ //target/all/ //target/direct/ "
             "//dep1/all/ //dep2/all/ //dep1/direct/ ");
 }
+
+TEST(ConfigValuesExtractors, Cached) {
+  TestWithScope setup;
+  Err err;
+
+  // Two configs sharing a value, used by two targets, one of which also has
+  // its own values.
+  Config config1(setup.settings(), Label(SourceDir("//foo/"), "config1"));
+  config1.visibility().SetPublic();
+  config1.own_values().cflags().push_back("--one");
+  config1.own_values().cflags().push_back("--shared");
+  config1.own_values().include_dirs().push_back(SourceDir("//one/"));
+  config1.own_values().include_dirs().push_back(SourceDir("//shared/"));
+  ASSERT_TRUE(config1.OnResolved(&err));
+
+  Config config2(setup.settings(), Label(SourceDir("//foo/"), "config2"));
+  config2.visibility().SetPublic();
+  config2.own_values().cflags().push_back("--shared");
+  config2.own_values().cflags().push_back("--two");
+  config2.own_values().include_dirs().push_back(SourceDir("//shared/"));
+  config2.own_values().include_dirs().push_back(SourceDir("//two/"));
+  ASSERT_TRUE(config2.OnResolved(&err));
+
+  Target target1(setup.settings(), Label(SourceDir("//foo/"), "target1"));
+  target1.set_output_type(Target::SOURCE_SET);
+  target1.SetToolchain(setup.toolchain());
+  target1.configs().push_back(LabelConfigPair(&config1));
+  target1.configs().push_back(LabelConfigPair(&config2));
+  target1.config_values().cflags().push_back("--target");
+  target1.config_values().include_dirs().push_back(SourceDir("//two/"));
+  ASSERT_TRUE(target1.OnResolved(&err));
+
+  Target target2(setup.settings(), Label(SourceDir("//foo/"), "target2"));
+  target2.set_output_type(Target::SOURCE_SET);
+  target2.SetToolchain(setup.toolchain());
+  target2.configs().push_back(LabelConfigPair(&config2));
+  target2.configs().push_back(LabelConfigPair(&config1));
+  ASSERT_TRUE(target2.OnResolved(&err));
+
+  ConfigFragmentKey key;
+  key.writer = "test";
+
+  // Write every target twice, the second time from the cache, and compare
+  // with the uncached output.
+  for (const Target* target : {&target1, &target2, &target1, &target2}) {
+    std::ostringstream expected_flags;
+    RecursiveTargetConfigToStream<std::string, FlagWriter>(
+        kRecursiveWriterKeepDuplicates, target, &ConfigValues::cflags,
+        FlagWriter(), expected_flags);
+    std::ostringstream flags;
+    RecursiveTargetConfigToStreamCached<std::string, FlagWriter>(
+        kRecursiveWriterKeepDuplicates, target, &ConfigValues::cflags,
+        FlagWriter(), key, flags);
+    EXPECT_EQ(expected_flags.str(), flags.str());
+
+    std::ostringstream expected_includes;
+    RecursiveTargetConfigToStream<SourceDir, IncludeWriter>(
+        kRecursiveWriterSkipDuplicates, target, &ConfigValues::include_dirs,
+        IncludeWriter(), expected_includes);
+    std::ostringstream includes;
+    RecursiveTargetConfigToStreamCached<SourceDir, IncludeWriter>(
+        kRecursiveWriterSkipDuplicates, target, &ConfigValues::include_dirs,
+        IncludeWriter(), key, includes);
+    EXPECT_EQ(expected_includes.str(), includes.str());
+  }
+
+  std::ostringstream includes;
+  RecursiveTargetConfigToStreamCached<SourceDir, IncludeWriter>(
+      kRecursiveWriterSkipDuplicates, &target1, &ConfigValues::include_dirs,
+      IncludeWriter(), key, includes);
+  EXPECT_EQ("//two/ //one/ //shared/ ", includes.str());
+
+  // Only the values of configs are cached.
+  EXPECT_TRUE(config1.fragment_cache().Find(
+      &config1.resolved_values().cflags(), key));
+  EXPECT_TRUE(config2.fragment_cache().Find(
+      &config2.resolved_values().include_dirs(), key));
+}
@@ -114,17 +114,20 @@ bool CreateBundleTargetGenerator::FillBundleDir(
 }
 
 bool CreateBundleTargetGenerator::FillXcodeExtraAttributes() {
-  // Need to get a mutable value to mark all values in the scope as used. This
-  // cannot be done on a const Scope.
-  Value* value = scope_->GetMutableValue(variables::kXcodeExtraAttributes,
-                                         Scope::SEARCH_CURRENT, true);
-  if (!value)
+  // Only read the value of the current scope. Its scope may be shared with
+  // the value it was forwarded from, so it is read through the const
+  // accessor, which doesn't copy it.
+  const Scope* found_in = nullptr;
+  const Value* value = scope_->GetValueWithScope(
+      StringAtom(variables::kXcodeExtraAttributes), &found_in);
+  if (!value || found_in != scope_)
     return true;
+  scope_->MarkUsed(variables::kXcodeExtraAttributes);
 
   if (!value->VerifyTypeIs(Value::SCOPE, err_))
     return false;
 
-  Scope* scope_value = value->scope_value();
+  const Scope* scope_value = value->scope_value();
 
   Scope::KeyValueMap value_map;
   scope_value->GetCurrentScopeValues(&value_map);
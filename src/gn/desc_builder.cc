@@ -8,6 +8,7 @@
 #include "base/json/json_writer.h"
 #include "base/strings/string_number_conversions.h"
 #include "gn/commands.h"
+#include "gn/compiled_substitution.h"
 #include "gn/config.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
@@ -802,10 +803,12 @@ class TargetDescBuilder : public BaseDescBuilder {
       return;  // Constant output.
 
     auto dict = std::make_unique<base::DictionaryValue>();
+    SubstitutionExpanderCache expanders;
     for (const auto& source : target_->sources()) {
       std::vector<OutputFile> outputs;
       const char* tool_name = Tool::kToolNone;
-      if (target_->GetOutputFilesForSource(source, &tool_name, &outputs)) {
+      if (target_->GetOutputFilesForSource(source, &tool_name, &outputs,
+                                           &expanders)) {
         auto list = std::make_unique<base::ListValue>();
         for (const auto& output : outputs)
           list->AppendString(output.value());
@@ -5,12 +5,14 @@
 #include "gn/escape.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include <memory>
 
 #include "base/compiler_specific.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
+#include "gn/escape_scanner.h"
 #include "util/build_config.h"
 
 namespace {
@@ -22,26 +24,6 @@ constexpr size_t kMaxEscapedCharsPerChar = 2;
 constexpr size_t kMaxEscapedCharsPerChar = 3;
 #endif
 
-// A "1" in this lookup table means that char is valid in the Posix shell.
-// clang-format off
-const char kShellValid[0x80] = {
-// 00-1f: all are invalid
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-// ' ' !  "  #  $  %  &  '  (  )  *  +  ,  -  .  /
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
-//  0  1  2  3  4  5  6  7  8  9  :  ;  <  =  >  ?
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 0, 0,
-//  @  A  B  C  D  E  F  G  H  I  J  K  L  M  N  O
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-//  P  Q  R  S  T  U  V  W  X  Y  Z  [  \  ]  ^  _
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
-//  `  a  b  c  d  e  f  g  h  i  j  k  l  m  n  o
-    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-//  p  q  r  s  t  u  v  w  x  y  z  {  |  }  ~
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
-// clang-format on
-
 size_t EscapeStringToString_Space(std::string_view str,
                                   const EscapeOptions& options,
                                   char* dest,
@@ -69,6 +51,28 @@ class StackOrHeapBuffer {
   std::unique_ptr<char[]> heap_buf;
 };
 
+// Copies |str| to |dest| and returns the number of characters written. The
+// characters from |set| are written by |escape_char|, which returns how many
+// characters it wrote. The runs of other characters are copied as they are.
+template <typename EscapeChar>
+size_t CopyAndEscape(std::string_view str,
+                     EscapeCharSet set,
+                     char* dest,
+                     EscapeChar escape_char) {
+  size_t i = 0;
+  size_t begin = 0;
+  while (begin < str.size()) {
+    size_t found = FindCharToEscape(set, str, begin);
+    memcpy(dest + i, str.data() + begin, found - begin);
+    i += found - begin;
+    if (found == str.size())
+      break;
+    i += escape_char(str[found], dest + i);
+    begin = found + 1;
+  }
+  return i;
+}
+
 // Ninja's escaping rules are very simple. We always escape colons even
 // though they're OK in many places, in case the resulting string is used on
 // the left-hand-side of a rule.
@@ -80,17 +84,12 @@ size_t EscapeStringToString_Ninja(std::string_view str,
                                   const EscapeOptions& options,
                                   char* dest,
                                   bool* needed_quoting) {
-  size_t i = 0;
-  for (const auto& elem : str) {
-    if (ShouldEscapeCharForNinja(elem))
-      dest[i++] = '$';
-    dest[i++] = elem;
-  }
-  return i;
-}
-
-inline bool ShouldEscapeCharForCompilationDatabase(char ch) {
-  return ch == '\\' || ch == '"';
+  return CopyAndEscape(str, EscapeCharSet::kNinja, dest,
+                       [](char ch, char* out) {
+                         out[0] = '$';
+                         out[1] = ch;
+                         return 2;
+                       });
 }
 
 size_t EscapeStringToString_CompilationDatabase(std::string_view str,
@@ -98,22 +97,17 @@ size_t EscapeStringToString_CompilationDatabase(std::string_view str,
                                                 char* dest,
                                                 bool* needed_quoting) {
   size_t i = 0;
-  bool quote = false;
-  for (const auto& elem : str) {
-    if (static_cast<unsigned>(elem) >= 0x80 ||
-        !kShellValid[static_cast<int>(elem)]) {
-      quote = true;
-      break;
-    }
-  }
+  bool quote =
+      FindCharToEscape(EscapeCharSet::kShellInvalid, str, 0) != str.size();
   if (quote)
     dest[i++] = '"';
 
-  for (const auto& elem : str) {
-    if (ShouldEscapeCharForCompilationDatabase(elem))
-      dest[i++] = '\\';
-    dest[i++] = elem;
-  }
+  i += CopyAndEscape(str, EscapeCharSet::kCompilationDatabase, dest + i,
+                     [](char ch, char* out) {
+                       out[0] = '\\';
+                       out[1] = ch;
+                       return 2;
+                     });
   if (quote)
     dest[i++] = '"';
   return i;
@@ -123,18 +117,15 @@ size_t EscapeStringToString_Depfile(std::string_view str,
                                     const EscapeOptions& options,
                                     char* dest,
                                     bool* needed_quoting) {
-  size_t i = 0;
-  for (const auto& elem : str) {
-    // Escape all characters that ninja depfile parser can recognize as escaped,
-    // even if some of them can work without escaping.
-    if (elem == ' ' || elem == '\\' || elem == '#' || elem == '*' ||
-        elem == '[' || elem == '|' || elem == ']')
-      dest[i++] = '\\';
-    else if (elem == '$')  // Extra rule for $$
-      dest[i++] = '$';
-    dest[i++] = elem;
-  }
-  return i;
+  // Escape all characters that ninja depfile parser can recognize as escaped,
+  // even if some of them can work without escaping.
+  return CopyAndEscape(str, EscapeCharSet::kDepfile, dest,
+                       [](char ch, char* out) {
+                         // Extra rule for $$.
+                         out[0] = ch == '$' ? '$' : '\\';
+                         out[1] = ch;
+                         return 2;
+                       });
 }
 
 size_t EscapeStringToString_NinjaPreformatted(std::string_view str,
@@ -213,30 +204,29 @@ size_t EscapeStringToString_PosixNinjaFork(std::string_view str,
                                            const EscapeOptions& options,
                                            char* dest,
                                            bool* needed_quoting) {
-  size_t i = 0;
-  for (const auto& elem : str) {
-    if (elem == '$' || elem == ' ') {
-      // Space and $ are special to both Ninja and the shell. '$' escape for
-      // Ninja, then backslash-escape for the shell.
-      dest[i++] = '\\';
-      dest[i++] = '$';
-      dest[i++] = elem;
-    } else if (elem == ':') {
-      // Colon is the only other Ninja special char, which is not special to
-      // the shell.
-      dest[i++] = '$';
-      dest[i++] = ':';
-    } else if (static_cast<unsigned>(elem) >= 0x80 ||
-               !kShellValid[static_cast<int>(elem)]) {
-      // All other invalid shell chars get backslash-escaped.
-      dest[i++] = '\\';
-      dest[i++] = elem;
-    } else {
-      // Everything else is a literal.
-      dest[i++] = elem;
-    }
-  }
-  return i;
+  // Everything but the characters found here is a literal.
+  return CopyAndEscape(
+      str, EscapeCharSet::kPosixNinjaCommand, dest, [](char ch, char* out) {
+        if (ch == '$' || ch == ' ') {
+          // Space and $ are special to both Ninja and the shell. '$' escape
+          // for Ninja, then backslash-escape for the shell.
+          out[0] = '\\';
+          out[1] = '$';
+          out[2] = ch;
+          return 3;
+        }
+        if (ch == ':') {
+          // Colon is the only other Ninja special char, which is not special
+          // to the shell.
+          out[0] = '$';
+          out[1] = ':';
+          return 2;
+        }
+        // All other invalid shell chars get backslash-escaped.
+        out[0] = '\\';
+        out[1] = ch;
+        return 2;
+      });
 }
 
 // Escapes |str| into |dest| and returns the number of characters written.
@@ -0,0 +1,174 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/escape_benchmark.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "gn/escape.h"
+#include "gn/escape_scanner.h"
+#include "util/ticks.h"
+
+namespace {
+
+// Discards what is written to it, like a stream that is never read.
+class NullStreamBuf : public std::streambuf {
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    return n;
+  }
+  int_type overflow(int_type ch) override { return ch; }
+};
+
+struct Corpus {
+  const char* name;
+  std::vector<std::string> strings;
+};
+
+std::vector<Corpus> MakeCorpora() {
+  std::vector<Corpus> corpora;
+
+  // Short compiler flags and defines, the most common case.
+  Corpus flags{"flags", {}};
+  for (int i = 0; i < 200; i++) {
+    flags.strings.push_back("-DCOMPONENT_" + std::to_string(i));
+    flags.strings.push_back("-Wno-unused-parameter");
+    flags.strings.push_back("-fvisibility=hidden");
+    flags.strings.push_back("-I../../foundation/subsystem_" +
+                            std::to_string(i % 17) + "/include");
+  }
+  corpora.push_back(std::move(flags));
+
+  // Longer paths with the odd character to escape.
+  Corpus paths{"paths", {}};
+  for (int i = 0; i < 200; i++) {
+    paths.strings.push_back(
+        "obj/foundation/communication/subsystem_" + std::to_string(i % 31) +
+        "/component_" + std::to_string(i) +
+        "/interfaces/innerapis/native/src/component_impl_" +
+        std::to_string(i) + ".o");
+    paths.strings.push_back("../../third_party/some library/src/file " +
+                            std::to_string(i) + ".cpp");
+  }
+  corpora.push_back(std::move(paths));
+
+  // Long strings with few characters to escape, like response file contents.
+  Corpus long_strings{"long", {}};
+  for (int i = 0; i < 20; i++) {
+    std::string str;
+    while (str.size() < 4096)
+      str += "gen/out/obj/component_" + std::to_string(i) + "/file.o ";
+    long_strings.strings.push_back(std::move(str));
+  }
+  corpora.push_back(std::move(long_strings));
+
+  // Mostly characters to escape, the worst case for the vector scanners.
+  Corpus dense{"dense", {}};
+  for (int i = 0; i < 200; i++)
+    dense.strings.push_back("$a :b\\c\"d#e*f[g|h]i{j}k;l<m>n?o " +
+                            std::to_string(i));
+  corpora.push_back(std::move(dense));
+
+  return corpora;
+}
+
+struct Mode {
+  const char* name;
+  EscapeOptions options;
+};
+
+std::vector<Mode> GetModes() {
+  std::vector<Mode> modes;
+  modes.push_back({"ninja", {}});
+  modes.back().options.mode = ESCAPE_NINJA;
+  modes.push_back({"ninja_command", {}});
+  modes.back().options.mode = ESCAPE_NINJA_COMMAND;
+  modes.back().options.platform = ESCAPE_PLATFORM_POSIX;
+  modes.push_back({"depfile", {}});
+  modes.back().options.mode = ESCAPE_DEPFILE;
+  modes.push_back({"compile_db", {}});
+  modes.back().options.mode = ESCAPE_COMPILATION_DATABASE;
+  return modes;
+}
+
+// Returns the throughput in MB of input per second.
+double TimeEscaping(const Corpus& corpus,
+                    const EscapeOptions& options,
+                    int iterations) {
+  NullStreamBuf null_buf;
+  std::ostream out(&null_buf);
+  size_t bytes = 0;
+  for (const std::string& str : corpus.strings)
+    bytes += str.size();
+
+  ElapsedTimer timer;
+  for (int i = 0; i < iterations; i++) {
+    for (const std::string& str : corpus.strings)
+      EscapeStringToStream(out, str, options);
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+  return seconds > 0 ? bytes * static_cast<double>(iterations) / seconds / 1e6
+                     : 0;
+}
+
+}  // namespace
+
+bool RunEscapeBenchmark(int iterations) {
+  std::vector<EscapeScanner> scanners = GetSupportedEscapeScanners();
+  std::vector<Corpus> corpora = MakeCorpora();
+  std::vector<Mode> modes = GetModes();
+
+  // Check the outputs before timing anything.
+  bool ok = true;
+  for (const Mode& mode : modes) {
+    for (const Corpus& corpus : corpora) {
+      SetEscapeScannerForTesting(EscapeScanner::kScalar);
+      std::vector<std::string> expected;
+      for (const std::string& str : corpus.strings)
+        expected.push_back(EscapeString(str, mode.options, nullptr));
+      for (EscapeScanner scanner : scanners) {
+        SetEscapeScannerForTesting(scanner);
+        for (size_t i = 0; i < corpus.strings.size(); i++) {
+          if (EscapeString(corpus.strings[i], mode.options, nullptr) !=
+              expected[i]) {
+            fprintf(stderr, "%s differs from scalar for %s of \"%s\".\n",
+                    GetEscapeScannerName(scanner), mode.name,
+                    corpus.strings[i].c_str());
+            ok = false;
+          }
+        }
+      }
+    }
+  }
+
+  printf("%d iterations, MB/s of input (speedup over scalar)\n", iterations);
+  printf("%-14s %-6s", "mode", "corpus");
+  for (EscapeScanner scanner : scanners)
+    printf(" %16s", GetEscapeScannerName(scanner));
+  printf("\n");
+  for (const Mode& mode : modes) {
+    for (const Corpus& corpus : corpora) {
+      printf("%-14s %-6s", mode.name, corpus.name);
+      double scalar = 0;
+      for (EscapeScanner scanner : scanners) {
+        SetEscapeScannerForTesting(scanner);
+        double throughput = TimeEscaping(corpus, mode.options, iterations);
+        if (scanner == EscapeScanner::kScalar)
+          scalar = throughput;
+        printf(" %8.0f (%4.2fx)", throughput,
+               scalar > 0 ? throughput / scalar : 0);
+      }
+      printf("\n");
+    }
+  }
+
+  SetEscapeScannerForTesting(scanners.back());
+  return ok;
+}
@@ -0,0 +1,16 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_ESCAPE_BENCHMARK_H_
+#define TOOLS_GN_ESCAPE_BENCHMARK_H_
+
+// Times escaping strings like the ones in ninja files with every escape
+// scanner the CPU supports, for the modes that use the scanners, and prints a
+// table of throughput per scanner.
+//
+// The output of every scanner is first compared byte for byte with the scalar
+// one. Returns false if any differs.
+bool RunEscapeBenchmark(int iterations);
+
+#endif  // TOOLS_GN_ESCAPE_BENCHMARK_H_
@@ -0,0 +1,438 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/escape_scanner.h"
+
+#include <stdint.h>
+
+#include "base/logging.h"
+#include "util/build_config.h"
+
+#if defined(ARCH_CPU_X86_64) || \
+    (defined(ARCH_CPU_X86) && (defined(__SSE2__) || _M_IX86_FP >= 2))
+#define ESCAPE_SCANNER_SSE2 1
+#if defined(COMPILER_GCC)
+// GCC and Clang can compile single functions for AVX2, which are only called
+// when the CPU supports it.
+#define ESCAPE_SCANNER_AVX2 1
+#endif
+#elif defined(ARCH_CPU_ARM64)
+#define ESCAPE_SCANNER_NEON 1
+#endif
+
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+#if defined(ESCAPE_SCANNER_SSE2)
+#include <immintrin.h>
+#endif
+#if defined(ESCAPE_SCANNER_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr bool InRange(unsigned char ch, char lo, char hi) {
+  return ch >= static_cast<unsigned char>(lo) &&
+         ch <= static_cast<unsigned char>(hi);
+}
+
+// Whether |ch| is a literal in the Posix shell. ':' is, but is special to
+// Ninja.
+constexpr bool IsShellValid(unsigned char ch) {
+  return InRange(ch, '+', ':') || ch == '=' || InRange(ch, '@', 'Z') ||
+         ch == '_' || InRange(ch, 'a', 'z');
+}
+
+constexpr bool IsInSet(EscapeCharSet set, unsigned char ch) {
+  switch (set) {
+    case EscapeCharSet::kNinja:
+      return ch == '$' || ch == ' ' || ch == ':';
+    case EscapeCharSet::kPosixNinjaCommand:
+      return ch == ':' || !IsShellValid(ch);
+    case EscapeCharSet::kDepfile:
+      return ch == ' ' || ch == '\\' || ch == '#' || ch == '*' || ch == '[' ||
+             ch == '|' || ch == ']' || ch == '$';
+    case EscapeCharSet::kCompilationDatabase:
+      return ch == '\\' || ch == '"';
+    case EscapeCharSet::kShellInvalid:
+      return !IsShellValid(ch);
+  }
+  return false;
+}
+
+struct CharTable {
+  bool in_set[256];
+};
+
+constexpr CharTable MakeCharTable(EscapeCharSet set) {
+  CharTable table = {};
+  for (int ch = 0; ch < 256; ch++)
+    table.in_set[ch] = IsInSet(set, static_cast<unsigned char>(ch));
+  return table;
+}
+
+template <EscapeCharSet kSet>
+constexpr CharTable kCharTable = MakeCharTable(kSet);
+
+template <EscapeCharSet kSet>
+size_t FindScalar(const char* str, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (kCharTable<kSet>.in_set[static_cast<unsigned char>(str[i])])
+      return i;
+  }
+  return size;
+}
+
+inline unsigned CountTrailingZeros(uint32_t value) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return index;
+#else
+  return __builtin_ctz(value);
+#endif
+}
+
+inline unsigned CountTrailingZeros64(uint64_t value) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return index;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+// The vector scanners test a block at a time, and handle the end of a string
+// by testing the last full block again, ignoring the bytes already tested.
+// Strings shorter than a block are scanned one byte at a time.
+
+#if defined(ESCAPE_SCANNER_SSE2)
+
+inline __m128i Sse2Equal(__m128i v, char ch) {
+  return _mm_cmpeq_epi8(v, _mm_set1_epi8(ch));
+}
+
+// Compares unsigned bytes with [lo, hi]. SSE2 only compares signed bytes, so
+// this moves the range to start at -128 first.
+inline __m128i Sse2InRange(__m128i v, char lo, char hi) {
+  __m128i shifted =
+      _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(-128 - lo)));
+  return _mm_cmplt_epi8(shifted,
+                        _mm_set1_epi8(static_cast<char>(-128 + hi - lo + 1)));
+}
+
+inline __m128i Sse2ShellValid(__m128i v) {
+  return _mm_or_si128(
+      _mm_or_si128(Sse2InRange(v, '+', ':'), Sse2Equal(v, '=')),
+      _mm_or_si128(_mm_or_si128(Sse2InRange(v, '@', 'Z'), Sse2Equal(v, '_')),
+                   Sse2InRange(v, 'a', 'z')));
+}
+
+// Returns a bit per byte of |v|, set for the bytes in |kSet|.
+template <EscapeCharSet kSet>
+inline uint32_t Sse2Bits(__m128i v) {
+  if constexpr (kSet == EscapeCharSet::kNinja) {
+    return _mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(Sse2Equal(v, '$'), Sse2Equal(v, ' ')),
+                     Sse2Equal(v, ':')));
+  } else if constexpr (kSet == EscapeCharSet::kPosixNinjaCommand) {
+    __m128i literal = _mm_andnot_si128(Sse2Equal(v, ':'), Sse2ShellValid(v));
+    return ~_mm_movemask_epi8(literal) & 0xffff;
+  } else if constexpr (kSet == EscapeCharSet::kDepfile) {
+    __m128i a = _mm_or_si128(Sse2Equal(v, ' '), Sse2Equal(v, '\\'));
+    __m128i b = _mm_or_si128(Sse2Equal(v, '#'), Sse2Equal(v, '*'));
+    __m128i c = _mm_or_si128(Sse2Equal(v, '['), Sse2Equal(v, '|'));
+    __m128i d = _mm_or_si128(Sse2Equal(v, ']'), Sse2Equal(v, '$'));
+    return _mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)));
+  } else if constexpr (kSet == EscapeCharSet::kCompilationDatabase) {
+    return _mm_movemask_epi8(
+        _mm_or_si128(Sse2Equal(v, '\\'), Sse2Equal(v, '"')));
+  } else {
+    static_assert(kSet == EscapeCharSet::kShellInvalid);
+    return ~_mm_movemask_epi8(Sse2ShellValid(v)) & 0xffff;
+  }
+}
+
+inline __m128i Sse2Load(const char* str) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+}
+
+template <EscapeCharSet kSet>
+size_t FindSse2(const char* str, size_t size) {
+  constexpr size_t kBlock = 16;
+  if (size < kBlock)
+    return FindScalar<kSet>(str, size);
+
+  size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    uint32_t bits = Sse2Bits<kSet>(Sse2Load(str + i));
+    if (bits)
+      return i + CountTrailingZeros(bits);
+  }
+  if (i < size) {
+    size_t last = size - kBlock;
+    uint32_t bits = Sse2Bits<kSet>(Sse2Load(str + last)) >> (i - last);
+    if (bits)
+      return i + CountTrailingZeros(bits);
+  }
+  return size;
+}
+
+#endif  // defined(ESCAPE_SCANNER_SSE2)
+
+#if defined(ESCAPE_SCANNER_AVX2)
+
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+
+AVX2_FUNCTION inline __m256i Avx2Equal(__m256i v, char ch) {
+  return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(ch));
+}
+
+// Like Sse2InRange(). AVX2 only has a signed greater-than.
+AVX2_FUNCTION inline __m256i Avx2InRange(__m256i v, char lo, char hi) {
+  __m256i shifted =
+      _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(-128 - lo)));
+  return _mm256_cmpgt_epi8(
+      _mm256_set1_epi8(static_cast<char>(-128 + hi - lo + 1)), shifted);
+}
+
+AVX2_FUNCTION inline __m256i Avx2ShellValid(__m256i v) {
+  return _mm256_or_si256(
+      _mm256_or_si256(Avx2InRange(v, '+', ':'), Avx2Equal(v, '=')),
+      _mm256_or_si256(
+          _mm256_or_si256(Avx2InRange(v, '@', 'Z'), Avx2Equal(v, '_')),
+          Avx2InRange(v, 'a', 'z')));
+}
+
+template <EscapeCharSet kSet>
+AVX2_FUNCTION inline uint32_t Avx2Bits(__m256i v) {
+  if constexpr (kSet == EscapeCharSet::kNinja) {
+    return _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(Avx2Equal(v, '$'), Avx2Equal(v, ' ')),
+                        Avx2Equal(v, ':')));
+  } else if constexpr (kSet == EscapeCharSet::kPosixNinjaCommand) {
+    __m256i literal =
+        _mm256_andnot_si256(Avx2Equal(v, ':'), Avx2ShellValid(v));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(literal));
+  } else if constexpr (kSet == EscapeCharSet::kDepfile) {
+    __m256i a = _mm256_or_si256(Avx2Equal(v, ' '), Avx2Equal(v, '\\'));
+    __m256i b = _mm256_or_si256(Avx2Equal(v, '#'), Avx2Equal(v, '*'));
+    __m256i c = _mm256_or_si256(Avx2Equal(v, '['), Avx2Equal(v, '|'));
+    __m256i d = _mm256_or_si256(Avx2Equal(v, ']'), Avx2Equal(v, '$'));
+    return _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)));
+  } else if constexpr (kSet == EscapeCharSet::kCompilationDatabase) {
+    return _mm256_movemask_epi8(
+        _mm256_or_si256(Avx2Equal(v, '\\'), Avx2Equal(v, '"')));
+  } else {
+    static_assert(kSet == EscapeCharSet::kShellInvalid);
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(Avx2ShellValid(v)));
+  }
+}
+
+AVX2_FUNCTION inline __m256i Avx2Load(const char* str) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str));
+}
+
+template <EscapeCharSet kSet>
+AVX2_FUNCTION size_t FindAvx2(const char* str, size_t size) {
+  constexpr size_t kBlock = 32;
+  if (size < kBlock)
+    return FindSse2<kSet>(str, size);
+
+  size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    uint32_t bits = Avx2Bits<kSet>(Avx2Load(str + i));
+    if (bits)
+      return i + CountTrailingZeros(bits);
+  }
+  if (i < size) {
+    size_t last = size - kBlock;
+    uint32_t bits = Avx2Bits<kSet>(Avx2Load(str + last)) >> (i - last);
+    if (bits)
+      return i + CountTrailingZeros(bits);
+  }
+  return size;
+}
+
+#undef AVX2_FUNCTION
+
+bool CpuSupportsAvx2() {
+  // Also checks that the OS saves the AVX registers.
+  return __builtin_cpu_supports("avx2");
+}
+
+#endif  // defined(ESCAPE_SCANNER_AVX2)
+
+#if defined(ESCAPE_SCANNER_NEON)
+
+inline uint8x16_t NeonEqual(uint8x16_t v, char ch) {
+  return vceqq_u8(v, vdupq_n_u8(static_cast<uint8_t>(ch)));
+}
+
+inline uint8x16_t NeonInRange(uint8x16_t v, char lo, char hi) {
+  return vcleq_u8(vsubq_u8(v, vdupq_n_u8(static_cast<uint8_t>(lo))),
+                  vdupq_n_u8(static_cast<uint8_t>(hi - lo)));
+}
+
+inline uint8x16_t NeonShellValid(uint8x16_t v) {
+  return vorrq_u8(
+      vorrq_u8(NeonInRange(v, '+', ':'), NeonEqual(v, '=')),
+      vorrq_u8(vorrq_u8(NeonInRange(v, '@', 'Z'), NeonEqual(v, '_')),
+               NeonInRange(v, 'a', 'z')));
+}
+
+// Returns 0xff for the bytes of |v| in |kSet|.
+template <EscapeCharSet kSet>
+inline uint8x16_t NeonMask(uint8x16_t v) {
+  if constexpr (kSet == EscapeCharSet::kNinja) {
+    return vorrq_u8(vorrq_u8(NeonEqual(v, '$'), NeonEqual(v, ' ')),
+                    NeonEqual(v, ':'));
+  } else if constexpr (kSet == EscapeCharSet::kPosixNinjaCommand) {
+    return vorrq_u8(NeonEqual(v, ':'), vmvnq_u8(NeonShellValid(v)));
+  } else if constexpr (kSet == EscapeCharSet::kDepfile) {
+    uint8x16_t a = vorrq_u8(NeonEqual(v, ' '), NeonEqual(v, '\\'));
+    uint8x16_t b = vorrq_u8(NeonEqual(v, '#'), NeonEqual(v, '*'));
+    uint8x16_t c = vorrq_u8(NeonEqual(v, '['), NeonEqual(v, '|'));
+    uint8x16_t d = vorrq_u8(NeonEqual(v, ']'), NeonEqual(v, '$'));
+    return vorrq_u8(vorrq_u8(a, b), vorrq_u8(c, d));
+  } else if constexpr (kSet == EscapeCharSet::kCompilationDatabase) {
+    return vorrq_u8(NeonEqual(v, '\\'), NeonEqual(v, '"'));
+  } else {
+    static_assert(kSet == EscapeCharSet::kShellInvalid);
+    return vmvnq_u8(NeonShellValid(v));
+  }
+}
+
+// Returns 4 bits per byte of |mask|, NEON having no movemask.
+inline uint64_t NeonBits(uint8x16_t mask) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(mask), 4)), 0);
+}
+
+inline uint8x16_t NeonLoad(const char* str) {
+  return vld1q_u8(reinterpret_cast<const uint8_t*>(str));
+}
+
+template <EscapeCharSet kSet>
+size_t FindNeon(const char* str, size_t size) {
+  constexpr size_t kBlock = 16;
+  if (size < kBlock)
+    return FindScalar<kSet>(str, size);
+
+  size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    uint64_t bits = NeonBits(NeonMask<kSet>(NeonLoad(str + i)));
+    if (bits)
+      return i + CountTrailingZeros64(bits) / 4;
+  }
+  if (i < size) {
+    size_t last = size - kBlock;
+    uint64_t bits =
+        NeonBits(NeonMask<kSet>(NeonLoad(str + last))) >> (4 * (i - last));
+    if (bits)
+      return i + CountTrailingZeros64(bits) / 4;
+  }
+  return size;
+}
+
+#endif  // defined(ESCAPE_SCANNER_NEON)
+
+using FindFunction = size_t (*)(const char* str, size_t size);
+
+// The functions of one scanner, indexed by EscapeCharSet.
+struct ScannerFunctions {
+  FindFunction find[5];
+};
+
+#define SCANNER_FUNCTIONS(Find)                                          \
+  {{Find<EscapeCharSet::kNinja>, Find<EscapeCharSet::kPosixNinjaCommand>, \
+    Find<EscapeCharSet::kDepfile>,                                        \
+    Find<EscapeCharSet::kCompilationDatabase>,                            \
+    Find<EscapeCharSet::kShellInvalid>}}
+
+constexpr ScannerFunctions kScalarFunctions = SCANNER_FUNCTIONS(FindScalar);
+#if defined(ESCAPE_SCANNER_SSE2)
+constexpr ScannerFunctions kSse2Functions = SCANNER_FUNCTIONS(FindSse2);
+#endif
+#if defined(ESCAPE_SCANNER_AVX2)
+constexpr ScannerFunctions kAvx2Functions = SCANNER_FUNCTIONS(FindAvx2);
+#endif
+#if defined(ESCAPE_SCANNER_NEON)
+constexpr ScannerFunctions kNeonFunctions = SCANNER_FUNCTIONS(FindNeon);
+#endif
+
+#undef SCANNER_FUNCTIONS
+
+const ScannerFunctions* GetScannerFunctions(EscapeScanner scanner) {
+  switch (scanner) {
+    case EscapeScanner::kScalar:
+      return &kScalarFunctions;
+#if defined(ESCAPE_SCANNER_SSE2)
+    case EscapeScanner::kSSE2:
+      return &kSse2Functions;
+#endif
+#if defined(ESCAPE_SCANNER_AVX2)
+    case EscapeScanner::kAVX2:
+      return &kAvx2Functions;
+#endif
+#if defined(ESCAPE_SCANNER_NEON)
+    case EscapeScanner::kNEON:
+      return &kNeonFunctions;
+#endif
+    default:
+      NOTREACHED();
+      return &kScalarFunctions;
+  }
+}
+
+const ScannerFunctions*& ActiveScannerFunctions() {
+  static const ScannerFunctions* functions =
+      GetScannerFunctions(GetSupportedEscapeScanners().back());
+  return functions;
+}
+
+}  // namespace
+
+size_t FindCharToEscape(EscapeCharSet set, std::string_view str, size_t begin) {
+  DCHECK(begin <= str.size());
+  return begin + ActiveScannerFunctions()->find[static_cast<size_t>(set)](
+                     str.data() + begin, str.size() - begin);
+}
+
+std::vector<EscapeScanner> GetSupportedEscapeScanners() {
+  std::vector<EscapeScanner> scanners = {EscapeScanner::kScalar};
+#if defined(ESCAPE_SCANNER_SSE2)
+  scanners.push_back(EscapeScanner::kSSE2);
+#endif
+#if defined(ESCAPE_SCANNER_AVX2)
+  if (CpuSupportsAvx2())
+    scanners.push_back(EscapeScanner::kAVX2);
+#endif
+#if defined(ESCAPE_SCANNER_NEON)
+  scanners.push_back(EscapeScanner::kNEON);
+#endif
+  return scanners;
+}
+
+const char* GetEscapeScannerName(EscapeScanner scanner) {
+  switch (scanner) {
+    case EscapeScanner::kScalar:
+      return "scalar";
+    case EscapeScanner::kSSE2:
+      return "sse2";
+    case EscapeScanner::kAVX2:
+      return "avx2";
+    case EscapeScanner::kNEON:
+      return "neon";
+  }
+  return "";
+}
+
+void SetEscapeScannerForTesting(EscapeScanner scanner) {
+  ActiveScannerFunctions() = GetScannerFunctions(scanner);
+}
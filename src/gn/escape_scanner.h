@@ -0,0 +1,59 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_ESCAPE_SCANNER_H_
+#define TOOLS_GN_ESCAPE_SCANNER_H_
+
+#include <stddef.h>
+
+#include <string_view>
+#include <vector>
+
+// Finds the characters escape.cc has to escape, testing many bytes at a time
+// when the CPU supports it. The escaping functions copy the runs of other
+// characters in bulk.
+
+// The sets of characters the escaping modes treat specially.
+enum class EscapeCharSet {
+  // '$', ' ' and ':', for ESCAPE_NINJA.
+  kNinja,
+
+  // Everything but the characters that are literals for both Ninja and the
+  // Posix shell, for ESCAPE_NINJA_COMMAND on Posix.
+  kPosixNinjaCommand,
+
+  // ' ', '\\', '#', '*', '[', '|', ']' and '$', for ESCAPE_DEPFILE.
+  kDepfile,
+
+  // '\\' and '"', for ESCAPE_COMPILATION_DATABASE.
+  kCompilationDatabase,
+
+  // Characters that aren't valid in the Posix shell. Strings with any of these
+  // are quoted by ESCAPE_COMPILATION_DATABASE.
+  kShellInvalid,
+};
+
+// Returns the offset of the first character from |set| in |str| at or after
+// |begin|, or str.size() if there is none.
+size_t FindCharToEscape(EscapeCharSet set, std::string_view str, size_t begin);
+
+// The implementations of FindCharToEscape().
+enum class EscapeScanner {
+  kScalar,
+  kSSE2,  // 16 bytes at a time.
+  kAVX2,  // 32 bytes at a time.
+  kNEON,  // 16 bytes at a time.
+};
+
+// Returns the scanners the current CPU supports, kScalar first. The last one
+// is used by default.
+std::vector<EscapeScanner> GetSupportedEscapeScanners();
+
+const char* GetEscapeScannerName(EscapeScanner scanner);
+
+// Makes FindCharToEscape() use the given supported scanner. Must not be
+// called while other threads escape strings. For tests and benchmarks.
+void SetEscapeScannerForTesting(EscapeScanner scanner);
+
+#endif  // TOOLS_GN_ESCAPE_SCANNER_H_
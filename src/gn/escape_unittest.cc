@@ -2,10 +2,56 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
 #include "gn/escape.h"
+#include "gn/escape_scanner.h"
 #include "gn/string_output_buffer.h"
 #include "util/test/test.h"
 
+namespace {
+
+// Restores the default escape scanner when going out of scope.
+class ScopedEscapeScanner {
+ public:
+  ScopedEscapeScanner() = default;
+  ~ScopedEscapeScanner() {
+    SetEscapeScannerForTesting(GetSupportedEscapeScanners().back());
+  }
+};
+
+// Strings of every length up to a few blocks with special characters, bytes
+// >= 0x80 and plain characters at varying positions.
+std::vector<std::string> MakeEscapeTestStrings() {
+  std::vector<std::string> strings;
+  for (int ch = 1; ch < 256; ch++)
+    strings.push_back(std::string(1, static_cast<char>(ch)));
+
+  const std::string chars =
+      "abcdefghijklmnopqrstuvwxyzABCXYZ0123456789+,-./=@_ $:\\\"#*[|]{}'`;<>?!"
+      "~%&()^\x01\x7f\x80\xc3\xa9\xff";
+  uint32_t random = 1;
+  for (size_t length = 0; length <= 100; length++) {
+    for (int variant = 0; variant < 8; variant++) {
+      std::string str;
+      for (size_t i = 0; i < length; i++) {
+        random = random * 1103515245 + 12345;
+        // Mostly plain characters, so there are long runs between the
+        // special ones.
+        size_t index = (random >> 16) % (variant < 4 ? 40 : chars.size());
+        str.push_back(chars[index]);
+      }
+      strings.push_back(str);
+    }
+  }
+  return strings;
+}
+
+}  // namespace
+
 TEST(Escape, Ninja) {
   EscapeOptions opts;
   opts.mode = ESCAPE_NINJA;
@@ -110,3 +156,103 @@ TEST(Escape, CompilationDatabase) {
   std::string result = EscapeString("asdf:$ \\#*[|]bar", opts, nullptr);
   EXPECT_EQ("\"asdf:$ \\\\#*[|]bar\"", result);
 }
+
+TEST(Escape, AllScanners) {
+  ScopedEscapeScanner restore_scanner;
+  std::vector<std::string> strings = MakeEscapeTestStrings();
+
+  std::vector<EscapeOptions> all_options;
+  for (EscapingMode mode :
+       {ESCAPE_NONE, ESCAPE_SPACE, ESCAPE_NINJA, ESCAPE_DEPFILE,
+        ESCAPE_NINJA_COMMAND, ESCAPE_NINJA_PREFORMATTED_COMMAND,
+        ESCAPE_COMPILATION_DATABASE}) {
+    for (EscapingPlatform platform :
+         {ESCAPE_PLATFORM_POSIX, ESCAPE_PLATFORM_WIN}) {
+      for (bool inhibit_quoting : {false, true}) {
+        EscapeOptions options;
+        options.mode = mode;
+        options.platform = platform;
+        options.inhibit_quoting = inhibit_quoting;
+        all_options.push_back(options);
+      }
+    }
+  }
+
+  // Windows escaping expects no whitespace but spaces.
+  auto skip = [](const EscapeOptions& options, const std::string& str) {
+    return options.mode == ESCAPE_NINJA_COMMAND &&
+           options.platform == ESCAPE_PLATFORM_WIN &&
+           str.find_first_of("\r\n\v\t") != std::string::npos;
+  };
+
+  // Every scanner escapes every string the same way as the scalar one.
+  SetEscapeScannerForTesting(EscapeScanner::kScalar);
+  std::vector<std::string> expected;
+  std::vector<bool> expected_quoting;
+  for (const EscapeOptions& options : all_options) {
+    for (const std::string& str : strings) {
+      if (skip(options, str))
+        continue;
+      bool needed_quoting = false;
+      expected.push_back(EscapeString(str, options, &needed_quoting));
+      expected_quoting.push_back(needed_quoting);
+    }
+  }
+
+  for (EscapeScanner scanner : GetSupportedEscapeScanners()) {
+    SetEscapeScannerForTesting(scanner);
+    size_t index = 0;
+    for (const EscapeOptions& options : all_options) {
+      for (const std::string& str : strings) {
+        if (skip(options, str))
+          continue;
+        bool needed_quoting = false;
+        ASSERT_EQ(expected[index], EscapeString(str, options, &needed_quoting))
+            << GetEscapeScannerName(scanner) << " mode " << options.mode
+            << " platform " << options.platform << " \"" << str << "\"";
+        EXPECT_EQ(expected_quoting[index], needed_quoting);
+        index++;
+      }
+    }
+  }
+}
+
+TEST(EscapeScanner, FindCharToEscape) {
+  ScopedEscapeScanner restore_scanner;
+
+  for (EscapeScanner scanner : GetSupportedEscapeScanners()) {
+    SetEscapeScannerForTesting(scanner);
+    for (EscapeCharSet set :
+         {EscapeCharSet::kNinja, EscapeCharSet::kPosixNinjaCommand,
+          EscapeCharSet::kDepfile, EscapeCharSet::kCompilationDatabase,
+          EscapeCharSet::kShellInvalid}) {
+      // A single special character at every position of strings up to a few
+      // blocks long, found from every start offset up to it.
+      for (size_t length = 1; length <= 70; length++) {
+        for (size_t pos = 0; pos < length; pos++) {
+          std::string str(length, 'a');
+          str[pos] = '$';
+          bool special = set != EscapeCharSet::kCompilationDatabase;
+          size_t expected = special ? pos : length;
+          for (size_t begin = 0; begin <= pos; begin++) {
+            EXPECT_EQ(expected, FindCharToEscape(set, str, begin))
+                << GetEscapeScannerName(scanner) << " " << length << " "
+                << pos << " " << begin;
+          }
+          EXPECT_EQ(length, FindCharToEscape(set, str, pos + 1));
+        }
+      }
+    }
+
+    // Which characters are in the sets.
+    EXPECT_EQ(3u, FindCharToEscape(EscapeCharSet::kNinja, "ab;:", 0));
+    EXPECT_EQ(2u,
+              FindCharToEscape(EscapeCharSet::kPosixNinjaCommand, "a_;", 0));
+    EXPECT_EQ(3u, FindCharToEscape(EscapeCharSet::kPosixNinjaCommand,
+                                   "a=/\xc3\xa9", 0));
+    EXPECT_EQ(4u, FindCharToEscape(EscapeCharSet::kDepfile, "a:;~]", 0));
+    EXPECT_EQ(3u, FindCharToEscape(EscapeCharSet::kCompilationDatabase,
+                                   "a$ \"", 0));
+    EXPECT_EQ(4u, FindCharToEscape(EscapeCharSet::kShellInvalid, "a:_=~", 0));
+  }
+}
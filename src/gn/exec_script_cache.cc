@@ -0,0 +1,167 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/exec_script_cache.h"
+
+#include <string_view>
+#include <utility>
+
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "gn/filesystem_utils.h"
+#include "util/atomic_write.h"
+
+namespace {
+
+// First line of the cache file. Bump the version when changing the format or
+// the way keys are computed.
+const char kHeader[] = "GN exec_script cache v1\n";
+
+std::string HexSHA1(const std::string& data) {
+  std::string hash = base::SHA1HashString(data);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+}  // namespace
+
+const char ExecScriptCache::kFileName[] = "exec_script.cache";
+
+ExecScriptCache::ExecScriptCache(const base::FilePath& cache_file)
+    : cache_file_(cache_file) {}
+
+ExecScriptCache::~ExecScriptCache() = default;
+
+void ExecScriptCache::Load() {
+  std::string contents;
+  if (!base::ReadFileToString(cache_file_, &contents))
+    return;
+  if (contents.compare(0, sizeof(kHeader) - 1, kHeader) != 0)
+    return;
+
+  // Each entry is a "<key> <duration in us> <output size>" line followed by
+  // the output and a newline.
+  std::unordered_map<std::string, Entry> entries;
+  size_t pos = sizeof(kHeader) - 1;
+  while (pos < contents.size()) {
+    size_t line_end = contents.find('\n', pos);
+    if (line_end == std::string::npos)
+      return;
+    std::string_view line(&contents[pos], line_end - pos);
+    std::vector<std::string_view> fields = base::SplitStringPiece(
+        line, " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+    uint64_t duration_us = 0;
+    uint64_t size = 0;
+    if (fields.size() != 3 || !base::StringToUint64(fields[1], &duration_us) ||
+        !base::StringToUint64(fields[2], &size))
+      return;
+    pos = line_end + 1;
+    if (size + 1 > contents.size() - pos || contents[pos + size] != '\n')
+      return;
+
+    Entry& entry = entries[std::string(fields[0])];
+    entry.output.assign(contents, pos, size);
+    entry.duration_us = duration_us;
+    pos += size + 1;
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_ = std::move(entries);
+}
+
+bool ExecScriptCache::Save() const {
+  std::string contents = kHeader;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (const auto& [key, entry] : entries_) {
+      if (!entry.used)
+        continue;
+      contents.append(base::StringPrintf(
+          "%s %llu %zu\n", key.c_str(),
+          static_cast<unsigned long long>(entry.duration_us),
+          entry.output.size()));
+      contents.append(entry.output);
+      contents.push_back('\n');
+    }
+  }
+  return util::WriteFileAtomically(cache_file_, contents.data(),
+                                   static_cast<int>(contents.size())) ==
+         static_cast<int>(contents.size());
+}
+
+std::string ExecScriptCache::MakeKey(
+    const base::CommandLine& cmdline,
+    const base::FilePath& startup_dir,
+    bool allowlist_enforced,
+    const std::vector<base::FilePath>& inputs) {
+  std::string key_data;
+  key_data.append(FilePathToUTF8(cmdline.GetCommandLineString()));
+  key_data.push_back('\0');
+  key_data.append(FilePathToUTF8(startup_dir));
+  key_data.push_back('\0');
+  key_data.push_back(allowlist_enforced ? '1' : '0');
+  for (const base::FilePath& input : inputs) {
+    key_data.push_back('\0');
+    key_data.append(FilePathToUTF8(input));
+    key_data.push_back('=');
+    key_data.append(GetFileHash(input));
+  }
+  return HexSHA1(key_data);
+}
+
+bool ExecScriptCache::Lookup(const std::string& key, std::string* output) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    misses_++;
+    return false;
+  }
+  found->second.used = true;
+  hits_++;
+  saved_us_ += found->second.duration_us;
+  *output = found->second.output;
+  return true;
+}
+
+void ExecScriptCache::Insert(const std::string& key,
+                             const std::string& output,
+                             TickDelta duration) {
+  std::lock_guard<std::mutex> lock(lock_);
+  Entry& entry = entries_[key];
+  entry.output = output;
+  entry.duration_us = duration.InMicroseconds();
+  entry.used = true;
+}
+
+std::string ExecScriptCache::Summarize() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  int lookups = hits_ + misses_;
+  double hit_rate = lookups ? 100.0 * hits_ / lookups : 0.0;
+  return "exec_script cache: (hits, misses, hit rate, time saved in ms)\n" +
+         base::StringPrintf(" %d  %d  %.1f%%  %.2f\n", hits_, misses_,
+                            hit_rate, saved_us_ / 1000.0);
+}
+
+std::string ExecScriptCache::GetFileHash(const base::FilePath& path) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = file_hashes_.find(path);
+    if (found != file_hashes_.end())
+      return found->second;
+  }
+
+  // Read outside of the lock. Two threads may hash the same file at once,
+  // which is harmless.
+  std::string contents;
+  std::string hash = base::ReadFileToString(path, &contents)
+                         ? HexSHA1(contents)
+                         : std::string("missing");
+
+  std::lock_guard<std::mutex> lock(lock_);
+  file_hashes_.emplace(path, hash);
+  return hash;
+}
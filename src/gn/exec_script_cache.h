@@ -0,0 +1,109 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_EXEC_SCRIPT_CACHE_H_
+#define TOOLS_GN_EXEC_SCRIPT_CACHE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "util/ticks.h"
+
+namespace base {
+class CommandLine;
+}
+
+// Persistent cache of exec_script() results, enabled by the
+// --exec-script-cache switch.
+//
+// Build files tend to call the same scripts with the same arguments over and
+// over, and each call forks a process. The cache maps everything that can
+// influence a script's output to the stdout of a previous successful run:
+// the command line, the working directory, whether the exec_script allowlist
+// is enforced, and the contents of the script and of its declared file
+// dependencies. Those files are the ones recorded in build.ninja.d, so
+// editing any of them invalidates the entries that depend on it, exactly as
+// it makes Ninja re-run GN.
+//
+// Scripts are assumed to only depend on those inputs. In particular the
+// environment and undeclared files are not part of the key, which is why the
+// cache is opt-in.
+//
+// The cache is loaded from the build directory at setup time and saved back
+// at the end of a successful run. Only the entries used by that run are
+// saved, so results for stale arguments don't accumulate.
+//
+// This class is threadsafe.
+class ExecScriptCache {
+ public:
+  // Name of the cache file in the build directory.
+  static const char kFileName[];
+
+  explicit ExecScriptCache(const base::FilePath& cache_file);
+  ~ExecScriptCache();
+
+  // Reads the entries saved by a previous run, if any. A missing or
+  // malformed file leaves the cache empty.
+  void Load();
+
+  // Writes the entries used by this run to the cache file. Returns false on
+  // failure.
+  bool Save() const;
+
+  // Computes the key identifying an invocation of |cmdline| from
+  // |startup_dir|. |inputs| are the script and its declared dependencies.
+  std::string MakeKey(const base::CommandLine& cmdline,
+                      const base::FilePath& startup_dir,
+                      bool allowlist_enforced,
+                      const std::vector<base::FilePath>& inputs);
+
+  // Looks up the output of a previous run for |key|. Returns true and fills
+  // |output| on a hit.
+  bool Lookup(const std::string& key, std::string* output);
+
+  // Records the output of a successful run that took |duration|.
+  void Insert(const std::string& key,
+              const std::string& output,
+              TickDelta duration);
+
+  // Returns a summary of the hit rate and the time saved for --time.
+  std::string Summarize() const;
+
+ private:
+  struct Entry {
+    std::string output;
+
+    // How long the script took to run when the entry was created. Each hit
+    // saves roughly that much.
+    uint64_t duration_us = 0;
+
+    // Set when the entry is looked up or inserted by this run.
+    bool used = false;
+  };
+
+  // Returns the hash of the contents of |path|, memoized for the duration of
+  // the run.
+  std::string GetFileHash(const base::FilePath& path);
+
+  base::FilePath cache_file_;
+
+  mutable std::mutex lock_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::map<base::FilePath, std::string> file_hashes_;
+
+  int hits_ = 0;
+  int misses_ = 0;
+  uint64_t saved_us_ = 0;
+
+  ExecScriptCache(const ExecScriptCache&) = delete;
+  ExecScriptCache& operator=(const ExecScriptCache&) = delete;
+};
+
+#endif  // TOOLS_GN_EXEC_SCRIPT_CACHE_H_
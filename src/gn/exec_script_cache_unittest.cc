@@ -0,0 +1,117 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/exec_script_cache.h"
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteFile(const base::FilePath& path, const std::string& contents) {
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(),
+                            static_cast<int>(contents.size())));
+}
+
+base::CommandLine MakeCommandLine(const base::FilePath& script,
+                                  const std::string& arg) {
+  base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+  cmdline.SetParseSwitches(false);
+  cmdline.SetProgram(script);
+  cmdline.AppendArg(arg);
+  return cmdline;
+}
+
+}  // namespace
+
+TEST(ExecScriptCache, Key) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath script = temp_dir.GetPath().AppendASCII("script.py");
+  WriteFile(script, "print('hello')");
+
+  ExecScriptCache cache(temp_dir.GetPath().AppendASCII("cache"));
+  base::FilePath dir = temp_dir.GetPath();
+  std::string key =
+      cache.MakeKey(MakeCommandLine(script, "a"), dir, false, {script});
+  EXPECT_EQ(key,
+            cache.MakeKey(MakeCommandLine(script, "a"), dir, false, {script}));
+
+  // Any difference in the invocation gives a different key.
+  EXPECT_NE(key,
+            cache.MakeKey(MakeCommandLine(script, "b"), dir, false, {script}));
+  EXPECT_NE(key, cache.MakeKey(MakeCommandLine(script, "a"), dir.DirName(),
+                               false, {script}));
+  EXPECT_NE(key,
+            cache.MakeKey(MakeCommandLine(script, "a"), dir, true, {script}));
+  EXPECT_NE(key, cache.MakeKey(MakeCommandLine(script, "a"), dir, false,
+                               {script, temp_dir.GetPath().AppendASCII("x")}));
+
+  // So do different input contents, as seen by a new run.
+  WriteFile(script, "print('goodbye')");
+  ExecScriptCache next_cache(temp_dir.GetPath().AppendASCII("cache"));
+  EXPECT_NE(key, next_cache.MakeKey(MakeCommandLine(script, "a"), dir, false,
+                                    {script}));
+}
+
+TEST(ExecScriptCache, SaveAndLoad) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_file = temp_dir.GetPath().AppendASCII("cache");
+
+  {
+    ExecScriptCache cache(cache_file);
+    cache.Load();  // Doesn't exist yet.
+    std::string output;
+    EXPECT_FALSE(cache.Lookup("key1", &output));
+    cache.Insert("key1", "one\ntwo\n", TickDelta(5000000));
+    cache.Insert("key2", "", TickDelta(1000000));
+    EXPECT_TRUE(cache.Lookup("key1", &output));
+    EXPECT_EQ("one\ntwo\n", output);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  {
+    ExecScriptCache cache(cache_file);
+    cache.Load();
+    std::string output;
+    EXPECT_TRUE(cache.Lookup("key1", &output));
+    EXPECT_EQ("one\ntwo\n", output);
+    EXPECT_TRUE(cache.Lookup("key1", &output));
+    EXPECT_FALSE(cache.Lookup("key3", &output));
+
+    // Each hit saves the recorded 5ms.
+    EXPECT_EQ(
+        "exec_script cache: (hits, misses, hit rate, time saved in ms)\n"
+        " 2  1  66.7%  10.00\n",
+        cache.Summarize());
+
+    // key2 wasn't used by this run so it's dropped.
+    ASSERT_TRUE(cache.Save());
+  }
+
+  {
+    ExecScriptCache cache(cache_file);
+    cache.Load();
+    std::string output;
+    EXPECT_TRUE(cache.Lookup("key1", &output));
+    EXPECT_FALSE(cache.Lookup("key2", &output));
+  }
+}
+
+TEST(ExecScriptCache, Malformed) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_file = temp_dir.GetPath().AppendASCII("cache");
+  WriteFile(cache_file, "GN exec_script cache v1\nkey1 10 100\nshort\n");
+
+  ExecScriptCache cache(cache_file);
+  cache.Load();
+  std::string output;
+  EXPECT_FALSE(cache.Lookup("key1", &output));
+}
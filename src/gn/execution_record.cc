@@ -0,0 +1,384 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/execution_record.h"
+
+#include <memory>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "gn/build_settings.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/functions.h"
+#include "gn/input_file.h"
+#include "gn/item.h"
+#include "gn/label.h"
+#include "gn/parse_tree.h"
+#include "gn/parser.h"
+#include "gn/scheduler.h"
+#include "gn/settings.h"
+#include "gn/target_generator.h"
+#include "gn/tokenizer.h"
+
+namespace {
+
+thread_local ExecutionRecord* current_record = nullptr;
+
+bool IsIdentifier(std::string_view name) {
+  if (name.empty() || !Tokenizer::IsIdentifierFirstChar(name[0]))
+    return false;
+  for (char c : name.substr(1)) {
+    if (!Tokenizer::IsIdentifierContinuingChar(c))
+      return false;
+  }
+  return name != "true" && name != "false" && name != "if" && name != "else";
+}
+
+// Appends |value| as GN source. Returns false if it can't be written so that
+// executing it gives the same value.
+bool AppendValue(const Value& value, std::string* out) {
+  switch (value.type()) {
+    case Value::BOOLEAN:
+    case Value::INTEGER:
+      out->append(value.ToString(false));
+      return true;
+    case Value::STRING:
+      // String literals can't span lines, and what could be interpreted is
+      // written as hex.
+      out->push_back('"');
+      for (char c : value.string_value()) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '$' || c == '"' || c == '\\' || byte < 0x20 || byte == 0x7f)
+          out->append(base::StringPrintf("$0x%02X", byte));
+        else
+          out->push_back(c);
+      }
+      out->push_back('"');
+      return true;
+    case Value::LIST:
+      out->push_back('[');
+      for (size_t i = 0; i < value.list_value().size(); i++) {
+        if (i > 0)
+          out->append(", ");
+        if (!AppendValue(value.list_value()[i], out))
+          return false;
+      }
+      out->push_back(']');
+      return true;
+    case Value::SCOPE: {
+      Scope::KeyValueMap values;
+      value.scope_value()->GetCurrentScopeValues(&values);
+      out->append("{\n");
+      for (const auto& [name, nested] : values) {
+        if (!IsIdentifier(name))
+          return false;
+        out->append(name);
+        out->append(" = ");
+        if (!AppendValue(nested, out))
+          return false;
+        out->push_back('\n');
+      }
+      out->push_back('}');
+      return true;
+    }
+    case Value::NONE:
+      break;
+  }
+  return false;
+}
+
+// Parses |text| as a new input file named |name|. The input file manager
+// keeps the parse tree, which values and items refer to, for the rest of the
+// process. Returns null on error.
+const BlockNode* ParseRestoredInput(const std::string& text,
+                                    const std::string& name,
+                                    Err* err) {
+  InputFile* input_file;
+  std::vector<Token>* tokens;
+  std::unique_ptr<ParseNode>* parse_root;
+  g_scheduler->input_file_manager()->AddDynamicInput(SourceFile(), &input_file,
+                                                     &tokens, &parse_root);
+  input_file->SetContents(text);
+  input_file->set_friendly_name(name);
+
+  *tokens = Tokenizer::Tokenize(input_file, err);
+  if (err->has_error())
+    return nullptr;
+  *parse_root = Parser::Parse(*tokens, err);
+  if (err->has_error())
+    return nullptr;
+  return (*parse_root)->AsBlock();
+}
+
+// Executes the first |count| statements of |block| in |scope|.
+bool ExecuteStatements(const BlockNode* block,
+                       size_t count,
+                       Scope* scope,
+                       Err* err) {
+  for (size_t i = 0; i < count; i++) {
+    block->statements()[i]->Execute(scope, err);
+    if (err->has_error())
+      return false;
+  }
+  return true;
+}
+
+// Appends a chunk of text that may span lines, and reads it back from |text|
+// at |pos|.
+void AppendChunk(char type, const std::string& chunk, std::string* out) {
+  out->push_back(type);
+  out->push_back(' ');
+  out->append(base::NumberToString(chunk.size()));
+  out->push_back('\n');
+  out->append(chunk);
+  out->push_back('\n');
+}
+
+bool ReadChunk(std::string_view size_text,
+               std::string_view text,
+               size_t* pos,
+               std::string* chunk) {
+  uint64_t size = 0;
+  if (!base::StringToUint64(size_text, &size) ||
+      size + 1 > text.size() - *pos || text[*pos + size] != '\n')
+    return false;
+  chunk->assign(text.substr(*pos, size));
+  *pos += size + 1;
+  return true;
+}
+
+}  // namespace
+
+ExecutionRecord::Recording::Recording(ExecutionRecord* record)
+    : previous_(current_record) {
+  current_record = record;
+}
+
+ExecutionRecord::Recording::~Recording() {
+  current_record = previous_;
+}
+
+ExecutionRecord::ItemDefinition::ItemDefinition(Scope* scope,
+                                                const std::string& kind)
+    : record_(current_record), scope_(scope), kind_(kind) {
+  if (record_)
+    scope_->set_lookup_observer(this);
+}
+
+ExecutionRecord::ItemDefinition::~ItemDefinition() {
+  if (record_)
+    scope_->set_lookup_observer(nullptr);
+}
+
+void ExecutionRecord::ItemDefinition::Done(const Item* item) {
+  if (!record_)
+    return;
+
+  Definition& definition = record_->definitions_.emplace_back();
+  definition.kind = kind_;
+  definition.name = item->label().name();
+  definition.source_dir = scope_->GetSourceDir();
+  definition.build_dependency_files.assign(
+      item->build_dependency_files().begin(),
+      item->build_dependency_files().end());
+  for (const auto& [name, found] : values_) {
+    std::string* out =
+        found.second ? &definition.values : &definition.outer_values;
+    out->append(name);
+    out->append(" = ");
+    if (!AppendValue(found.first, out))
+      record_->can_restore_ = false;
+    out->push_back('\n');
+  }
+}
+
+void ExecutionRecord::ItemDefinition::OnValueFound(
+    StringAtom ident,
+    const Value& value,
+    const Scope* found_in_scope) {
+  values_.emplace(ident.str(), std::make_pair(value, found_in_scope == scope_));
+}
+
+ExecutionRecord::ExecutionRecord() = default;
+
+ExecutionRecord::~ExecutionRecord() = default;
+
+// static
+ExecutionRecord* ExecutionRecord::Current() {
+  return current_record;
+}
+
+void ExecutionRecord::AddGenDependency(const base::FilePath& file,
+                                       const SourceFile& reader) {
+  gen_dependencies_.emplace_back(file, reader);
+}
+
+void ExecutionRecord::AddWrittenFile(const SourceFile& file) {
+  written_files_.push_back(file);
+}
+
+void ExecutionRecord::AddDeclaredArgs(const Scope::KeyValueMap& args) {
+  for (const auto& arg : args)
+    declared_args_.emplace_back(arg.first);
+}
+
+void ExecutionRecord::Replay(const Settings* settings) const {
+  for (const auto& [file, reader] : gen_dependencies_) {
+    if (reader.is_null())
+      g_scheduler->AddGenDependency(file);
+    else
+      g_scheduler->AddGenDependency(file, reader);
+  }
+  for (const SourceFile& file : written_files_)
+    g_scheduler->AddWrittenFile(file);
+  if (!declared_args_.empty()) {
+    settings->build_settings()->build_args().AddRestoredDeclarations(
+        declared_args_);
+  }
+}
+
+bool ExecutionRecord::RestoreItems(const Settings* settings,
+                                   Scope::ItemVector* items,
+                                   Err* err) const {
+  for (const Definition& definition : definitions_) {
+    std::string input_name =
+        "restored definition of " +
+        std::string(definition.source_dir.SourceWithNoTrailingSlash()) + ":" +
+        definition.name;
+    Scope outer_scope(settings);
+    outer_scope.set_source_dir(definition.source_dir);
+    if (!definition.outer_values.empty()) {
+      const BlockNode* outer_values =
+          ParseRestoredInput(definition.outer_values, input_name, err);
+      if (!outer_values ||
+          !ExecuteStatements(outer_values, outer_values->statements().size(),
+                             &outer_scope, err))
+        return false;
+    }
+
+    // The values are followed by the call defining the item, which errors
+    // about the item point to.
+    std::string values = definition.values + definition.kind + "(";
+    AppendValue(Value(nullptr, definition.name), &values);
+    values.append(")\n");
+    const BlockNode* block = ParseRestoredInput(values, input_name, err);
+    if (!block)
+      return false;
+    const FunctionCallNode* function =
+        block->statements().back()->AsFunctionCall();
+    if (!function) {
+      *err = Err(block, "Invalid restored item definition.");
+      return false;
+    }
+
+    Scope scope(&outer_scope);
+    for (const SourceFile& file : definition.build_dependency_files)
+      scope.AddBuildDependencyFile(file);
+    scope.set_item_collector(items);
+    if (!ExecuteStatements(block, block->statements().size() - 1, &scope, err))
+      return false;
+
+    std::vector<Value> args = {Value(function, definition.name)};
+    if (definition.kind == functions::kConfig)
+      functions::RunConfig(function, args, &scope, err);
+    else if (definition.kind == functions::kPool)
+      functions::RunPool(function, args, &scope, err);
+    else
+      TargetGenerator::GenerateTarget(&scope, function, args, definition.kind,
+                                      err);
+    if (err->has_error())
+      return false;
+  }
+  return true;
+}
+
+void ExecutionRecord::Write(std::string* out) const {
+  // Each line starts with its type and a space:
+  //  - "g <path>" for a file or directory not attributed to a build file.
+  //  - "r <reader>" then "a <path>" for an attributed one.
+  //  - "w <file>" for a written file.
+  //  - "d <name>" for a declared build argument.
+  //  - "x -" if the items can't be restored.
+  //  - For each item, "i <kind> <name>", "s <source dir>", a "b <file>" line
+  //    for each of its build dependency files, then "o <size>" and "v <size>"
+  //    lines each followed by assignments and a newline.
+  for (const auto& [file, reader] : gen_dependencies_) {
+    if (!reader.is_null())
+      out->append("r " + reader.value() + "\na ");
+    else
+      out->append("g ");
+    out->append(FilePathToUTF8(file));
+    out->push_back('\n');
+  }
+  for (const SourceFile& file : written_files_)
+    out->append("w " + file.value() + "\n");
+  for (const std::string& arg : declared_args_)
+    out->append("d " + arg + "\n");
+  if (!can_restore_)
+    out->append("x -\n");
+  for (const Definition& definition : definitions_) {
+    out->append("i " + definition.kind + " " + definition.name + "\n");
+    out->append("s " + definition.source_dir.value() + "\n");
+    for (const SourceFile& file : definition.build_dependency_files)
+      out->append("b " + file.value() + "\n");
+    AppendChunk('o', definition.outer_values, out);
+    AppendChunk('v', definition.values, out);
+  }
+}
+
+bool ExecutionRecord::Read(std::string_view text) {
+  SourceFile reader;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t line_end = text.find('\n', pos);
+    if (line_end == std::string_view::npos)
+      return false;
+    std::string_view line = text.substr(pos, line_end - pos);
+    pos = line_end + 1;
+    if (line.size() < 2 || line[1] != ' ')
+      return false;
+    char type = line[0];
+    std::string_view rest = line.substr(2);
+
+    Definition* definition =
+        definitions_.empty() ? nullptr : &definitions_.back();
+    if (type == 'g') {
+      gen_dependencies_.emplace_back(UTF8ToFilePath(rest), SourceFile());
+    } else if (type == 'r') {
+      reader = SourceFile(std::string(rest));
+    } else if (type == 'a') {
+      if (reader.is_null())
+        return false;
+      gen_dependencies_.emplace_back(UTF8ToFilePath(rest), reader);
+      reader = SourceFile();
+    } else if (type == 'w') {
+      written_files_.emplace_back(std::string(rest));
+    } else if (type == 'd') {
+      declared_args_.emplace_back(rest);
+    } else if (type == 'x') {
+      can_restore_ = false;
+    } else if (type == 'i') {
+      size_t space = rest.find(' ');
+      if (space == std::string_view::npos)
+        return false;
+      Definition& added = definitions_.emplace_back();
+      added.kind.assign(rest.substr(0, space));
+      added.name.assign(rest.substr(space + 1));
+    } else if (type == 's' && definition) {
+      definition->source_dir = SourceDir(rest);
+    } else if (type == 'b' && definition) {
+      definition->build_dependency_files.emplace_back(std::string(rest));
+    } else if (type == 'o' && definition) {
+      if (!ReadChunk(rest, text, &pos, &definition->outer_values))
+        return false;
+    } else if (type == 'v' && definition) {
+      if (!ReadChunk(rest, text, &pos, &definition->values))
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,137 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_EXECUTION_RECORD_H_
+#define TOOLS_GN_EXECUTION_RECORD_H_
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gn/scope.h"
+#include "gn/source_dir.h"
+#include "gn/source_file.h"
+#include "gn/value.h"
+
+class Err;
+class Item;
+class Settings;
+
+// What executing a build file or an import did that outlives the execution:
+// the items it defined, the files it consulted or wrote, and the build
+// arguments it declared. "gn gen --incremental" keeps these records so that
+// an unchanged build file doesn't have to be executed again.
+//
+// An item is recorded as the values its generator looked up, written as GN
+// assignments. Restoring it executes those assignments in a new scope and
+// runs the same generator on it, without the templates and imports that
+// computed the values.
+//
+// A record collects what happens on the thread executing the file while it
+// is the current record of that thread, see Recording.
+class ExecutionRecord {
+ public:
+  ExecutionRecord();
+  ~ExecutionRecord();
+
+  // Makes |record| the current record of this thread while in scope. A null
+  // record stops recording, e.g. for what an import does since it has a
+  // record of its own.
+  class Recording {
+   public:
+    explicit Recording(ExecutionRecord* record);
+    ~Recording();
+
+   private:
+    ExecutionRecord* previous_;
+
+    Recording(const Recording&) = delete;
+    Recording& operator=(const Recording&) = delete;
+  };
+
+  // Records the definition of an item by the current record of this thread,
+  // if any, from the values looked up in the scope of the item while this
+  // object exists.
+  class ItemDefinition : public Scope::LookupObserver {
+   public:
+    // |kind| is the function defining the item: "config", "pool" or the
+    // target type.
+    ItemDefinition(Scope* scope, const std::string& kind);
+    ~ItemDefinition() override;
+
+    // Adds the definition of |item| to the record.
+    void Done(const Item* item);
+
+    // Scope::LookupObserver implementation.
+    void OnValueFound(StringAtom ident,
+                      const Value& value,
+                      const Scope* found_in_scope) override;
+
+   private:
+    ExecutionRecord* record_;
+    Scope* scope_;
+    std::string kind_;
+
+    // The values looked up, by name, and whether they were found in |scope_|
+    // rather than in a containing scope.
+    std::map<std::string_view, std::pair<Value, bool>> values_;
+
+    ItemDefinition(const ItemDefinition&) = delete;
+    ItemDefinition& operator=(const ItemDefinition&) = delete;
+  };
+
+  // The current record of this thread, or null.
+  static ExecutionRecord* Current();
+
+  // Recording. |reader| is null for the files not attributed to a build file,
+  // see Scheduler::AddGenDependency().
+  void AddGenDependency(const base::FilePath& file, const SourceFile& reader);
+  void AddWrittenFile(const SourceFile& file);
+  void AddDeclaredArgs(const Scope::KeyValueMap& args);
+
+  // False if an item can't be restored, e.g. because one of its values can't
+  // be written as GN.
+  bool can_restore() const { return can_restore_; }
+
+  // Adds what the file did besides defining items to the scheduler and the
+  // build arguments again.
+  void Replay(const Settings* settings) const;
+
+  // Defines the recorded items again in |items|, in the same order. Returns
+  // false on error.
+  bool RestoreItems(const Settings* settings,
+                    Scope::ItemVector* items,
+                    Err* err) const;
+
+  // Appends the record to |out| as text, and reads that text.
+  void Write(std::string* out) const;
+  bool Read(std::string_view text);
+
+ private:
+  struct Definition {
+    std::string kind;
+    std::string name;
+    SourceDir source_dir;
+    std::vector<SourceFile> build_dependency_files;
+
+    // The assignments of the values found in containing scopes, and of the
+    // values found in the scope of the item.
+    std::string outer_values;
+    std::string values;
+  };
+
+  std::vector<std::pair<base::FilePath, SourceFile>> gen_dependencies_;
+  std::vector<SourceFile> written_files_;
+  std::vector<std::string> declared_args_;
+  std::vector<Definition> definitions_;
+  bool can_restore_ = true;
+
+  ExecutionRecord(const ExecutionRecord&) = delete;
+  ExecutionRecord& operator=(const ExecutionRecord&) = delete;
+};
+
+#endif  // TOOLS_GN_EXECUTION_RECORD_H_
@@ -0,0 +1,143 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/execution_record.h"
+
+#include <algorithm>
+
+#include "gn/config.h"
+#include "gn/pool.h"
+#include "gn/scheduler.h"
+#include "gn/target.h"
+#include "gn/test_with_scheduler.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+using ExecutionRecordTest = TestWithScheduler;
+
+// The items defined while recording are defined again with the same values
+// by the record read back, without the template and file-level values that
+// computed them.
+TEST_F(ExecutionRecordTest, RestoreItems) {
+  TestWithScope setup;
+  Scope::ItemVector items;
+  setup.scope()->set_item_collector(&items);
+  setup.scope()->set_source_dir(SourceDir("//foo/"));
+
+  TestParseInput input(R"(
+    visibility = [ ":*" ]
+    config("conf") {
+      defines = [ "a\"b\\c\$d$0x0Ae" ]
+    }
+    template("wrapped") {
+      source_set(target_name) {
+        forward_variables_from(invoker, "*")
+      }
+    }
+    wrapped("lib") {
+      sources = [ "lib.cc" ]
+      public_configs = [ ":conf" ]
+      metadata = {
+        names = [ "lib" ]
+      }
+    }
+    pool("pool") {
+      depth = 2
+    }
+  )");
+  ASSERT_FALSE(input.has_error());
+
+  ExecutionRecord record;
+  Err err;
+  {
+    ExecutionRecord::Recording recording(&record);
+    input.parsed()->Execute(setup.scope(), &err);
+  }
+  ASSERT_FALSE(err.has_error()) << err.message();
+  ASSERT_EQ(3u, items.size());
+  EXPECT_TRUE(record.can_restore());
+
+  std::string text;
+  record.Write(&text);
+  ExecutionRecord read;
+  ASSERT_TRUE(read.Read(text));
+  std::string read_text;
+  read.Write(&read_text);
+  EXPECT_EQ(text, read_text);
+
+  Scope::ItemVector restored;
+  ASSERT_TRUE(read.RestoreItems(setup.settings(), &restored, &err))
+      << err.message();
+  ASSERT_EQ(3u, restored.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    EXPECT_EQ(items[i]->label(), restored[i]->label());
+    EXPECT_EQ(items[i]->visibility().Describe(0, false),
+              restored[i]->visibility().Describe(0, false));
+    EXPECT_EQ(items[i]->build_dependency_files(),
+              restored[i]->build_dependency_files());
+  }
+
+  const Config* config = restored[0]->AsConfig();
+  ASSERT_TRUE(config);
+  ASSERT_EQ(1u, config->own_values().defines().size());
+  EXPECT_EQ("a\"b\\c$d\ne", config->own_values().defines()[0]);
+
+  const Target* target = restored[1]->AsTarget();
+  ASSERT_TRUE(target);
+  EXPECT_EQ(Target::SOURCE_SET, target->output_type());
+  EXPECT_EQ(items[1]->AsTarget()->sources(), target->sources());
+  ASSERT_EQ(1u, target->own_public_configs().size());
+  EXPECT_EQ(config->label(), target->own_public_configs()[0].label);
+  EXPECT_EQ(items[1]->AsTarget()->metadata().contents(),
+            target->metadata().contents());
+  EXPECT_TRUE(target->defined_from());
+
+  const Pool* pool = restored[2]->AsPool();
+  ASSERT_TRUE(pool);
+  EXPECT_EQ(2, pool->depth());
+}
+
+// What a file did besides defining items is added again.
+TEST_F(ExecutionRecordTest, Replay) {
+  TestWithScope setup;
+  base::FilePath unattributed(FILE_PATH_LITERAL("/in/unattributed"));
+  base::FilePath attributed(FILE_PATH_LITERAL("/in/attributed"));
+  ExecutionRecord record;
+  record.AddGenDependency(unattributed, SourceFile());
+  record.AddGenDependency(attributed, SourceFile("//BUILD.gn"));
+  record.AddWrittenFile(SourceFile("//out/Debug/written.txt"));
+  Scope::KeyValueMap declared;
+  declared["declared"] = Value(nullptr, true);
+  record.AddDeclaredArgs(declared);
+
+  std::string text;
+  record.Write(&text);
+  ExecutionRecord read;
+  ASSERT_TRUE(read.Read(text));
+
+  setup.build_settings()->build_args().AddArgOverride("declared",
+                                                      Value(nullptr, false));
+  Err err;
+  EXPECT_FALSE(setup.build_settings()->build_args().VerifyAllOverridesUsed(
+      &err));
+
+  read.Replay(setup.settings());
+  std::vector<base::FilePath> dependencies = scheduler().GetGenDependencies();
+  EXPECT_NE(dependencies.end(), std::find(dependencies.begin(),
+                                          dependencies.end(), unattributed));
+  EXPECT_EQ(SourceFileSet({SourceFile("//BUILD.gn")}),
+            scheduler().GetGenDependencyReaders()[attributed]);
+  EXPECT_EQ(0u, scheduler().GetGenDependencyReaders().count(unattributed));
+  err = Err();
+  EXPECT_TRUE(setup.build_settings()->build_args().VerifyAllOverridesUsed(
+      &err))
+      << err.message();
+}
+
+TEST_F(ExecutionRecordTest, ReadErrors) {
+  ExecutionRecord record;
+  EXPECT_FALSE(record.Read("a /no/reader\n"));
+  EXPECT_FALSE(record.Read("v 10\ntoo short\n"));
+  EXPECT_FALSE(record.Read("unknown\n"));
+}
@@ -0,0 +1,207 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/file_system_cache.h"
+
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "util/build_config.h"
+
+#if defined(OS_LINUX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <string_view>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#endif
+
+namespace {
+
+#if defined(OS_LINUX)
+// Layout of the records returned by getdents64().
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+// Reads the entries of |dir| with getdents64(). Unlike base::FileEnumerator,
+// this doesn't stat() every entry: the kernel reports the type of most of
+// them, and only symbolic links and entries of unknown type are stat()ed
+// relative to the directory.
+bool ReadDirectoryEntries(const base::FilePath& dir,
+                          FileSystemCache::DirEntries* entries) {
+  base::ScopedFD fd(HANDLE_EINTR(
+      open(dir.value().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return false;
+
+  alignas(LinuxDirent64) char buffer[16384];
+  for (;;) {
+    long size =
+        HANDLE_EINTR(syscall(SYS_getdents64, fd.get(), buffer, sizeof(buffer)));
+    if (size < 0)
+      return false;
+    if (size == 0)
+      return true;
+
+    for (long offset = 0; offset < size;) {
+      const LinuxDirent64* record =
+          reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+      offset += record->d_reclen;
+
+      std::string_view name(record->d_name);
+      if (name == "." || name == "..")
+        continue;
+
+      FileSystemCache::DirEntry& entry = entries->emplace_back();
+      entry.name.assign(name);
+      if (record->d_type == DT_LNK || record->d_type == DT_UNKNOWN) {
+        // Follow symbolic links like base::FileEnumerator does.
+        struct stat info;
+        entry.is_directory = fstatat(fd.get(), record->d_name, &info, 0) == 0 &&
+                             S_ISDIR(info.st_mode);
+      } else {
+        entry.is_directory = record->d_type == DT_DIR;
+      }
+    }
+  }
+}
+#else
+bool ReadDirectoryEntries(const base::FilePath& dir,
+                          FileSystemCache::DirEntries* entries) {
+  base::FileEnumerator enumerator(
+      dir, false,
+      base::FileEnumerator::FILES | base::FileEnumerator::DIRECTORIES);
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    FileSystemCache::DirEntry& entry = entries->emplace_back();
+    entry.name = path.BaseName().value();
+    entry.is_directory = enumerator.GetInfo().IsDirectory();
+  }
+  return true;
+}
+#endif
+
+}  // namespace
+
+FileSystemCache::FileSystemCache() = default;
+
+FileSystemCache::~FileSystemCache() = default;
+
+void FileSystemCache::SetBuildDir(const base::FilePath& build_dir) {
+  build_dir_ = build_dir.StripTrailingSeparators();
+}
+
+bool FileSystemCache::PathExists(const base::FilePath& path) {
+  return GetPathType(path) != PathType::kMissing;
+}
+
+bool FileSystemCache::DirectoryExists(const base::FilePath& path) {
+  return GetPathType(path) == PathType::kDirectory;
+}
+
+std::shared_ptr<const FileSystemCache::DirEntries>
+FileSystemCache::ListDirectory(const base::FilePath& dir) {
+  bool cached = IsCached(dir);
+  Shard& shard = GetShard(dir);
+  if (cached) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto found = shard.listings.find(dir.value());
+    if (found != shard.listings.end())
+      return found->second;
+  }
+
+  // List outside of the lock. If another thread lists the same directory
+  // concurrently, the first result to be inserted wins.
+  std::shared_ptr<DirEntries> entries;
+  if (GetPathType(dir) == PathType::kDirectory) {
+    entries = std::make_shared<DirEntries>();
+    if (!ReadDirectoryEntries(dir, entries.get()))
+      entries.reset();
+  }
+  if (!cached)
+    return entries;
+
+  std::lock_guard<std::mutex> lock(shard.lock);
+  return shard.listings.emplace(dir.value(), std::move(entries)).first->second;
+}
+
+std::shared_ptr<const std::string> FileSystemCache::ReadFile(
+    const base::FilePath& path) {
+  bool cached = IsCached(path);
+  Shard& shard = GetShard(path);
+  if (cached) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto found = shard.contents.find(path.value());
+    if (found != shard.contents.end())
+      return found->second;
+  }
+
+  auto contents = std::make_shared<std::string>();
+  if (!base::ReadFileToString(path, contents.get()))
+    contents.reset();
+  if (!cached)
+    return contents;
+
+  std::lock_guard<std::mutex> lock(shard.lock);
+  return shard.contents.emplace(path.value(), std::move(contents))
+      .first->second;
+}
+
+base::FilePath FileSystemCache::GetExistenceDependency(
+    const base::FilePath& path) {
+  base::FilePath dir = path.DirName();
+  while (!DirectoryExists(dir)) {
+    base::FilePath parent = dir.DirName();
+    if (parent == dir)
+      break;
+    dir = parent;
+  }
+  return dir;
+}
+
+bool FileSystemCache::IsCached(const base::FilePath& path) const {
+  return build_dir_.empty() ||
+         (path != build_dir_ && !build_dir_.IsParent(path));
+}
+
+FileSystemCache::Shard& FileSystemCache::GetShard(const base::FilePath& path) {
+  size_t hash = std::hash<base::FilePath::StringType>()(path.value());
+  return shards_[hash % kShardCount];
+}
+
+FileSystemCache::PathType FileSystemCache::GetPathType(
+    const base::FilePath& path) {
+  bool cached = IsCached(path);
+  Shard& shard = GetShard(path);
+  if (cached) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto found = shard.stats.find(path.value());
+    if (found != shard.stats.end())
+      return found->second;
+  }
+
+  base::File::Info info;
+  PathType type = PathType::kMissing;
+  if (base::GetFileInfo(path, &info))
+    type = info.is_directory ? PathType::kDirectory : PathType::kFile;
+  if (!cached)
+    return type;
+
+  std::lock_guard<std::mutex> lock(shard.lock);
+  shard.stats.emplace(path.value(), type);
+  return type;
+}
@@ -0,0 +1,97 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_FILE_SYSTEM_CACHE_H_
+#define TOOLS_GN_FILE_SYSTEM_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/files/file_path.h"
+
+// Caches the result of file system queries made by build files (path_exists,
+// glob_files, read_file and the like) for the duration of one run.
+//
+// The same BUILD.gn file is typically executed once per toolchain, and each
+// execution makes the same queries. On slow (e.g. network) file systems the
+// redundant stat() calls add up. Since the source tree is not supposed to
+// change while GN runs, the first answer is kept and returned to later
+// queries.
+//
+// The cache is not a substitute for gen dependencies: callers are still
+// responsible for calling Scheduler::AddGenDependency() on what they consult
+// so that the build is regenerated when it changes.
+//
+// Files in the build directory are written while GN runs (e.g. by write_file),
+// so queries about them are not cached, just like they are not gen
+// dependencies.
+//
+// This class is threadsafe. The cache is split in shards, each with its own
+// lock, to limit contention between worker threads.
+class FileSystemCache {
+ public:
+  // An entry of a directory listing.
+  struct DirEntry {
+    base::FilePath::StringType name;
+    bool is_directory = false;
+  };
+  using DirEntries = std::vector<DirEntry>;
+
+  FileSystemCache();
+  ~FileSystemCache();
+
+  // Sets the build directory, whose contents are never cached. Must be called
+  // before any query.
+  void SetBuildDir(const base::FilePath& build_dir);
+
+  // Equivalent of base::PathExists() and base::DirectoryExists().
+  bool PathExists(const base::FilePath& path);
+  bool DirectoryExists(const base::FilePath& path);
+
+  // Returns the entries of the given directory, in no particular order, or
+  // null if it can't be listed. Symbolic links are followed when determining
+  // whether an entry is a directory, like base::FileEnumerator does.
+  std::shared_ptr<const DirEntries> ListDirectory(const base::FilePath& dir);
+
+  // Returns the contents of the given file, or null if it can't be read.
+  std::shared_ptr<const std::string> ReadFile(const base::FilePath& path);
+
+  // Returns the closest existing directory containing |path|. Adding or
+  // removing |path| changes the modification time of that directory, so it
+  // is the gen dependency to use for a query about whether |path| exists.
+  base::FilePath GetExistenceDependency(const base::FilePath& path);
+
+ private:
+  enum class PathType { kMissing, kFile, kDirectory };
+
+  struct Shard {
+    std::mutex lock;
+    std::unordered_map<base::FilePath::StringType, PathType> stats;
+    std::unordered_map<base::FilePath::StringType,
+                       std::shared_ptr<const DirEntries>>
+        listings;
+    std::unordered_map<base::FilePath::StringType,
+                       std::shared_ptr<const std::string>>
+        contents;
+  };
+
+  static constexpr size_t kShardCount = 16;
+
+  // Returns false for paths in the build directory.
+  bool IsCached(const base::FilePath& path) const;
+
+  Shard& GetShard(const base::FilePath& path);
+  PathType GetPathType(const base::FilePath& path);
+
+  base::FilePath build_dir_;
+  Shard shards_[kShardCount];
+
+  FileSystemCache(const FileSystemCache&) = delete;
+  FileSystemCache& operator=(const FileSystemCache&) = delete;
+};
+
+#endif  // TOOLS_GN_FILE_SYSTEM_CACHE_H_
@@ -0,0 +1,120 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/file_system_cache.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteFile(const base::FilePath& path, const std::string& data) {
+  CHECK_EQ(static_cast<int>(data.size()),
+           base::WriteFile(path, data.data(), static_cast<int>(data.size())));
+}
+
+}  // namespace
+
+TEST(FileSystemCache, Stat) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file = temp_dir.GetPath().AppendASCII("file.txt");
+  WriteFile(file, "foo");
+
+  FileSystemCache cache;
+  EXPECT_TRUE(cache.PathExists(file));
+  EXPECT_FALSE(cache.DirectoryExists(file));
+  EXPECT_TRUE(cache.PathExists(temp_dir.GetPath()));
+  EXPECT_TRUE(cache.DirectoryExists(temp_dir.GetPath()));
+  EXPECT_FALSE(cache.PathExists(temp_dir.GetPath().AppendASCII("missing")));
+
+  // The first answer sticks.
+  ASSERT_TRUE(base::DeleteFile(file, false));
+  EXPECT_TRUE(cache.PathExists(file));
+}
+
+TEST(FileSystemCache, ListDirectory) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  WriteFile(temp_dir.GetPath().AppendASCII("b.txt"), "b");
+  ASSERT_TRUE(base::CreateDirectory(temp_dir.GetPath().AppendASCII("a")));
+
+  FileSystemCache cache;
+  EXPECT_FALSE(cache.ListDirectory(temp_dir.GetPath().AppendASCII("b.txt")));
+  EXPECT_FALSE(cache.ListDirectory(temp_dir.GetPath().AppendASCII("missing")));
+
+  std::shared_ptr<const FileSystemCache::DirEntries> entries =
+      cache.ListDirectory(temp_dir.GetPath());
+  ASSERT_TRUE(entries);
+  std::vector<FileSystemCache::DirEntry> sorted(*entries);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const auto& a, const auto& b) { return a.name < b.name; });
+  ASSERT_EQ(2u, sorted.size());
+  EXPECT_EQ(FILE_PATH_LITERAL("a"), sorted[0].name);
+  EXPECT_TRUE(sorted[0].is_directory);
+  EXPECT_EQ(FILE_PATH_LITERAL("b.txt"), sorted[1].name);
+  EXPECT_FALSE(sorted[1].is_directory);
+
+  EXPECT_EQ(entries, cache.ListDirectory(temp_dir.GetPath()));
+}
+
+TEST(FileSystemCache, ReadFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file = temp_dir.GetPath().AppendASCII("file.txt");
+  WriteFile(file, "foo");
+
+  FileSystemCache cache;
+  EXPECT_FALSE(cache.ReadFile(temp_dir.GetPath().AppendASCII("missing")));
+  std::shared_ptr<const std::string> contents = cache.ReadFile(file);
+  ASSERT_TRUE(contents);
+  EXPECT_EQ("foo", *contents);
+
+  WriteFile(file, "bar");
+  EXPECT_EQ(contents, cache.ReadFile(file));
+  EXPECT_EQ("foo", *contents);
+}
+
+// Files in the build directory are written during the run, so they are always
+// queried again.
+TEST(FileSystemCache, BuildDirIsNotCached) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_dir = temp_dir.GetPath().AppendASCII("out");
+  ASSERT_TRUE(base::CreateDirectory(build_dir));
+  base::FilePath file = build_dir.AppendASCII("file.txt");
+  base::FilePath source = temp_dir.GetPath().AppendASCII("source.txt");
+
+  FileSystemCache cache;
+  cache.SetBuildDir(build_dir);
+  EXPECT_FALSE(cache.PathExists(file));
+  EXPECT_FALSE(cache.ReadFile(file));
+  EXPECT_TRUE(cache.ListDirectory(build_dir)->empty());
+  EXPECT_FALSE(cache.PathExists(source));
+
+  WriteFile(file, "foo");
+  WriteFile(source, "foo");
+  EXPECT_TRUE(cache.PathExists(file));
+  ASSERT_TRUE(cache.ReadFile(file));
+  EXPECT_EQ("foo", *cache.ReadFile(file));
+  EXPECT_EQ(1u, cache.ListDirectory(build_dir)->size());
+  EXPECT_FALSE(cache.PathExists(source));
+}
+
+TEST(FileSystemCache, GetExistenceDependency) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath dir = temp_dir.GetPath().AppendASCII("dir");
+  ASSERT_TRUE(base::CreateDirectory(dir));
+
+  FileSystemCache cache;
+  EXPECT_EQ(dir, cache.GetExistenceDependency(dir.AppendASCII("file")));
+  EXPECT_EQ(temp_dir.GetPath(), cache.GetExistenceDependency(dir));
+  EXPECT_EQ(dir, cache.GetExistenceDependency(
+                     dir.AppendASCII("missing").AppendASCII("file")));
+}
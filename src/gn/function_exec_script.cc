@@ -2,6 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "base/command_line.h"
 #include "base/files/file_util.h"
 #include "base/logging.h"
@@ -9,11 +16,13 @@
 #include "base/strings/utf_string_conversions.h"
 #include "gn/err.h"
 #include "gn/exec_process.h"
+#include "gn/exec_script_cache.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
 #include "gn/input_conversion.h"
 #include "gn/input_file.h"
 #include "gn/parse_tree.h"
+#include "gn/python_worker.h"
 #include "gn/scheduler.h"
 #include "gn/trace.h"
 #include "gn/value.h"
@@ -57,6 +66,117 @@ bool CheckExecScriptPermissions(const BuildSettings* build_settings,
   return false;
 }
 
+// The result of running a script.
+struct ScriptResult {
+  // False if the process couldn't be started.
+  bool launched = false;
+
+  std::string output;
+  std::string stderr_output;
+  int exit_code = 0;
+  TickDelta exec_time{0};
+};
+
+// When a .gni file is evaluated for several toolchains, identical
+// exec_script() calls run concurrently on different worker threads. This
+// table lets them share one process: the first caller runs it and the others
+// with the same command line and working directory wait for its result.
+//
+// Entries are removed when the process completes, so this only deduplicates
+// concurrent calls. Later calls run the script again, see ExecScriptCache
+// for reusing results across calls and runs.
+class InFlightScripts {
+ public:
+  // Runs |cmdline| from |startup_dir| or waits for an identical call that is
+  // already running. Sets |*joined| when the result comes from another call.
+  //
+  // If |python_workers| is not null, the script is first offered to a Python
+  // worker with |script_argv| (the script and its arguments).
+  ScriptResult Run(const base::CommandLine& cmdline,
+                   const base::FilePath& startup_dir,
+                   PythonWorkerPool* python_workers,
+                   const std::vector<std::string>& script_argv,
+                   bool* joined) {
+    std::string key = FilePathToUTF8(cmdline.GetCommandLineString());
+    key.push_back('\0');
+    key.append(FilePathToUTF8(startup_dir));
+
+    std::unique_lock<std::mutex> lock(lock_);
+    auto found = flights_.find(key);
+    if (found != flights_.end()) {
+      // Keep a reference since the entry is erased when the flight lands.
+      std::shared_ptr<Flight> flight = found->second;
+      done_cv_.wait(lock, [&flight]() { return flight->done; });
+      *joined = true;
+      return flight->result;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    flights_[key] = flight;
+    lock.unlock();
+
+    ScriptResult result =
+        Execute(cmdline, startup_dir, python_workers, script_argv);
+
+    lock.lock();
+    flight->result = result;
+    flight->done = true;
+    flights_.erase(key);
+    lock.unlock();
+    done_cv_.notify_all();
+
+    *joined = false;
+    return result;
+  }
+
+ private:
+  struct Flight {
+    bool done = false;
+    ScriptResult result;
+  };
+
+  static ScriptResult Execute(const base::CommandLine& cmdline,
+                              const base::FilePath& startup_dir,
+                              PythonWorkerPool* python_workers,
+                              const std::vector<std::string>& script_argv) {
+    // The first time a build is run, no targets will have been written so
+    // the build output directory won't exist. We need to make sure it does
+    // before running any scripts with this as its startup directory, although
+    // it will be relatively rare that the directory won't exist by the time
+    // we get here.
+    //
+    // If this shows up on benchmarks, we can cache whether we've done this
+    // or not and skip creating the directory.
+    base::CreateDirectory(startup_dir);
+
+    // Execute the process.
+    // TODO(brettw) set the environment block.
+    ScriptResult result;
+    Ticks begin_exec = TicksNow();
+    if (python_workers) {
+      result.launched = python_workers->RunScript(
+          script_argv, startup_dir, &result.output, &result.stderr_output,
+          &result.exit_code);
+    }
+    if (!result.launched) {
+      result.launched =
+          internal::ExecProcess(cmdline, startup_dir, &result.output,
+                                &result.stderr_output, &result.exit_code);
+    }
+    result.exec_time = TicksDelta(TicksNow(), begin_exec);
+    return result;
+  }
+
+  std::mutex lock_;
+  std::condition_variable done_cv_;
+  std::map<std::string, std::shared_ptr<Flight>> flights_;
+};
+
+InFlightScripts& GetInFlightScripts() {
+  static InFlightScripts* in_flight = new InFlightScripts;
+  return *in_flight;
+}
+
 }  // namespace
 
 const char kExecScript[] = "exec_script";
@@ -83,6 +203,14 @@ const char kExecScript_Help[] =
   "python.bat" on Windows). This can be configured by the script_executable
   variable, see "gn help dotfile".
 
+  When GN is run with --exec-script-cache, the output of successful runs is
+  cached in the build directory and reused as long as the command line and the
+  contents of the script and of its dependencies don't change. See
+  "gn help --exec-script-cache".
+
+  With --python-worker, Python scripts are run by long-lived interpreters
+  instead of starting a new one for each call. See "gn help --python-worker".
+
 Arguments:
 
   filename:
@@ -156,7 +284,8 @@ Value RunExecScript(Scope* scope,
 
   // Add all dependencies of this script, including the script itself, to the
   // build deps.
-  g_scheduler->AddGenDependency(script_path);
+  std::vector<base::FilePath> inputs;
+  inputs.push_back(script_path);
   if (args.size() == 4) {
     const Value& deps_value = args[3];
     if (!deps_value.VerifyTypeIs(Value::LIST, err))
@@ -165,7 +294,7 @@ Value RunExecScript(Scope* scope,
     for (const auto& dep : deps_value.list_value()) {
       if (!dep.VerifyTypeIs(Value::STRING, err))
         return Value();
-      g_scheduler->AddGenDependency(build_settings->GetFullPath(
+      inputs.push_back(build_settings->GetFullPath(
           cur_dir.ResolveRelativeAs(
               true, dep, err,
               scope->settings()->build_settings()->root_path_utf8()),
@@ -174,6 +303,8 @@ Value RunExecScript(Scope* scope,
         return Value();
     }
   }
+  for (const auto& input : inputs)
+    g_scheduler->AddGenDependency(input);
 
   // Make the command line.
   base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
@@ -189,12 +320,19 @@ Value RunExecScript(Scope* scope,
   // pass script_path as the first argument. Otherwise, set the
   // program to script_path directly.
   base::FilePath interpreter_path = build_settings->python_path();
+  PythonWorkerPool* python_workers = nullptr;
+  std::vector<std::string> script_argv;
   if (!interpreter_path.empty()) {
     if (build_settings->python_path_is_relative_to_build_dir()) {
       interpreter_path = startup_dir.Append(interpreter_path);
     }
     cmdline.SetProgram(interpreter_path);
     cmdline.AppendArgPath(script_path);
+
+    // Python scripts may be run by a worker instead, see PythonWorkerPool.
+    python_workers = build_settings->python_worker_pool();
+    if (python_workers)
+      script_argv.push_back(FilePathToUTF8(script_path));
   } else {
     cmdline.SetProgram(script_path);
   }
@@ -208,12 +346,30 @@ Value RunExecScript(Scope* scope,
       if (!arg.VerifyTypeIs(Value::STRING, err))
         return Value();
       cmdline.AppendArg(arg.string_value());
+      if (python_workers)
+        script_argv.push_back(arg.string_value());
     }
   }
 
   // Log command line for debugging help.
   trace.SetCommandLine(cmdline);
-  Ticks begin_exec = 0;
+
+  // Reuse the output of an identical previous run if possible.
+  ExecScriptCache* cache = build_settings->exec_script_cache();
+  std::string cache_key;
+  std::string output;
+  if (cache) {
+    cache_key =
+        cache->MakeKey(cmdline, startup_dir,
+                       !!build_settings->exec_script_allowlist(), inputs);
+    if (cache->Lookup(cache_key, &output)) {
+      if (g_scheduler->verbose_logging())
+        g_scheduler->Log("Cached", script_source_path);
+      return ConvertInputToValue(scope->settings(), output, function,
+                                 args.size() >= 3 ? args[2] : Value(), err);
+    }
+  }
+
   if (g_scheduler->verbose_logging()) {
 #if defined(OS_WIN)
     g_scheduler->Log("Executing",
@@ -221,41 +377,28 @@ Value RunExecScript(Scope* scope,
 #else
     g_scheduler->Log("Executing", cmdline.GetCommandLineString());
 #endif
-    begin_exec = TicksNow();
   }
 
-  // The first time a build is run, no targets will have been written so the
-  // build output directory won't exist. We need to make sure it does before
-  // running any scripts with this as its startup directory, although it will
-  // be relatively rare that the directory won't exist by the time we get here.
-  //
-  // If this shows up on benchmarks, we can cache whether we've done this
-  // or not and skip creating the directory.
-  base::CreateDirectory(startup_dir);
-
-  // Execute the process.
-  // TODO(brettw) set the environment block.
-  std::string output;
-  std::string stderr_output;
-  int exit_code = 0;
-  {
-    if (!internal::ExecProcess(cmdline, startup_dir, &output, &stderr_output,
-                               &exit_code)) {
-      *err = Err(function->function(), "Could not execute interpreter.",
-                 "I was trying to execute \"" +
-                     FilePathToUTF8(interpreter_path) + "\".");
-      return Value();
-    }
+  bool joined = false;
+  ScriptResult result = GetInFlightScripts().Run(
+      cmdline, startup_dir, python_workers, script_argv, &joined);
+  if (!result.launched) {
+    *err = Err(function->function(), "Could not execute interpreter.",
+               "I was trying to execute \"" +
+                   FilePathToUTF8(interpreter_path) + "\".");
+    return Value();
   }
   if (g_scheduler->verbose_logging()) {
     g_scheduler->Log(
         "Executing",
-        script_source_path + " took " +
-            base::Int64ToString(
-                TicksDelta(TicksNow(), begin_exec).InMilliseconds()) +
-            "ms");
+        script_source_path + (joined ? " shared an identical call that took "
+                                     : " took ") +
+            base::Int64ToString(result.exec_time.InMilliseconds()) + "ms");
   }
 
+  output = std::move(result.output);
+  const std::string& stderr_output = result.stderr_output;
+  int exit_code = result.exit_code;
   if (exit_code != 0) {
     std::string msg =
         "Current dir: " + FilePathToUTF8(startup_dir) +
@@ -273,6 +416,9 @@ Value RunExecScript(Scope* scope,
     return Value();
   }
 
+  if (cache)
+    cache->Insert(cache_key, output, result.exec_time);
+
   // Default to None value for the input conversion if unspecified.
   return ConvertInputToValue(scope->settings(), output, function,
                              args.size() >= 3 ? args[2] : Value(), err);
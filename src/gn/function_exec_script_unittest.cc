@@ -0,0 +1,119 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/filesystem_utils.h"
+#include "gn/functions.h"
+#include "gn/test_with_scheduler.h"
+#include "gn/test_with_scope.h"
+#include "util/build_config.h"
+#include "util/test/test.h"
+
+// The test script is a shell script.
+#if !defined(OS_WIN)
+namespace {
+
+class ExecScriptTest : public TestWithScheduler {
+ public:
+  ExecScriptTest() {
+    CHECK(temp_dir_.CreateUniqueTempDir());
+    runs_path_ = temp_dir_.GetPath().AppendASCII("runs");
+
+    // Records each run, then gives the other callers time to join it.
+    std::string script =
+        "#!/bin/sh\n"
+        "echo run >> \"$1\"\n"
+        "sleep 1\n"
+        "echo \"output $2\"\n"
+        "exit $2\n";
+    base::FilePath script_path = temp_dir_.GetPath().AppendASCII("script.sh");
+    CHECK_EQ(static_cast<int>(script.size()),
+             base::WriteFile(script_path, script.data(),
+                             static_cast<int>(script.size())));
+    CHECK(base::SetPosixFilePermissions(script_path, 0700));
+  }
+
+  // Runs the script from |thread_count| threads at once, each with its own
+  // scope, and returns the results and errors.
+  void RunConcurrently(int thread_count,
+                       const std::string& exit_code,
+                       std::vector<Value>* results,
+                       std::vector<Err>* errors) {
+    results->resize(thread_count);
+    errors->resize(thread_count);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; i++) {
+      threads.emplace_back([this, i, &exit_code, results, errors]() {
+        TestWithScope setup;
+        setup.build_settings()->SetRootPath(temp_dir_.GetPath());
+
+        Value script_args(nullptr, Value::LIST);
+        script_args.list_value().push_back(
+            Value(nullptr, FilePathToUTF8(runs_path_)));
+        script_args.list_value().push_back(Value(nullptr, exit_code));
+        std::vector<Value> args;
+        args.push_back(Value(nullptr, "//script.sh"));
+        args.push_back(script_args);
+        args.push_back(Value(nullptr, "trim string"));
+
+        FunctionCallNode function_call;
+        (*results)[i] = functions::RunExecScript(
+            setup.scope(), &function_call, args, &(*errors)[i]);
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  // Returns the number of times the script ran.
+  int CountRuns() {
+    std::string runs;
+    if (!base::ReadFileToString(runs_path_, &runs))
+      return 0;
+    return static_cast<int>(std::count(runs.begin(), runs.end(), '\n'));
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath runs_path_;
+};
+
+}  // namespace
+
+// Identical calls made while the script is running share its result.
+TEST_F(ExecScriptTest, ConcurrentCallsRunOnce) {
+  std::vector<Value> results;
+  std::vector<Err> errors;
+  RunConcurrently(4, "0", &results, &errors);
+
+  EXPECT_EQ(1, CountRuns());
+  for (size_t i = 0; i < results.size(); i++) {
+    EXPECT_FALSE(errors[i].has_error()) << errors[i].message();
+    ASSERT_EQ(Value::STRING, results[i].type());
+    EXPECT_EQ("output 0", results[i].string_value());
+  }
+}
+
+// A failing script also runs once, and every caller reports the failure.
+TEST_F(ExecScriptTest, ConcurrentCallsShareErrors) {
+  std::vector<Value> results;
+  std::vector<Err> errors;
+  RunConcurrently(4, "3", &results, &errors);
+
+  EXPECT_EQ(1, CountRuns());
+  for (size_t i = 0; i < errors.size(); i++) {
+    ASSERT_TRUE(errors[i].has_error());
+    EXPECT_EQ("Script returned non-zero exit code.", errors[i].message());
+    EXPECT_EQ(errors[0].help_text(), errors[i].help_text());
+    EXPECT_NE(std::string::npos, errors[i].help_text().find("output 3"));
+  }
+}
+#endif  // !defined(OS_WIN)
@@ -65,8 +65,9 @@ Value RunForEach(Scope* scope,
   std::string_view loop_var(identifier->value().value());
 
   // Extract the list to iterate over. Always copy in case the code changes
-  // the list variable inside the loop.
-  Value list_value = args_vector[1]->Execute(scope, err);
+  // the list variable inside the loop. Since list storage is copy-on-write
+  // this only takes a reference, and being const it never gets detached.
+  const Value list_value = args_vector[1]->Execute(scope, err);
   if (err->has_error())
     return Value();
   list_value.VerifyTypeIs(Value::Type::LIST, err);
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <utility>
+
 #include "gn/err.h"
 #include "gn/functions.h"
 #include "gn/parse_tree.h"
@@ -12,7 +14,7 @@ namespace functions {
 namespace {
 
 void ForwardAllValues(const FunctionCallNode* function,
-                      Scope* source,
+                      const Scope* source,
                       Scope* dest,
                       const std::set<std::string>& exclusion_set,
                       Err* err) {
@@ -29,7 +31,7 @@ void ForwardAllValues(const FunctionCallNode* function,
   source->MarkAllUsed();
 }
 
-void ForwardValuesFromList(Scope* source,
+void ForwardValuesFromList(const Scope* source,
                            Scope* dest,
                            const std::vector<Value>& list,
                            const std::set<std::string>& exclusion_set,
@@ -174,14 +176,13 @@ Value RunForwardVariablesFrom(Scope* scope,
     return Value();
   }
 
-  Value* value = nullptr;  // Value to use, may point to result_value.
-  Value result_value;      // Storage for the "evaluate" case.
+  const Value* value = nullptr;  // Value to use, may point to result_value.
+  Value result_value;            // Storage for the "evaluate" case.
   const IdentifierNode* identifier = args_vector[0]->AsIdentifier();
   if (identifier) {
     // Optimize the common case where the input scope is an identifier. This
     // prevents a copy of a potentially large Scope object.
-    value = scope->GetMutableValue(identifier->value().value(),
-                                   Scope::SEARCH_NESTED, true);
+    value = scope->GetValue(identifier->value().atom(), true);
     if (!value) {
       *err = Err(identifier, "Undefined identifier.");
       return Value();
@@ -197,7 +198,7 @@ Value RunForwardVariablesFrom(Scope* scope,
   // Extract the source scope.
   if (!value->VerifyTypeIs(Value::SCOPE, err))
     return Value();
-  Scope* source = value->scope_value();
+  const Scope* source = value->scope_value();
 
   // Extract the exclusion list if defined.
   std::set<std::string> exclusion_set;
@@ -231,7 +232,8 @@ Value RunForwardVariablesFrom(Scope* scope,
     }
   } else {
     if (what_value.type() == Value::LIST) {
-      ForwardValuesFromList(source, scope, what_value.list_value(),
+      ForwardValuesFromList(source, scope,
+                            std::as_const(what_value).list_value(),
                             exclusion_set, err);
       return Value();
     }
@@ -4,18 +4,23 @@
 
 #include <stddef.h>
 #include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <iterator>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
-#include "base/files/file_util.h"
+#include "base/memory/ref_counted.h"
 #include "gn/build_settings.h"
 #include "gn/err.h"
+#include "gn/file_system_cache.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
 #include "gn/parse_tree.h"
+#include "gn/scheduler.h"
 #include "gn/scope.h"
 #include "gn/settings.h"
 #include "gn/source_dir.h"
@@ -60,6 +65,7 @@ bool ParseArguments(const std::vector<Value>& args,
 // Helper function to check if a path points to a file and resolve it.
 // Returns true if it's a file, false if it's a directory or doesn't exist.
 bool ResolveAndCheckFile(Scope* scope,
+                         const FunctionCallNode* function,
                          const Value& root_value,
                          const std::string& source_root_path,
                          base::FilePath* system_path,
@@ -81,7 +87,15 @@ bool ResolveAndCheckFile(Scope* scope,
 
   *system_path =
       scope->settings()->build_settings()->GetFullPath(resolved_file);
-  return base::PathExists(*system_path) && !base::DirectoryExists(*system_path);
+  FileSystemCache* file_system_cache = g_scheduler->file_system_cache();
+  if (!file_system_cache->PathExists(*system_path) ||
+      file_system_cache->DirectoryExists(*system_path)) {
+    return false;
+  }
+  AddFileSystemGenDependency(
+      scope->settings()->build_settings(),
+      file_system_cache->GetExistenceDependency(*system_path), function);
+  return true;
 }
 
 // Helper function to validate directory path
@@ -144,31 +158,166 @@ Value ReturnSingleFile(const FunctionCallNode* function,
   }
 }
 
-// Helper function to collect all files in directory
+// A walk of a directory tree, shared between the thread that called
+// glob_files() and helper tasks on the worker pool.
+//
+// Directories waiting to be listed are kept on a shared stack and whoever is
+// free takes the next one. Helpers are only posted when there is more than
+// one directory waiting. The calling thread never waits for a helper to
+// start, only for directories that are already being listed, so the walk
+// completes even if every worker is busy (or blocked on glob_files() itself).
+class DirectoryWalk : public base::RefCountedThreadSafe<DirectoryWalk> {
+ public:
+  // Directories equal to |pruned_dir| are not descended into. |max_files| is
+  // the number of files after which the walk is abandoned.
+  DirectoryWalk(const base::FilePath& root,
+                const base::FilePath& pruned_dir,
+                size_t max_files)
+      : pruned_dir_(pruned_dir),
+        max_files_(max_files),
+        // The walking thread is itself a worker.
+        max_helpers_(
+            std::max<size_t>(1, g_scheduler->worker_thread_count()) - 1) {
+    pending_dirs_.push_back(root);
+  }
+
+  // Walks the tree. Returns false if more than |max_files| files were found.
+  bool Walk() {
+    Drain(true);
+    std::lock_guard<std::mutex> lock(lock_);
+    return !too_many_files_;
+  }
+
+  // Valid after Walk() returned true. Both are in no particular order.
+  const std::vector<base::FilePath>& files() const { return files_; }
+  const std::vector<base::FilePath>& walked_dirs() const {
+    return walked_dirs_;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<DirectoryWalk>;
+  ~DirectoryWalk() = default;
+
+  // Lists pending directories until there are none left. When |is_caller|,
+  // also waits for the directories being listed by helpers, which may yield
+  // more work.
+  void Drain(bool is_caller) {
+    FileSystemCache* file_system_cache = g_scheduler->file_system_cache();
+    std::vector<base::FilePath> subdirs;
+    std::vector<base::FilePath> files;
+
+    std::unique_lock<std::mutex> lock(lock_);
+    for (;;) {
+      if (too_many_files_)
+        break;
+      if (pending_dirs_.empty()) {
+        if (!is_caller || busy_count_ == 0)
+          break;
+        done_cv_.wait(lock);
+        continue;
+      }
+
+      base::FilePath dir = std::move(pending_dirs_.back());
+      pending_dirs_.pop_back();
+      busy_count_++;
+      lock.unlock();
+
+      subdirs.clear();
+      files.clear();
+      std::shared_ptr<const FileSystemCache::DirEntries> entries =
+          file_system_cache->ListDirectory(dir);
+      if (entries) {
+        for (const FileSystemCache::DirEntry& entry : *entries) {
+          base::FilePath path = dir.Append(entry.name);
+          if (!entry.is_directory)
+            files.push_back(std::move(path));
+          else if (path != pruned_dir_)
+            subdirs.push_back(std::move(path));
+        }
+      }
+
+      lock.lock();
+      busy_count_--;
+      if (entries)
+        walked_dirs_.push_back(std::move(dir));
+      files_.insert(files_.end(), std::make_move_iterator(files.begin()),
+                    std::make_move_iterator(files.end()));
+      if (files_.size() > max_files_)
+        too_many_files_ = true;
+      pending_dirs_.insert(pending_dirs_.end(),
+                           std::make_move_iterator(subdirs.begin()),
+                           std::make_move_iterator(subdirs.end()));
+      if (pending_dirs_.size() > 1 && helper_count_ < max_helpers_) {
+        helper_count_++;
+        g_scheduler->ScheduleHelperWork(
+            [walk = scoped_refptr<DirectoryWalk>(this)]() {
+              walk->Drain(false);
+            });
+      }
+      done_cv_.notify_all();
+    }
+    if (!is_caller)
+      helper_count_--;
+  }
+
+  const base::FilePath pruned_dir_;
+  const size_t max_files_;
+  const size_t max_helpers_;
+
+  std::mutex lock_;
+  std::condition_variable done_cv_;
+
+  // Protected by |lock_|.
+  std::vector<base::FilePath> pending_dirs_;
+  size_t busy_count_ = 0;  // Directories being listed.
+  size_t helper_count_ = 0;
+  bool too_many_files_ = false;
+  std::vector<base::FilePath> files_;
+  std::vector<base::FilePath> walked_dirs_;
+
+  DirectoryWalk(const DirectoryWalk&) = delete;
+  DirectoryWalk& operator=(const DirectoryWalk&) = delete;
+};
+
+// Helper function to collect all files in directory and its subdirectories,
+// except those in the build directory. Every directory visited is recorded as
+// a gen dependency so that adding or removing files anywhere in the tree
+// regenerates the build.
 std::vector<std::string> CollectFilesInDirectory(
+    const BuildSettings* build_settings,
     const base::FilePath& system_path,
     const std::string& source_root_path,
     int max_results,
     const FunctionCallNode* function,
     Err* err) {
-  std::vector<std::string> results;
-  base::FileEnumerator enumerator(system_path, true,
-                                  base::FileEnumerator::FILES);
-  for (base::FilePath path = enumerator.Next(); !path.empty();
-       path = enumerator.Next()) {
-    if (static_cast<int>(results.size()) >= max_results) {
-      *err = Err(function->function(), "Too many files found.",
-                 "glob_files:  The number of files found exceeds the global "
-                 "limit (glob_max_results = " +
-                     std::to_string(max_results) + ").");
-      return {};
-    }
-    std::string file_path_utf8 = FilePathToUTF8(path);
+  base::FilePath build_dir;
+  if (!build_settings->build_dir().is_null()) {
+    build_dir = build_settings->GetFullPath(build_settings->build_dir())
+                    .StripTrailingSeparators();
+  }
 
+  auto walk = base::MakeRefCounted<DirectoryWalk>(
+      system_path.StripTrailingSeparators(), build_dir,
+      static_cast<size_t>(std::max(max_results, 0)));
+  if (!walk->Walk()) {
+    *err = Err(function->function(), "Too many files found.",
+               "glob_files:  The number of files found exceeds the global "
+               "limit (glob_max_results = " +
+                   std::to_string(max_results) + ").");
+    return {};
+  }
+
+  for (const base::FilePath& dir : walk->walked_dirs())
+    AddFileSystemGenDependency(build_settings, dir, function);
+
+  std::vector<std::string> results;
+  results.reserve(walk->files().size());
+  for (const base::FilePath& path : walk->files()) {
     std::string source_relative;
-    if (MakeAbsolutePathRelativeIfPossible(source_root_path, file_path_utf8,
+    if (MakeAbsolutePathRelativeIfPossible(source_root_path,
+                                           FilePathToUTF8(path),
                                            &source_relative)) {
-      results.push_back(source_relative);
+      results.push_back(std::move(source_relative));
     }
   }
   return results;
@@ -260,8 +409,8 @@ Value RunGlobFiles(Scope* scope,
       scope->settings()->build_settings()->root_path_utf8();
 
   base::FilePath system_path;
-  bool is_file_path = ResolveAndCheckFile(scope, root_value, source_root_path,
-                                          &system_path, err);
+  bool is_file_path = ResolveAndCheckFile(scope, function, root_value,
+                                          source_root_path, &system_path, err);
 
   if (is_file_path) {
     return ReturnSingleFile(function, system_path, source_root_path, err);
@@ -273,7 +422,7 @@ Value RunGlobFiles(Scope* scope,
     return Value();
   }
 
-  if (!base::DirectoryExists(system_path)) {
+  if (!g_scheduler->file_system_cache()->DirectoryExists(system_path)) {
     *err = Err(function->function(), "Path not found.",
                "glob_files: The specified path does not exist.");
     return Value();
@@ -281,7 +430,8 @@ Value RunGlobFiles(Scope* scope,
 
   int max_results = scope->settings()->build_settings()->glob_max_results();
   std::vector<std::string> results = CollectFilesInDirectory(
-      system_path, source_root_path, max_results, function, err);
+      scope->settings()->build_settings(), system_path, source_root_path,
+      max_results, function, err);
 
   if (err->has_error()) {
     return Value();
@@ -2,14 +2,17 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <string>
 #include <vector>
+
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "gn/functions.h"
 #include "gn/parse_tree.h"
 #include "gn/scope.h"
 #include "gn/source_dir.h"
+#include "gn/test_with_scheduler.h"
 #include "gn/test_with_scope.h"
 #include "gn/value.h"
 #include "util/test/test.h"
@@ -31,7 +34,9 @@ Value RunGlobFiles(Scope* scope,
 }
 }  // namespace
 
-TEST(GlobFilesTest, NormalScan) {
+using GlobFilesTest = TestWithScheduler;
+
+TEST_F(GlobFilesTest, NormalScan) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -53,7 +58,7 @@ TEST(GlobFilesTest, NormalScan) {
   EXPECT_EQ("//some-dir/file2.h", result.list_value()[1].string_value());
 }
 
-TEST(GlobFilesTest, RecursiveScan) {
+TEST_F(GlobFilesTest, RecursiveScan) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -81,9 +86,15 @@ TEST(GlobFilesTest, RecursiveScan) {
   EXPECT_EQ("//some-dir/subdir/nested/nested.cc",
             result.list_value()[1].string_value());
   EXPECT_EQ("//some-dir/subdir/sub.cc", result.list_value()[2].string_value());
+
+  // Every directory walked is a gen dependency.
+  std::vector<base::FilePath> deps = scheduler().GetGenDependencies();
+  std::sort(deps.begin(), deps.end());
+  EXPECT_EQ(std::vector<base::FilePath>({dir_path, subdir_path, nested_path}),
+            deps);
 }
 
-TEST(GlobFilesTest, EmptyDirectory) {
+TEST_F(GlobFilesTest, EmptyDirectory) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -112,7 +123,7 @@ TEST(GlobFilesTest, EmptyDirectory) {
   }
 }
 
-TEST(GlobFilesTest, FilterOutputDir) {
+TEST_F(GlobFilesTest, FilterOutputDir) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
   setup.build_settings()->SetBuildDir(SourceDir("//out/Default/"));
@@ -137,9 +148,50 @@ TEST(GlobFilesTest, FilterOutputDir) {
   EXPECT_TRUE(result.type() == Value::LIST);
   EXPECT_EQ(1u, result.list_value().size());
   EXPECT_EQ("//some-dir/source.cc", result.list_value()[0].string_value());
+
+  // The build directory isn't descended into when scanning a parent.
+  result = RunGlobFiles(setup.scope(), "//");
+  EXPECT_TRUE(result.type() == Value::LIST);
+  ASSERT_EQ(1u, result.list_value().size());
+  EXPECT_EQ("//some-dir/source.cc", result.list_value()[0].string_value());
+}
+
+TEST_F(GlobFilesTest, LargeTree) {
+  TestWithScope setup;
+  setup.scope()->set_source_dir(SourceDir("//"));
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  setup.build_settings()->SetRootPath(temp_dir.GetPath());
+
+  // Enough directories for the walk to be shared with the worker pool.
+  std::vector<std::string> expected;
+  base::FilePath root = temp_dir.GetPath().AppendASCII("res");
+  for (int i = 0; i < 10; i++) {
+    base::FilePath dir = root.AppendASCII("d" + std::to_string(i));
+    for (int j = 0; j < 10; j++) {
+      base::FilePath subdir = dir.AppendASCII("s" + std::to_string(j));
+      ASSERT_TRUE(base::CreateDirectory(subdir));
+      for (int k = 0; k < 3; k++) {
+        std::string name = "f" + std::to_string(k) + ".png";
+        base::WriteFile(subdir.AppendASCII(name), "x", 1);
+        expected.push_back("//res/d" + std::to_string(i) + "/s" +
+                           std::to_string(j) + "/" + name);
+      }
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  Value result = RunGlobFiles(setup.scope(), "res");
+  ASSERT_TRUE(result.type() == Value::LIST);
+  std::vector<std::string> actual;
+  for (const Value& value : result.list_value())
+    actual.push_back(value.string_value());
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(111u, scheduler().GetGenDependencies().size());
 }
 
-TEST(GlobFilesTest, InvalidArguments) {
+TEST_F(GlobFilesTest, InvalidArguments) {
   TestWithScope setup;
   FunctionCallNode function_call;
 
@@ -186,7 +238,7 @@ TEST(GlobFilesTest, InvalidArguments) {
   }
 }
 
-TEST(GlobFilesTest, SortAndDeduplicate) {
+TEST_F(GlobFilesTest, SortAndDeduplicate) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -208,7 +260,7 @@ TEST(GlobFilesTest, SortAndDeduplicate) {
   EXPECT_EQ("//some-dir/c.cc", result.list_value()[2].string_value());
 }
 
-TEST(GlobFilesTest, MaxResultsLimit) {
+TEST_F(GlobFilesTest, MaxResultsLimit) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
   setup.build_settings()->set_glob_max_results(2);
@@ -233,7 +285,7 @@ TEST(GlobFilesTest, MaxResultsLimit) {
   EXPECT_TRUE(err.has_error());
 }
 
-TEST(GlobFilesTest, CannotOverrideMaxResultsInScope) {
+TEST_F(GlobFilesTest, CannotOverrideMaxResultsInScope) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
   // Set a global limit via build_settings
@@ -262,7 +314,7 @@ TEST(GlobFilesTest, CannotOverrideMaxResultsInScope) {
   EXPECT_TRUE(err.has_error());
 }
 
-TEST(GlobFilesTest, RejectOutputDirectory) {
+TEST_F(GlobFilesTest, RejectOutputDirectory) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
   setup.build_settings()->SetBuildDir(SourceDir("//out/Default/"));
@@ -287,7 +339,7 @@ TEST(GlobFilesTest, RejectOutputDirectory) {
   EXPECT_TRUE(err.has_error());
 }
 
-TEST(GlobFilesTest, RejectOutputSubDirectory) {
+TEST_F(GlobFilesTest, RejectOutputSubDirectory) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
   setup.build_settings()->SetBuildDir(SourceDir("//out/"));
@@ -312,7 +364,7 @@ TEST(GlobFilesTest, RejectOutputSubDirectory) {
   EXPECT_TRUE(err.has_error());
 }
 
-TEST(GlobFilesTest, RejectOutSideSource) {
+TEST_F(GlobFilesTest, RejectOutSideSource) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -330,7 +382,7 @@ TEST(GlobFilesTest, RejectOutSideSource) {
   EXPECT_TRUE(err.has_error());
 }
 
-TEST(GlobFilesTest, RelativePath) {
+TEST_F(GlobFilesTest, RelativePath) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -364,7 +416,7 @@ TEST(GlobFilesTest, RelativePath) {
   }
 }
 
-TEST(GlobFilesTest, RejectSystemAbsolutePath) {
+TEST_F(GlobFilesTest, RejectSystemAbsolutePath) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -397,7 +449,7 @@ TEST(GlobFilesTest, RejectSystemAbsolutePath) {
   }
 }
 
-TEST(GlobFilesTest, DirectoryNotFound) {
+TEST_F(GlobFilesTest, DirectoryNotFound) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -430,7 +482,7 @@ TEST(GlobFilesTest, DirectoryNotFound) {
   }
 }
 
-TEST(GlobFilesTest, SingleFile) {
+TEST_F(GlobFilesTest, SingleFile) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
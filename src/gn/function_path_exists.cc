@@ -4,11 +4,12 @@
 
 #include <stddef.h>
 
-#include "base/files/file_util.h"
 #include "gn/build_settings.h"
 #include "gn/err.h"
+#include "gn/file_system_cache.h"
 #include "gn/functions.h"
 #include "gn/parse_tree.h"
+#include "gn/scheduler.h"
 #include "gn/settings.h"
 #include "gn/value.h"
 
@@ -48,7 +49,11 @@ Value RunPathExists(Scope* scope,
     return value;
   }
 
-  bool exists = PathExists(system_path);
+  FileSystemCache* file_system_cache = g_scheduler->file_system_cache();
+  AddFileSystemGenDependency(
+      scope->settings()->build_settings(),
+      file_system_cache->GetExistenceDependency(system_path), function);
+  bool exists = file_system_cache->PathExists(system_path);
   return Value(function, exists);
 }
 
@@ -60,6 +65,9 @@ const char kPathExists_Help[] =
 
   path_exists(path)
 
+  The directory that would contain the path becomes a dependency of the build,
+  so creating or deleting the path makes GN regenerate the build files.
+
 Examples:
   path_exists("//")  # true
   path_exists("BUILD.gn")  # true
@@ -2,9 +2,12 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "gn/functions.h"
+#include "gn/test_with_scheduler.h"
 #include "gn/test_with_scope.h"
 #include "util/build_config.h"
 #include "util/test/test.h"
@@ -22,7 +25,9 @@ bool RunPathExists(Scope* scope, const std::string& path) {
 }
 }  // namespace
 
-TEST(PathExistsTest, FileExists) {
+using PathExistsTest = TestWithScheduler;
+
+TEST_F(PathExistsTest, FileExists) {
   TestWithScope setup;
   setup.scope()->set_source_dir(SourceDir("//some-dir/"));
 
@@ -45,9 +50,15 @@ TEST(PathExistsTest, FileExists) {
   EXPECT_TRUE(RunPathExists(setup.scope(), temp_dir.GetPath().As8Bit()));
   EXPECT_FALSE(RunPathExists(setup.scope(), "//bar"));
   EXPECT_FALSE(RunPathExists(setup.scope(), "bar"));
+
+  // The directories that contain the paths are gen dependencies.
+  std::vector<base::FilePath> deps = scheduler().GetGenDependencies();
+  EXPECT_NE(deps.end(), std::find(deps.begin(), deps.end(), dir_path));
+  EXPECT_NE(deps.end(),
+            std::find(deps.begin(), deps.end(), temp_dir.GetPath()));
 }
 
-TEST(PathExistsTest, FileExistsInvalidValues) {
+TEST_F(PathExistsTest, FileExistsInvalidValues) {
   TestWithScope setup;
   FunctionCallNode function_call;
 
@@ -2,8 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include "base/files/file_util.h"
 #include "gn/err.h"
+#include "gn/file_system_cache.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
 #include "gn/input_conversion.h"
@@ -65,14 +65,15 @@ Value RunReadFile(Scope* scope,
   g_scheduler->AddGenDependency(file_path);
 
   // Read contents.
-  std::string file_contents;
-  if (!base::ReadFileToString(file_path, &file_contents)) {
+  std::shared_ptr<const std::string> file_contents =
+      g_scheduler->file_system_cache()->ReadFile(file_path);
+  if (!file_contents) {
     *err = Err(args[0], "Could not read file.",
                "I resolved this to \"" + FilePathToUTF8(file_path) + "\".");
     return Value();
   }
 
-  return ConvertInputToValue(scope->settings(), file_contents, function,
+  return ConvertInputToValue(scope->settings(), *file_contents, function,
                              args[1], err);
 }
 
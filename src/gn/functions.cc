@@ -17,6 +17,7 @@
 #include "gn/config.h"
 #include "gn/config_values_generator.h"
 #include "gn/err.h"
+#include "gn/execution_record.h"
 #include "gn/input_file.h"
 #include "gn/ohos_components_checker.h"
 #include "gn/ohos_components_mapping.h"
@@ -175,6 +176,24 @@ Label MakeLabelForScope(const Scope* scope,
                toolchain_label.name());
 }
 
+void AddFileSystemGenDependency(const BuildSettings* build_settings,
+                                const base::FilePath& path,
+                                const FunctionCallNode* function) {
+  if (!build_settings->build_dir().is_null()) {
+    base::FilePath build_dir =
+        build_settings->GetFullPath(build_settings->build_dir())
+            .StripTrailingSeparators();
+    if (path == build_dir || build_dir.IsParent(path))
+      return;
+  }
+  const InputFile* reader =
+      function ? function->GetRange().begin().file() : nullptr;
+  if (reader && !reader->name().is_null())
+    g_scheduler->AddGenDependency(path, reader->name());
+  else
+    g_scheduler->AddGenDependency(path);
+}
+
 // static
 const int NonNestableBlock::kKey = 0;
 
@@ -367,6 +386,7 @@ Value RunConfig(const FunctionCallNode* function,
     return Value();
 
   Label label(MakeLabelForScope(scope, function, args[0].string_value()));
+  ExecutionRecord::ItemDefinition definition(scope, kConfig);
 
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Defining config", label.GetUserVisibleName(true));
@@ -402,6 +422,7 @@ Value RunConfig(const FunctionCallNode* function,
     *err = Err(function, "Can't define a config in this context.");
     return Value();
   }
+  definition.Done(config.get());
   collector->push_back(std::move(config));
 
   return Value();
@@ -753,15 +774,14 @@ Value RunNotNeeded(Scope* scope,
   }
   auto args_cur = args_vector.begin();
 
-  Value* value = nullptr;  // Value to use, may point to result_value.
-  Value result_value;      // Storage for the "evaluate" case.
-  Value scope_value;       // Storage for an evaluated scope.
+  const Value* value = nullptr;  // Value to use, may point to result_value.
+  Value result_value;            // Storage for the "evaluate" case.
+  Value scope_value;             // Storage for an evaluated scope.
   const IdentifierNode* identifier = (*args_cur)->AsIdentifier();
   if (identifier) {
     // Optimize the common case where the input scope is an identifier. This
     // prevents a copy of a potentially large Scope object.
-    value = scope->GetMutableValue(identifier->value().value(),
-                                   Scope::SEARCH_NESTED, true);
+    value = scope->GetValue(identifier->value().atom(), true);
     if (!value) {
       *err = Err(identifier, "Undefined identifier.");
       return Value();
@@ -776,7 +796,7 @@ Value RunNotNeeded(Scope* scope,
   args_cur++;
 
   // Extract the source scope if different from current one.
-  Scope* source = scope;
+  const Scope* source = scope;
   if (value->type() == Value::SCOPE) {
     if (args_cur == args_vector.end()) {
       *err = Err(
@@ -784,13 +804,12 @@ Value RunNotNeeded(Scope* scope,
           "The first argument is a scope, expecting two or three arguments.");
       return Value();
     }
-    // Copy the scope value if it will be overridden.
+    // Keep the scope value if it will be overridden.
     if (value == &result_value) {
-      scope_value = Value(nullptr, value->scope_value()->MakeClosure());
-      source = scope_value.scope_value();
-    } else {
-      source = value->scope_value();
+      scope_value = std::move(result_value);
+      value = &scope_value;
     }
+    source = value->scope_value();
     result_value = (*args_cur)->Execute(scope, err);
     if (err->has_error())
       return Value();
@@ -807,7 +826,14 @@ Value RunNotNeeded(Scope* scope,
   Value exclusion_value;
   std::set<std::string> exclusion_set;
   if (args_cur != args_vector.end()) {
-    exclusion_value = (*args_cur)->Execute(source, err);
+    // The list is evaluated in the source scope. The scope of a value can
+    // only be read, so that is done from a scope nested in it.
+    if (source == scope) {
+      exclusion_value = (*args_cur)->Execute(scope, err);
+    } else {
+      Scope source_reader(source);
+      exclusion_value = (*args_cur)->Execute(&source_reader, err);
+    }
     if (err->has_error())
       return Value();
 
@@ -913,6 +939,7 @@ Value RunPool(const FunctionCallNode* function,
     return Value();
 
   Label label(MakeLabelForScope(scope, function, args[0].string_value()));
+  ExecutionRecord::ItemDefinition definition(scope, kPool);
 
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Defining pool", label.GetUserVisibleName(true));
@@ -962,6 +989,7 @@ Value RunPool(const FunctionCallNode* function,
     *err = Err(function, "Can't define a pool in this context.");
     return Value();
   }
+  definition.Done(pool.get());
   collector->push_back(std::move(pool));
 
   return Value();
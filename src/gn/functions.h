@@ -10,6 +10,9 @@
 #include <string_view>
 #include <vector>
 
+#include "base/files/file_path.h"
+
+class BuildSettings;
 class Err;
 class BlockNode;
 class FunctionCallNode;
@@ -571,6 +574,15 @@ Label MakeLabelForScope(const Scope* scope,
                         const FunctionCallNode* function,
                         const std::string& name);
 
+// Records a gen dependency on a file or directory that a build file consulted
+// on disk. Paths inside the build directory are skipped: that directory
+// changes on every build, so depending on it would regenerate forever.
+// |function| is the call that consulted it, if known, whose build file is
+// recorded as the reader (see Scheduler::AddGenDependency()).
+void AddFileSystemGenDependency(const BuildSettings* build_settings,
+                                const base::FilePath& path,
+                                const FunctionCallNode* function);
+
 // Some types of blocks can't be nested inside other ones. For such cases,
 // instantiate this object upon entering the block and Enter() will fail if
 // there is already another non-nestable block on the stack.
@@ -0,0 +1,226 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/gen_inputs_manifest.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "gn/filesystem_utils.h"
+#include "util/atomic_write.h"
+#include "util/exe_path.h"
+
+namespace {
+
+// First line of the manifest. Bump the version when changing the format or
+// the hash function.
+const char kHeader[] = "GN gen inputs manifest v2\n";
+
+const char kMissing[] = "missing";
+
+// Files that can't be read count as changed every time.
+const char kUnreadable[] = "unreadable";
+
+// Prefix of the hash of a directory, which is that of its sorted entry names.
+// Globs and path_exists() depend on the entries, not on the modification time
+// that changes whenever any of them is written.
+const char kDirectoryPrefix[] = "dir:";
+
+// Returns the names of the entries of |dir|, sorted, one per line. Names of
+// subdirectories end with a slash, so that replacing a file with a directory
+// counts as a change.
+std::string ListDirectory(const base::FilePath& dir) {
+  base::FileEnumerator enumerator(
+      dir, false,
+      base::FileEnumerator::FILES | base::FileEnumerator::DIRECTORIES);
+  std::vector<std::string> names;
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    std::string name = FilePathToUTF8(path.BaseName());
+    if (enumerator.GetInfo().IsDirectory())
+      name.push_back('/');
+    names.push_back(std::move(name));
+  }
+  std::sort(names.begin(), names.end());
+  std::string listing;
+  for (const std::string& name : names) {
+    listing.append(name);
+    listing.push_back('\n');
+  }
+  return listing;
+}
+
+}  // namespace
+
+const char GenInputsManifest::kFileName[] = "gen_inputs.manifest";
+
+GenInputsManifest::GenInputsManifest(const base::FilePath& build_dir)
+    : build_dir_(build_dir) {}
+
+GenInputsManifest::~GenInputsManifest() = default;
+
+bool GenInputsManifest::Load() {
+  entries_.clear();
+
+  std::string contents;
+  if (!base::ReadFileToString(build_dir_.AppendASCII(kFileName), &contents))
+    return false;
+  if (contents.compare(0, sizeof(kHeader) - 1, kHeader) != 0)
+    return false;
+
+  // The header is followed by a "gn <generator key>" line, then a
+  // "<hash> <modification time> <path>" line per input. The path is last
+  // since it may contain spaces.
+  std::vector<Entry> entries;
+  bool has_generator = false;
+  size_t pos = sizeof(kHeader) - 1;
+  while (pos < contents.size()) {
+    size_t line_end = contents.find('\n', pos);
+    if (line_end == std::string::npos)
+      return false;
+    std::string_view line(&contents[pos], line_end - pos);
+    pos = line_end + 1;
+
+    if (!has_generator) {
+      if (line != "gn " + GetGeneratorKey())
+        return false;
+      has_generator = true;
+      continue;
+    }
+
+    size_t hash_end = line.find(' ');
+    size_t time_end = hash_end == std::string_view::npos
+                          ? std::string_view::npos
+                          : line.find(' ', hash_end + 1);
+    if (time_end == std::string_view::npos)
+      return false;
+    Entry& entry = entries.emplace_back();
+    entry.hash = std::string(line.substr(0, hash_end));
+    if (!base::StringToUint64(
+            line.substr(hash_end + 1, time_end - hash_end - 1),
+            &entry.last_modified))
+      return false;
+    entry.path = UTF8ToFilePath(line.substr(time_end + 1));
+  }
+  if (!has_generator)
+    return false;
+
+  entries_ = std::move(entries);
+  return true;
+}
+
+bool GenInputsManifest::Save() const {
+  std::string contents = kHeader;
+  contents.append("gn " + GetGeneratorKey() + "\n");
+  for (const Entry& entry : entries_) {
+    contents.append(base::StringPrintf(
+        "%s %" PRIu64 " ", entry.hash.c_str(),
+        static_cast<uint64_t>(entry.last_modified)));
+    contents.append(FilePathToUTF8(entry.path));
+    contents.push_back('\n');
+  }
+  return util::WriteFileAtomically(build_dir_.AppendASCII(kFileName),
+                                   contents.data(),
+                                   static_cast<int>(contents.size())) ==
+         static_cast<int>(contents.size());
+}
+
+void GenInputsManifest::RecordInputs(
+    const std::vector<base::FilePath>& inputs) {
+  entries_.clear();
+  entries_.reserve(inputs.size());
+  for (const base::FilePath& input : inputs) {
+    DCHECK(input.IsAbsolute());
+    Entry& entry = entries_.emplace_back();
+    entry.path = input;
+    HashFile(&entry);
+  }
+}
+
+bool GenInputsManifest::InputsUnchanged() {
+  for (Entry& entry : entries_) {
+    if (EntryChanged(&entry))
+      return false;
+  }
+  return true;
+}
+
+void GenInputsManifest::GetChangedInputs(std::set<base::FilePath>* changed) {
+  for (Entry& entry : entries_) {
+    if (EntryChanged(&entry))
+      changed->insert(entry.path);
+  }
+}
+
+// static
+void GenInputsManifest::Delete(const base::FilePath& build_dir) {
+  base::DeleteFile(build_dir.AppendASCII(kFileName), false);
+}
+
+bool GenInputsManifest::EntryChanged(Entry* entry) const {
+  if (entry->hash == kUnreadable)
+    return true;
+
+  base::File::Info info;
+  if (!base::GetFileInfo(entry->path, &info))
+    return entry->hash != kMissing;
+  if (info.last_modified == entry->last_modified)
+    return false;
+
+  Entry current;
+  current.path = entry->path;
+  HashFile(&current);
+  if (current.hash != entry->hash)
+    return true;
+  *entry = std::move(current);
+  return false;
+}
+
+void GenInputsManifest::HashFile(Entry* entry) const {
+  const base::FilePath& path = entry->path;
+
+  // Stat before reading, so that a file modified in between has a newer
+  // modification time than the recorded one and is read again next time.
+  base::File::Info info;
+  std::string contents;
+  if (!base::GetFileInfo(path, &info)) {
+    entry->hash = kMissing;
+    entry->last_modified = 0;
+    return;
+  }
+  entry->last_modified = info.last_modified;
+  if (info.is_directory) {
+    contents = ListDirectory(path);
+  } else if (!base::ReadFileToString(path, &contents)) {
+    entry->hash = kUnreadable;
+    return;
+  }
+  std::string hash = base::SHA1HashString(contents);
+  entry->hash = base::HexEncode(hash.data(), hash.size());
+  if (info.is_directory)
+    entry->hash.insert(0, kDirectoryPrefix);
+}
+
+// static
+std::string GenInputsManifest::GetGeneratorKey() {
+  base::FilePath exe_path = GetExePath();
+  base::File::Info info;
+  if (!base::GetFileInfo(exe_path, &info))
+    return FilePathToUTF8(exe_path);
+  return base::StringPrintf("%" PRId64 " %" PRIu64 " ",
+                            static_cast<int64_t>(info.size),
+                            static_cast<uint64_t>(info.last_modified)) +
+         FilePathToUTF8(exe_path);
+}
@@ -0,0 +1,92 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_GEN_INPUTS_MANIFEST_H_
+#define TOOLS_GN_GEN_INPUTS_MANIFEST_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "util/ticks.h"
+
+// Records the contents of the files that "gn gen" read, the ones listed in
+// build.ninja.d, so that a regeneration can tell whether any of them really
+// changed.
+//
+// Ninja re-runs "gn gen" when any of those files is newer than
+// build.ninja.stamp, which also happens when a file is touched or rewritten
+// with the same contents, e.g. when switching branches back and forth. If
+// all recorded inputs still have the same contents, and GN itself didn't
+// change, the previous output is still valid and the regeneration only needs
+// to touch build.ninja.stamp.
+//
+// Only files whose modification time changed since they were recorded are
+// read again, so the check costs a stat() per input.
+//
+// The manifest is deleted when a gen starts and saved once it succeeded, so
+// it never describes a build directory left behind by a failed run.
+class GenInputsManifest {
+ public:
+  // Name of the manifest file in the build directory.
+  static const char kFileName[];
+
+  explicit GenInputsManifest(const base::FilePath& build_dir);
+  ~GenInputsManifest();
+
+  // Reads the manifest saved by a previous run. Returns false if there is
+  // none, if it is malformed, or if it was written by a different GN binary.
+  bool Load();
+
+  // Writes the manifest. Returns false on failure.
+  bool Save() const;
+
+  // Replaces the entries with the current contents of |inputs|, which must
+  // be absolute. Paths relative to the build directory would depend on how
+  // ".." is resolved through symlinks, and a moved checkout must not match.
+  void RecordInputs(const std::vector<base::FilePath>& inputs);
+
+  // Returns true if all recorded inputs still have the recorded contents.
+  // Entries of files that were only touched are updated with their new
+  // modification time, so they aren't read again next time.
+  bool InputsUnchanged();
+
+  // Adds the recorded inputs that don't have the recorded contents anymore
+  // to |changed|. Entries are updated as by InputsUnchanged().
+  void GetChangedInputs(std::set<base::FilePath>* changed);
+
+  // Deletes the manifest in |build_dir|, if any.
+  static void Delete(const base::FilePath& build_dir);
+
+  // Identifies the GN binary, whose changes can change the output too.
+  static std::string GetGeneratorKey();
+
+ private:
+  struct Entry {
+    base::FilePath path;
+
+    // Hex SHA1 of the contents, or of the entry names prefixed with "dir:"
+    // for a directory, "missing" if the file didn't exist, or "unreadable".
+    std::string hash;
+
+    // Zero if the file didn't exist.
+    Ticks last_modified = 0;
+  };
+
+  // Returns true if the file of |entry| doesn't have the recorded contents.
+  // Updates the modification time of files that were only touched.
+  bool EntryChanged(Entry* entry) const;
+
+  // Fills the hash and modification time of |entry| from its file.
+  void HashFile(Entry* entry) const;
+
+  base::FilePath build_dir_;
+  std::vector<Entry> entries_;
+
+  GenInputsManifest(const GenInputsManifest&) = delete;
+  GenInputsManifest& operator=(const GenInputsManifest&) = delete;
+};
+
+#endif  // TOOLS_GN_GEN_INPUTS_MANIFEST_H_
@@ -0,0 +1,143 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/gen_inputs_manifest.h"
+
+#include <set>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteFile(const base::FilePath& path, const std::string& contents) {
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(),
+                            static_cast<int>(contents.size())));
+}
+
+// Returns whether the inputs recorded in |build_dir| are unchanged, as seen
+// by a new run.
+bool InputsUnchanged(const base::FilePath& build_dir) {
+  GenInputsManifest manifest(build_dir);
+  return manifest.Load() && manifest.InputsUnchanged();
+}
+
+}  // namespace
+
+TEST(GenInputsManifest, InputsUnchanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_dir = temp_dir.GetPath().AppendASCII("out");
+  ASSERT_TRUE(base::CreateDirectory(build_dir));
+  base::FilePath build_gn = temp_dir.GetPath().AppendASCII("BUILD.gn");
+  base::FilePath args_gn = build_dir.AppendASCII("args.gn");
+  WriteFile(build_gn, "group(\"a\") {}\n");
+  WriteFile(args_gn, "is_debug = true\n");
+
+  // No manifest yet.
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+
+  // Missing files are recorded too.
+  {
+    GenInputsManifest manifest(build_dir);
+    manifest.RecordInputs({build_gn, args_gn,
+                           temp_dir.GetPath().AppendASCII("missing.gni")});
+    ASSERT_TRUE(manifest.Save());
+  }
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+
+  // Rewriting a file with the same contents doesn't count.
+  WriteFile(build_gn, "group(\"a\") {}\n");
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+
+  // Different contents do.
+  WriteFile(args_gn, "is_debug = false\n");
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+  WriteFile(args_gn, "is_debug = true\n");
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+
+  // So does a file that appears or disappears.
+  WriteFile(temp_dir.GetPath().AppendASCII("missing.gni"), "");
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+  base::DeleteFile(temp_dir.GetPath().AppendASCII("missing.gni"), false);
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+  base::DeleteFile(build_gn, false);
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+
+  GenInputsManifest::Delete(build_dir);
+  EXPECT_FALSE(base::PathExists(
+      build_dir.AppendASCII(GenInputsManifest::kFileName)));
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+}
+
+// Directories (e.g. read by glob_files) change with their entry names, not
+// with the contents or modification time of their files.
+TEST(GenInputsManifest, Directory) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_dir = temp_dir.GetPath().AppendASCII("out");
+  ASSERT_TRUE(base::CreateDirectory(build_dir));
+  base::FilePath dir = temp_dir.GetPath().AppendASCII("dir");
+  ASSERT_TRUE(base::CreateDirectory(dir));
+  WriteFile(dir.AppendASCII("a.cc"), "a");
+  {
+    GenInputsManifest manifest(build_dir);
+    manifest.RecordInputs({dir});
+    ASSERT_TRUE(manifest.Save());
+  }
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+
+  // Neither writing a file nor adding and removing one counts.
+  WriteFile(dir.AppendASCII("a.cc"), "b");
+  WriteFile(dir.AppendASCII("b.cc"), "b");
+  base::DeleteFile(dir.AppendASCII("b.cc"), false);
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+
+  // A new entry does, and so does a file replaced by a directory.
+  WriteFile(dir.AppendASCII("b.cc"), "b");
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+  base::DeleteFile(dir.AppendASCII("b.cc"), false);
+  EXPECT_TRUE(InputsUnchanged(build_dir));
+  base::DeleteFile(dir.AppendASCII("a.cc"), false);
+  ASSERT_TRUE(base::CreateDirectory(dir.AppendASCII("a.cc")));
+  EXPECT_FALSE(InputsUnchanged(build_dir));
+}
+
+TEST(GenInputsManifest, Malformed) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  WriteFile(temp_dir.GetPath().AppendASCII(GenInputsManifest::kFileName),
+            "GN gen inputs manifest v2\ngn not-this-binary\n");
+  EXPECT_FALSE(InputsUnchanged(temp_dir.GetPath()));
+
+  WriteFile(temp_dir.GetPath().AppendASCII(GenInputsManifest::kFileName),
+            "garbage\n");
+  EXPECT_FALSE(InputsUnchanged(temp_dir.GetPath()));
+}
+
+TEST(GenInputsManifest, GetChangedInputs) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath a = temp_dir.GetPath().AppendASCII("a.gn");
+  base::FilePath b = temp_dir.GetPath().AppendASCII("b.gn");
+  WriteFile(a, "a = 1\n");
+  WriteFile(b, "b = 1\n");
+  {
+    GenInputsManifest manifest(temp_dir.GetPath());
+    manifest.RecordInputs({a, b});
+    ASSERT_TRUE(manifest.Save());
+  }
+
+  WriteFile(a, "a = 1\n");
+  WriteFile(b, "b = 2\n");
+  GenInputsManifest manifest(temp_dir.GetPath());
+  ASSERT_TRUE(manifest.Load());
+  std::set<base::FilePath> changed;
+  manifest.GetChangedInputs(&changed);
+  EXPECT_EQ(std::set<base::FilePath>({b}), changed);
+}
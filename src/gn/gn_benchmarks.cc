@@ -0,0 +1,317 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Benchmarks for GN. Usage:
+//
+//   gn_benchmarks [gen] [options]
+//     Generates a synthetic OpenHarmony-like project and times "gn gen" on
+//     it. Every run is a new process, so that caches and leaked state from
+//     one run don't help the next, after one untimed run to warm up the
+//     disk cache.
+//
+//     Phases are timed from the traces GN records, adding up the time each
+//     thread spent in them:
+//       setup             Reading .gn, args and the OHOS component list.
+//       parse             Loading and parsing build files.
+//       evaluate          Running build files, imports and templates.
+//       resolve           Defining and resolving targets.
+//       ninja_write       Generating and writing the ninja files.
+//       ohos_post_passes  The inner API info, precise build and graph passes.
+//     "wall" is the elapsed time of the whole gen. With more threads than
+//     cores the phases include time threads waited for a core, so use
+//     --threads=1 to see where the work goes and the default to see what
+//     parallelism does to "wall".
+//
+//     --components=200 --fanout=3 --template-depth=3 --toolchains=1
+//     --external-deps=2 --sources=10 --seed=1 --no-ohos
+//         Shape of the project, see synthetic_project.h.
+//     --runs=5
+//         Number of timed runs.
+//     --threads=N
+//         Passed to gn.
+//     --project-dir=<dir>
+//         Write the project there and keep it instead of using a temporary
+//         directory, e.g. to profile "gn gen out" in it.
+//
+//   gn_benchmarks worker_pool [max_threads] [tasks]
+//     Times WorkerPool for increasing thread counts.
+//
+//   gn_benchmarks escape [iterations]
+//     Times escaping strings with every escape scanner the CPU supports, after
+//     checking that they all produce the same output.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversions.h"
+#include "gn/commands.h"
+#include "gn/err.h"
+#include "gn/escape_benchmark.h"
+#include "gn/exec_process.h"
+#include "gn/filesystem_utils.h"
+#include "gn/switches.h"
+#include "gn/synthetic_project.h"
+#include "gn/trace.h"
+#include "util/build_config.h"
+#include "util/exe_path.h"
+#include "util/msg_loop.h"
+#include "util/ticks.h"
+#include "util/worker_pool_benchmark.h"
+
+namespace {
+
+// Runs a single gen in the current directory and prints its phase times.
+const char kGenRunCommand[] = "gen_run";
+
+// Prefix of the lines with phase times. The OHOS passes print to stdout too.
+const char kPhasePrefix[] = "gn_benchmarks_phase ";
+
+const char* kPhases[] = {"setup",    "parse",       "evaluate",
+                         "resolve",  "ninja_write", "ohos_post_passes",
+                         "wall"};
+
+const char* PhaseForTraceType(TraceItem::Type type) {
+  switch (type) {
+    case TraceItem::TRACE_SETUP:
+      return "setup";
+    case TraceItem::TRACE_FILE_LOAD:
+    case TraceItem::TRACE_FILE_PARSE:
+      return "parse";
+    case TraceItem::TRACE_FILE_EXECUTE:
+    case TraceItem::TRACE_FILE_EXECUTE_TEMPLATE:
+    case TraceItem::TRACE_IMPORT_LOAD:
+    case TraceItem::TRACE_IMPORT_BLOCK:
+    case TraceItem::TRACE_SCRIPT_EXECUTE:
+      return "evaluate";
+    case TraceItem::TRACE_DEFINE_TARGET:
+    case TraceItem::TRACE_ON_RESOLVED:
+    case TraceItem::TRACE_CHECK_HEADER:
+    case TraceItem::TRACE_CHECK_HEADERS:
+      return "resolve";
+    case TraceItem::TRACE_FILE_WRITE:
+    case TraceItem::TRACE_FILE_WRITE_GENERATED:
+    case TraceItem::TRACE_FILE_WRITE_NINJA:
+    case TraceItem::TRACE_WALK_METADATA:
+      return "ninja_write";
+    case TraceItem::TRACE_OHOS_POST_PASS:
+      return "ohos_post_passes";
+  }
+  return "";
+}
+
+int RunGenOnce(const base::CommandLine& cmdline) {
+  if (!commands::CommandSwitches::Init(cmdline))
+    return 1;
+  EnableTracing();
+
+  MsgLoop msg_loop;
+  ElapsedTimer timer;
+  if (commands::RunGen({kSyntheticProjectBuildDir}) != 0)
+    return 1;
+  double wall = timer.Elapsed().InMillisecondsF();
+
+  std::map<std::string, double> phases;
+  for (const auto& [type, delta] : GetTraceSelfTimes())
+    phases[PhaseForTraceType(type)] += delta.InMillisecondsF();
+  phases["wall"] = wall;
+  for (const char* phase : kPhases)
+    printf("%s%s %.3f\n", kPhasePrefix, phase, phases[phase]);
+  return 0;
+}
+
+bool GetIntSwitch(const base::CommandLine& cmdline,
+                  const char* name,
+                  int* value) {
+  if (!cmdline.HasSwitch(name))
+    return true;
+  if (base::StringToInt(cmdline.GetSwitchValueString(name), value) &&
+      *value >= 0)
+    return true;
+  fprintf(stderr, "Invalid value for --%s.\n", name);
+  return false;
+}
+
+// Runs gen in a new process and adds its phase times to |times|.
+bool TimeGen(const base::CommandLine& cmdline,
+             const base::FilePath& root,
+             std::map<std::string, std::vector<double>>* times) {
+  base::CommandLine child(GetExePath());
+  child.AppendArg(kGenRunCommand);
+  child.AppendSwitch(switches::kQuiet);
+  if (cmdline.HasSwitch(switches::kThreads)) {
+    child.AppendSwitch(switches::kThreads,
+                       cmdline.GetSwitchValueString(switches::kThreads));
+  }
+
+  std::string std_out;
+  std::string std_err;
+  int exit_code = 0;
+  if (!internal::ExecProcess(child, root, &std_out, &std_err, &exit_code) ||
+      exit_code != 0) {
+    fprintf(stderr, "gn gen failed:\n%s%s", std_out.c_str(), std_err.c_str());
+    return false;
+  }
+
+  for (const std::string& line : base::SplitString(
+           std_out, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (!base::starts_with(line, kPhasePrefix))
+      continue;
+    std::vector<std::string> fields = base::SplitString(
+        line.substr(strlen(kPhasePrefix)), " ", base::TRIM_WHITESPACE,
+        base::SPLIT_WANT_NONEMPTY);
+    if (fields.size() == 2)
+      (*times)[fields[0]].push_back(strtod(fields[1].c_str(), nullptr));
+  }
+  return true;
+}
+
+int RunGenBenchmark(const base::CommandLine& cmdline) {
+  SyntheticProjectOptions options;
+  int seed = static_cast<int>(options.seed);
+  int runs = 5;
+  if (!GetIntSwitch(cmdline, "components", &options.components) ||
+      !GetIntSwitch(cmdline, "fanout", &options.fanout) ||
+      !GetIntSwitch(cmdline, "template-depth", &options.template_depth) ||
+      !GetIntSwitch(cmdline, "toolchains", &options.toolchains) ||
+      !GetIntSwitch(cmdline, "external-deps", &options.external_deps) ||
+      !GetIntSwitch(cmdline, "sources", &options.sources) ||
+      !GetIntSwitch(cmdline, "seed", &seed) ||
+      !GetIntSwitch(cmdline, "runs", &runs))
+    return 1;
+  options.seed = seed;
+  options.ohos = !cmdline.HasSwitch("no-ohos");
+  if (options.toolchains < 1 || runs < 1) {
+    fprintf(stderr, "--toolchains and --runs must be at least 1.\n");
+    return 1;
+  }
+
+  base::ScopedTempDir temp_dir;
+  base::FilePath root = cmdline.GetSwitchValuePath("project-dir");
+  if (root.empty()) {
+    if (!temp_dir.CreateUniqueTempDir()) {
+      fprintf(stderr, "Could not create a temporary directory.\n");
+      return 1;
+    }
+    root = temp_dir.GetPath();
+  } else if (!base::CreateDirectory(root)) {
+    fprintf(stderr, "Could not create %s.\n", FilePathToUTF8(root).c_str());
+    return 1;
+  }
+  root = base::MakeAbsoluteFilePath(root);
+
+  Err err;
+  if (!WriteSyntheticProject(options, root, &err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+
+  printf(
+      "%d components, fanout %d, template depth %d, %d toolchains, "
+      "%d external_deps, %d sources, seed %d, OHOS %s\n",
+      options.components, options.fanout, options.template_depth,
+      options.toolchains, options.external_deps, options.sources, seed,
+      options.ohos ? "on" : "off");
+  printf("%d targets, %d runs\n\n", GetSyntheticProjectTargetCount(options),
+         runs);
+
+  std::map<std::string, std::vector<double>> warm_up;
+  if (!TimeGen(cmdline, root, &warm_up))
+    return 1;
+  std::map<std::string, std::vector<double>> times;
+  for (int i = 0; i < runs; i++) {
+    if (!TimeGen(cmdline, root, &times))
+      return 1;
+  }
+
+  printf("%-18s %10s %10s %10s\n", "phase", "min ms", "median ms", "max ms");
+  for (const char* phase : kPhases) {
+    std::vector<double>& values = times[phase];
+    if (values.empty() ||
+        (!options.ohos && std::string(phase) == "ohos_post_passes"))
+      continue;
+    std::sort(values.begin(), values.end());
+    printf("%-18s %10.1f %10.1f %10.1f\n", phase, values.front(),
+           values[values.size() / 2], values.back());
+  }
+  return 0;
+}
+
+int RunWorkerPool(const std::vector<std::string>& args) {
+  int max_threads = 128;
+  int tasks = 1000000;
+  if ((args.size() > 0 && !base::StringToInt(args[0], &max_threads)) ||
+      (args.size() > 1 && !base::StringToInt(args[1], &tasks)) ||
+      max_threads < 1 || tasks < 1) {
+    fprintf(stderr, "Usage: gn_benchmarks worker_pool [max_threads] [tasks]\n");
+    return 1;
+  }
+  RunWorkerPoolBenchmark(static_cast<size_t>(max_threads), tasks);
+  return 0;
+}
+
+int RunEscape(const std::vector<std::string>& args) {
+  int iterations = 2000;
+  if ((args.size() > 0 && !base::StringToInt(args[0], &iterations)) ||
+      iterations < 1) {
+    fprintf(stderr, "Usage: gn_benchmarks escape [iterations]\n");
+    return 1;
+  }
+  return RunEscapeBenchmark(iterations) ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+#if defined(OS_WIN)
+  base::CommandLine::set_slash_is_not_a_switch();
+#endif
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& cmdline = *base::CommandLine::ForCurrentProcess();
+
+  std::vector<std::string> args;
+  for (const auto& arg : cmdline.GetArgs()) {
+#if defined(OS_WIN)
+    args.push_back(base::UTF16ToUTF8(arg));
+#else
+    args.push_back(arg);
+#endif
+  }
+  std::string benchmark = args.empty() ? "gen" : args[0];
+  if (!args.empty())
+    args.erase(args.begin());
+
+  int result;
+  if (benchmark == "gen") {
+    result = RunGenBenchmark(cmdline);
+  } else if (benchmark == kGenRunCommand) {
+    result = RunGenOnce(cmdline);
+  } else if (benchmark == "worker_pool") {
+    result = RunWorkerPool(args);
+  } else if (benchmark == "escape") {
+    result = RunEscape(args);
+  } else {
+    fprintf(stderr,
+            "Unknown benchmark \"%s\". Try \"gen\", \"worker_pool\" or "
+            "\"escape\".\n",
+            benchmark.c_str());
+    result = 1;
+  }
+
+  // Like gn itself, skip freeing everything on the way out.
+  fflush(stdout);
+  exit(result);
+}
@@ -6,10 +6,13 @@
 #include <string>
 
 #include "base/command_line.h"
+#include "base/files/file_path.h"
 #include "base/strings/utf_string_conversions.h"
 #include "gn/commands.h"
 #include "gn/err.h"
+#include "gn/filesystem_utils.h"
 #include "gn/location.h"
+#include "gn/memory_stats.h"
 #include "gn/standard_out.h"
 #include "gn/switches.h"
 #include "util/build_config.h"
@@ -74,6 +77,16 @@ int main(int argc, char** argv) {
   if (found_command != command_map.end()) {
     MsgLoop msg_loop;
     retval = found_command->second.runner(args);
+
+    if (MemoryStatsEnabled()) {
+      OutputString(SummarizeMemoryStats());
+      base::FilePath json_file = cmdline.GetSwitchValuePath(switches::kMemstats);
+      if (!json_file.empty() && !SaveMemoryStats(json_file)) {
+        Err(Location(), "Could not write the --memstats file.",
+            "Unable to write \"" + FilePathToUTF8(json_file) + "\".")
+            .PrintNonfatalToStdout();
+      }
+    }
   } else {
     Err(Location(), "Command \"" + command + "\" unknown.").PrintToStdout();
     OutputString(
@@ -253,6 +253,12 @@ class HashTableBase {
   // Return the number of keys in the set.
   size_t size() const { return count_; }
 
+  // Return the number of bytes used by the buckets array if it is allocated
+  // from the heap, or 0 otherwise.
+  size_t heap_bytes() const {
+    return buckets_ != buckets0_ ? size_ * sizeof(Node) : 0;
+  }
+
  protected:
   // The following should only be called by derived classes that
   // extend this template class, and are not available to their
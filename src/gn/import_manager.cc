@@ -6,7 +6,11 @@
 
 #include <memory>
 
+#include "gn/build_settings.h"
 #include "gn/err.h"
+#include "gn/execution_record.h"
+#include "gn/incremental_gen_state.h"
+#include "gn/memory_stats.h"
 #include "gn/parse_tree.h"
 #include "gn/scheduler.h"
 #include "gn/scope_per_file_provider.h"
@@ -37,8 +41,19 @@ std::unique_ptr<Scope> UncachedImport(const Settings* settings,
   // people mean when they use these.
   ScopePerFileProvider per_file_provider(scope.get(), false);
 
+  // What the import does is recorded apart from the file importing it, since
+  // the files importing it later only get the resulting scope.
+  IncrementalGenState* incremental =
+      settings->build_settings()->incremental_gen_state();
+  std::unique_ptr<ExecutionRecord> record;
+  if (incremental)
+    record = std::make_unique<ExecutionRecord>();
+
   scope->SetProcessingImport();
-  node->Execute(scope.get(), err);
+  {
+    ExecutionRecord::Recording recording(record.get());
+    node->Execute(scope.get(), err);
+  }
   if (err->has_error()) {
     // If there was an error, append the caller location so the error message
     // displays a why the file was imported (esp. useful for failed asserts).
@@ -47,6 +62,10 @@ std::unique_ptr<Scope> UncachedImport(const Settings* settings,
   }
   scope->ClearProcessingImport();
 
+  if (incremental) {
+    incremental->AddImportExecution(file, settings->toolchain_label(),
+                                    std::move(record));
+  }
   return scope;
 }
 
@@ -160,3 +179,16 @@ std::vector<SourceFile> ImportManager::GetImportedFiles() const {
                  [](const ImportMap::value_type& val) { return val.first; });
   return imported_files;
 }
+
+size_t ImportManager::EstimateMemoryUsage(
+    std::unordered_set<const void*>* seen) {
+  std::lock_guard<std::mutex> lock(imports_lock_);
+  size_t result = 0;
+  for (const auto& [file, info] : imports_) {
+    result += sizeof(ImportInfo);
+    std::lock_guard<std::mutex> info_lock(info->load_lock);
+    if (info->scope && seen->insert(info->scope.get()).second)
+      result += info->scope->EstimateMemoryUsage(seen);
+  }
+  return result;
+}
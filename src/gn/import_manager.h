@@ -33,6 +33,10 @@ class ImportManager {
 
   std::vector<SourceFile> GetImportedFiles() const;
 
+  // Returns the approximate number of bytes held by the cached import scopes.
+  // Shared storage already in |seen| isn't counted again.
+  size_t EstimateMemoryUsage(std::unordered_set<const void*>* seen);
+
  private:
   struct ImportInfo;
 
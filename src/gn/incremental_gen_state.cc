@@ -0,0 +1,606 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/incremental_gen_state.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "gn/build_settings.h"
+#include "gn/config.h"
+#include "gn/execution_record.h"
+#include "gn/filesystem_utils.h"
+#include "gn/item.h"
+#include "gn/ninja_file_manifest.h"
+#include "gn/ninja_utils.h"
+#include "gn/pool.h"
+#include "gn/scheduler.h"
+#include "gn/settings.h"
+#include "gn/target.h"
+#include "gn/tool.h"
+#include "gn/toolchain.h"
+#include "util/atomic_write.h"
+
+namespace {
+
+// First line of the state file. Bump the version when changing the format or
+// what makes a target dirty.
+const char kHeader[] = "GN incremental gen state v3\n";
+
+std::string HashKey(const std::string& key) {
+  std::string hash = base::SHA1HashString(key);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+// An item of the previous run.
+struct PreviousItem {
+  // Indices of the files its definition came from.
+  std::vector<size_t> files;
+
+  // Indices of the items it refers to.
+  std::vector<size_t> refs;
+};
+
+// Adds the items whose changes change the rules of |item| to |refs|. The
+// validations of a target only have their output files written, which only
+// depend on their own definition and toolchain, so their files are added to
+// |files| instead: they can form cycles with deps.
+void GetReferences(const Item* item,
+                   std::vector<const Item*>* refs,
+                   SourceFileSet* files) {
+  auto add = [refs](const auto& pairs) {
+    for (const auto& pair : pairs) {
+      if (pair.ptr)
+        refs->push_back(pair.ptr);
+    }
+  };
+
+  if (const Target* target = item->AsTarget()) {
+    add(target->public_deps());
+    add(target->private_deps());
+    add(target->data_deps());
+    add(target->configs());
+    add(target->all_dependent_configs());
+    add(target->public_configs());
+    add(target->own_configs());
+    add(target->own_all_dependent_configs());
+    add(target->own_public_configs());
+    if (target->pool().ptr)
+      refs->push_back(target->pool().ptr);
+    refs->push_back(target->toolchain());
+    for (const auto& pair : target->validations()) {
+      files->insert(pair.ptr->build_dependency_files().begin(),
+                    pair.ptr->build_dependency_files().end());
+      refs->push_back(pair.ptr->toolchain());
+    }
+  } else if (const Config* config = item->AsConfig()) {
+    add(config->configs());
+  } else if (const Toolchain* toolchain = item->AsToolchain()) {
+    add(toolchain->deps());
+    for (const auto& tool : toolchain->tools()) {
+      if (tool.second->pool().ptr)
+        refs->push_back(tool.second->pool().ptr);
+    }
+  }
+}
+
+// Appends the comma-separated |indices|, or "-" if there are none.
+void AppendIndices(const std::vector<size_t>& indices, std::string* out) {
+  if (indices.empty()) {
+    out->push_back('-');
+    return;
+  }
+  for (size_t i = 0; i < indices.size(); i++) {
+    if (i > 0)
+      out->push_back(',');
+    out->append(base::NumberToString(indices[i]));
+  }
+}
+
+// Parses what AppendIndices() wrote. Returns false if an index isn't below
+// |limit|.
+bool ParseIndices(std::string_view text,
+                  size_t limit,
+                  std::vector<size_t>* indices) {
+  if (text == "-")
+    return true;
+  for (std::string_view piece : base::SplitStringPiece(
+           text, ",", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL)) {
+    size_t index = 0;
+    if (!base::StringToSizeT(piece, &index) || index >= limit)
+      return false;
+    indices->push_back(index);
+  }
+  return true;
+}
+
+// Splits "<first> <rest>" lines, where |rest| may contain spaces.
+bool SplitFirst(std::string_view line,
+                std::string_view* first,
+                std::string_view* rest) {
+  size_t space = line.find(' ');
+  if (space == std::string_view::npos)
+    return false;
+  *first = line.substr(0, space);
+  *rest = line.substr(space + 1);
+  return true;
+}
+
+// An execution of the previous run, see IncrementalGenState::Execution.
+struct PreviousExecution {
+  std::string toolchain;
+  std::string_view file;
+  std::vector<size_t> inputs;
+  bool defines_toolchain = false;
+  std::string_view record;
+};
+
+// Reads the "<size> <toolchain>" of an execution line and the execution that
+// follows it in |contents| at |pos|: its file on a line, then its record.
+bool ReadExecution(std::string_view line,
+                   const std::string& contents,
+                   size_t* pos,
+                   PreviousExecution* execution) {
+  std::string_view size_text, toolchain;
+  uint64_t size = 0;
+  if (!SplitFirst(line, &size_text, &toolchain) ||
+      !base::StringToUint64(size_text, &size) ||
+      size + 1 > contents.size() - *pos || contents[*pos + size] != '\n')
+    return false;
+  std::string_view text(&contents[*pos], size);
+  *pos += size + 1;
+
+  size_t file_end = text.find('\n');
+  if (file_end == std::string_view::npos)
+    return false;
+  execution->toolchain.assign(toolchain);
+  execution->file = text.substr(0, file_end);
+  execution->record = text.substr(file_end + 1);
+  return true;
+}
+
+}  // namespace
+
+const char IncrementalGenState::kFileName[] = "incremental_gen.state";
+
+IncrementalGenState::IncrementalGenState(const BuildSettings* build_settings)
+    : build_settings_(build_settings) {}
+
+IncrementalGenState::~IncrementalGenState() = default;
+
+IncrementalGenState::Execution::Execution() = default;
+
+IncrementalGenState::Execution::~Execution() = default;
+
+bool IncrementalGenState::Load(const std::string& key,
+                               const std::set<base::FilePath>& changed_inputs) {
+  unchanged_rules_.clear();
+  unchanged_executions_.clear();
+  previous_imports_.clear();
+
+  std::string contents;
+  if (!base::ReadFileToString(
+          build_settings_->GetFullPath(build_settings_->build_dir())
+              .AppendASCII(kFileName),
+          &contents))
+    return false;
+  if (contents.compare(0, sizeof(kHeader) - 1, kHeader) != 0)
+    return false;
+
+  // The header is followed by a "key <hash>" line, then by:
+  //  - "F <path>" lines for the attributed files, numbered in order.
+  //  - "I <files> <refs> <label>" lines for the items, numbered in order,
+  //    with the indices of their files and of the items they refer to.
+  //  - "X <files> <size> <toolchain>" lines for the executions of build
+  //    files, with the indices of their inputs, each followed by the build
+  //    file on a line, its ExecutionRecord and a newline. The executions of
+  //    build files defining toolchains are "C" lines instead.
+  //  - "M <size> <toolchain>" lines for the executions of imports, followed
+  //    by the import and its record in the same way.
+  //  - "A <files> <path>" lines for the other inputs consulted by build
+  //    files, with the indices of those files.
+  //  - A "T <size> <label>" line followed by the rules and a newline for each
+  //    target.
+  // Items may refer to items that come after them, so their references are
+  // checked once all are read.
+  std::map<base::FilePath, size_t> file_indices;
+  std::vector<PreviousItem> items;
+  std::vector<std::string_view> item_refs;
+  std::unordered_map<std::string_view, size_t> item_indices;
+  std::map<base::FilePath, std::vector<size_t>> readers;
+  std::unordered_map<std::string, std::string> rules;
+  std::vector<PreviousExecution> executions;
+  std::vector<PreviousExecution> imports;
+  bool has_key = false;
+  size_t pos = sizeof(kHeader) - 1;
+  while (pos < contents.size()) {
+    size_t line_end = contents.find('\n', pos);
+    if (line_end == std::string::npos)
+      return false;
+    std::string_view line(&contents[pos], line_end - pos);
+    pos = line_end + 1;
+
+    std::string_view type, rest, indices;
+    if (!has_key) {
+      if (line != "key " + HashKey(key))
+        return false;
+      has_key = true;
+    } else if (!SplitFirst(line, &type, &rest) || type.size() != 1) {
+      return false;
+    } else if (type == "F") {
+      size_t index = file_indices.size();
+      file_indices.emplace(UTF8ToFilePath(rest), index);
+    } else if (type == "I") {
+      std::string_view files, label;
+      PreviousItem& item = items.emplace_back();
+      if (!SplitFirst(rest, &files, &rest) ||
+          !SplitFirst(rest, &indices, &label) ||
+          !ParseIndices(files, file_indices.size(), &item.files))
+        return false;
+      item_refs.push_back(indices);
+      item_indices[label] = items.size() - 1;
+    } else if (type == "X" || type == "C") {
+      PreviousExecution& execution = executions.emplace_back();
+      execution.defines_toolchain = type == "C";
+      if (!SplitFirst(rest, &indices, &rest) ||
+          !ParseIndices(indices, file_indices.size(), &execution.inputs) ||
+          !ReadExecution(rest, contents, &pos, &execution))
+        return false;
+    } else if (type == "M") {
+      if (!ReadExecution(rest, contents, &pos, &imports.emplace_back()))
+        return false;
+    } else if (type == "A") {
+      std::string_view path;
+      if (!SplitFirst(rest, &indices, &path) ||
+          !ParseIndices(indices, file_indices.size(),
+                        &readers[UTF8ToFilePath(path)]))
+        return false;
+    } else if (type == "T") {
+      std::string_view label;
+      uint64_t size = 0;
+      if (!SplitFirst(rest, &indices, &label) ||
+          !base::StringToUint64(indices, &size) ||
+          size + 1 > contents.size() - pos || contents[pos + size] != '\n')
+        return false;
+      rules[std::string(label)] = contents.substr(pos, size);
+      pos += size + 1;
+    } else {
+      return false;
+    }
+  }
+  if (!has_key)
+    return false;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (!ParseIndices(item_refs[i], items.size(), &items[i].refs))
+      return false;
+  }
+
+  // Changed inputs that weren't attributed make the state unusable.
+  std::vector<bool> changed_files(file_indices.size());
+  for (const base::FilePath& input : changed_inputs) {
+    auto found_file = file_indices.find(input);
+    auto found_readers = readers.find(input);
+    if (found_file != file_indices.end()) {
+      changed_files[found_file->second] = true;
+    } else if (found_readers != readers.end()) {
+      for (size_t reader : found_readers->second)
+        changed_files[reader] = true;
+    } else {
+      return false;
+    }
+  }
+
+  // Build files whose inputs didn't change can be restored, unless a build
+  // file defining a toolchain changed.
+  auto any_changed = [&changed_files](const std::vector<size_t>& files) {
+    return std::any_of(
+        files.begin(), files.end(),
+        [&changed_files](size_t file) { return changed_files[file]; });
+  };
+  auto make_execution = [](const PreviousExecution& previous,
+                           std::shared_ptr<Execution>* execution) {
+    *execution = std::make_shared<Execution>();
+    (*execution)->record = std::make_unique<ExecutionRecord>();
+    return (*execution)->record->Read(previous.record);
+  };
+  ExecutionMap unchanged_executions;
+  if (std::none_of(executions.begin(), executions.end(),
+                   [&any_changed](const PreviousExecution& execution) {
+                     return execution.defines_toolchain &&
+                            any_changed(execution.inputs);
+                   })) {
+    std::vector<base::FilePath> files(file_indices.size());
+    for (const auto& [path, index] : file_indices)
+      files[index] = path;
+    for (const PreviousExecution& previous : executions) {
+      if (previous.defines_toolchain || any_changed(previous.inputs))
+        continue;
+      std::shared_ptr<Execution> execution;
+      if (!make_execution(previous, &execution))
+        return false;
+      if (!execution->record->can_restore())
+        continue;
+      for (size_t input : previous.inputs) {
+        std::string path;
+        if (!MakeAbsolutePathRelativeIfPossible(
+                build_settings_->root_path_utf8(),
+                FilePathToUTF8(files[input]), &path))
+          return false;
+        execution->inputs.insert(SourceFile(std::move(path)));
+      }
+      unchanged_executions[{previous.toolchain,
+                            SourceFile(std::string(previous.file))}] =
+          std::move(execution);
+    }
+  }
+  ExecutionMap previous_imports;
+  for (const PreviousExecution& previous : imports) {
+    std::shared_ptr<Execution> execution;
+    if (!make_execution(previous, &execution))
+      return false;
+    previous_imports[{previous.toolchain,
+                      SourceFile(std::string(previous.file))}] =
+        std::move(execution);
+  }
+
+  // Items whose own files changed are dirty, and so is everything referring
+  // to a dirty item.
+  std::vector<std::vector<size_t>> referrers(items.size());
+  std::vector<bool> dirty(items.size());
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < items.size(); i++) {
+    for (size_t ref : items[i].refs)
+      referrers[ref].push_back(i);
+    if (std::any_of(items[i].files.begin(), items[i].files.end(),
+                    [&changed_files](size_t file) {
+                      return changed_files[file];
+                    })) {
+      dirty[i] = true;
+      pending.push_back(i);
+    }
+  }
+  while (!pending.empty()) {
+    size_t item = pending.back();
+    pending.pop_back();
+    for (size_t referrer : referrers[item]) {
+      if (!dirty[referrer]) {
+        dirty[referrer] = true;
+        pending.push_back(referrer);
+      }
+    }
+  }
+
+  for (auto& [label, target_rules] : rules) {
+    auto found = item_indices.find(label);
+    if (found != item_indices.end() && !dirty[found->second])
+      unchanged_rules_.emplace(label, std::move(target_rules));
+  }
+  unchanged_executions_ = std::move(unchanged_executions);
+  previous_imports_ = std::move(previous_imports);
+  return true;
+}
+
+bool IncrementalGenState::Save(
+    const std::string& key,
+    const std::vector<const Item*>& items,
+    const std::map<base::FilePath, SourceFileSet>& readers,
+    const NinjaWriter::PerToolchainRules& rules) const {
+  std::string contents = kHeader;
+  contents.append("key " + HashKey(key) + "\n");
+
+  std::unordered_map<const Item*, size_t> item_indices;
+  std::vector<SourceFileSet> item_files(items.size());
+  std::vector<std::vector<const Item*>> item_refs(items.size());
+  std::unordered_map<SourceFile, size_t> file_indices;
+  for (size_t i = 0; i < items.size(); i++) {
+    item_indices[items[i]] = i;
+    item_files[i] = items[i]->build_dependency_files();
+    GetReferences(items[i], &item_refs[i], &item_files[i]);
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  auto add_file = [this, &contents, &file_indices](const SourceFile& file) {
+    auto [found, inserted] = file_indices.emplace(file, file_indices.size());
+    if (inserted) {
+      contents.append("F ");
+      contents.append(FilePathToUTF8(build_settings_->GetFullPath(file)));
+      contents.push_back('\n');
+    }
+    return found->second;
+  };
+  for (const SourceFileSet& files : item_files) {
+    for (const SourceFile& file : files)
+      add_file(file);
+  }
+  for (const auto& [execution_key, execution] : executions_) {
+    for (const SourceFile& file : execution->inputs)
+      add_file(file);
+  }
+
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < items.size(); i++) {
+    contents.append("I ");
+    indices.clear();
+    for (const SourceFile& file : item_files[i])
+      indices.push_back(file_indices[file]);
+    AppendIndices(indices, &contents);
+    contents.push_back(' ');
+    indices.clear();
+    for (const Item* ref : item_refs[i]) {
+      auto found = item_indices.find(ref);
+      if (found != item_indices.end())
+        indices.push_back(found->second);
+    }
+    AppendIndices(indices, &contents);
+    contents.push_back(' ');
+    contents.append(items[i]->label().GetUserVisibleName(true));
+    contents.push_back('\n');
+  }
+
+  auto append_execution = [&contents](const ExecutionKey& execution_key,
+                                      const Execution& execution) {
+    std::string text = execution_key.second.value() + "\n";
+    execution.record->Write(&text);
+    contents.append(base::NumberToString(text.size()) + " " +
+                    execution_key.first + "\n");
+    contents.append(text);
+    contents.push_back('\n');
+  };
+  for (const auto& [execution_key, execution] : executions_) {
+    contents.append(execution->defines_toolchain ? "C " : "X ");
+    indices.clear();
+    for (const SourceFile& file : execution->inputs)
+      indices.push_back(file_indices[file]);
+    AppendIndices(indices, &contents);
+    contents.push_back(' ');
+    append_execution(execution_key, *execution);
+  }
+  for (const auto& [execution_key, execution] : imports_) {
+    contents.append("M ");
+    append_execution(execution_key, *execution);
+  }
+
+  // An input read by a build file that no item came from nor was recorded
+  // can change anything, so it's left unattributed.
+  for (const auto& [path, files] : readers) {
+    indices.clear();
+    for (const SourceFile& file : files) {
+      auto found = file_indices.find(file);
+      if (found == file_indices.end())
+        break;
+      indices.push_back(found->second);
+    }
+    if (indices.size() != files.size())
+      continue;
+    contents.append("A ");
+    AppendIndices(indices, &contents);
+    contents.push_back(' ');
+    contents.append(FilePathToUTF8(path));
+    contents.push_back('\n');
+  }
+
+  for (const auto& [toolchain, toolchain_rules] : rules) {
+    for (const NinjaWriter::TargetRulePair& pair : toolchain_rules) {
+      contents.append("T " + base::NumberToString(pair.second.size()) + " " +
+                      pair.first->label().GetUserVisibleName(true) + "\n");
+      contents.append(pair.second);
+      contents.push_back('\n');
+    }
+  }
+
+  return util::WriteFileAtomically(
+             build_settings_->GetFullPath(build_settings_->build_dir())
+                 .AppendASCII(kFileName),
+             contents.data(), static_cast<int>(contents.size())) ==
+         static_cast<int>(contents.size());
+}
+
+const std::string* IncrementalGenState::GetUnchangedRules(
+    const Target* target) {
+  if (unchanged_rules_.empty())
+    return nullptr;
+
+  // Generated files are written by the target writer itself, and may have
+  // been removed since.
+  if (target->output_type() == Target::GENERATED_FILE)
+    return nullptr;
+
+  auto found = unchanged_rules_.find(target->label().GetUserVisibleName(true));
+  if (found == unchanged_rules_.end())
+    return nullptr;
+
+  // The rules of binary targets load a separate file, which must still be
+  // the one written by the previous run.
+  if (target->IsBinary()) {
+    NinjaFileManifest* manifest = build_settings_->ninja_file_manifest();
+    base::FilePath ninja_file =
+        build_settings_->GetFullPath(GetNinjaFileForTarget(target));
+    if (!manifest || !manifest->KeepFileIfUnchanged(ninja_file))
+      return nullptr;
+  }
+
+  reused_count_++;
+  return &found->second;
+}
+
+bool IncrementalGenState::CanRestoreExecution(const SourceFile& file,
+                                              const Label& toolchain) const {
+  return unchanged_executions_.count(MakeExecutionKey(file, toolchain)) != 0;
+}
+
+bool IncrementalGenState::RestoreExecution(const Settings* settings,
+                                           const SourceFile& file,
+                                           Scope::ItemVector* items,
+                                           Err* err) {
+  ExecutionKey key = MakeExecutionKey(file, settings->toolchain_label());
+  auto found = unchanged_executions_.find(key);
+  DCHECK(found != unchanged_executions_.end());
+  const Execution& execution = *found->second;
+
+  // The imports executed in this run already did what they do again.
+  std::vector<const Execution*> imports;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    executions_[key] = found->second;
+    for (const SourceFile& input : execution.inputs) {
+      ExecutionKey import_key(key.first, input);
+      auto found_import = previous_imports_.find(import_key);
+      if (found_import != previous_imports_.end() &&
+          imports_.emplace(import_key, found_import->second).second)
+        imports.push_back(found_import->second.get());
+    }
+  }
+
+  for (const SourceFile& input : execution.inputs)
+    g_scheduler->AddGenDependency(build_settings_->GetFullPath(input));
+  for (const Execution* import : imports)
+    import->record->Replay(settings);
+  execution.record->Replay(settings);
+
+  restored_count_++;
+  return execution.record->RestoreItems(settings, items, err);
+}
+
+void IncrementalGenState::AddExecution(
+    const SourceFile& file,
+    const Label& toolchain,
+    SourceFileSet inputs,
+    bool defines_toolchain,
+    std::unique_ptr<ExecutionRecord> record) {
+  auto execution = std::make_shared<Execution>();
+  execution->inputs = std::move(inputs);
+  execution->defines_toolchain = defines_toolchain;
+  execution->record = std::move(record);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  executions_[MakeExecutionKey(file, toolchain)] = std::move(execution);
+}
+
+void IncrementalGenState::AddImportExecution(
+    const SourceFile& file,
+    const Label& toolchain,
+    std::unique_ptr<ExecutionRecord> record) {
+  auto execution = std::make_shared<Execution>();
+  execution->record = std::move(record);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  imports_[MakeExecutionKey(file, toolchain)] = std::move(execution);
+}
+
+// static
+IncrementalGenState::ExecutionKey IncrementalGenState::MakeExecutionKey(
+    const SourceFile& file,
+    const Label& toolchain) {
+  return ExecutionKey(toolchain.GetUserVisibleName(false), file);
+}
+
+// static
+void IncrementalGenState::Delete(const base::FilePath& build_dir) {
+  base::DeleteFile(build_dir.AppendASCII(kFileName), false);
+}
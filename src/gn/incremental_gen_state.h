@@ -0,0 +1,167 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_INCREMENTAL_GEN_STATE_H_
+#define TOOLS_GN_INCREMENTAL_GEN_STATE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gn/ninja_writer.h"
+#include "gn/scope.h"
+#include "gn/source_file.h"
+
+class BuildSettings;
+class Err;
+class ExecutionRecord;
+class Item;
+class Label;
+class Settings;
+class Target;
+
+// What "gn gen --incremental" keeps from one run to the next: what executing
+// each build file did (see ExecutionRecord), the ninja rules written for each
+// target, and the graph of all items, i.e. the files the definition of each
+// was attributed to (its build_dependency_files()) and the items it refers
+// to.
+//
+// A build file is only executed again if one of its inputs changed contents
+// since the previous run: the file itself, its imports, its read_file()
+// inputs and the build config. Otherwise the items it defined are restored
+// from their recorded values, and what else it did is replayed. The graph is
+// still resolved as a whole. The ninja rules of a target are only generated
+// again if the target is dirty: if one of its build dependency files
+// changed, or if anything it refers to is dirty (deps of any kind, configs,
+// its pool and its toolchain). The rules of the other targets are taken from
+// the previous run, and their separate .ninja files are left alone.
+//
+// Directories and files consulted by glob_files() or path_exists() are
+// attributed to the build files that consulted them, so a change to them
+// makes those files and the items depending on them dirty. A change to a file
+// defining a toolchain keeps every build file from being restored, since the
+// toolchain args may have changed. Any other changed input, like args.gn, the
+// dotfile or the inputs of an exec_script() call, can change anything, so
+// the previous state is then ignored. The same goes for a different GN
+// binary or command line. The results of exec_script() and getenv() are
+// assumed not to change otherwise, as they already are by the regeneration
+// of the build by ninja.
+//
+// The state is deleted when a gen starts and saved once it succeeded.
+class IncrementalGenState {
+ public:
+  // Name of the state file in the build directory.
+  static const char kFileName[];
+
+  explicit IncrementalGenState(const BuildSettings* build_settings);
+  ~IncrementalGenState();
+
+  // Loads the state saved by the previous run and keeps the executions of
+  // its build files that didn't change and the rules of its targets that
+  // aren't dirty. |key| identifies the invocation, and |changed_inputs| are
+  // the absolute paths of the inputs of the previous run whose contents
+  // changed since. Returns false, leaving the state empty, if the previous
+  // state is missing or can't be used.
+  bool Load(const std::string& key,
+            const std::set<base::FilePath>& changed_inputs);
+
+  // Writes the state for this run: the executions of build files and
+  // imports, the rules written for each target, and the graph of |items|,
+  // which are all the resolved items. |readers| are the build files that
+  // consulted each of the other inputs, see
+  // Scheduler::GetGenDependencyReaders(). Returns false on failure.
+  bool Save(const std::string& key,
+            const std::vector<const Item*>& items,
+            const std::map<base::FilePath, SourceFileSet>& readers,
+            const NinjaWriter::PerToolchainRules& rules) const;
+
+  // Returns the rules written for |target| by the previous run if they are
+  // still valid, or null. Can be called on any thread.
+  const std::string* GetUnchangedRules(const Target* target);
+
+  // Returns whether the execution of |file| in |toolchain| by the previous
+  // run can be restored instead of executing the file again.
+  bool CanRestoreExecution(const SourceFile& file,
+                           const Label& toolchain) const;
+
+  // Restores the execution of |file| in the toolchain of |settings| by the
+  // previous run, which CanRestoreExecution() allowed: replays what it and
+  // the imports it used did, and defines its items again in |items|. Returns
+  // false on error. Can be called on any thread.
+  bool RestoreExecution(const Settings* settings,
+                        const SourceFile& file,
+                        Scope::ItemVector* items,
+                        Err* err);
+
+  // Records the execution of |file|, a build file or an import, in this run.
+  // |inputs| are the build dependency files of a build file. Can be called on
+  // any thread.
+  void AddExecution(const SourceFile& file,
+                    const Label& toolchain,
+                    SourceFileSet inputs,
+                    bool defines_toolchain,
+                    std::unique_ptr<ExecutionRecord> record);
+  void AddImportExecution(const SourceFile& file,
+                          const Label& toolchain,
+                          std::unique_ptr<ExecutionRecord> record);
+
+  // The number of targets whose rules were reused.
+  int reused_count() const { return reused_count_; }
+
+  // The number of build file executions that were restored.
+  int restored_count() const { return restored_count_; }
+
+  // Deletes the state in |build_dir|, if any.
+  static void Delete(const base::FilePath& build_dir);
+
+ private:
+  // The execution of a build file or an import in a toolchain.
+  struct Execution {
+    Execution();
+    ~Execution();
+
+    SourceFileSet inputs;
+    bool defines_toolchain = false;
+    std::unique_ptr<ExecutionRecord> record;
+  };
+
+  // Executions by the toolchain label and the file.
+  using ExecutionKey = std::pair<std::string, SourceFile>;
+  using ExecutionMap = std::map<ExecutionKey, std::shared_ptr<const Execution>>;
+
+  static ExecutionKey MakeExecutionKey(const SourceFile& file,
+                                       const Label& toolchain);
+
+  const BuildSettings* build_settings_;
+
+  // The executions of the previous run that can be restored, and of all its
+  // imports. Not modified after Load().
+  ExecutionMap unchanged_executions_;
+  ExecutionMap previous_imports_;
+
+  // The executions of this run, including the restored ones.
+  mutable std::mutex lock_;
+  ExecutionMap executions_;
+  ExecutionMap imports_;
+
+  // Rules of the previous run of the targets that aren't dirty, by label
+  // including the toolchain. Not modified after Load(), so reading it needs
+  // no lock.
+  std::unordered_map<std::string, std::string> unchanged_rules_;
+
+  std::atomic<int> reused_count_{0};
+  std::atomic<int> restored_count_{0};
+
+  IncrementalGenState(const IncrementalGenState&) = delete;
+  IncrementalGenState& operator=(const IncrementalGenState&) = delete;
+};
+
+#endif  // TOOLS_GN_INCREMENTAL_GEN_STATE_H_
@@ -0,0 +1,179 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/incremental_gen_state.h"
+
+#include <map>
+#include <memory>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/execution_record.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+namespace {
+
+class IncrementalGenStateTest : public testing::Test {
+ public:
+  IncrementalGenStateTest()
+      : a_(setup_, "//a:a", Target::GROUP),
+        b_(setup_, "//b:b", Target::GROUP),
+        c_(setup_, "//c:c", Target::GROUP) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    setup_.build_settings()->SetRootPath(temp_dir_.GetPath());
+    ASSERT_TRUE(base::CreateDirectory(setup_.build_settings()->GetFullPath(
+        setup_.build_settings()->build_dir())));
+
+    // //a:a depends on //b:b, and each target is defined in its own file.
+    a_.build_dependency_files().insert(SourceFile("//a/BUILD.gn"));
+    b_.build_dependency_files().insert(SourceFile("//b/BUILD.gn"));
+    c_.build_dependency_files().insert(SourceFile("//c/BUILD.gn"));
+    a_.private_deps().push_back(LabelTargetPair(&b_));
+
+    Err err;
+    ASSERT_TRUE(b_.OnResolved(&err));
+    ASSERT_TRUE(a_.OnResolved(&err));
+    ASSERT_TRUE(c_.OnResolved(&err));
+  }
+
+  // Saves the state of a run that wrote "rules <name>" for each target, and
+  // whose build files consulted the other inputs in |readers|.
+  void SaveState(
+      const std::string& key,
+      const std::map<base::FilePath, SourceFileSet>& readers = {}) {
+    IncrementalGenState state(setup_.build_settings());
+    SaveState(&state, key, readers);
+  }
+  void SaveState(IncrementalGenState* state,
+                 const std::string& key,
+                 const std::map<base::FilePath, SourceFileSet>& readers = {}) {
+    NinjaWriter::PerToolchainRules rules;
+    rules[setup_.toolchain()] = {
+        {&a_, "rules a"}, {&b_, "rules b"}, {&c_, "rules c"}};
+    ASSERT_TRUE(state->Save(key, {&a_, &b_, &c_}, readers, rules));
+  }
+
+  base::FilePath FullPath(const char* path) const {
+    return temp_dir_.GetPath().AppendASCII(path);
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  TestWithScope setup_;
+  TestTarget a_;
+  TestTarget b_;
+  TestTarget c_;
+};
+
+}  // namespace
+
+TEST_F(IncrementalGenStateTest, ReusesUnchangedTargets) {
+  SaveState("key");
+
+  // Nothing changed.
+  {
+    IncrementalGenState state(setup_.build_settings());
+    ASSERT_TRUE(state.Load("key", {}));
+    ASSERT_TRUE(state.GetUnchangedRules(&a_));
+    EXPECT_EQ("rules a", *state.GetUnchangedRules(&a_));
+    ASSERT_TRUE(state.GetUnchangedRules(&c_));
+    EXPECT_EQ("rules c", *state.GetUnchangedRules(&c_));
+  }
+
+  // A changed file makes the targets it defines dirty, and their dependents.
+  {
+    IncrementalGenState state(setup_.build_settings());
+    ASSERT_TRUE(state.Load("key", {FullPath("b/BUILD.gn")}));
+    EXPECT_FALSE(state.GetUnchangedRules(&a_));
+    EXPECT_FALSE(state.GetUnchangedRules(&b_));
+    const std::string* rules = state.GetUnchangedRules(&c_);
+    ASSERT_TRUE(rules);
+    EXPECT_EQ("rules c", *rules);
+    EXPECT_EQ(1, state.reused_count());
+  }
+  {
+    IncrementalGenState state(setup_.build_settings());
+    ASSERT_TRUE(state.Load("key", {FullPath("a/BUILD.gn")}));
+    EXPECT_FALSE(state.GetUnchangedRules(&a_));
+    EXPECT_TRUE(state.GetUnchangedRules(&b_));
+  }
+}
+
+// Directories are dirty for the build files that globbed them.
+TEST_F(IncrementalGenStateTest, AttributedInputs) {
+  SaveState("key", {{FullPath("b/src"), {SourceFile("//b/BUILD.gn")}},
+                    {FullPath("tools"), {SourceFile("//tools/BUILD.gn")}}});
+
+  IncrementalGenState state(setup_.build_settings());
+  ASSERT_TRUE(state.Load("key", {FullPath("b/src")}));
+  EXPECT_FALSE(state.GetUnchangedRules(&a_));
+  EXPECT_FALSE(state.GetUnchangedRules(&b_));
+  EXPECT_TRUE(state.GetUnchangedRules(&c_));
+
+  // No item came from the build file that consulted this one.
+  EXPECT_FALSE(state.Load("key", {FullPath("tools")}));
+}
+
+TEST_F(IncrementalGenStateTest, UnusableState) {
+  SaveState("key");
+
+  // A changed file no item came from can change anything.
+  IncrementalGenState state(setup_.build_settings());
+  EXPECT_FALSE(state.Load("key", {FullPath("out/Debug/args.gn")}));
+  EXPECT_FALSE(state.GetUnchangedRules(&c_));
+
+  // So can a different invocation.
+  EXPECT_FALSE(state.Load("other key", {}));
+
+  IncrementalGenState::Delete(setup_.build_settings()->GetFullPath(
+      setup_.build_settings()->build_dir()));
+  EXPECT_FALSE(state.Load("key", {}));
+}
+
+// Build files whose inputs didn't change are restored, unless a build file
+// defining a toolchain changed.
+TEST_F(IncrementalGenStateTest, RestoresUnchangedExecutions) {
+  const Label& toolchain = setup_.toolchain()->label();
+  SourceFile a_file("//a/BUILD.gn");
+  SourceFile b_file("//b/BUILD.gn");
+  SourceFile c_file("//c/BUILD.gn");
+  SourceFile toolchain_file("//toolchain/BUILD.gn");
+  {
+    IncrementalGenState state(setup_.build_settings());
+    state.AddExecution(a_file, toolchain,
+                       {a_file, SourceFile("//build/a.gni")}, false,
+                       std::make_unique<ExecutionRecord>());
+    state.AddExecution(b_file, toolchain, {b_file}, false,
+                       std::make_unique<ExecutionRecord>());
+    state.AddExecution(toolchain_file, toolchain, {toolchain_file}, true,
+                       std::make_unique<ExecutionRecord>());
+
+    // This one can't be restored.
+    auto record = std::make_unique<ExecutionRecord>();
+    ASSERT_TRUE(record->Read("x -\n"));
+    state.AddExecution(c_file, toolchain, {c_file}, false, std::move(record));
+    SaveState(&state, "key");
+  }
+
+  IncrementalGenState state(setup_.build_settings());
+  ASSERT_TRUE(state.Load("key", {}));
+  EXPECT_TRUE(state.CanRestoreExecution(a_file, toolchain));
+  EXPECT_TRUE(state.CanRestoreExecution(b_file, toolchain));
+  EXPECT_FALSE(state.CanRestoreExecution(c_file, toolchain));
+  EXPECT_FALSE(state.CanRestoreExecution(toolchain_file, toolchain));
+  EXPECT_FALSE(
+      state.CanRestoreExecution(a_file, Label(SourceDir("//other/"), "tc")));
+
+  // A changed import keeps the build files using it from being restored.
+  ASSERT_TRUE(state.Load("key", {FullPath("build/a.gni")}));
+  EXPECT_FALSE(state.CanRestoreExecution(a_file, toolchain));
+  EXPECT_TRUE(state.CanRestoreExecution(b_file, toolchain));
+
+  ASSERT_TRUE(state.Load("key", {FullPath("toolchain/BUILD.gn")}));
+  EXPECT_FALSE(state.CanRestoreExecution(a_file, toolchain));
+  EXPECT_FALSE(state.CanRestoreExecution(b_file, toolchain));
+}
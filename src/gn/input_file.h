@@ -36,6 +36,7 @@ class InputFile {
   const std::string& friendly_name() const { return friendly_name_; }
   void set_friendly_name(const std::string& f) { friendly_name_ = f; }
 
+  bool contents_loaded() const { return contents_loaded_; }
   const std::string& contents() const {
     DCHECK(contents_loaded_);
     return contents_;
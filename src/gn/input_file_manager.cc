@@ -9,6 +9,7 @@
 
 #include "base/stl_util.h"
 #include "gn/filesystem_utils.h"
+#include "gn/memory_stats.h"
 #include "gn/parser.h"
 #include "gn/scheduler.h"
 #include "gn/scope_per_file_provider.h"
@@ -29,6 +30,53 @@ struct ScopedUnlock {
   std::unique_lock<std::mutex>& lock_;
 };
 
+// Returns the approximate number of bytes held by the parse tree rooted at
+// |node|.
+size_t EstimateParseTree(const ParseNode* node) {
+  if (!node)
+    return 0;
+  if (const AccessorNode* accessor = node->AsAccessor()) {
+    return sizeof(AccessorNode) + EstimateParseTree(accessor->subscript()) +
+           EstimateParseTree(accessor->member());
+  }
+  if (const BinaryOpNode* binary_op = node->AsBinaryOp()) {
+    return sizeof(BinaryOpNode) + EstimateParseTree(binary_op->left()) +
+           EstimateParseTree(binary_op->right());
+  }
+  if (const BlockNode* block = node->AsBlock()) {
+    size_t result = sizeof(BlockNode) + VectorHeapBytes(block->statements()) +
+                    EstimateParseTree(block->End());
+    for (const auto& statement : block->statements())
+      result += EstimateParseTree(statement.get());
+    return result;
+  }
+  if (const ConditionNode* condition = node->AsCondition()) {
+    return sizeof(ConditionNode) + EstimateParseTree(condition->condition()) +
+           EstimateParseTree(condition->if_true()) +
+           EstimateParseTree(condition->if_false());
+  }
+  if (const FunctionCallNode* call = node->AsFunctionCall()) {
+    return sizeof(FunctionCallNode) + EstimateParseTree(call->args()) +
+           EstimateParseTree(call->block());
+  }
+  if (const ListNode* list = node->AsList()) {
+    size_t result = sizeof(ListNode) + VectorHeapBytes(list->contents()) +
+                    EstimateParseTree(list->End());
+    for (const auto& item : list->contents())
+      result += EstimateParseTree(item.get());
+    return result;
+  }
+  if (const UnaryOpNode* unary_op = node->AsUnaryOp())
+    return sizeof(UnaryOpNode) + EstimateParseTree(unary_op->operand());
+  if (node->AsIdentifier())
+    return sizeof(IdentifierNode);
+  if (node->AsLiteral())
+    return sizeof(LiteralNode);
+  if (node->AsBlockComment())
+    return sizeof(BlockCommentNode);
+  return sizeof(EndNode);
+}
+
 void InvokeFileLoadCallback(const InputFileManager::FileLoadCallback& cb,
                             const ParseNode* node) {
   cb(node);
@@ -264,6 +312,22 @@ int InputFileManager::GetInputFileCount() const {
   return static_cast<int>(input_files_.size());
 }
 
+size_t InputFileManager::EstimateMemoryUsage() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  size_t result = 0;
+  auto add = [&result](const InputFileData& data) {
+    result += sizeof(InputFileData) + VectorHeapBytes(data.tokens) +
+              EstimateParseTree(data.parsed_root.get());
+    if (data.file.contents_loaded())
+      result += StringHeapBytes(data.file.contents());
+  };
+  for (const auto& [name, data] : input_files_)
+    add(*data);
+  for (const auto& data : dynamic_inputs_)
+    add(*data);
+  return result;
+}
+
 void InputFileManager::AddAllPhysicalInputFileNamesToVectorSetSorter(
     VectorSetSorter<base::FilePath>* sorter) const {
   std::lock_guard<std::mutex> lock(lock_);
@@ -91,6 +91,10 @@ class InputFileManager : public base::RefCountedThreadSafe<InputFileManager> {
   // Does not count dynamic input.
   int GetInputFileCount() const;
 
+  // Returns the approximate number of bytes held by the contents, tokens and
+  // parse trees of all files, including dynamic inputs.
+  size_t EstimateMemoryUsage() const;
+
   // Add all physical input files to a VectorSetSorter instance.
   // This allows fast merging and sorting with other file paths sets.
   //
@@ -4,6 +4,8 @@
 
 #include "gn/invoke_python.h"
 
+#include <vector>
+
 #include "base/command_line.h"
 #include "base/files/file_path.h"
 #include "base/strings/string_number_conversions.h"
@@ -11,6 +13,7 @@
 #include "gn/err.h"
 #include "gn/exec_process.h"
 #include "gn/filesystem_utils.h"
+#include "gn/python_worker.h"
 
 namespace internal {
 
@@ -38,8 +41,17 @@ bool InvokePython(const BuildSettings* build_settings,
   std::string stderr_output;
 
   int exit_code = 0;
-  if (!internal::ExecProcess(cmdline, startup_dir, &output, &stderr_output,
-                             &exit_code)) {
+  bool ran = false;
+  if (PythonWorkerPool* python_workers = build_settings->python_worker_pool()) {
+    std::vector<std::string> script_argv = {FilePathToUTF8(python_script_path),
+                                            FilePathToUTF8(output_path)};
+    if (!python_script_extra_args.empty())
+      script_argv.push_back(python_script_extra_args);
+    ran = python_workers->RunScript(script_argv, startup_dir, &output,
+                                    &stderr_output, &exit_code);
+  }
+  if (!ran && !internal::ExecProcess(cmdline, startup_dir, &output,
+                                     &stderr_output, &exit_code)) {
     *err =
         Err(Location(), "Could not execute python.",
             "I was trying to execute \"" + FilePathToUTF8(python_path) + "\".");
@@ -4,12 +4,18 @@
 
 #include "gn/loader.h"
 
+#include <algorithm>
 #include <memory>
+#include <tuple>
+#include <utility>
 
 #include "gn/build_settings.h"
 #include "gn/err.h"
+#include "gn/execution_record.h"
 #include "gn/filesystem_utils.h"
+#include "gn/incremental_gen_state.h"
 #include "gn/input_file_manager.h"
+#include "gn/item.h"
 #include "gn/parse_tree.h"
 #include "gn/scheduler.h"
 #include "gn/scope_per_file_provider.h"
@@ -47,6 +53,14 @@ struct LoaderImpl::LoadID {
   Label toolchain_name;
 };
 
+// A file load waiting for room (see set_max_loads_in_flight()).
+struct LoaderImpl::QueuedLoad {
+  const Settings* settings;
+  LocationRange origin;
+  int priority;
+  uint64_t sequence;
+};
+
 // Our tracking information for a toolchain.
 struct LoaderImpl::ToolchainRecord {
   // The default toolchain label can be empty for the first time the default
@@ -178,6 +192,27 @@ void LoaderImpl::ToolchainLoaded(const Toolchain* toolchain) {
   }
 }
 
+void LoaderImpl::AddLoadPriorityHint(const Label& label) {
+  LoadID load_id(BuildFileForLabel(label), label.GetToolchainLabel());
+  auto found = queued_loads_.find(load_id);
+  if (found == queued_loads_.end() && invocations_.count(load_id)) {
+    // Scheduled loads that aren't queued have started. Counting their
+    // waiters is pointless, and the entry would outlive DidLoadFile().
+    auto found_toolchain = toolchain_records_.find(load_id.toolchain_name);
+    if (found_toolchain != toolchain_records_.end() &&
+        found_toolchain->second->is_config_loaded)
+      return;
+  }
+
+  int priority = ++waiter_counts_[load_id];
+  if (found == queued_loads_.end())
+    return;
+  QueuedLoad& queued = found->second;
+  load_queue_.erase({-queued.priority, queued.sequence, load_id});
+  queued.priority = priority;
+  load_queue_.emplace(-queued.priority, queued.sequence, load_id);
+}
+
 Label LoaderImpl::GetDefaultToolchain() const {
   return default_toolchain_label_;
 }
@@ -205,8 +240,40 @@ SourceFile LoaderImpl::BuildFileForLabel(const Label& label) const {
 void LoaderImpl::ScheduleLoadFile(const Settings* settings,
                                   const LocationRange& origin,
                                   const SourceFile& file) {
-  Err err;
   pending_loads_++;
+  if (max_loads_in_flight_ == 0 || loads_in_flight_ < max_loads_in_flight_) {
+    StartLoadFile(settings, origin, file);
+    return;
+  }
+
+  LoadID load_id(file, settings->toolchain_label());
+  auto found_priority = waiter_counts_.find(load_id);
+  int priority =
+      found_priority == waiter_counts_.end() ? 0 : found_priority->second;
+  uint64_t sequence = next_load_sequence_++;
+  queued_loads_.emplace(load_id,
+                        QueuedLoad{settings, origin, priority, sequence});
+  load_queue_.emplace(-priority, sequence, load_id);
+}
+
+void LoaderImpl::StartLoadFile(const Settings* settings,
+                               const LocationRange& origin,
+                               const SourceFile& file) {
+  Err err;
+  loads_in_flight_++;
+
+  // An unchanged build file doesn't need to be loaded, see
+  // IncrementalGenState.
+  IncrementalGenState* incremental =
+      settings->build_settings()->incremental_gen_state();
+  if (incremental &&
+      incremental->CanRestoreExecution(file, settings->toolchain_label())) {
+    g_scheduler->ScheduleWork([this, settings, file, origin]() {
+      BackgroundRestoreFile(settings, file, origin);
+    });
+    return;
+  }
+
   if (!AsyncLoadFile(
           origin, settings->build_settings(), file,
           [this, settings, file, origin](const ParseNode* parse_node) {
@@ -214,10 +281,26 @@ void LoaderImpl::ScheduleLoadFile(const Settings* settings,
           },
           &err)) {
     g_scheduler->FailWithError(err);
+    loads_in_flight_--;
     DecrementPendingLoads();
   }
 }
 
+void LoaderImpl::StartQueuedLoads() {
+  while (!load_queue_.empty() && loads_in_flight_ < max_loads_in_flight_) {
+    auto next = load_queue_.begin();
+    LoadID load_id = std::get<LoadID>(*next);
+    load_queue_.erase(next);
+
+    auto found = queued_loads_.find(load_id);
+    DCHECK(found != queued_loads_.end());
+    QueuedLoad queued = std::move(found->second);
+    queued_loads_.erase(found);
+
+    StartLoadFile(queued.settings, queued.origin, load_id.file);
+  }
+}
+
 void LoaderImpl::ScheduleLoadBuildConfig(
     Settings* settings,
     const Scope::KeyValueMap& toolchain_overrides) {
@@ -240,7 +323,10 @@ void LoaderImpl::BackgroundLoadFile(const Settings* settings,
                                     const LocationRange& origin,
                                     const ParseNode* root) {
   if (!root) {
-    task_runner_->PostTask([this]() { DecrementPendingLoads(); });
+    task_runner_->PostTask(
+        [this, load_id = LoadID(file_name, settings->toolchain_label())]() {
+          DidLoadFile(load_id);
+        });
     return;
   }
 
@@ -262,8 +348,17 @@ void LoaderImpl::BackgroundLoadFile(const Settings* settings,
   ScopedTrace trace(TraceItem::TRACE_FILE_EXECUTE, file_name.value());
   trace.SetToolchain(settings->toolchain_label());
 
+  IncrementalGenState* incremental =
+      settings->build_settings()->incremental_gen_state();
+  std::unique_ptr<ExecutionRecord> record;
+  if (incremental)
+    record = std::make_unique<ExecutionRecord>();
+
   Err err;
-  root->Execute(&our_scope, &err);
+  {
+    ExecutionRecord::Recording recording(record.get());
+    root->Execute(&our_scope, &err);
+  }
   if (!err.has_error())
     our_scope.CheckForUnusedVars(&err);
 
@@ -275,6 +370,21 @@ void LoaderImpl::BackgroundLoadFile(const Settings* settings,
       err.set_toolchain_label(settings->toolchain_label());
 
     g_scheduler->FailWithError(err);
+  } else if (incremental) {
+    bool defines_toolchain = std::any_of(
+        collected_items.begin(), collected_items.end(),
+        [](const std::unique_ptr<Item>& item) { return item->AsToolchain(); });
+    incremental->AddExecution(file_name, settings->toolchain_label(),
+                              our_scope.CollectBuildDependencyFiles(),
+                              defines_toolchain, std::move(record));
+  }
+
+  if (TracingEnabled()) {
+    trace.AddArg("items", static_cast<int64_t>(collected_items.size()));
+    for (const auto& item : collected_items) {
+      if (item->AsTarget())
+        trace.AddFlow(TraceItem::FLOW_BEGIN, item->label());
+    }
   }
 
   // Pass all of the items that were defined off to the builder.
@@ -283,7 +393,46 @@ void LoaderImpl::BackgroundLoadFile(const Settings* settings,
 
   trace.Done();
 
-  task_runner_->PostTask([this]() { DidLoadFile(); });
+  task_runner_->PostTask(
+      [this, load_id = LoadID(file_name, settings->toolchain_label())]() {
+        DidLoadFile(load_id);
+      });
+}
+
+void LoaderImpl::BackgroundRestoreFile(const Settings* settings,
+                                       const SourceFile& file_name,
+                                       const LocationRange& origin) {
+  if (g_scheduler->verbose_logging()) {
+    g_scheduler->Log("Restoring",
+                     file_name.value() + " with toolchain " +
+                         settings->toolchain_label().GetUserVisibleName(false));
+  }
+
+  ScopedTrace trace(TraceItem::TRACE_FILE_EXECUTE, file_name.value());
+  trace.SetToolchain(settings->toolchain_label());
+
+  Scope::ItemVector restored_items;
+  Err err;
+  if (!settings->build_settings()->incremental_gen_state()->RestoreExecution(
+          settings, file_name, &restored_items, &err)) {
+    if (!origin.is_null())
+      err.AppendSubErr(Err(origin, "which caused the file to be included."));
+
+    if (!settings->is_default())
+      err.set_toolchain_label(settings->toolchain_label());
+
+    g_scheduler->FailWithError(err);
+  }
+
+  for (auto& item : restored_items)
+    settings->build_settings()->ItemDefined(std::move(item));
+
+  trace.Done();
+
+  task_runner_->PostTask(
+      [this, load_id = LoadID(file_name, settings->toolchain_label())]() {
+        DidLoadFile(load_id);
+      });
 }
 
 void LoaderImpl::BackgroundLoadBuildConfig(
@@ -363,7 +512,11 @@ void LoaderImpl::BackgroundLoadBuildConfig(
       });
 }
 
-void LoaderImpl::DidLoadFile() {
+void LoaderImpl::DidLoadFile(const LoadID& load_id) {
+  DCHECK_GT(loads_in_flight_, 0u);
+  loads_in_flight_--;
+  waiter_counts_.erase(load_id);
+  StartQueuedLoads();
   DecrementPendingLoads();
 }
 
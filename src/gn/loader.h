@@ -5,10 +5,13 @@
 #ifndef TOOLS_GN_LOADER_H_
 #define TOOLS_GN_LOADER_H_
 
+#include <stdint.h>
+
 #include <functional>
 #include <map>
 #include <memory>
 #include <set>
+#include <tuple>
 
 #include "base/memory/ref_counted.h"
 #include "gn/label.h"
@@ -57,6 +60,11 @@ class Loader : public base::RefCountedThreadSafe<Loader> {
   // label, and calls Load().
   void Load(const Label& label, const LocationRange& origin);
 
+  // Hints that one more item is waiting for the item with the given label to
+  // be defined. Loaders may use this to start the loads of the files that
+  // unblock the most items first. Does nothing by default.
+  virtual void AddLoadPriorityHint(const Label& label) {}
+
   // When processing the default build config, we want to capture the argument
   // of set_default_build_config. The implementation of that function uses this
   // constant as a property key to get the Label* out of the scope where the
@@ -85,6 +93,7 @@ class LoaderImpl : public Loader {
             const LocationRange& origin,
             const Label& toolchain_name) override;
   void ToolchainLoaded(const Toolchain* toolchain) override;
+  void AddLoadPriorityHint(const Label& label) override;
   Label GetDefaultToolchain() const override;
   const Settings* GetToolchainSettings(const Label& label) const override;
   SourceFile BuildFileForLabel(const Label& label) const override;
@@ -116,16 +125,32 @@ class LoaderImpl : public Loader {
     return default_toolchain_label_;
   }
 
+  // Limits the number of build files being loaded at the same time. Further
+  // loads wait in a queue, from which the files with the most items waiting
+  // on them (see AddLoadPriorityHint()) are started first. This only matters
+  // if the limit is close to the number of worker threads: beyond that the
+  // loads would wait in the worker pool's FIFO queue instead. 0, the default,
+  // means no limit.
+  void set_max_loads_in_flight(size_t max) { max_loads_in_flight_ = max; }
+
  private:
   struct LoadID;
+  struct QueuedLoad;
   struct ToolchainRecord;
 
   ~LoaderImpl() override;
 
-  // Schedules the input file manager to load the given file.
+  // Schedules the input file manager to load the given file, or queues the
+  // load if the maximum number of loads are in flight.
   void ScheduleLoadFile(const Settings* settings,
                         const LocationRange& origin,
                         const SourceFile& file);
+  void StartLoadFile(const Settings* settings,
+                     const LocationRange& origin,
+                     const SourceFile& file);
+
+  // Starts queued loads, highest priority first, while there is room.
+  void StartQueuedLoads();
   void ScheduleLoadBuildConfig(Settings* settings,
                                const Scope::KeyValueMap& toolchain_overrides);
 
@@ -139,9 +164,15 @@ class LoaderImpl : public Loader {
                                  const Scope::KeyValueMap& toolchain_overrides,
                                  const ParseNode* root);
 
+  // Restores the previous execution of the given file on a background thread
+  // instead of running it, see IncrementalGenState.
+  void BackgroundRestoreFile(const Settings* settings,
+                             const SourceFile& file_name,
+                             const LocationRange& origin);
+
   // Posted to the main thread when any file other than a build config file
   // file has completed running.
-  void DidLoadFile();
+  void DidLoadFile(const LoadID& load_id);
 
   // Posted to the main thread when any build config file has completed
   // running. The label should be the name of the toolchain.
@@ -182,6 +213,20 @@ class LoaderImpl : public Loader {
   ToolchainRecordMap toolchain_records_;
 
   std::string build_file_extension_;
+
+  size_t max_loads_in_flight_ = 0;
+  size_t loads_in_flight_ = 0;
+
+  // Number of items waiting on items defined by each file, as reported by
+  // AddLoadPriorityHint(). Also counts files that weren't requested yet.
+  // Entries are erased once the file has been loaded.
+  std::map<LoadID, int> waiter_counts_;
+
+  // Loads waiting for room, keyed by their ID, and the same loads ordered by
+  // descending waiter count then by request order.
+  std::map<LoadID, QueuedLoad> queued_loads_;
+  std::set<std::tuple<int, uint64_t, LoadID>> load_queue_;
+  uint64_t next_load_sequence_ = 0;
 };
 
 #endif  // TOOLS_GN_LOADER_H_
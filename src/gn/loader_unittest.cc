@@ -239,6 +239,53 @@ TEST_F(LoaderTest, Foo) {
   EXPECT_FALSE(scheduler().is_failed());
 }
 
+TEST_F(LoaderTest, LoadPriority) {
+  SourceFile build_config("//build/config/BUILDCONFIG.gn");
+  build_settings_.set_build_config_file(build_config);
+
+  scoped_refptr<LoaderImpl> loader(new LoaderImpl(&build_settings_));
+  mock_ifm_.AddCannedResponse(build_config,
+                              "set_default_toolchain(\"//tc:tc\")");
+  loader->set_async_load_file(mock_ifm_.GetAsyncCallback());
+  loader->set_max_loads_in_flight(1);
+
+  SourceFile root_build("//BUILD.gn");
+  loader->Load(root_build, LocationRange(), Label());
+  mock_ifm_.IssueAllPending();
+  MsgLoop::Current()->RunUntilIdleForTesting();
+  EXPECT_TRUE(mock_ifm_.HasOnePending(root_build));
+
+  // The root build file takes the only slot, so these loads are queued.
+  SourceFile a_build("//a/BUILD.gn");
+  SourceFile b_build("//b/BUILD.gn");
+  SourceFile c_build("//c/BUILD.gn");
+  loader->Load(a_build, LocationRange(), Label());
+  loader->Load(b_build, LocationRange(), Label());
+  loader->Load(c_build, LocationRange(), Label());
+  EXPECT_TRUE(mock_ifm_.HasOnePending(root_build));
+
+  // Files with more items waiting on them are loaded first, then the others
+  // in request order.
+  SourceDir tc_dir("//tc/");
+  loader->AddLoadPriorityHint(Label(SourceDir("//c/"), "x", tc_dir, "tc"));
+  loader->AddLoadPriorityHint(Label(SourceDir("//c/"), "y", tc_dir, "tc"));
+  loader->AddLoadPriorityHint(Label(SourceDir("//b/"), "x", tc_dir, "tc"));
+
+  mock_ifm_.IssueAllPending();
+  MsgLoop::Current()->RunUntilIdleForTesting();
+  EXPECT_TRUE(mock_ifm_.HasOnePending(c_build));
+  mock_ifm_.IssueAllPending();
+  MsgLoop::Current()->RunUntilIdleForTesting();
+  EXPECT_TRUE(mock_ifm_.HasOnePending(b_build));
+  mock_ifm_.IssueAllPending();
+  MsgLoop::Current()->RunUntilIdleForTesting();
+  EXPECT_TRUE(mock_ifm_.HasOnePending(a_build));
+  mock_ifm_.IssueAllPending();
+  MsgLoop::Current()->RunUntilIdleForTesting();
+
+  EXPECT_FALSE(scheduler().is_failed());
+}
+
 TEST_F(LoaderTest, BuildDependencyFilesAreCollected) {
   SourceFile build_config("//build/config/BUILDCONFIG.gn");
   SourceFile root_build("//BUILD.gn");
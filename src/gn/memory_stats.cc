@@ -0,0 +1,305 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/string_escape.h"
+#include "base/strings/stringprintf.h"
+#include "gn/builder.h"
+#include "gn/builder_record.h"
+#include "gn/config.h"
+#include "gn/config_values.h"
+#include "gn/input_file_manager.h"
+#include "gn/loader.h"
+#include "gn/path_output.h"
+#include "gn/resolved_target_data.h"
+#include "gn/scope.h"
+#include "gn/settings.h"
+#include "gn/string_atom.h"
+#include "gn/string_output_buffer.h"
+#include "gn/target.h"
+#include "gn/toolchain.h"
+#include "util/sys_info.h"
+
+namespace {
+
+class MemoryStatsLog {
+ public:
+  void Add(MemoryStatsSample sample) {
+    std::lock_guard<std::mutex> lock(lock_);
+    samples_.push_back(std::move(sample));
+  }
+
+  std::vector<MemoryStatsSample> samples() const {
+    std::lock_guard<std::mutex> lock(lock_);
+    return samples_;
+  }
+
+ private:
+  mutable std::mutex lock_;
+  std::vector<MemoryStatsSample> samples_;
+};
+
+MemoryStatsLog* memory_stats_log = nullptr;
+
+std::atomic<int64_t> pending_ninja_bytes{0};
+
+size_t StringsHeapBytes(const std::vector<std::string>& strings) {
+  size_t result = VectorHeapBytes(strings);
+  for (const std::string& str : strings)
+    result += StringHeapBytes(str);
+  return result;
+}
+
+template <typename T>
+size_t UniqueVectorHeapBytes(const UniqueVector<T>& vector) {
+  // The index holds one bucket per element, with room to grow.
+  return VectorHeapBytes(vector.vector()) + 2 * vector.size() * sizeof(size_t);
+}
+
+size_t EstimateConfigValues(const ConfigValues& values) {
+  size_t result = StringsHeapBytes(values.arflags()) +
+                  StringsHeapBytes(values.asmflags()) +
+                  StringsHeapBytes(values.cflags()) +
+                  StringsHeapBytes(values.cflags_c()) +
+                  StringsHeapBytes(values.cflags_cc()) +
+                  StringsHeapBytes(values.cflags_objc()) +
+                  StringsHeapBytes(values.cflags_objcc()) +
+                  StringsHeapBytes(values.defines()) +
+                  StringsHeapBytes(values.frameworks()) +
+                  StringsHeapBytes(values.weak_frameworks()) +
+                  StringsHeapBytes(values.weak_libraries()) +
+                  StringsHeapBytes(values.ldflags()) +
+                  StringsHeapBytes(values.rustflags()) +
+                  StringsHeapBytes(values.rustenv()) +
+                  StringsHeapBytes(values.swiftflags());
+  result += VectorHeapBytes(values.framework_dirs()) +
+            VectorHeapBytes(values.include_dirs()) +
+            VectorHeapBytes(values.lib_dirs()) +
+            VectorHeapBytes(values.inputs()) + VectorHeapBytes(values.libs());
+  return result;
+}
+
+size_t EstimateTarget(const Target* target) {
+  size_t result = sizeof(Target);
+  result += VectorHeapBytes(target->sources()) +
+            VectorHeapBytes(target->public_headers()) +
+            VectorHeapBytes(target->include_dirs()) +
+            StringsHeapBytes(target->data());
+  result += VectorHeapBytes(target->private_deps()) +
+            VectorHeapBytes(target->public_deps()) +
+            VectorHeapBytes(target->data_deps()) +
+            VectorHeapBytes(target->gen_deps()) +
+            VectorHeapBytes(target->validations()) +
+            VectorHeapBytes(target->whole_archive_deps()) +
+            VectorHeapBytes(target->no_whole_archive_deps());
+  result += UniqueVectorHeapBytes(target->configs()) +
+            UniqueVectorHeapBytes(target->own_configs()) +
+            UniqueVectorHeapBytes(target->all_dependent_configs()) +
+            UniqueVectorHeapBytes(target->own_all_dependent_configs()) +
+            UniqueVectorHeapBytes(target->public_configs()) +
+            UniqueVectorHeapBytes(target->own_public_configs());
+  result += UniqueVectorHeapBytes(target->all_lib_dirs()) +
+            UniqueVectorHeapBytes(target->all_libs()) +
+            UniqueVectorHeapBytes(target->all_framework_dirs()) +
+            UniqueVectorHeapBytes(target->all_frameworks()) +
+            UniqueVectorHeapBytes(target->all_weak_frameworks());
+  result += VectorHeapBytes(target->computed_outputs()) +
+            VectorHeapBytes(target->runtime_outputs());
+  result += EstimateConfigValues(target->config_values());
+  return result;
+}
+
+size_t EstimateConfig(const Config* config, bool resolved) {
+  size_t result = sizeof(Config) + EstimateConfigValues(config->own_values()) +
+                  UniqueVectorHeapBytes(config->configs());
+  // Configs without sub-configs share their resolved values with their own.
+  if (resolved && !config->configs().empty())
+    result += EstimateConfigValues(config->resolved_values());
+  return result;
+}
+
+// Adds up the persistent scopes: each toolchain's build config scope and the
+// cached results of imports. Template closures referenced from them are
+// counted once.
+size_t EstimateScopes(const Builder& builder, const Loader& loader) {
+  std::unordered_set<const void*> seen;
+  size_t result = 0;
+  for (const BuilderRecord* record : builder.GetAllRecords()) {
+    if (record->type() != BuilderRecord::ITEM_TOOLCHAIN)
+      continue;
+    const Settings* settings = loader.GetToolchainSettings(record->label());
+    if (!settings)
+      continue;
+    if (seen.insert(settings->base_config()).second)
+      result += settings->base_config()->EstimateMemoryUsage(&seen);
+    result += settings->import_manager().EstimateMemoryUsage(&seen);
+  }
+  return result;
+}
+
+std::string FormatMegabytes(uint64_t bytes) {
+  return base::StringPrintf("%.1f", bytes / (1024.0 * 1024.0));
+}
+
+}  // namespace
+
+void EnableMemoryStats() {
+  if (!memory_stats_log)
+    memory_stats_log = new MemoryStatsLog;
+}
+
+bool MemoryStatsEnabled() {
+  return !!memory_stats_log;
+}
+
+void AddPendingNinjaBytes(int64_t bytes) {
+  pending_ninja_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void RecordMemoryStats(const std::string& phase,
+                       const MemoryStatsSources& sources) {
+  if (!memory_stats_log)
+    return;
+
+  MemoryStatsSample sample;
+  sample.phase = phase;
+  sample.resident_bytes = ResidentMemoryBytes();
+  // The peak comes from a different source than the current size and can
+  // lag behind it slightly.
+  sample.peak_resident_bytes =
+      std::max(PeakResidentMemoryBytes(), sample.resident_bytes);
+  sample.allocated_bytes = AllocatedMemoryBytes();
+
+  uint64_t input_files = 0;
+  if (sources.input_file_manager)
+    input_files = sources.input_file_manager->EstimateMemoryUsage();
+
+  uint64_t scopes = 0;
+  if (sources.builder && sources.loader)
+    scopes = EstimateScopes(*sources.builder, *sources.loader);
+
+  uint64_t targets = 0;
+  uint64_t configs = 0;
+  if (sources.builder) {
+    for (const BuilderRecord* record : sources.builder->GetAllRecords()) {
+      const Item* item = record->item();
+      if (!item)
+        continue;
+      if (const Target* target = item->AsTarget())
+        targets += EstimateTarget(target);
+      else if (const Config* config = item->AsConfig())
+        configs += EstimateConfig(config, record->resolved());
+    }
+  }
+
+  uint64_t resolved = 0;
+  if (sources.resolved_target_data)
+    resolved = sources.resolved_target_data->EstimateMemoryUsage();
+
+  sample.categories = {
+      {"input_files", input_files},
+      {"scopes", scopes},
+      {"targets", targets},
+      {"configs", configs},
+      {"resolved_target_data", resolved},
+      {"string_atoms", StringAtom::EstimateTableMemoryUsage()},
+      {"path_output_cache", PathOutput::EstimateCacheMemoryUsage()},
+      {"ninja_buffers",
+       StringOutputBuffer::GetTotalPageBytes() +
+           pending_ninja_bytes.load(std::memory_order_relaxed)},
+      {"ninja_buffers_peak", StringOutputBuffer::GetPeakTotalPageBytes()},
+  };
+  memory_stats_log->Add(std::move(sample));
+}
+
+std::vector<MemoryStatsSample> GetMemoryStats() {
+  if (!memory_stats_log)
+    return {};
+  return memory_stats_log->samples();
+}
+
+std::string SummarizeMemoryStats() {
+  std::vector<MemoryStatsSample> samples = GetMemoryStats();
+  if (samples.empty())
+    return std::string();
+
+  std::ostringstream out;
+  out << "Memory use: (MB at the end of each phase)\n";
+  out << base::StringPrintf(" %-22s", "");
+  for (const MemoryStatsSample& sample : samples)
+    out << base::StringPrintf(" %10s", sample.phase.c_str());
+  out << std::endl;
+
+  auto print_row = [&out, &samples](const std::string& name, auto get) {
+    out << base::StringPrintf(" %-22s", name.c_str());
+    for (const MemoryStatsSample& sample : samples)
+      out << base::StringPrintf(" %10s", FormatMegabytes(get(sample)).c_str());
+    out << std::endl;
+  };
+  print_row("resident", [](const MemoryStatsSample& s) {
+    return s.resident_bytes;
+  });
+  print_row("peak resident", [](const MemoryStatsSample& s) {
+    return s.peak_resident_bytes;
+  });
+  print_row("allocated", [](const MemoryStatsSample& s) {
+    return s.allocated_bytes;
+  });
+  for (size_t i = 0; i < samples[0].categories.size(); i++) {
+    print_row(samples[0].categories[i].first,
+              [i](const MemoryStatsSample& s) { return s.categories[i].second; });
+  }
+  return out.str();
+}
+
+std::string MemoryStatsToJSON() {
+  std::ostringstream out;
+  out << "{\"samples\":[";
+  std::string quote_buffer;
+  bool first_sample = true;
+  for (const MemoryStatsSample& sample : GetMemoryStats()) {
+    if (!first_sample)
+      out << ",";
+    first_sample = false;
+
+    quote_buffer.resize(0);
+    base::EscapeJSONString(sample.phase, true, &quote_buffer);
+    out << "{\"phase\":" << quote_buffer;
+    out << ",\"resident_bytes\":" << sample.resident_bytes;
+    out << ",\"peak_resident_bytes\":" << sample.peak_resident_bytes;
+    out << ",\"allocated_bytes\":" << sample.allocated_bytes;
+    out << ",\"categories\":{";
+    bool first_category = true;
+    for (const auto& [name, bytes] : sample.categories) {
+      if (!first_category)
+        out << ",";
+      first_category = false;
+      out << "\"" << name << "\":" << bytes;
+    }
+    out << "}}";
+  }
+  out << "]}\n";
+  return out.str();
+}
+
+bool SaveMemoryStats(const base::FilePath& file_name) {
+  std::string json = MemoryStatsToJSON();
+  return base::WriteFile(file_name, json.data(), static_cast<int>(json.size())) ==
+         static_cast<int>(json.size());
+}
+
+void ResetMemoryStatsForTesting() {
+  delete memory_stats_log;
+  memory_stats_log = nullptr;
+  pending_ninja_bytes = 0;
+}
@@ -0,0 +1,99 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_MEMORY_STATS_H_
+#define TOOLS_GN_MEMORY_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class Builder;
+class InputFileManager;
+class Loader;
+class ResolvedTargetData;
+
+namespace base {
+class FilePath;
+}  // namespace base
+
+// Support for --memstats: approximate number of bytes held by GN's main data
+// structures, sampled at the end of each phase of a run.
+//
+// The estimates add up the sizes of the objects and of the heap blocks they
+// own (string and vector capacities, map entries). Allocator overhead and
+// short-lived objects aren't counted, so the total stays below the process's
+// allocated memory.
+
+// Returns the bytes |str| holds outside of the std::string object.
+inline size_t StringHeapBytes(const std::string& str) {
+  // Strings up to the initial capacity are stored inline.
+  static const size_t inline_capacity = std::string().capacity();
+  return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+}
+
+// Returns the bytes the buffer of |vector| takes, not counting what the
+// elements themselves own.
+template <typename T>
+size_t VectorHeapBytes(const std::vector<T>& vector) {
+  return vector.capacity() * sizeof(T);
+}
+
+struct MemoryStatsSample {
+  std::string phase;
+
+  // Process-wide numbers from the OS and the allocator. 0 if unknown.
+  uint64_t resident_bytes = 0;
+  uint64_t peak_resident_bytes = 0;
+  uint64_t allocated_bytes = 0;
+
+  // Estimated bytes per kind of structure, in a fixed order.
+  std::vector<std::pair<std::string, uint64_t>> categories;
+};
+
+// What a sample looks at. Null members are skipped.
+struct MemoryStatsSources {
+  const Builder* builder = nullptr;
+  const Loader* loader = nullptr;
+  const InputFileManager* input_file_manager = nullptr;
+  const ResolvedTargetData* resolved_target_data = nullptr;
+};
+
+// Call to turn sampling on. It's off by default.
+void EnableMemoryStats();
+
+bool MemoryStatsEnabled();
+
+// Counts generated ninja text held in memory outside of StringOutputBuffers,
+// like rules waiting to be written to the toolchain files. Only called when
+// enabled.
+void AddPendingNinjaBytes(int64_t bytes);
+
+// Takes a sample of everything in |sources| and adds it to the log under the
+// given phase name. Must not run concurrently with anything that modifies the
+// sources.
+void RecordMemoryStats(const std::string& phase,
+                       const MemoryStatsSources& sources);
+
+// Returns all samples taken so far.
+std::vector<MemoryStatsSample> GetMemoryStats();
+
+// Returns a table of the samples taken so far, one column per phase.
+std::string SummarizeMemoryStats();
+
+// Returns the samples taken so far as JSON:
+//   {"samples": [{"phase": "load", "resident_bytes": ...,
+//                 "categories": {"input_files": ..., ...}}, ...]}
+std::string MemoryStatsToJSON();
+
+// Writes MemoryStatsToJSON() to the given file. Returns false on failure.
+bool SaveMemoryStats(const base::FilePath& file_name);
+
+// Drops all samples and turns sampling off. For tests.
+void ResetMemoryStatsForTesting();
+
+#endif  // TOOLS_GN_MEMORY_STATS_H_
@@ -0,0 +1,75 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/memory_stats.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "gn/scope.h"
+#include "gn/test_with_scope.h"
+#include "gn/value.h"
+#include "util/test/test.h"
+
+TEST(MemoryStats, SharedValuesCountedOnce) {
+  std::string long_string(1000, 'x');
+  Value list(nullptr, Value::LIST);
+  list.list_value().push_back(Value(nullptr, long_string));
+
+  std::unordered_set<const void*> seen;
+  size_t list_bytes = list.EstimateMemoryUsage(&seen);
+  EXPECT_GE(list_bytes, long_string.size());
+
+  // A copy shares the list storage with the original.
+  Value copy = list;
+  EXPECT_EQ(0u, copy.EstimateMemoryUsage(&seen));
+
+  seen.clear();
+  EXPECT_EQ(list_bytes, copy.EstimateMemoryUsage(&seen));
+}
+
+TEST(MemoryStats, Scope) {
+  TestWithScope setup;
+  Scope scope(setup.settings());
+  std::unordered_set<const void*> empty_seen;
+  size_t empty_bytes = scope.EstimateMemoryUsage(&empty_seen);
+
+  scope.SetValue("foo", Value(nullptr, std::string(1000, 'x')), nullptr);
+  std::unordered_set<const void*> seen;
+  EXPECT_GE(scope.EstimateMemoryUsage(&seen), empty_bytes + 1000);
+}
+
+TEST(MemoryStats, Record) {
+  EnableMemoryStats();
+  ASSERT_TRUE(MemoryStatsEnabled());
+
+  AddPendingNinjaBytes(1 << 20);
+  RecordMemoryStats("load", MemoryStatsSources());
+  RecordMemoryStats("write", MemoryStatsSources());
+
+  std::vector<MemoryStatsSample> samples = GetMemoryStats();
+  ASSERT_EQ(2u, samples.size());
+  EXPECT_EQ("load", samples[0].phase);
+  EXPECT_EQ("write", samples[1].phase);
+
+  uint64_t ninja_bytes = 0;
+  for (const auto& [name, bytes] : samples[0].categories) {
+    if (name == "ninja_buffers")
+      ninja_bytes = bytes;
+  }
+  EXPECT_GE(ninja_bytes, uint64_t(1) << 20);
+
+  std::string summary = SummarizeMemoryStats();
+  EXPECT_NE(std::string::npos, summary.find("load"));
+  EXPECT_NE(std::string::npos, summary.find("ninja_buffers"));
+
+  std::string json = MemoryStatsToJSON();
+  EXPECT_EQ(0u, json.find("{\"samples\":[{\"phase\":\"load\""));
+  EXPECT_NE(std::string::npos, json.find("\"phase\":\"write\""));
+
+  ResetMemoryStatsForTesting();
+  EXPECT_FALSE(MemoryStatsEnabled());
+  EXPECT_TRUE(GetMemoryStats().empty());
+}
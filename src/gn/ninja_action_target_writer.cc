@@ -276,9 +276,10 @@ void NinjaActionTargetWriter::WriteOutputFilesForBuildLine(
     std::vector<OutputFile>* output_files) {
   size_t first_output_index = output_files->size();
 
-  SubstitutionWriter::ApplyListToSourceAsOutputFile(
-      target_, settings_, target_->action_values().outputs(), source,
-      output_files);
+  output_expanders_
+      .Get(target_, settings_, target_->action_values().outputs(),
+           SubstitutionExpander::SOURCE)
+      .ApplyToSourceAsOutputFiles(source, output_files);
 
   for (size_t i = first_output_index; i < output_files->size(); i++) {
     out_ << " ";
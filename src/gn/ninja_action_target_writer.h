@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "base/gtest_prod_util.h"
+#include "gn/compiled_substitution.h"
 #include "gn/ninja_target_writer.h"
 
 class OutputFile;
@@ -60,6 +61,10 @@ class NinjaActionTargetWriter : public NinjaTargetWriter {
   // computing intermediate strings.
   PathOutput path_output_no_escaping_;
 
+  // Holds the outputs pattern of an action_foreach target bound to it, which
+  // is expanded for every source.
+  SubstitutionExpanderCache output_expanders_;
+
   NinjaActionTargetWriter(const NinjaActionTargetWriter&) = delete;
   NinjaActionTargetWriter& operator=(const NinjaActionTargetWriter&) = delete;
 };
@@ -8,6 +8,7 @@
 
 #include "base/strings/string_util.h"
 #include "gn/builtin_tool.h"
+#include "gn/compiled_substitution.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
 #include "gn/filesystem_utils.h"
@@ -209,6 +210,7 @@ void NinjaBinaryTargetWriter::AddSourceSetFiles(
     const Target* source_set,
     UniqueVector<OutputFile>* obj_files) const {
   std::vector<OutputFile> tool_outputs;  // Prevent allocation in loop.
+  SubstitutionExpanderCache expanders;
 
   // Compute object files for all sources. Only link the first output from
   // the tool if there are more than one.
@@ -217,7 +219,8 @@ void NinjaBinaryTargetWriter::AddSourceSetFiles(
     // Do not add .pcm files as they are not object files linked to final
     // binaries.
     if (source.GetType() != SourceFile::SOURCE_MODULEMAP &&
-        source_set->GetOutputFilesForSource(source, &tool_name, &tool_outputs))
+        source_set->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                            &expanders))
       obj_files->push_back(tool_outputs[0]);
   }
 
@@ -6,8 +6,13 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 
@@ -49,6 +54,64 @@ struct Counts {
   const Target* last_seen;
 };
 
+// The names a target in the default toolchain may claim in build.ninja,
+// computed up front in parallel.
+struct TargetNames {
+  // The outputs of the target, normalized.
+  std::vector<StringAtom> outputs;
+
+  // "foo/bar:baz" for "//foo/bar:baz".
+  StringAtom long_name;
+
+  // "foo/bar" for "//foo/bar:bar", if that differs from the short name.
+  bool has_medium_name = false;
+  StringAtom medium_name;
+};
+
+// Number of items, e.g. phony rules, handled by one task when writing
+// build.ninja in parallel. Large enough that posting a task costs little next
+// to the work in it.
+constexpr size_t kItemsPerChunk = 4096;
+
+// Calls |run(chunk)| for every chunk in [0, chunk_count), spread over the
+// worker pool and the calling thread, and returns once all calls are done.
+void RunChunksInParallel(size_t chunk_count,
+                         const std::function<void(size_t)>& run) {
+  if (chunk_count == 0)
+    return;
+
+  struct State {
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    std::condition_variable done_cv;
+    size_t done = 0;  // Protected by |lock|.
+  };
+  auto state = std::make_shared<State>();
+
+  // Helpers may start after all chunks are taken, but they only use |run|
+  // for chunks they took, which this function waits for.
+  auto drain = [state, chunk_count, &run]() {
+    for (size_t chunk; (chunk = state->next.fetch_add(1)) < chunk_count;) {
+      run(chunk);
+      std::lock_guard<std::mutex> lock(state->lock);
+      if (++state->done == chunk_count)
+        state->done_cv.notify_one();
+    }
+  };
+
+  size_t helpers =
+      g_scheduler
+          ? std::min(chunk_count - 1, g_scheduler->worker_thread_count())
+          : 0;
+  for (size_t i = 0; i < helpers; i++)
+    g_scheduler->ScheduleHelperWork(drain);
+  drain();
+
+  std::unique_lock<std::mutex> lock(state->lock);
+  while (state->done < chunk_count)
+    state->done_cv.wait(lock);
+}
+
 }  // namespace
 
 base::CommandLine GetSelfInvocationCommandLine(
@@ -199,18 +262,20 @@ NinjaBuildWriter::NinjaBuildWriter(
     const std::vector<const Target*>& all_targets,
     const Toolchain* default_toolchain,
     const std::vector<const Target*>& default_toolchain_targets,
-    std::ostream& out,
     std::ostream& dep_out)
     : build_settings_(build_settings),
       used_toolchains_(used_toolchains),
       all_targets_(all_targets),
       default_toolchain_(default_toolchain),
       default_toolchain_targets_(default_toolchain_targets),
-      out_(out),
+      out_(nullptr),
       dep_out_(dep_out),
       path_output_(build_settings->build_dir(),
                    build_settings->root_path_utf8(),
-                   ESCAPE_NINJA) {}
+                   ESCAPE_NINJA),
+      items_per_chunk_(kItemsPerChunk) {
+  AppendSections({});
+}
 
 NinjaBuildWriter::~NinjaBuildWriter() = default;
 
@@ -220,6 +285,35 @@ bool NinjaBuildWriter::Run(Err* err) {
   return WriteSubninjas(err) && WritePhonyAndAllRules(err);
 }
 
+std::string NinjaBuildWriter::GetContents() const {
+  std::string contents;
+  for (const auto& section : sections_)
+    contents += section->str();
+  return contents;
+}
+
+template <typename Format>
+void NinjaBuildWriter::WriteInChunks(size_t count, const Format& format) {
+  size_t chunk_count = (count + items_per_chunk_ - 1) / items_per_chunk_;
+  std::vector<std::unique_ptr<StringOutputBuffer>> chunks(chunk_count);
+  RunChunksInParallel(chunk_count, [&](size_t chunk) {
+    auto buffer = std::make_unique<StringOutputBuffer>();
+    std::ostream out(buffer.get());
+    size_t begin = chunk * items_per_chunk_;
+    format(out, begin, std::min(count, begin + items_per_chunk_));
+    chunks[chunk] = std::move(buffer);
+  });
+  AppendSections(std::move(chunks));
+}
+
+void NinjaBuildWriter::AppendSections(
+    std::vector<std::unique_ptr<StringOutputBuffer>> chunks) {
+  for (auto& chunk : chunks)
+    sections_.push_back(std::move(chunk));
+  sections_.push_back(std::make_unique<StringOutputBuffer>());
+  out_.rdbuf(sections_.back().get());
+}
+
 // static
 bool NinjaBuildWriter::RunAndWriteFile(const BuildSettings* build_settings,
                                        const Builder& builder,
@@ -254,11 +348,9 @@ bool NinjaBuildWriter::RunAndWriteFile(const BuildSettings* build_settings,
     }
   }
 
-  std::stringstream file;
   std::stringstream depfile;
   NinjaBuildWriter gen(build_settings, used_toolchains, all_targets,
-                       default_toolchain, default_toolchain_targets, file,
-                       depfile);
+                       default_toolchain, default_toolchain_targets, depfile);
   if (!gen.Run(err))
     return false;
 
@@ -269,10 +361,10 @@ bool NinjaBuildWriter::RunAndWriteFile(const BuildSettings* build_settings,
   base::FilePath ninja_file_name(build_settings->GetFullPath(
       SourceFile(build_settings->build_dir().value() + "build.ninja")));
   base::CreateDirectory(ninja_file_name.DirName());
-  std::string ninja_contents = file.str();
-  if (util::WriteFileAtomically(ninja_file_name, ninja_contents.data(),
-                                static_cast<int>(ninja_contents.size())) !=
-      static_cast<int>(ninja_contents.size()))
+  std::vector<std::string_view> ninja_contents;
+  for (const auto& section : gen.sections_)
+    section->AppendPageViews(&ninja_contents);
+  if (!util::WriteFileAtomically(ninja_file_name, ninja_contents))
     return false;
 
   // Dep file listing build dependencies.
@@ -529,11 +621,55 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
   std::map<std::string, Counts> short_names;
   std::map<std::string, Counts> exes;
 
+  // The phony rules to write, in order.
+  std::vector<std::pair<const Target*, StringAtom>> phony_rules;
+
+  // Which names a target gets depends on the targets before it, so only
+  // building the strings for the names is done in parallel.
+  std::vector<TargetNames> target_names(default_toolchain_targets_.size());
+  RunChunksInParallel(
+      (target_names.size() + items_per_chunk_ - 1) / items_per_chunk_,
+      [this, &target_names](size_t chunk) {
+        size_t begin = chunk * items_per_chunk_;
+        size_t end = std::min(target_names.size(), begin + items_per_chunk_);
+        for (size_t i = begin; i < end; i++) {
+          const Target* target = default_toolchain_targets_[i];
+          TargetNames& names = target_names[i];
+
+          // Need to normalize because many toolchain outputs will be preceded
+          // with "./".
+          for (const auto& output : target->computed_outputs()) {
+            std::string output_string(output.value());
+            NormalizePath(&output_string);
+            names.outputs.push_back(StringAtom(output_string));
+          }
+
+          // The long name "foo/bar:baz" for the target "//foo/bar:baz".
+          const Label& label = target->label();
+          std::string long_name = label.GetUserVisibleName(false);
+          base::TrimString(long_name, "/", &long_name);
+          names.long_name = StringAtom(long_name);
+
+          // The directory name with no target name if they match
+          // (e.g. "//foo/bar:bar" -> "foo/bar"). That may be the same as the
+          // short name of the target, which is written separately.
+          if (FindLastDirComponent(label.dir()) == label.name()) {
+            std::string medium_name = DirectoryWithNoLastSlash(label.dir());
+            base::TrimString(medium_name, "/", &medium_name);
+            if (medium_name != label.name()) {
+              names.has_medium_name = true;
+              names.medium_name = StringAtom(medium_name);
+            }
+          }
+        }
+      });
+
   // ----------------------------------------------------
   // If you change this algorithm, update the help above!
   // ----------------------------------------------------
 
-  for (const Target* target : default_toolchain_targets_) {
+  for (size_t i = 0; i < default_toolchain_targets_.size(); i++) {
+    const Target* target = default_toolchain_targets_[i];
     const Label& label = target->label();
     const std::string& short_name = label.name();
 
@@ -579,15 +715,11 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
     //
     // If at this point there is a collision (no phony rules have been
     // generated yet), two targets make the same output so throw an error.
-    for (const auto& output : target->computed_outputs()) {
-      // Need to normalize because many toolchain outputs will be preceded
-      // with "./".
-      std::string output_string(output.value());
-      NormalizePath(&output_string);
-      const StringAtom output_string_atom(output_string);
-
-      if (!written_rules.insert(output_string_atom).second) {
-        *err = GetDuplicateOutputError(default_toolchain_targets_, output);
+    const std::vector<StringAtom>& outputs = target_names[i].outputs;
+    for (size_t j = 0; j < outputs.size(); j++) {
+      if (!written_rules.insert(outputs[j]).second) {
+        *err = GetDuplicateOutputError(default_toolchain_targets_,
+                                       target->computed_outputs()[j]);
         return false;
       }
     }
@@ -596,13 +728,13 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
   // First prefer the short names of toplevel targets.
   for (const Target* target : toplevel_targets) {
     if (written_rules.insert(target->label().name_atom()).second)
-      WritePhonyRule(target, target->label().name_atom());
+      phony_rules.emplace_back(target, target->label().name_atom());
   }
 
   // Next prefer short names of toplevel dir targets.
   for (const Target* target : toplevel_dir_targets) {
     if (written_rules.insert(target->label().name_atom()).second)
-      WritePhonyRule(target, target->label().name_atom());
+      phony_rules.emplace_back(target, target->label().name_atom());
   }
 
   // Write out the names labels of executables. Many toolchains will produce
@@ -619,7 +751,7 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
     const Counts& counts = pair.second;
     const StringAtom& short_name = counts.last_seen->label().name_atom();
     if (counts.count == 1 && written_rules.insert(short_name).second)
-      WritePhonyRule(counts.last_seen, short_name);
+      phony_rules.emplace_back(counts.last_seen, short_name);
   }
 
   // Write short names when those names are unique and not already taken.
@@ -627,47 +759,41 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
     const Counts& counts = pair.second;
     const StringAtom& short_name = counts.last_seen->label().name_atom();
     if (counts.count == 1 && written_rules.insert(short_name).second)
-      WritePhonyRule(counts.last_seen, short_name);
+      phony_rules.emplace_back(counts.last_seen, short_name);
   }
 
   // Write the label variants of the target name.
-  for (const Target* target : default_toolchain_targets_) {
-    const Label& label = target->label();
-
-    // Write the long name "foo/bar:baz" for the target "//foo/bar:baz".
-    std::string long_name = label.GetUserVisibleName(false);
-    base::TrimString(long_name, "/", &long_name);
-    const StringAtom long_name_atom(long_name);
-    if (written_rules.insert(long_name_atom).second)
-      WritePhonyRule(target, long_name_atom);
-
-    // Write the directory name with no target name if they match
-    // (e.g. "//foo/bar:bar" -> "foo/bar").
-    if (FindLastDirComponent(label.dir()) == label.name()) {
-      std::string medium_name = DirectoryWithNoLastSlash(label.dir());
-      base::TrimString(medium_name, "/", &medium_name);
-      const StringAtom medium_name_atom(medium_name);
-
-      // That may have generated a name the same as the short name of the
-      // target which we already wrote.
-      if (medium_name != label.name() &&
-          written_rules.insert(medium_name_atom).second)
-        WritePhonyRule(target, medium_name_atom);
-    }
+  for (size_t i = 0; i < default_toolchain_targets_.size(); i++) {
+    const Target* target = default_toolchain_targets_[i];
+    const TargetNames& names = target_names[i];
+    if (written_rules.insert(names.long_name).second)
+      phony_rules.emplace_back(target, names.long_name);
+    if (names.has_medium_name &&
+        written_rules.insert(names.medium_name).second)
+      phony_rules.emplace_back(target, names.medium_name);
   }
 
+  WriteInChunks(phony_rules.size(), [this, &phony_rules](std::ostream& out,
+                                                         size_t begin,
+                                                         size_t end) {
+    for (size_t i = begin; i < end; i++)
+      WritePhonyRule(out, phony_rules[i].first, phony_rules[i].second);
+  });
+
   // Write the autogenerated "all" rule.
   if (!default_toolchain_targets_.empty()) {
     out_ << "\nbuild all: phony";
-
-    EscapeOptions ninja_escape;
-    ninja_escape.mode = ESCAPE_NINJA;
-    for (const Target* target : default_toolchain_targets_) {
-      if (target->has_dependency_output()) {
-        out_ << " $\n    ";
-        path_output_.WriteFile(out_, target->dependency_output());
-      }
-    }
+    WriteInChunks(default_toolchain_targets_.size(),
+                  [this](std::ostream& out, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                      const Target* target = default_toolchain_targets_[i];
+                      if (target->has_dependency_output()) {
+                        out << " $\n    ";
+                        path_output_.WriteFile(out,
+                                               target->dependency_output());
+                      }
+                    }
+                  });
   }
   out_ << std::endl;
 
@@ -690,8 +816,9 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
   return true;
 }
 
-void NinjaBuildWriter::WritePhonyRule(const Target* target,
-                                      std::string_view phony_name) {
+void NinjaBuildWriter::WritePhonyRule(std::ostream& out,
+                                      const Target* target,
+                                      std::string_view phony_name) const {
   EscapeOptions ninja_escape;
   ninja_escape.mode = ESCAPE_NINJA;
 
@@ -705,9 +832,9 @@ void NinjaBuildWriter::WritePhonyRule(const Target* target,
     return;
   }
 
-  out_ << "build " << escaped << ": phony ";
-  path_output_.WriteFile(out_, target->dependency_output());
-  out_ << std::endl;
+  out << "build " << escaped << ": phony ";
+  path_output_.WriteFile(out, target->dependency_output());
+  out << std::endl;
 }
 
 
@@ -7,11 +7,15 @@
 
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <ostream>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "gn/path_output.h"
+#include "gn/string_output_buffer.h"
 
 class Builder;
 class BuildSettings;
@@ -35,7 +39,6 @@ class NinjaBuildWriter {
                    const std::vector<const Target*>& all_targets,
                    const Toolchain* default_toolchain,
                    const std::vector<const Target*>& default_toolchain_targets,
-                   std::ostream& out,
                    std::ostream& dep_out);
   ~NinjaBuildWriter();
 
@@ -58,8 +61,18 @@ class NinjaBuildWriter {
   // On error, returns an empty string.
   static std::string ExtractRegenerationCommands(std::istream& build_ninja_in);
 
+  // Generates build.ninja, and writes the files it depends on to |dep_out|.
   bool Run(Err* err);
 
+  // Returns the build.ninja generated by Run().
+  std::string GetContents() const;
+
+  // Sets the number of phony rules, or entries of the "all" rule, formatted
+  // by one task.
+  void set_items_per_chunk_for_testing(size_t items) {
+    items_per_chunk_ = items;
+  }
+
  private:
   // WriteNinjaRules writes the rules that ninja uses to regenerate its own
   // build files, used whenever a build input file has changed.
@@ -84,7 +97,19 @@ class NinjaBuildWriter {
   bool WritePhonyAndAllRules(Err* err);
   void WritePreciseTarget();
 
-  void WritePhonyRule(const Target* target, std::string_view phony_name);
+  void WritePhonyRule(std::ostream& out,
+                      const Target* target,
+                      std::string_view phony_name) const;
+
+  // Formats |count| items in chunks of |items_per_chunk_| with
+  // |format(out, begin, end)|, on the worker pool and this thread, and
+  // appends the chunks in order.
+  template <typename Format>
+  void WriteInChunks(size_t count, const Format& format);
+
+  // Appends |chunks| after what was written to |out_| so far, and points
+  // |out_| at a new section after them.
+  void AppendSections(std::vector<std::unique_ptr<StringOutputBuffer>> chunks);
 
   const BuildSettings* build_settings_;
 
@@ -93,9 +118,17 @@ class NinjaBuildWriter {
   const Toolchain* default_toolchain_;
   const std::vector<const Target*>& default_toolchain_targets_;
 
-  std::ostream& out_;
+  // The build.ninja contents, in order. Chunks formatted in parallel are
+  // kept as sections of their own so they can be written out without first
+  // copying them together.
+  std::vector<std::unique_ptr<StringOutputBuffer>> sections_;
+
+  // Writes to the last of |sections_|.
+  std::ostream out_;
+
   std::ostream& dep_out_;
   PathOutput path_output_;
+  size_t items_per_chunk_;
 
   NinjaBuildWriter(const NinjaBuildWriter&) = delete;
   NinjaBuildWriter& operator=(const NinjaBuildWriter&) = delete;
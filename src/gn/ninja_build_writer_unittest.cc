@@ -4,6 +4,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 
 #include "base/command_line.h"
@@ -136,11 +137,10 @@ TEST_F(NinjaBuildWriterTest, TwoTargets) {
 
   std::vector<const Target*> targets = {&target_foo, &target_bar, &target_baz};
 
-  std::ostringstream ninja_out;
   std::ostringstream depfile_out;
 
   NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
-                          setup.toolchain(), targets, ninja_out, depfile_out);
+                          setup.toolchain(), targets, depfile_out);
   ASSERT_TRUE(writer.Run(&err));
 
   const char expected_rule_gn[] = "rule gn\n";
@@ -173,7 +173,7 @@ TEST_F(NinjaBuildWriterTest, TwoTargets) {
       "    phony/bar/bar $\n"
       "    phony/baz/baz\n";
   const char expected_default[] = "default all\n";
-  std::string out_str = ninja_out.str();
+  std::string out_str = writer.GetContents();
 #define EXPECT_SNIPPET(expected)                       \
   EXPECT_NE(std::string::npos, out_str.find(expected)) \
       << "Expected to find: " << expected << "\n"      \
@@ -215,12 +215,12 @@ TEST_F(NinjaBuildWriterTest, ExtractRegenerationCommands) {
 
   std::vector<const Target*> targets = {&target_foo};
 
-  std::stringstream ninja_out;
   std::ostringstream depfile_out;
 
   NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
-                          setup.toolchain(), targets, ninja_out, depfile_out);
+                          setup.toolchain(), targets, depfile_out);
   ASSERT_TRUE(writer.Run(&err));
+  std::stringstream ninja_out(writer.GetContents());
 
   const char expected_rule_gn[] = "rule gn\n";
   const char expected_build_ninja_stamp[] = "build build.ninja.stamp: gn\n";
@@ -291,10 +291,9 @@ TEST_F(NinjaBuildWriterTest, SpaceInDepfile) {
   std::unordered_map<const Settings*, const Toolchain*> used_toolchains;
   used_toolchains[setup.settings()] = setup.toolchain();
   std::vector<const Target*> targets;
-  std::ostringstream ninja_out;
   std::ostringstream depfile_out;
   NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
-                          setup.toolchain(), targets, ninja_out, depfile_out);
+                          setup.toolchain(), targets, depfile_out);
   ASSERT_TRUE(writer.Run(&err));
 
   EXPECT_EQ(depfile_out.str(),
@@ -324,10 +323,9 @@ TEST_F(NinjaBuildWriterTest, DuplicateOutputs) {
   std::unordered_map<const Settings*, const Toolchain*> used_toolchains;
   used_toolchains[setup.settings()] = setup.toolchain();
   std::vector<const Target*> targets = {&target_foo, &target_bar};
-  std::ostringstream ninja_out;
   std::ostringstream depfile_out;
   NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
-                          setup.toolchain(), targets, ninja_out, depfile_out);
+                          setup.toolchain(), targets, depfile_out);
   ASSERT_FALSE(writer.Run(&err));
 
   const char expected_help_test[] =
@@ -344,3 +342,47 @@ TEST_F(NinjaBuildWriterTest, DuplicateOutputs) {
   EXPECT_EQ(expected_help_test, err.help_text());
 }
 
+
+TEST_F(NinjaBuildWriterTest, Chunks) {
+  TestWithScope setup;
+  Err err;
+
+  // Enough targets for several chunks, with colliding short names and a
+  // toplevel dir target.
+  std::vector<std::unique_ptr<Target>> owned_targets;
+  std::vector<const Target*> targets;
+  for (int i = 0; i < 10; i++) {
+    std::string dir = i == 0 ? "//name0/" : "//dir" + std::to_string(i) + "/";
+    auto target = std::make_unique<Target>(
+        setup.settings(),
+        Label(SourceDir(dir), "name" + std::to_string(i % 4)));
+    target->set_output_type(Target::GROUP);
+    target->visibility().SetPublic();
+    target->SetToolchain(setup.toolchain());
+    ASSERT_TRUE(target->OnResolved(&err));
+    targets.push_back(target.get());
+    owned_targets.push_back(std::move(target));
+  }
+
+  std::unordered_map<const Settings*, const Toolchain*> used_toolchains;
+  used_toolchains[setup.settings()] = setup.toolchain();
+
+  std::ostringstream depfile_out;
+  NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
+                          setup.toolchain(), targets, depfile_out);
+  ASSERT_TRUE(writer.Run(&err));
+  std::string expected = writer.GetContents();
+  EXPECT_NE(std::string::npos, expected.find("build name0: phony"));
+  EXPECT_NE(std::string::npos, expected.find("build dir9$:name1: phony"));
+
+  // The output doesn't depend on how it is split into chunks.
+  for (size_t items_per_chunk : {1, 3}) {
+    std::ostringstream chunked_depfile_out;
+    NinjaBuildWriter chunked_writer(setup.build_settings(), used_toolchains,
+                                    targets, setup.toolchain(), targets,
+                                    chunked_depfile_out);
+    chunked_writer.set_items_per_chunk_for_testing(items_per_chunk);
+    ASSERT_TRUE(chunked_writer.Run(&err));
+    EXPECT_EQ(expected, chunked_writer.GetContents()) << items_per_chunk;
+  }
+}
@@ -13,6 +13,7 @@
 
 #include "base/strings/string_util.h"
 #include "gn/c_substitution_type.h"
+#include "gn/compiled_substitution.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
 #include "gn/err.h"
@@ -394,13 +395,15 @@ void NinjaCBinaryTargetWriter::WriteSources(
 
   std::vector<OutputFile> tool_outputs;  // Prevent reallocation in loop.
   std::vector<OutputFile> deps;
+  SubstitutionExpanderCache expanders;
   for (const auto& source : target_->sources()) {
     DCHECK_NE(source.GetType(), SourceFile::SOURCE_SWIFT);
 
     // Clear the vector but maintain the max capacity to prevent reallocations.
     deps.resize(0);
     const char* tool_name = Tool::kToolNone;
-    if (!target_->GetOutputFilesForSource(source, &tool_name, &tool_outputs)) {
+    if (!target_->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                          &expanders)) {
       if (source.IsDefType())
         other_files->push_back(source);
       continue;  // No output for this source.
@@ -5,6 +5,7 @@
 #include "gn/ninja_copy_target_writer.h"
 
 #include "base/strings/string_util.h"
+#include "gn/compiled_substitution.h"
 #include "gn/general_tool.h"
 #include "gn/ninja_utils.h"
 #include "gn/output_file.h"
@@ -66,7 +67,9 @@ void NinjaCopyTargetWriter::WriteCopyRules(
       target_->action_values().outputs();
   CHECK_EQ(1u, output_subst_list.list().size())
       << "Should have one entry exactly.";
-  const SubstitutionPattern& output_subst = output_subst_list.list()[0];
+  SubstitutionExpander output_expander(
+      target_, target_->settings(), CompiledSubstitutionList(output_subst_list),
+      SubstitutionExpander::SOURCE);
 
   std::string tool_name =
       GetNinjaRulePrefixForToolchain(settings_) + GeneralTool::kGeneralToolCopy;
@@ -109,13 +112,10 @@ void NinjaCopyTargetWriter::WriteCopyRules(
   // Such cases should be avoided where possible, but sometimes that's not
   // possible.
   for (const auto& input_file : target_->sources()) {
-    OutputFile output_file =
-        SubstitutionWriter::ApplyPatternToSourceAsOutputFile(
-            target_, target_->settings(), output_subst, input_file);
-    output_files->push_back(output_file);
+    output_expander.ApplyToSourceAsOutputFiles(input_file, output_files);
 
     out_ << "build ";
-    WriteOutput(std::move(output_file));
+    WriteOutput(output_files->back());
 
     out_ << ": " << tool_name << " ";
     path_output_.WriteFile(out_, input_file);
@@ -0,0 +1,351 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_file_manifest.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <algorithm>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/string_output_buffer.h"
+#include "util/atomic_write.h"
+
+namespace {
+
+// First line of the manifest. Bump the version when changing the format or
+// the hash function.
+const char kHeader[] = "GN ninja file manifest v1\n";
+
+// MurmurHash64A, seeded with the hash of the previous part of the contents.
+// StringOutputBuffer pages always have the same size, so hashing the contents
+// page by page gives the same result for the same contents.
+uint64_t HashBytes(std::string_view data, uint64_t seed) {
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int r = 47;
+
+  uint64_t h = seed ^ (data.size() * m);
+  const char* p = data.data();
+  const char* end = p + data.size() / 8 * 8;
+  for (; p != end; p += 8) {
+    uint64_t k;
+    memcpy(&k, p, sizeof(k));
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  size_t tail = data.size() % 8;
+  if (tail) {
+    uint64_t k = 0;
+    for (size_t i = 0; i < tail; i++) {
+      k |= static_cast<uint64_t>(static_cast<unsigned char>(p[i]))
+           << (8 * i);
+    }
+    h ^= k;
+    h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+// Writes what is streamed to it to a file, and hashes it page by page like
+// NinjaFileManifest::HashContents() hashes a StringOutputBuffer.
+class HashingFileBuffer : public std::streambuf {
+ public:
+  explicit HashingFileBuffer(base::File file)
+      : file_(std::move(file)), ok_(file_.IsValid()) {
+    page_.reserve(StringOutputBuffer::kPageSize);
+  }
+
+  // Writes what is left and closes the file. Returns false if any write
+  // failed.
+  bool Finish() {
+    if (!page_.empty())
+      WritePage();
+    file_.Close();
+    return ok_;
+  }
+
+  uint64_t hash() const { return hash_; }
+  uint64_t size() const { return size_; }
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    size_t left = static_cast<size_t>(n);
+    while (left > 0) {
+      size_t count =
+          std::min(left, StringOutputBuffer::kPageSize - page_.size());
+      page_.append(s, count);
+      s += count;
+      left -= count;
+      if (page_.size() == StringOutputBuffer::kPageSize)
+        WritePage();
+    }
+    return n;
+  }
+
+  int_type overflow(int_type ch) override {
+    if (ch != traits_type::eof()) {
+      char c = traits_type::to_char_type(ch);
+      xsputn(&c, 1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+ private:
+  void WritePage() {
+    hash_ = HashBytes(page_, hash_);
+    size_ += page_.size();
+    if (ok_ && file_.WriteAtCurrentPos(page_.data(),
+                                       static_cast<int>(page_.size())) !=
+                   static_cast<int>(page_.size()))
+      ok_ = false;
+    page_.clear();
+  }
+
+  base::File file_;
+  bool ok_;
+  std::string page_;
+  uint64_t hash_ = 0;
+  uint64_t size_ = 0;
+};
+
+}  // namespace
+
+const char NinjaFileManifest::kFileName[] = "ninja_files.manifest";
+
+NinjaFileManifest::NinjaFileManifest(const base::FilePath& build_dir)
+    : build_dir_(build_dir),
+      manifest_file_(build_dir.AppendASCII(kFileName)) {}
+
+NinjaFileManifest::~NinjaFileManifest() = default;
+
+void NinjaFileManifest::Load() {
+  std::string contents;
+  if (!base::ReadFileToString(manifest_file_, &contents))
+    return;
+  if (contents.compare(0, sizeof(kHeader) - 1, kHeader) != 0)
+    return;
+
+  // Each entry is a "<hash> <size> <modification time> <path>" line. The path
+  // is last since it may contain spaces.
+  std::unordered_map<std::string, Entry> entries;
+  size_t pos = sizeof(kHeader) - 1;
+  while (pos < contents.size()) {
+    size_t line_end = contents.find('\n', pos);
+    if (line_end == std::string::npos)
+      return;
+    std::string_view line(&contents[pos], line_end - pos);
+    pos = line_end + 1;
+
+    std::vector<std::string_view> fields = base::SplitStringPiece(
+        line, " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+    Entry entry;
+    if (fields.size() < 4 || !base::HexStringToUInt64(fields[0], &entry.hash) ||
+        !base::StringToUint64(fields[1], &entry.size) ||
+        !base::StringToUint64(fields[2], &entry.last_modified))
+      return;
+    size_t path_offset =
+        fields[0].size() + fields[1].size() + fields[2].size() + 3;
+    entries[std::string(line.substr(path_offset))] = entry;
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_ = std::move(entries);
+}
+
+bool NinjaFileManifest::Save() const {
+  std::string contents = kHeader;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (const auto& [key, entry] : entries_) {
+      if (!entry.used)
+        continue;
+      contents.append(base::StringPrintf(
+          "%016" PRIx64 " %" PRIu64 " %" PRIu64 " ", entry.hash, entry.size,
+          static_cast<uint64_t>(entry.last_modified)));
+      contents.append(key);
+      contents.push_back('\n');
+    }
+  }
+  return util::WriteFileAtomically(manifest_file_, contents.data(),
+                                   static_cast<int>(contents.size())) ==
+         static_cast<int>(contents.size());
+}
+
+bool NinjaFileManifest::WriteFileIfChanged(const base::FilePath& file_path,
+                                           const StringOutputBuffer& contents,
+                                           Err* err) {
+  std::string key = GetKey(file_path);
+  uint64_t hash = HashContents(contents);
+  uint64_t size = contents.size();
+  if (KeepFileIfRecorded(key, file_path, hash, size))
+    return true;
+
+  if (!contents.WriteToFileIfChanged(file_path, err))
+    return false;
+  RecordFile(key, file_path, hash, size);
+  return true;
+}
+
+bool NinjaFileManifest::WriteFileIfChanged(
+    const base::FilePath& file_path,
+    const std::function<bool(std::ostream&)>& write,
+    Err* err) {
+  base::FilePath temp_path;
+  HashingFileBuffer buffer(
+      base::CreateAndOpenTemporaryFileInDir(file_path.DirName(), &temp_path));
+  bool written;
+  {
+    std::ostream out(&buffer);
+    written = write(out);
+  }
+  if (!buffer.Finish() || !written) {
+    if (!temp_path.empty())
+      base::DeleteFile(temp_path, false);
+    if (err) {
+      *err = Err(Location(), "Unable to write file.",
+                 "I was writing \"" + FilePathToUTF8(file_path) + "\".");
+    }
+    return false;
+  }
+
+  std::string key = GetKey(file_path);
+  if (KeepFileIfRecorded(key, file_path, buffer.hash(), buffer.size())) {
+    base::DeleteFile(temp_path, false);
+    return true;
+  }
+
+  if (base::ContentsEqual(temp_path, file_path)) {
+    base::DeleteFile(temp_path, false);
+  } else if (!base::ReplaceFile(temp_path, file_path, nullptr)) {
+    base::DeleteFile(temp_path, false);
+    if (err) {
+      *err = Err(Location(), "Unable to write file.",
+                 "I was writing \"" + FilePathToUTF8(file_path) + "\".");
+    }
+    return false;
+  }
+  RecordFile(key, file_path, buffer.hash(), buffer.size());
+  return true;
+}
+
+bool NinjaFileManifest::KeepFileIfUnchanged(const base::FilePath& file_path) {
+  std::string key = GetKey(file_path);
+  Ticks last_modified = 0;
+  uint64_t size = 0;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = entries_.find(key);
+    if (found == entries_.end())
+      return false;
+    last_modified = found->second.last_modified;
+    size = found->second.size;
+  }
+
+  base::File::Info info;
+  if (!base::GetFileInfo(file_path, &info) || info.is_directory ||
+      static_cast<uint64_t>(info.size) != size ||
+      info.last_modified != last_modified)
+    return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[key].used = true;
+  skipped_count_++;
+  return true;
+}
+
+// static
+uint64_t NinjaFileManifest::HashContents(const StringOutputBuffer& contents) {
+  std::vector<std::string_view> pages;
+  contents.AppendPageViews(&pages);
+  uint64_t hash = 0;
+  for (std::string_view page : pages)
+    hash = HashBytes(page, hash);
+  return hash;
+}
+
+int NinjaFileManifest::skipped_count() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return skipped_count_;
+}
+
+int NinjaFileManifest::checked_count() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return checked_count_;
+}
+
+bool NinjaFileManifest::KeepFileIfRecorded(const std::string& key,
+                                           const base::FilePath& file_path,
+                                           uint64_t hash,
+                                           uint64_t size) {
+  Entry old_entry;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = entries_.find(key);
+    if (found == entries_.end())
+      return false;
+    old_entry = found->second;
+  }
+
+  // A file with the recorded contents is only trusted if it still has the
+  // size and modification time it had when it was recorded.
+  base::File::Info info;
+  if (old_entry.hash != hash || old_entry.size != size ||
+      !base::GetFileInfo(file_path, &info) || info.is_directory ||
+      static_cast<uint64_t>(info.size) != size ||
+      info.last_modified != old_entry.last_modified)
+    return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[key].used = true;
+  skipped_count_++;
+  return true;
+}
+
+void NinjaFileManifest::RecordFile(const std::string& key,
+                                   const base::FilePath& file_path,
+                                   uint64_t hash,
+                                   uint64_t size) {
+  base::File::Info info;
+  bool recorded = base::GetFileInfo(file_path, &info);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  checked_count_++;
+  if (recorded) {
+    Entry& entry = entries_[key];
+    entry.hash = hash;
+    entry.size = size;
+    entry.last_modified = info.last_modified;
+    entry.used = true;
+  }
+  // Otherwise the entry isn't saved, and the next run compares the contents.
+}
+
+std::string NinjaFileManifest::GetKey(const base::FilePath& file_path) const {
+  std::string path = FilePathToUTF8(file_path);
+  std::string build_dir = FilePathToUTF8(build_dir_);
+  if (!build_dir.empty() && !EndsWithSlash(build_dir))
+    build_dir.push_back('/');
+  if (path.compare(0, build_dir.size(), build_dir) == 0)
+    path.erase(0, build_dir.size());
+  return path;
+}
@@ -0,0 +1,121 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_NINJA_FILE_MANIFEST_H_
+#define TOOLS_GN_NINJA_FILE_MANIFEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "base/files/file_path.h"
+#include "util/ticks.h"
+
+class Err;
+class StringOutputBuffer;
+
+// Records the hash, size and modification time of the ninja files written by
+// "gn gen", in a file in the build directory, so that the next run can tell
+// which files already have the right contents without reading them.
+//
+// Most regenerations leave most ninja files unchanged. Comparing each new
+// file with the old one means reading hundreds of thousands of files. With
+// the manifest, a file whose new contents hash to the recorded value only
+// needs a stat() to check that it wasn't modified or deleted since. Files
+// that don't match fall back to comparing the contents.
+//
+// Entries for files not written by a run are dropped when it saves the
+// manifest.
+//
+// This class is threadsafe.
+class NinjaFileManifest {
+ public:
+  // Name of the manifest file in the build directory.
+  static const char kFileName[];
+
+  explicit NinjaFileManifest(const base::FilePath& build_dir);
+  ~NinjaFileManifest();
+
+  // Reads the entries saved by a previous run, if any. A missing or
+  // malformed file leaves the manifest empty.
+  void Load();
+
+  // Writes the entries for the files written by this run. Returns false on
+  // failure.
+  bool Save() const;
+
+  // Writes |contents| to |file_path| unless the file already has them.
+  // Returns false and sets |err| if given on failure.
+  bool WriteFileIfChanged(const base::FilePath& file_path,
+                          const StringOutputBuffer& contents,
+                          Err* err);
+
+  // Like the above, for contents too large to be assembled in memory.
+  // |write| streams them to a temporary file next to |file_path|, which then
+  // replaces the file unless it already has the same contents. |write|
+  // returns false on failure.
+  bool WriteFileIfChanged(const base::FilePath& file_path,
+                          const std::function<bool(std::ostream&)>& write,
+                          Err* err);
+
+  // Returns true if |file_path| still is as recorded by the previous run,
+  // which then counts as having written it: its entry is kept. Used for files
+  // whose contents are known to be unchanged without generating them again.
+  bool KeepFileIfUnchanged(const base::FilePath& file_path);
+
+  // Returns the hash of |contents| recorded in the manifest.
+  static uint64_t HashContents(const StringOutputBuffer& contents);
+
+  // The number of files written so far that were skipped thanks to the
+  // manifest, and the number that were compared or written.
+  int skipped_count() const;
+  int checked_count() const;
+
+ private:
+  struct Entry {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    Ticks last_modified = 0;
+
+    // Set when the file is written by this run.
+    bool used = false;
+  };
+
+  // Returns the key of |file_path| in |entries_|, relative to the build
+  // directory when it is in it.
+  std::string GetKey(const base::FilePath& file_path) const;
+
+  // Returns true, and keeps the entry, if |file_path| is recorded with |hash|
+  // and |size| and wasn't modified since.
+  bool KeepFileIfRecorded(const std::string& key,
+                          const base::FilePath& file_path,
+                          uint64_t hash,
+                          uint64_t size);
+
+  // Records that |file_path| was just compared or written with contents of
+  // |hash| and |size|.
+  void RecordFile(const std::string& key,
+                  const base::FilePath& file_path,
+                  uint64_t hash,
+                  uint64_t size);
+
+  base::FilePath build_dir_;
+  base::FilePath manifest_file_;
+
+  mutable std::mutex lock_;
+  std::unordered_map<std::string, Entry> entries_;
+  int skipped_count_ = 0;
+  int checked_count_ = 0;
+
+  NinjaFileManifest(const NinjaFileManifest&) = delete;
+  NinjaFileManifest& operator=(const NinjaFileManifest&) = delete;
+};
+
+#endif  // TOOLS_GN_NINJA_FILE_MANIFEST_H_
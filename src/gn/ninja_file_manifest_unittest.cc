@@ -0,0 +1,178 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_file_manifest.h"
+
+#include <ostream>
+#include <string>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/string_output_buffer.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::string ReadFile(const base::FilePath& path) {
+  std::string contents;
+  base::ReadFileToString(path, &contents);
+  return contents;
+}
+
+}  // namespace
+
+TEST(NinjaFileManifest, SkipsUnchangedFiles) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file = temp_dir.GetPath().AppendASCII("foo.ninja");
+
+  StringOutputBuffer contents;
+  std::ostream(&contents) << "build foo: stamp\n";
+
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, contents, nullptr));
+    EXPECT_EQ(0, manifest.skipped_count());
+    EXPECT_EQ(1, manifest.checked_count());
+    EXPECT_TRUE(manifest.Save());
+  }
+  EXPECT_EQ("build foo: stamp\n", ReadFile(file));
+
+  // The next run trusts the recorded hash.
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, contents, nullptr));
+    EXPECT_EQ(1, manifest.skipped_count());
+    EXPECT_EQ(0, manifest.checked_count());
+    EXPECT_TRUE(manifest.Save());
+  }
+
+  // Unless the file was modified since.
+  base::WriteFile(file, "modified", 8);
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, contents, nullptr));
+    EXPECT_EQ(0, manifest.skipped_count());
+    EXPECT_EQ(1, manifest.checked_count());
+    EXPECT_TRUE(manifest.Save());
+  }
+  EXPECT_EQ("build foo: stamp\n", ReadFile(file));
+
+  // New contents are always written.
+  StringOutputBuffer new_contents;
+  std::ostream(&new_contents) << "build bar: stamp\n";
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, new_contents, nullptr));
+    EXPECT_EQ(0, manifest.skipped_count());
+    EXPECT_EQ(1, manifest.checked_count());
+  }
+  EXPECT_EQ("build bar: stamp\n", ReadFile(file));
+}
+
+TEST(NinjaFileManifest, SaveKeepsWrittenFiles) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath foo = temp_dir.GetPath().AppendASCII("foo.ninja");
+  base::FilePath bar = temp_dir.GetPath().AppendASCII("bar bar.ninja");
+
+  StringOutputBuffer contents;
+  std::ostream(&contents) << "build foo: stamp\n";
+
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    ASSERT_TRUE(manifest.WriteFileIfChanged(foo, contents, nullptr));
+    ASSERT_TRUE(manifest.WriteFileIfChanged(bar, contents, nullptr));
+    EXPECT_TRUE(manifest.Save());
+  }
+
+  // Only write foo.ninja. The entry for bar.ninja is dropped.
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(foo, contents, nullptr));
+    EXPECT_EQ(1, manifest.skipped_count());
+    EXPECT_TRUE(manifest.Save());
+  }
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(bar, contents, nullptr));
+    ASSERT_TRUE(manifest.WriteFileIfChanged(foo, contents, nullptr));
+    EXPECT_EQ(1, manifest.skipped_count());
+    EXPECT_EQ(1, manifest.checked_count());
+  }
+
+  // A malformed manifest is ignored.
+  base::FilePath manifest_file =
+      temp_dir.GetPath().AppendASCII(NinjaFileManifest::kFileName);
+  base::WriteFile(manifest_file, "garbage\n", 8);
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(foo, contents, nullptr));
+    EXPECT_EQ(0, manifest.skipped_count());
+  }
+}
+
+TEST(NinjaFileManifest, StreamedContents) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file = temp_dir.GetPath().AppendASCII("foo.ninja");
+
+  // More than two pages.
+  std::string line = "build foo: stamp\n";
+  std::string text;
+  while (text.size() < 2 * StringOutputBuffer::kPageSize + 100)
+    text += line;
+  auto write = [&text](std::ostream& out) {
+    out << text;
+    return true;
+  };
+
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, write, nullptr));
+    EXPECT_EQ(1, manifest.checked_count());
+    EXPECT_TRUE(manifest.Save());
+  }
+  EXPECT_EQ(text, ReadFile(file));
+
+  // The hash is the same as for the contents held in memory.
+  StringOutputBuffer contents;
+  std::ostream(&contents) << text;
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, contents, nullptr));
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, write, nullptr));
+    EXPECT_EQ(2, manifest.skipped_count());
+    EXPECT_EQ(0, manifest.checked_count());
+  }
+
+  // Modified files are replaced, failed writes leave them alone, and no
+  // temporary file is left behind.
+  base::WriteFile(file, "modified", 8);
+  {
+    NinjaFileManifest manifest(temp_dir.GetPath());
+    manifest.Load();
+    ASSERT_TRUE(manifest.WriteFileIfChanged(file, write, nullptr));
+    EXPECT_EQ(1, manifest.checked_count());
+    EXPECT_FALSE(manifest.WriteFileIfChanged(
+        file, [](std::ostream& out) { return false; }, nullptr));
+  }
+  EXPECT_EQ(text, ReadFile(file));
+  int file_count = 0;
+  base::FileEnumerator files(temp_dir.GetPath(), false,
+                             base::FileEnumerator::FILES);
+  for (base::FilePath path = files.Next(); !path.empty(); path = files.Next())
+    file_count++;
+  EXPECT_EQ(2, file_count);  // foo.ninja and the manifest.
+}
@@ -0,0 +1,273 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_rule_spool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <queue>
+#include <string_view>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "gn/memory_stats.h"
+#include "gn/target.h"
+
+namespace {
+
+// Spilled rules are read back in blocks of at least this size.
+constexpr size_t kReadBlockBytes = 64 * 1024;
+
+std::atomic<uint64_t> next_spool_id{1};
+
+// The buffer of the current thread in the spool it was last used with. Spool
+// ids are never reused, so a stale entry can't match a new spool.
+struct CachedThreadBuffer {
+  uint64_t spool_id = 0;
+  void* buffer = nullptr;
+};
+thread_local CachedThreadBuffer cached_thread_buffer;
+
+using PendingRule = std::pair<const Target*, std::string>;
+
+bool LabelLess(const Target* a, const Target* b) {
+  return a->label() < b->label();
+}
+
+// Where a spilled rule is in the temporary file.
+struct SpilledRule {
+  const Target* target;
+  int64_t offset;
+  size_t size;
+};
+
+// Rules of one toolchain spilled together, sorted by label and stored one
+// after the other.
+using Segment = std::vector<SpilledRule>;
+
+// Reads the rules of one segment, or of the rules still in memory, in order.
+class RuleCursor {
+ public:
+  RuleCursor(base::File* file, const Segment* segment)
+      : file_(file), segment_(segment) {}
+  explicit RuleCursor(const std::vector<PendingRule>* pending)
+      : pending_(pending) {}
+
+  bool done() const {
+    return index_ == (segment_ ? segment_->size() : pending_->size());
+  }
+
+  const Target* target() const {
+    return segment_ ? (*segment_)[index_].target : (*pending_)[index_].first;
+  }
+
+  // Returns the current rule and moves to the next one.
+  bool Next(std::string_view* rule) {
+    if (!segment_) {
+      *rule = (*pending_)[index_++].second;
+      return true;
+    }
+
+    const SpilledRule& spilled = (*segment_)[index_++];
+    if (spilled.offset < block_offset_ ||
+        spilled.offset + static_cast<int64_t>(spilled.size) >
+            block_offset_ + static_cast<int64_t>(block_.size())) {
+      // Read up to the end of the segment, since the rules are contiguous.
+      const SpilledRule& last = segment_->back();
+      int64_t segment_end = last.offset + static_cast<int64_t>(last.size);
+      size_t size = static_cast<size_t>(
+          std::min<int64_t>(segment_end - spilled.offset,
+                            std::max(kReadBlockBytes, spilled.size)));
+      block_.resize(size);
+      block_offset_ = spilled.offset;
+      if (size > 0 && file_->Read(block_offset_, block_.data(),
+                                  static_cast<int>(size)) !=
+                          static_cast<int>(size))
+        return false;
+    }
+    *rule = std::string_view(block_.data() + (spilled.offset - block_offset_),
+                             spilled.size);
+    return true;
+  }
+
+ private:
+  base::File* file_ = nullptr;
+  const Segment* segment_ = nullptr;
+  const std::vector<PendingRule>* pending_ = nullptr;
+  size_t index_ = 0;
+
+  std::string block_;
+  int64_t block_offset_ = 0;
+};
+
+}  // namespace
+
+struct NinjaRuleSpool::ThreadBuffer {
+  // Rules not spilled yet.
+  std::map<const Toolchain*, std::vector<PendingRule>> pending;
+  size_t pending_bytes = 0;
+
+  std::map<const Toolchain*, std::vector<Segment>> segments;
+  size_t rule_count = 0;
+
+  base::FilePath file_path;
+  base::File file;
+  int64_t file_size = 0;
+
+  // Set once spilling failed, after which rules stay in memory.
+  bool spill_failed = false;
+};
+
+NinjaRuleSpool::NinjaRuleSpool(const base::FilePath& spill_dir,
+                               size_t chunk_bytes)
+    : id_(next_spool_id.fetch_add(1, std::memory_order_relaxed)),
+      spill_dir_(spill_dir),
+      chunk_bytes_(chunk_bytes) {}
+
+NinjaRuleSpool::~NinjaRuleSpool() {
+  for (const auto& buffer : buffers_) {
+    if (buffer->file_path.empty())
+      continue;
+    buffer->file.Close();
+    base::DeleteFile(buffer->file_path, false);
+  }
+}
+
+NinjaRuleSpool::ThreadBuffer* NinjaRuleSpool::GetThreadBuffer() {
+  if (cached_thread_buffer.spool_id != id_) {
+    std::lock_guard<std::mutex> lock(lock_);
+    buffers_.push_back(std::make_unique<ThreadBuffer>());
+    cached_thread_buffer.spool_id = id_;
+    cached_thread_buffer.buffer = buffers_.back().get();
+  }
+  return static_cast<ThreadBuffer*>(cached_thread_buffer.buffer);
+}
+
+void NinjaRuleSpool::Add(const Target* target, std::string rule) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  buffer->pending_bytes += rule.size();
+  buffer->rule_count++;
+  buffer->pending[target->toolchain()].emplace_back(target, std::move(rule));
+  if (buffer->pending_bytes >= chunk_bytes_ && !buffer->spill_failed)
+    Spill(buffer);
+}
+
+void NinjaRuleSpool::Spill(ThreadBuffer* buffer) {
+  if (!buffer->file.IsValid()) {
+    buffer->file = base::CreateAndOpenTemporaryFileInDir(spill_dir_,
+                                                         &buffer->file_path);
+    if (!buffer->file.IsValid()) {
+      buffer->spill_failed = true;
+      return;
+    }
+  }
+
+  // Write the rules of every toolchain as one block, then record where each
+  // rule went once the write succeeded.
+  std::string block;
+  block.reserve(buffer->pending_bytes);
+  for (auto& [toolchain, rules] : buffer->pending) {
+    std::sort(rules.begin(), rules.end(),
+              [](const PendingRule& a, const PendingRule& b) {
+                return LabelLess(a.first, b.first);
+              });
+    for (const PendingRule& rule : rules)
+      block.append(rule.second);
+  }
+  if (buffer->file.Write(buffer->file_size, block.data(),
+                         static_cast<int>(block.size())) !=
+      static_cast<int>(block.size())) {
+    buffer->spill_failed = true;
+    return;
+  }
+
+  int64_t offset = buffer->file_size;
+  int64_t heap_bytes = 0;
+  for (auto& [toolchain, rules] : buffer->pending) {
+    Segment& segment = buffer->segments[toolchain].emplace_back();
+    segment.reserve(rules.size());
+    for (const PendingRule& rule : rules) {
+      segment.push_back({rule.first, offset, rule.second.size()});
+      offset += static_cast<int64_t>(rule.second.size());
+      heap_bytes += StringHeapBytes(rule.second);
+    }
+  }
+  buffer->file_size = offset;
+  buffer->pending.clear();
+  buffer->pending_bytes = 0;
+  if (MemoryStatsEnabled())
+    AddPendingNinjaBytes(-heap_bytes);
+}
+
+size_t NinjaRuleSpool::GetRuleCount() const {
+  size_t count = 0;
+  for (const auto& buffer : buffers_)
+    count += buffer->rule_count;
+  return count;
+}
+
+std::vector<const Toolchain*> NinjaRuleSpool::GetToolchains() const {
+  std::vector<const Toolchain*> toolchains;
+  for (const auto& buffer : buffers_) {
+    for (const auto& pair : buffer->pending)
+      toolchains.push_back(pair.first);
+    for (const auto& pair : buffer->segments)
+      toolchains.push_back(pair.first);
+  }
+  std::sort(toolchains.begin(), toolchains.end());
+  toolchains.erase(std::unique(toolchains.begin(), toolchains.end()),
+                   toolchains.end());
+  return toolchains;
+}
+
+int64_t NinjaRuleSpool::GetSpilledBytes() const {
+  int64_t bytes = 0;
+  for (const auto& buffer : buffers_)
+    bytes += buffer->file_size;
+  return bytes;
+}
+
+bool NinjaRuleSpool::WriteRules(const Toolchain* toolchain, std::ostream& out) {
+  std::vector<RuleCursor> cursors;
+  for (const auto& buffer : buffers_) {
+    auto segments = buffer->segments.find(toolchain);
+    if (segments != buffer->segments.end()) {
+      for (const Segment& segment : segments->second)
+        cursors.emplace_back(&buffer->file, &segment);
+    }
+    auto pending = buffer->pending.find(toolchain);
+    if (pending != buffer->pending.end()) {
+      std::sort(pending->second.begin(), pending->second.end(),
+                [](const PendingRule& a, const PendingRule& b) {
+                  return LabelLess(a.first, b.first);
+                });
+      cursors.emplace_back(&pending->second);
+    }
+  }
+
+  // Merge the sorted cursors, taking the smallest label first.
+  auto greater = [&cursors](size_t a, size_t b) {
+    return LabelLess(cursors[b].target(), cursors[a].target());
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(
+      greater);
+  for (size_t i = 0; i < cursors.size(); i++) {
+    if (!cursors[i].done())
+      heap.push(i);
+  }
+  while (!heap.empty()) {
+    size_t i = heap.top();
+    heap.pop();
+    std::string_view rule;
+    if (!cursors[i].Next(&rule))
+      return false;
+    out << rule;
+    if (!cursors[i].done())
+      heap.push(i);
+  }
+  return true;
+}
@@ -0,0 +1,79 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_NINJA_RULE_SPOOL_H_
+#define TOOLS_GN_NINJA_RULE_SPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+
+class Target;
+class Toolchain;
+
+// Collects the ninja rules of targets for the toolchain files without holding
+// all of them in memory, as an alternative to NinjaWriter::PerToolchainRules.
+//
+// Every thread adding rules has its own buffer. When the rules in it exceed
+// the chunk size, they are sorted by label and appended to a temporary file
+// of that thread as one segment per toolchain. WriteRules() merges the
+// segments and what is still buffered in label order, so the toolchain files
+// come out the same as when all rules are sorted in memory.
+//
+// Only the rule text is spilled: the location of every rule is kept in
+// memory, which is a few words per target.
+class NinjaRuleSpool {
+ public:
+  // Temporary files go in |spill_dir| and are deleted by the destructor.
+  // Each thread buffers up to about |chunk_bytes| of rules.
+  NinjaRuleSpool(const base::FilePath& spill_dir, size_t chunk_bytes);
+  ~NinjaRuleSpool();
+
+  // Adds the rule for |target| to the file of its toolchain. The rule may be
+  // empty, the toolchain file is written anyway. Can be called on any thread.
+  void Add(const Target* target, std::string rule);
+
+  // The following must not be called concurrently with Add().
+
+  // Returns the number of rules added.
+  size_t GetRuleCount() const;
+
+  // Returns the toolchains rules were added for.
+  std::vector<const Toolchain*> GetToolchains() const;
+
+  // Returns the number of bytes of rules written to temporary files.
+  int64_t GetSpilledBytes() const;
+
+  // Writes the rules of |toolchain| to |out| in label order. Returns false if
+  // reading back spilled rules failed.
+  bool WriteRules(const Toolchain* toolchain, std::ostream& out);
+
+ private:
+  struct ThreadBuffer;
+
+  ThreadBuffer* GetThreadBuffer();
+
+  // Moves the rules in |buffer| to its temporary file. If that fails they stay
+  // in memory.
+  void Spill(ThreadBuffer* buffer);
+
+  const uint64_t id_;
+  const base::FilePath spill_dir_;
+  const size_t chunk_bytes_;
+
+  std::mutex lock_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;  // Protected by lock_.
+
+  NinjaRuleSpool(const NinjaRuleSpool&) = delete;
+  NinjaRuleSpool& operator=(const NinjaRuleSpool&) = delete;
+};
+
+#endif  // TOOLS_GN_NINJA_RULE_SPOOL_H_
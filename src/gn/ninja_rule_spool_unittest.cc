@@ -0,0 +1,143 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/ninja_rule_spool.h"
+#include "gn/target.h"
+#include "gn/test_with_scope.h"
+#include "gn/toolchain.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::unique_ptr<Target> MakeTarget(const Settings* settings,
+                                   const Toolchain* toolchain,
+                                   int i) {
+  auto target = std::make_unique<Target>(
+      settings, Label(SourceDir("//dir" + std::to_string(i % 7) + "/"),
+                      "t" + std::to_string(i), toolchain->label().dir(),
+                      toolchain->label().name()));
+  target->set_output_type(Target::GROUP);
+  target->SetToolchain(toolchain);
+  return target;
+}
+
+std::string RuleFor(int i) {
+  // Every fifth rule is empty, as for targets without a ninja file.
+  return i % 5 == 0 ? std::string()
+                    : "subninja obj/t" + std::to_string(i) + ".ninja\n";
+}
+
+int CountFiles(const base::FilePath& dir) {
+  int count = 0;
+  base::FileEnumerator files(dir, false, base::FileEnumerator::FILES);
+  for (base::FilePath path = files.Next(); !path.empty(); path = files.Next())
+    count++;
+  return count;
+}
+
+}  // namespace
+
+TEST(NinjaRuleSpool, MergesInLabelOrder) {
+  TestWithScope setup;
+  Toolchain other_toolchain(setup.settings(),
+                            Label(SourceDir("//tc/"), "other"));
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const int kTargets = 200;
+  std::vector<std::unique_ptr<Target>> targets;
+  for (int i = 0; i < kTargets; i++) {
+    targets.push_back(MakeTarget(
+        setup.settings(), i % 3 ? setup.toolchain() : &other_toolchain, i));
+  }
+
+  // The reference output is all rules of a toolchain sorted by label.
+  auto expected_for = [&targets](const Toolchain* toolchain) {
+    std::vector<const Target*> sorted;
+    for (const auto& target : targets) {
+      if (target->toolchain() == toolchain)
+        sorted.push_back(target.get());
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Target* a, const Target* b) {
+                return a->label() < b->label();
+              });
+    std::string expected;
+    for (const Target* target : sorted)
+      expected += RuleFor(std::stoi(target->label().name().substr(1)));
+    return expected;
+  };
+
+  {
+    // A tiny chunk size, so nearly every rule is spilled, from a few threads
+    // adding interleaved rules.
+    NinjaRuleSpool spool(temp_dir.GetPath(), 64);
+    std::vector<std::thread> threads;
+    const int kThreads = 3;
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&spool, &targets, t]() {
+        for (int i = t; i < kTargets; i += kThreads)
+          spool.Add(targets[i].get(), RuleFor(i));
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+
+    EXPECT_EQ(static_cast<size_t>(kTargets), spool.GetRuleCount());
+    EXPECT_LT(0, spool.GetSpilledBytes());
+    EXPECT_EQ(2u, spool.GetToolchains().size());
+
+    for (const Toolchain* toolchain : {setup.toolchain(), &other_toolchain}) {
+      std::ostringstream out;
+      ASSERT_TRUE(spool.WriteRules(toolchain, out));
+      EXPECT_EQ(expected_for(toolchain), out.str());
+    }
+  }
+  // The temporary files are gone with the spool.
+  EXPECT_EQ(0, CountFiles(temp_dir.GetPath()));
+
+  {
+    // With a chunk size nothing reaches, all rules stay in memory.
+    NinjaRuleSpool spool(temp_dir.GetPath(), 1024 * 1024);
+    for (int i = kTargets - 1; i >= 0; i--)
+      spool.Add(targets[i].get(), RuleFor(i));
+    EXPECT_EQ(0, spool.GetSpilledBytes());
+    EXPECT_EQ(0, CountFiles(temp_dir.GetPath()));
+
+    std::ostringstream out;
+    ASSERT_TRUE(spool.WriteRules(setup.toolchain(), out));
+    EXPECT_EQ(expected_for(setup.toolchain()), out.str());
+  }
+}
+
+TEST(NinjaRuleSpool, EmptyRules) {
+  TestWithScope setup;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // A toolchain whose targets only have empty rules is still reported, so its
+  // toolchain file gets written.
+  NinjaRuleSpool spool(temp_dir.GetPath(), 1);
+  std::unique_ptr<Target> target =
+      MakeTarget(setup.settings(), setup.toolchain(), 0);
+  spool.Add(target.get(), std::string());
+
+  std::vector<const Toolchain*> toolchains = spool.GetToolchains();
+  ASSERT_EQ(1u, toolchains.size());
+  EXPECT_EQ(setup.toolchain(), toolchains[0]);
+
+  std::ostringstream out;
+  ASSERT_TRUE(spool.WriteRules(setup.toolchain(), out));
+  EXPECT_EQ("", out.str());
+}
@@ -8,6 +8,7 @@
 #include <string_view>
 
 #include "base/json/string_escape.h"
+#include "gn/config_fragment_cache.h"
 #include "gn/config_values_extractors.h"
 #include "gn/escape.h"
 #include "gn/filesystem_utils.h"
@@ -26,6 +27,16 @@ struct DefineWriter {
     EscapeStringToStream(out, "-D" + s, options);
   }
 
+  // For RecursiveTargetConfigToStreamCached().
+  ConfigFragmentKey GetFragmentKey() const {
+    ConfigFragmentKey key;
+    key.writer = kFragmentWriter;
+    key.options = options;
+    return key;
+  }
+
+  static constexpr char kFragmentWriter[] = "define";
+
   EscapeOptions options;
 };
 
@@ -98,6 +109,19 @@ struct IncludeWriter {
       out << " -I" << path;
   }
 
+  // For RecursiveTargetConfigToStreamCached().
+  ConfigFragmentKey GetFragmentKey() const {
+    ConfigFragmentKey key;
+    key.writer = kFragmentWriter;
+    key.options.mode = path_output_.escaping_mode();
+    key.options.platform = path_output_.escape_platform();
+    key.options.inhibit_quoting = path_output_.inhibit_quoting();
+    key.current_dir = path_output_.current_dir().value();
+    return key;
+  }
+
+  static constexpr char kFragmentWriter[] = "include";
+
   PathOutput& path_output_;
 };
 
@@ -20,6 +20,7 @@
 #include "gn/ninja_bundle_data_target_writer.h"
 #include "gn/ninja_copy_target_writer.h"
 #include "gn/ninja_create_bundle_target_writer.h"
+#include "gn/ninja_file_manifest.h"
 #include "gn/ninja_generated_file_target_writer.h"
 #include "gn/ninja_group_target_writer.h"
 #include "gn/ninja_target_command_util.h"
@@ -102,9 +103,14 @@ std::string NinjaTargetWriter::RunAndWriteFile(
     std::vector<OutputFile>* ninja_outputs) {
   const Settings* settings = target->settings();
 
-  ScopedTrace trace(TraceItem::TRACE_FILE_WRITE_NINJA,
-                    target->label().GetUserVisibleName(false));
+  ScopedTrace trace(TraceItem::TRACE_FILE_WRITE_NINJA, target->label());
   trace.SetToolchain(settings->toolchain_label());
+  if (TracingEnabled()) {
+    trace.AddFlow(TraceItem::FLOW_END, target->label());
+    trace.AddArg("type",
+                 Target::GetStringForOutputType(target->output_type()));
+    trace.AddArg("sources", static_cast<int64_t>(target->sources().size()));
+  }
 
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Computing", target->label().GetUserVisibleName(true));
@@ -171,12 +177,20 @@ std::string NinjaTargetWriter::RunAndWriteFile(
     CHECK(0) << "Output type of target not handled.";
   }
 
+  if (TracingEnabled())
+    trace.AddArg("bytes", static_cast<int64_t>(storage.size()));
+
   if (needs_file_write) {
     // Write the ninja file.
     SourceFile ninja_file = GetNinjaFileForTarget(target);
     base::FilePath full_ninja_file =
         settings->build_settings()->GetFullPath(ninja_file);
-    storage.WriteToFileIfChanged(full_ninja_file, nullptr);
+    if (NinjaFileManifest* manifest =
+            settings->build_settings()->ninja_file_manifest()) {
+      manifest->WriteFileIfChanged(full_ninja_file, storage, nullptr);
+    } else {
+      storage.WriteToFileIfChanged(full_ninja_file, nullptr);
+    }
 
     EscapeOptions options;
     options.mode = ESCAPE_NINJA;
@@ -269,9 +283,10 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     if (indent)
       out_ << "  ";
     out_ << CSubstitutionDefines.ninja_name << " =";
-    RecursiveTargetConfigToStream<std::string>(kRecursiveWriterSkipDuplicates,
-                                               target_, &ConfigValues::defines,
-                                               DefineWriter(), out_);
+    DefineWriter define_writer;
+    RecursiveTargetConfigToStreamCached<std::string>(
+        kRecursiveWriterSkipDuplicates, target_, &ConfigValues::defines,
+        define_writer, define_writer.GetFragmentKey(), out_);
     out_ << std::endl;
   }
 
@@ -301,9 +316,10 @@ void NinjaTargetWriter::WriteCCompilerVars(const SubstitutionBits& bits,
     PathOutput include_path_output(
         path_output_.current_dir(),
         settings_->build_settings()->root_path_utf8(), ESCAPE_NINJA_COMMAND);
-    RecursiveTargetConfigToStream<SourceDir>(
+    IncludeWriter include_writer(include_path_output);
+    RecursiveTargetConfigToStreamCached<SourceDir>(
         kRecursiveWriterSkipDuplicates, target_, &ConfigValues::include_dirs,
-        IncludeWriter(include_path_output), out_);
+        include_writer, include_writer.GetFragmentKey(), out_);
     out_ << std::endl;
   }
 
@@ -13,9 +13,12 @@
 #include "gn/c_tool.h"
 #include "gn/filesystem_utils.h"
 #include "gn/general_tool.h"
+#include "gn/ninja_file_manifest.h"
+#include "gn/ninja_rule_spool.h"
 #include "gn/ninja_utils.h"
 #include "gn/pool.h"
 #include "gn/settings.h"
+#include "gn/string_output_buffer.h"
 #include "gn/substitution_writer.h"
 #include "gn/target.h"
 #include "gn/toolchain.h"
@@ -41,6 +44,12 @@ NinjaToolchainWriter::~NinjaToolchainWriter() = default;
 
 void NinjaToolchainWriter::Run(
     const std::vector<NinjaWriter::TargetRulePair>& rules) {
+  WriteRules();
+  for (const auto& pair : rules)
+    out_ << pair.second;
+}
+
+void NinjaToolchainWriter::WriteRules() {
   std::string rule_prefix = GetNinjaRulePrefixForToolchain(settings_);
 
   for (const auto& tool : toolchain_->tools()) {
@@ -51,9 +60,6 @@ void NinjaToolchainWriter::Run(
     WriteToolRule(tool.second.get(), rule_prefix);
   }
   out_ << std::endl;
-
-  for (const auto& pair : rules)
-    out_ << pair.second;
 }
 
 // static
@@ -68,6 +74,16 @@ bool NinjaToolchainWriter::RunAndWriteFile(
 
   base::CreateDirectory(ninja_file.DirName());
 
+  // With a manifest, the file is only rewritten if its contents changed.
+  if (NinjaFileManifest* manifest =
+          settings->build_settings()->ninja_file_manifest()) {
+    StringOutputBuffer storage;
+    std::ostream out(&storage);
+    NinjaToolchainWriter gen(settings, toolchain, out);
+    gen.Run(rules);
+    return manifest->WriteFileIfChanged(ninja_file, storage, nullptr);
+  }
+
   std::ofstream file;
   file.open(FilePathToUTF8(ninja_file).c_str(),
             std::ios_base::out | std::ios_base::binary);
@@ -79,6 +95,36 @@ bool NinjaToolchainWriter::RunAndWriteFile(
   return true;
 }
 
+// static
+bool NinjaToolchainWriter::RunAndWriteFile(const Settings* settings,
+                                           const Toolchain* toolchain,
+                                           NinjaRuleSpool* spool) {
+  base::FilePath ninja_file(settings->build_settings()->GetFullPath(
+      GetNinjaFileForToolchain(settings)));
+  ScopedTrace trace(TraceItem::TRACE_FILE_WRITE_NINJA,
+                    FilePathToUTF8(ninja_file));
+
+  base::CreateDirectory(ninja_file.DirName());
+
+  auto write = [settings, toolchain, spool](std::ostream& out) {
+    NinjaToolchainWriter gen(settings, toolchain, out);
+    gen.WriteRules();
+    return spool->WriteRules(toolchain, out) && !out.fail();
+  };
+
+  // The rules are streamed from the spool rather than assembled in memory.
+  if (NinjaFileManifest* manifest =
+          settings->build_settings()->ninja_file_manifest())
+    return manifest->WriteFileIfChanged(ninja_file, write, nullptr);
+
+  std::ofstream file;
+  file.open(FilePathToUTF8(ninja_file).c_str(),
+            std::ios_base::out | std::ios_base::binary);
+  if (file.fail())
+    return false;
+  return write(file);
+}
+
 void NinjaToolchainWriter::WriteToolRule(Tool* tool,
                                          const std::string& rule_prefix) {
   out_ << "rule " << rule_prefix << tool->name() << std::endl;
@@ -16,6 +16,7 @@
 #include "gn/toolchain.h"
 
 struct EscapeOptions;
+class NinjaRuleSpool;
 class Settings;
 class Tool;
 
@@ -28,6 +29,11 @@ class NinjaToolchainWriter {
       const Toolchain* toolchain,
       const std::vector<NinjaWriter::TargetRulePair>& rules);
 
+  // Like the above but takes the rules of the targets from |spool|.
+  static bool RunAndWriteFile(const Settings* settings,
+                              const Toolchain* toolchain,
+                              NinjaRuleSpool* spool);
+
  private:
   FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, WriteToolRule);
   FRIEND_TEST_ALL_PREFIXES(NinjaToolchainWriter, WriteToolRuleWithLauncher);
@@ -39,6 +45,7 @@ class NinjaToolchainWriter {
 
   void Run(const std::vector<NinjaWriter::TargetRulePair>& extra_rules);
 
+  // Writes the rules for the tools of the toolchain.
   void WriteRules();
   void WriteToolRule(Tool* tool, const std::string& rule_prefix);
   void WriteRulePattern(const char* name,
@@ -8,6 +8,7 @@
 #include "gn/loader.h"
 #include "gn/location.h"
 #include "gn/ninja_build_writer.h"
+#include "gn/ninja_rule_spool.h"
 #include "gn/ninja_toolchain_writer.h"
 #include "gn/settings.h"
 #include "gn/target.h"
@@ -28,6 +29,18 @@ bool NinjaWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   return NinjaBuildWriter::RunAndWriteFile(build_settings, builder, err);
 }
 
+// static
+bool NinjaWriter::RunAndWriteFiles(const BuildSettings* build_settings,
+                                   const Builder& builder,
+                                   NinjaRuleSpool* spool,
+                                   Err* err) {
+  NinjaWriter writer(builder);
+
+  if (!writer.WriteToolchains(spool, err))
+    return false;
+  return NinjaBuildWriter::RunAndWriteFile(build_settings, builder, err);
+}
+
 bool NinjaWriter::WriteToolchains(const PerToolchainRules& per_toolchain_rules,
                                   Err* err) {
   if (per_toolchain_rules.empty()) {
@@ -49,3 +62,24 @@ bool NinjaWriter::WriteToolchains(const PerToolchainRules& per_toolchain_rules,
 
   return true;
 }
+
+bool NinjaWriter::WriteToolchains(NinjaRuleSpool* spool, Err* err) {
+  std::vector<const Toolchain*> toolchains = spool->GetToolchains();
+  if (toolchains.empty()) {
+    *err = Err(Location(), "No targets.",
+               "I could not find any targets to write, so I'm doing nothing.");
+    return false;
+  }
+
+  for (const Toolchain* toolchain : toolchains) {
+    const Settings* settings =
+        builder_.loader()->GetToolchainSettings(toolchain->label());
+    if (!NinjaToolchainWriter::RunAndWriteFile(settings, toolchain, spool)) {
+      *err =
+          Err(Location(), "Couldn't open toolchain buildfile(s) for writing");
+      return false;
+    }
+  }
+
+  return true;
+}
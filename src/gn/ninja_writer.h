@@ -13,6 +13,7 @@
 class Builder;
 class BuildSettings;
 class Err;
+class NinjaRuleSpool;
 class Target;
 class Toolchain;
 
@@ -33,11 +34,18 @@ class NinjaWriter {
                                const PerToolchainRules& per_toolchain_rules,
                                Err* err);
 
+  // Like the above but takes the rules from |spool|, see NinjaRuleSpool.
+  static bool RunAndWriteFiles(const BuildSettings* build_settings,
+                               const Builder& builder,
+                               NinjaRuleSpool* spool,
+                               Err* err);
+
  private:
   NinjaWriter(const Builder& builder);
   ~NinjaWriter();
 
   bool WriteToolchains(const PerToolchainRules& per_toolchain_rules, Err* err);
+  bool WriteToolchains(NinjaRuleSpool* spool, Err* err);
 
   const Builder& builder_;
 
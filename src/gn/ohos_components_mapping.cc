@@ -15,10 +15,12 @@
 #include "base/values.h"
 #include "gn/build_settings.h"
 #include "gn/config.h"
+#include "gn/file_system_cache.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
 #include "gn/ohos_components.h"
 #include "gn/parse_tree.h"
+#include "gn/scheduler.h"
 #include "gn/settings.h"
 #include "gn/substitution_writer.h"
 #include "gn/target.h"
@@ -40,7 +42,9 @@ static bool StartWith(const std::string &str, const std::string &prefix)
 const static std::string GetRealImportFile(const BuildSettings *settings, const std::string &path)
 {
     base::FilePath file = base::FilePath(settings->root_path().MaybeAsASCII() + path);
-    if (!base::PathExists(file)) {
+    FileSystemCache *file_system_cache = g_scheduler->file_system_cache();
+    AddFileSystemGenDependency(settings, file_system_cache->GetExistenceDependency(file), nullptr);
+    if (!file_system_cache->PathExists(file)) {
         return "";
     }
     return path;
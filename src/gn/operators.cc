@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 #include "base/strings/string_number_conversions.h"
 #include "gn/err.h"
@@ -54,10 +55,18 @@ class ValueDestination {
  private:
   enum Type { UNINITIALIZED, SCOPE, LIST };
 
+  // Returns the scope to write into when type_ == SCOPE.
+  Scope* GetScope() const;
+
   Type type_;
 
-  // Valid when type_ == SCOPE.
+  // Valid when type_ == SCOPE. For scope member accesses ("a.b = ...") the
+  // destination scope is owned by |scope_value_|. It's looked up through the
+  // value on each access rather than cached since the value's storage may be
+  // shared with a copy made while evaluating the right-hand side, in which
+  // case it has to be detached before being written to.
   Scope* scope_;
+  Value* scope_value_;
   const Token* name_token_;
 
   // Valid when type_ == LIST.
@@ -68,6 +77,7 @@ class ValueDestination {
 ValueDestination::ValueDestination()
     : type_(UNINITIALIZED),
       scope_(nullptr),
+      scope_value_(nullptr),
       name_token_(nullptr),
       list_(nullptr),
       index_(0) {}
@@ -96,7 +106,7 @@ bool ValueDestination::Init(Scope* exec_scope,
   }
 
   // Known to be an accessor.
-  std::string_view base_str = dest_accessor->base().value();
+  StringAtom base_str = dest_accessor->base().atom();
   Value* base =
       exec_scope->GetMutableValue(base_str, Scope::SEARCH_CURRENT, false);
   if (!base) {
@@ -113,7 +123,7 @@ bool ValueDestination::Init(Scope* exec_scope,
           "\n"
           "If you really wanted to do this, do:\n"
           "  " +
-              std::string(base_str) + " = " + std::string(base_str) +
+              base_str.str() + " = " + base_str.str() +
               "\n"
               "to copy it into the current scope before doing this operation.");
     } else {
@@ -135,7 +145,7 @@ bool ValueDestination::Init(Scope* exec_scope,
     type_ = LIST;
     list_ = base;
     return dest_accessor->ComputeAndValidateListIndex(
-        exec_scope, base->list_value().size(), &index_, err);
+        exec_scope, std::as_const(*base).list_value().size(), &index_, err);
   }
 
   // Scope access with a dot.
@@ -145,28 +155,34 @@ bool ValueDestination::Init(Scope* exec_scope,
     return false;
   }
   type_ = SCOPE;
-  scope_ = base->scope_value();
+  scope_value_ = base;
   name_token_ = &dest_accessor->member()->value();
   return true;
 }
 
+Scope* ValueDestination::GetScope() const {
+  DCHECK(type_ == SCOPE);
+  return scope_value_ ? scope_value_->scope_value() : scope_;
+}
+
 const Value* ValueDestination::GetExistingValue() const {
   if (type_ == SCOPE)
-    return scope_->GetValue(name_token_->value(), true);
+    return GetScope()->GetValue(name_token_->atom(), true);
   else if (type_ == LIST)
-    return &list_->list_value()[index_];
+    return &std::as_const(*list_).list_value()[index_];
   return nullptr;
 }
 
 Value* ValueDestination::GetExistingMutableValueIfExists(
     const ParseNode* origin) {
   if (type_ == SCOPE) {
-    Value* value = scope_->GetMutableValue(name_token_->value(),
-                                           Scope::SEARCH_CURRENT, false);
+    Scope* scope = GetScope();
+    Value* value = scope->GetMutableValue(name_token_->atom(),
+                                          Scope::SEARCH_CURRENT, false);
     if (value) {
       // The value will be written to, reset its tracking information.
       value->set_origin(origin);
-      scope_->MarkUnused(name_token_->value());
+      scope->MarkUnused(name_token_->value());
     }
   }
   if (type_ == LIST)
@@ -176,7 +192,8 @@ Value* ValueDestination::GetExistingMutableValueIfExists(
 
 Value* ValueDestination::SetValue(Value value, const ParseNode* set_node) {
   if (type_ == SCOPE) {
-    return scope_->SetValue(name_token_->value(), std::move(value), set_node);
+    return GetScope()->SetValue(name_token_->atom(), std::move(value),
+                                set_node);
   } else if (type_ == LIST) {
     Value* dest = &list_->list_value()[index_];
     *dest = std::move(value);
@@ -316,13 +333,15 @@ Value ExecuteEquals(Scope* exec_scope,
     // overwriting a nonempty list/scope with an empty one, which can then be
     // modified.
     if (old_value->type() == Value::LIST && right.type() == Value::LIST &&
-        !old_value->list_value().empty() && !right.list_value().empty()) {
+        !old_value->list_value().empty() &&
+        !std::as_const(right).list_value().empty()) {
       *err = MakeOverwriteError(op_node, *old_value);
       return Value();
     } else if (old_value->type() == Value::SCOPE &&
                right.type() == Value::SCOPE &&
                old_value->scope_value()->HasValues(Scope::SEARCH_CURRENT) &&
-               right.scope_value()->HasValues(Scope::SEARCH_CURRENT)) {
+               std::as_const(right).scope_value()->HasValues(
+                   Scope::SEARCH_CURRENT)) {
       *err = MakeOverwriteError(op_node, *old_value);
       return Value();
     }
@@ -475,9 +494,19 @@ void ExecutePlusEquals(Scope* exec_scope,
   } else if (mutable_dest->type() == Value::LIST) {
     // List concat.
     if (right.type() == Value::LIST) {
-      // Normal list concat. This is a destructive move.
-      for (Value& value : right.list_value())
-        mutable_dest->list_value().push_back(std::move(value));
+      if (std::as_const(*mutable_dest).list_value().empty()) {
+        // Appending to an empty list, which is common when accumulating
+        // values forwarded from an invoker. Take over the right side's
+        // (possibly shared) storage rather than copying the items.
+        const ParseNode* origin = mutable_dest->origin();
+        *mutable_dest = std::move(right);
+        mutable_dest->set_origin(origin);
+      } else {
+        // Normal list concat. This is a destructive move.
+        std::vector<Value>& dest_list = mutable_dest->list_value();
+        for (Value& value : right.list_value())
+          dest_list.push_back(std::move(value));
+      }
     } else {
       *err = Err(op_node->op(), "Incompatible types to add.",
                  "To append a single item to a list do \"foo += [ bar ]\".");
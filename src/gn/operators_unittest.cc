@@ -409,3 +409,32 @@ TEST(Operators, PlusEqualsUsed) {
   EXPECT_FALSE(setup.scope()->IsSetButUnused(foo));
   EXPECT_TRUE(nested.IsSetButUnused(foo));
 }
+
+// Assigning a scope to one of its own members must not be visible through the
+// copy on the right-hand side, even though copies of scopes share storage.
+TEST(Operators, ScopeMemberSelfAssignment) {
+  TestWithScope setup;
+  TestParseInput input(
+      "a = { x = 1 }\n"
+      "a.y = a\n"
+      "b = a.y\n"
+      "c = a\n"
+      "c.x = 2\n");
+  ASSERT_FALSE(input.has_error());
+
+  Err err;
+  input.parsed()->Execute(setup.scope(), &err);
+  ASSERT_FALSE(err.has_error()) << err.message();
+
+  const Value* a = setup.scope()->GetValue("a");
+  ASSERT_TRUE(a);
+  EXPECT_EQ("{\n  x = 1\n  y = {\n  x = 1\n}\n}", a->ToString(false));
+
+  const Value* b = setup.scope()->GetValue("b");
+  ASSERT_TRUE(b);
+  EXPECT_EQ("{\n  x = 1\n}", b->ToString(false));
+
+  const Value* c = setup.scope()->GetValue("c");
+  ASSERT_TRUE(c);
+  EXPECT_EQ("{\n  x = 2\n  y = {\n  x = 1\n}\n}", c->ToString(false));
+}
@@ -379,7 +379,7 @@ std::unique_ptr<AccessorNode> AccessorNode::NewFromJSON(
 }
 
 Value AccessorNode::ExecuteSubscriptAccess(Scope* scope, Err* err) const {
-  const Value* base_value = scope->GetValue(base_.value(), true);
+  const Value* base_value = scope->GetValue(base_.atom(), true);
   if (!base_value) {
     *err = MakeErrorDescribing("Undefined identifier.");
     return Value();
@@ -416,8 +416,8 @@ Value AccessorNode::ExecuteScopeSubscriptAccess(Scope* scope,
     return Value();
   if (!key_value.VerifyTypeIs(Value::STRING, err))
     return Value();
-  const Value* result =
-      ExecuteScopeAccessForMember(scope, key_value.string_value(), err);
+  const Value* result = ExecuteScopeAccessForMember(
+      scope, StringAtom(key_value.string_value()), err);
   if (!result) {
     *err =
         Err(subscript_.get(), "No value named \"" + key_value.string_value() +
@@ -429,7 +429,7 @@ Value AccessorNode::ExecuteScopeSubscriptAccess(Scope* scope,
 
 Value AccessorNode::ExecuteScopeAccess(Scope* scope, Err* err) const {
   const Value* result =
-      ExecuteScopeAccessForMember(scope, member_->value().value(), err);
+      ExecuteScopeAccessForMember(scope, member_->value().atom(), err);
 
   if (!result) {
     *err = Err(member_.get(), "No value named \"" + member_->value().value() +
@@ -441,40 +441,21 @@ Value AccessorNode::ExecuteScopeAccess(Scope* scope, Err* err) const {
 
 const Value* AccessorNode::ExecuteScopeAccessForMember(
     Scope* scope,
-    std::string_view member_str,
+    StringAtom member_str,
     Err* err) const {
-  // We jump through some hoops here since ideally a.b will count "b" as
-  // accessed in the given scope. The value "a" might be in some normal nested
-  // scope and we can modify it, but it might also be inherited from the
-  // readonly root scope and we can't do used variable tracking on it. (It's
-  // not legal to const cast it away since the root scope will be in readonly
-  // mode and being accessed from multiple threads without locking.) So this
-  // code handles both cases.
-  const Value* result = nullptr;
-
-  // Look up the value in the scope named by "base_".
-  Value* mutable_base_value =
-      scope->GetMutableValue(base_.value(), Scope::SEARCH_NESTED, true);
-  if (mutable_base_value) {
-    // Common case: base value is mutable so we can track variable accesses
-    // for unused value warnings.
-    if (!mutable_base_value->VerifyTypeIs(Value::SCOPE, err))
-      return nullptr;
-    result = mutable_base_value->scope_value()->GetValue(member_str, true);
-  } else {
-    // Fall back to see if the value is on a read-only scope.
-    const Value* const_base_value = scope->GetValue(base_.value(), true);
-    if (const_base_value) {
-      // Read only value, don't try to mark the value access as a "used" one.
-      if (!const_base_value->VerifyTypeIs(Value::SCOPE, err))
-        return nullptr;
-      result = const_base_value->scope_value()->GetValue(member_str);
-    } else {
-      *err = Err(base_, "Undefined identifier.");
-      return nullptr;
-    }
+  // Ideally a.b will count "b" as accessed in the scope of "a", and "a" as
+  // accessed unless it comes from the read-only root scope, which doesn't
+  // track uses. The scope of "a" is only read, so it goes through the const
+  // accessor: its storage may be shared with other copies of the value, and
+  // asking for a mutable scope would copy it.
+  const Value* base_value = scope->GetValue(base_.atom(), true);
+  if (!base_value) {
+    *err = Err(base_, "Undefined identifier.");
+    return nullptr;
   }
-  return result;
+  if (!base_value->VerifyTypeIs(Value::SCOPE, err))
+    return nullptr;
+  return base_value->scope_value()->GetValue(member_str, true);
 }
 
 void AccessorNode::SetNewLocation(int line_number) {
@@ -841,7 +822,7 @@ const IdentifierNode* IdentifierNode::AsIdentifier() const {
 Value IdentifierNode::Execute(Scope* scope, Err* err) const {
   const Scope* found_in_scope = nullptr;
   const Value* value =
-      scope->GetValueWithScope(value_.value(), true, &found_in_scope);
+      scope->GetValueWithScope(value_.atom(), true, &found_in_scope);
   Value result;
   if (!value) {
     *err = MakeErrorDescribing("Undefined identifier");
@@ -208,7 +208,7 @@ class AccessorNode : public ParseNode {
                                     Err* err) const;
   Value ExecuteScopeAccess(Scope* scope, Err* err) const;
   const Value* ExecuteScopeAccessForMember(Scope* scope,
-                                           std::string_view member_str,
+                                           StringAtom member_str,
                                            Err* err) const;
 
   static constexpr const char* kDumpAccessorKind = "accessor_kind";
@@ -368,3 +368,24 @@ TEST(ParseTree, Integers) {
   }
 }
 
+
+TEST(ParseTree, AccessorReadsSharedScope) {
+  TestWithScope setup;
+  TestParseInput input(
+      "a = { b = 1 }\n"
+      "c = a\n"
+      "d = c.b\n");
+  ASSERT_FALSE(input.has_error());
+  Err err;
+  input.parsed()->Execute(setup.scope(), &err);
+  ASSERT_FALSE(err.has_error()) << err.message();
+
+  // Reading c.b doesn't give c its own copy of the scope it shares with a.
+  const Value* a = setup.scope()->GetValue("a");
+  const Value* c = setup.scope()->GetValue("c");
+  ASSERT_TRUE(a && c);
+  EXPECT_EQ(a->scope_value(), c->scope_value());
+
+  // The read still counts as a use of "b".
+  EXPECT_TRUE(c->scope_value()->CheckForUnusedVars(&err));
+}
@@ -4,12 +4,143 @@
 
 #include "gn/path_output.h"
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
 #include "base/strings/string_util.h"
 #include "gn/filesystem_utils.h"
 #include "gn/output_file.h"
 #include "gn/string_utils.h"
 #include "util/build_config.h"
 
+namespace {
+
+// Independently locked parts of the cache of an origin, so that threads
+// writing different paths rarely wait for each other.
+constexpr size_t kOriginShards = 32;
+
+// The number of origins each thread remembers. A writer uses a couple of
+// escaping modes for its directory, and threads rarely work on many
+// directories at once.
+constexpr size_t kThreadOrigins = 16;
+
+// Identifies an origin. All PathOutputs with the same key write the same text
+// for a path.
+struct OriginKey {
+  std::string current_dir;
+  std::string inverse_current_dir;
+  EscapingMode mode;
+  EscapingPlatform platform;
+  bool inhibit_quoting;
+
+  bool operator<(const OriginKey& other) const {
+    return std::tie(current_dir, inverse_current_dir, mode, platform,
+                    inhibit_quoting) <
+           std::tie(other.current_dir, other.inverse_current_dir, other.mode,
+                    other.platform, other.inhibit_quoting);
+  }
+};
+
+}  // namespace
+
+// The cache shared by the PathOutputs with the same OriginKey.
+struct PathOutputOrigin {
+  struct Shard {
+    std::mutex lock;
+
+    // Keyed by the address of the string of a StringAtom, which never
+    // changes, with the PathOutput::CachedPathKind in the low bits. Entries
+    // are never removed, so the strings can be used outside the lock.
+    std::unordered_map<uintptr_t, std::string> paths;
+  };
+  Shard shards[kOriginShards];
+};
+
+namespace {
+
+struct OriginRegistry {
+  std::mutex lock;
+  std::map<OriginKey, std::unique_ptr<PathOutputOrigin>> origins;
+
+  // Incremented when the origins are cleared, to invalidate the origins the
+  // threads remember.
+  std::atomic<uint64_t> generation{0};
+};
+
+// The origins recently found by a thread, so that constructing a PathOutput
+// usually takes neither the registry lock nor a copy of its key.
+struct ThreadOrigin {
+  // The string of the StringAtom of the current dir, which never moves.
+  const std::string* current_dir = nullptr;
+  std::string inverse_current_dir;
+  EscapeOptions options;
+  PathOutputOrigin* origin = nullptr;
+};
+
+struct ThreadOrigins {
+  uint64_t generation = 0;
+  size_t size = 0;
+  size_t next = 0;  // The entry to replace when full.
+  ThreadOrigin entries[kThreadOrigins];
+};
+
+// Appends what is written to a string, which keeps its capacity when cleared
+// so that computing the text of a path doesn't allocate a new stream each
+// time.
+class StringStreamBuf : public std::streambuf {
+ public:
+  std::string& str() { return str_; }
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    str_.append(s, static_cast<size_t>(n));
+    return n;
+  }
+  int_type overflow(int_type ch) override {
+    if (ch != traits_type::eof())
+      str_.push_back(static_cast<char>(ch));
+    return ch;
+  }
+
+ private:
+  std::string str_;
+};
+
+// Returns the text written to |out|, computed by |write|.
+template <typename WriteFunction>
+std::string ComputePath(WriteFunction write) {
+  thread_local StringStreamBuf buf;
+  thread_local std::ostream out(&buf);
+  buf.str().clear();
+  write(out);
+  return buf.str();
+}
+
+uintptr_t CacheKey(const std::string& value, uintptr_t kind) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(&value);
+  DCHECK((address & 3) == 0);
+  return address | kind;
+}
+
+size_t ShardIndex(uintptr_t key) {
+  return ((key >> 4) ^ (key >> 12)) % kOriginShards;
+}
+
+OriginRegistry& GetOriginRegistry() {
+  // Leaked, like the StringAtom strings the caches are keyed by.
+  static OriginRegistry* registry = new OriginRegistry;
+  return *registry;
+}
+
+}  // namespace
+
 PathOutput::PathOutput(const SourceDir& current_dir,
                        std::string_view source_root,
                        EscapingMode escaping)
@@ -18,17 +149,145 @@ PathOutput::PathOutput(const SourceDir& current_dir,
   if (!EndsWithSlash(inverse_current_dir_))
     inverse_current_dir_.push_back('/');
   options_.mode = escaping;
+  UpdateOrigin();
 }
 
 PathOutput::~PathOutput() = default;
 
+void PathOutput::set_inhibit_quoting(bool iq) {
+  options_.inhibit_quoting = iq;
+  UpdateOrigin();
+}
+
+void PathOutput::set_escape_platform(EscapingPlatform p) {
+  options_.platform = p;
+  UpdateOrigin();
+}
+
 void PathOutput::WriteFile(std::ostream& out, const SourceFile& file) const {
-  WritePathStr(out, file.value());
+  const std::string* path = FindCached(file.value(), CACHED_FILE);
+  if (!path) {
+    path = &AddCached(file.value(), CACHED_FILE,
+                      ComputePath([this, &file](std::ostream& computed) {
+                        WritePathStr(computed, file.value());
+                      }));
+  }
+  out.write(path->data(), path->size());
 }
 
 void PathOutput::WriteDir(std::ostream& out,
                           const SourceDir& dir,
                           DirSlashEnding slash_ending) const {
+  CachedPathKind kind = slash_ending == DIR_INCLUDE_LAST_SLASH
+                            ? CACHED_DIR_INCLUDE_LAST_SLASH
+                            : CACHED_DIR_NO_LAST_SLASH;
+  const std::string* path = FindCached(dir.value(), kind);
+  if (!path) {
+    path = &AddCached(
+        dir.value(), kind,
+        ComputePath([this, &dir, slash_ending](std::ostream& computed) {
+          WriteDirUncached(computed, dir, slash_ending);
+        }));
+  }
+  out.write(path->data(), path->size());
+}
+
+// static
+size_t PathOutput::EstimateCacheMemoryUsage() {
+  OriginRegistry& registry = GetOriginRegistry();
+  std::lock_guard<std::mutex> registry_lock(registry.lock);
+  size_t result = 0;
+  for (const auto& [key, origin] : registry.origins) {
+    result += sizeof(PathOutputOrigin) + key.current_dir.capacity() +
+              key.inverse_current_dir.capacity();
+    for (PathOutputOrigin::Shard& shard : origin->shards) {
+      std::lock_guard<std::mutex> lock(shard.lock);
+      result += shard.paths.bucket_count() * sizeof(void*);
+      for (const auto& [path_key, path] : shard.paths) {
+        // Each node holds the pair and a next pointer.
+        result += sizeof(void*) + sizeof(path_key) + sizeof(path);
+        if (path.capacity() >= sizeof(path))
+          result += path.capacity() + 1;
+      }
+    }
+  }
+  return result;
+}
+
+// static
+void PathOutput::ClearCaches() {
+  OriginRegistry& registry = GetOriginRegistry();
+  std::lock_guard<std::mutex> lock(registry.lock);
+  registry.origins.clear();
+  registry.generation++;
+}
+
+void PathOutput::UpdateOrigin() {
+  OriginRegistry& registry = GetOriginRegistry();
+  thread_local ThreadOrigins thread_origins;
+  uint64_t generation = registry.generation.load();
+  if (thread_origins.generation != generation) {
+    thread_origins = ThreadOrigins();
+    thread_origins.generation = generation;
+  }
+
+  // The inverse current dir is all the source root contributes.
+  const std::string* current_dir = &current_dir_.value();
+  for (size_t i = 0; i < thread_origins.size; i++) {
+    const ThreadOrigin& entry = thread_origins.entries[i];
+    if (entry.current_dir == current_dir &&
+        entry.options.mode == options_.mode &&
+        entry.options.platform == options_.platform &&
+        entry.options.inhibit_quoting == options_.inhibit_quoting &&
+        entry.inverse_current_dir == inverse_current_dir_) {
+      origin_ = entry.origin;
+      return;
+    }
+  }
+
+  {
+    OriginKey key{*current_dir, inverse_current_dir_, options_.mode,
+                  options_.platform, options_.inhibit_quoting};
+    std::lock_guard<std::mutex> lock(registry.lock);
+    std::unique_ptr<PathOutputOrigin>& origin =
+        registry.origins[std::move(key)];
+    if (!origin)
+      origin = std::make_unique<PathOutputOrigin>();
+    origin_ = origin.get();
+  }
+
+  ThreadOrigin& entry = thread_origins.entries[thread_origins.next];
+  entry.current_dir = current_dir;
+  entry.inverse_current_dir = inverse_current_dir_;
+  entry.options = options_;
+  entry.origin = origin_;
+  thread_origins.next = (thread_origins.next + 1) % kThreadOrigins;
+  if (thread_origins.size < kThreadOrigins)
+    thread_origins.size++;
+}
+
+const std::string* PathOutput::FindCached(const std::string& value,
+                                          CachedPathKind kind) const {
+  uintptr_t key = CacheKey(value, kind);
+  PathOutputOrigin::Shard& shard = origin_->shards[ShardIndex(key)];
+  std::lock_guard<std::mutex> lock(shard.lock);
+  auto found = shard.paths.find(key);
+  return found == shard.paths.end() ? nullptr : &found->second;
+}
+
+const std::string& PathOutput::AddCached(const std::string& value,
+                                         CachedPathKind kind,
+                                         std::string path) const {
+  // Another thread may have added the same text meanwhile, which is harmless.
+  uintptr_t key = CacheKey(value, kind);
+  PathOutputOrigin::Shard& shard = origin_->shards[ShardIndex(key)];
+  std::lock_guard<std::mutex> lock(shard.lock);
+  return shard.paths.emplace(key, std::move(path)).first->second;
+}
+
+void PathOutput::WriteDirUncached(std::ostream& out,
+                                  const SourceDir& dir,
+                                  DirSlashEnding slash_ending) const {
   if (dir.value() == "/") {
     // Writing system root is always a slash (this will normally only come up
     // on Posix systems).
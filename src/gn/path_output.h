@@ -5,6 +5,9 @@
 #ifndef TOOLS_GN_PATH_OUTPUT_H_
 #define TOOLS_GN_PATH_OUTPUT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <iosfwd>
 #include <string>
 #include <string_view>
@@ -14,6 +17,7 @@
 #include "gn/unique_vector.h"
 
 class OutputFile;
+struct PathOutputOrigin;
 class SourceFile;
 
 namespace base {
@@ -22,6 +26,10 @@ class FilePath;
 
 // Writes file names to streams assuming a certain input directory and
 // escaping rules. This gives us a central place for managing this state.
+//
+// The rebased and escaped text of SourceFiles and SourceDirs is cached, shared
+// by all PathOutputs with the same current directory, source root and escape
+// options, since the same files and directories are written by many targets.
 class PathOutput {
  public:
   // Controls whether writing directory names include the trailing slash.
@@ -45,8 +53,9 @@ class PathOutput {
 
   // Getter/setters for flags inside the escape options.
   bool inhibit_quoting() const { return options_.inhibit_quoting; }
-  void set_inhibit_quoting(bool iq) { options_.inhibit_quoting = iq; }
-  void set_escape_platform(EscapingPlatform p) { options_.platform = p; }
+  void set_inhibit_quoting(bool iq);
+  EscapingPlatform escape_platform() const { return options_.platform; }
+  void set_escape_platform(EscapingPlatform p);
 
   void WriteFile(std::ostream& out, const SourceFile& file) const;
   void WriteFile(std::ostream& out, const OutputFile& file) const;
@@ -73,7 +82,40 @@ class PathOutput {
   // directory string to the file.
   void WritePathStr(std::ostream& out, std::string_view str) const;
 
+  // Returns the approximate number of bytes used by the caches of all
+  // PathOutputs.
+  static size_t EstimateCacheMemoryUsage();
+
+  // Frees the caches of all PathOutputs. No PathOutput may exist or be
+  // constructed meanwhile, e.g. this is called between loads of a build.
+  static void ClearCaches();
+
  private:
+  // What is cached for a SourceFile or SourceDir string.
+  enum CachedPathKind : uintptr_t {
+    CACHED_FILE,
+    CACHED_DIR_INCLUDE_LAST_SLASH,
+    CACHED_DIR_NO_LAST_SLASH,
+  };
+
+  // Finds the Origin for the current dir, source root and options.
+  void UpdateOrigin();
+
+  // The cache of the origin is keyed by |value|, the string of a StringAtom,
+  // and |kind|. Returns the cached text, or null.
+  const std::string* FindCached(const std::string& value,
+                                CachedPathKind kind) const;
+
+  // Adds the text for |value| and |kind| to the cache and returns it.
+  const std::string& AddCached(const std::string& value,
+                               CachedPathKind kind,
+                               std::string path) const;
+
+  // Backend for WriteDir(SourceDir) that doesn't use the cache.
+  void WriteDirUncached(std::ostream& out,
+                        const SourceDir& dir,
+                        DirSlashEnding slash_ending) const;
+
   // Takes the given string and writes it out, appending to the inverse
   // current dir. This assumes leading slashes have been trimmed.
   void WriteSourceRelativeString(std::ostream& out, std::string_view str) const;
@@ -86,6 +128,9 @@ class PathOutput {
   // Since the inverse_current_dir_ depends on some of these, we don't expose
   // this directly to modification.
   EscapeOptions options_;
+
+  // Never null. Origins live until ClearCaches() is called.
+  PathOutputOrigin* origin_ = nullptr;
 };
 
 #endif  // TOOLS_GN_PATH_OUTPUT_H_
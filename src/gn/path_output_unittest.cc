@@ -274,3 +274,70 @@ TEST(PathOutput, WriteDir) {
     }
   }
 }
+
+TEST(PathOutput, Cache) {
+  std::string_view source_root("/source/root");
+  SourceFile file("//foo/bar baz.cc");
+  SourceDir dir("//foo/bar/");
+
+  PathOutput writer(SourceDir("//out/Debug/"), source_root, ESCAPE_NINJA);
+  auto write = [&file, &dir](const PathOutput& writer) {
+    std::ostringstream out;
+    writer.WriteFile(out, file);
+    out << " ";
+    writer.WriteDir(out, dir, PathOutput::DIR_INCLUDE_LAST_SLASH);
+    out << " ";
+    writer.WriteDir(out, dir, PathOutput::DIR_NO_LAST_SLASH);
+    return out.str();
+  };
+  const std::string expected =
+      "../../foo/bar$ baz.cc ../../foo/bar/ ../../foo/bar";
+
+  // Writing the same paths again gives the cached text.
+  EXPECT_EQ(expected, write(writer));
+  size_t cache_bytes = PathOutput::EstimateCacheMemoryUsage();
+  EXPECT_EQ(expected, write(writer));
+  EXPECT_EQ(cache_bytes, PathOutput::EstimateCacheMemoryUsage());
+
+  // Another writer for the same directory and options shares the cache.
+  PathOutput same_writer(SourceDir("//out/Debug/"), source_root, ESCAPE_NINJA);
+  EXPECT_EQ(expected, write(same_writer));
+  EXPECT_EQ(cache_bytes, PathOutput::EstimateCacheMemoryUsage());
+
+  // Writers for other directories or options don't.
+  PathOutput other_dir(SourceDir("//out/"), source_root, ESCAPE_NINJA);
+  EXPECT_EQ("../foo/bar$ baz.cc ../foo/bar/ ../foo/bar", write(other_dir));
+  PathOutput in_dir(SourceDir("//foo/bar/"), source_root, ESCAPE_NINJA);
+  EXPECT_EQ("../../foo/bar$ baz.cc ./ .", write(in_dir));
+  PathOutput no_escaping(SourceDir("//out/Debug/"), source_root, ESCAPE_NONE);
+  EXPECT_EQ("../../foo/bar baz.cc ../../foo/bar/ ../../foo/bar",
+            write(no_escaping));
+  EXPECT_LT(cache_bytes, PathOutput::EstimateCacheMemoryUsage());
+
+  // Changing the options of a writer uses the cache for the new options.
+  same_writer.set_inhibit_quoting(true);
+  EXPECT_EQ(expected, write(same_writer));
+  same_writer.set_inhibit_quoting(false);
+  EXPECT_EQ(expected, write(same_writer));
+}
+
+TEST(PathOutput, ClearCaches) {
+  std::string_view source_root("/source/root");
+  SourceFile file("//foo/bar baz.cc");
+  auto write = [&source_root, &file]() {
+    PathOutput writer(SourceDir("//out/Debug/"), source_root, ESCAPE_NINJA);
+    std::ostringstream out;
+    writer.WriteFile(out, file);
+    return out.str();
+  };
+
+  EXPECT_EQ("../../foo/bar$ baz.cc", write());
+  EXPECT_LT(0u, PathOutput::EstimateCacheMemoryUsage());
+
+  PathOutput::ClearCaches();
+  EXPECT_EQ(0u, PathOutput::EstimateCacheMemoryUsage());
+
+  // The next writer for the same directory gets a new cache.
+  EXPECT_EQ("../../foo/bar$ baz.cc", write());
+  EXPECT_LT(0u, PathOutput::EstimateCacheMemoryUsage());
+}
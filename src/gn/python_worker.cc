@@ -0,0 +1,371 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/python_worker.h"
+
+#include <utility>
+
+#include "base/strings/string_number_conversions.h"
+#include "gn/filesystem_utils.h"
+#include "util/build_config.h"
+
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#endif
+
+#if !defined(OS_WIN)
+namespace {
+
+// The program run by each worker.
+//
+// Requests are read from stdin. Each one is a line with the number of fields
+// followed by the fields, each of which is a line with its size in bytes
+// followed by its contents. The first field is the working directory and the
+// others are the script and its arguments.
+//
+// The reply is written to stdout. It is either a "skip" line if the script
+// opted out of being run by the worker, or a "start" line written before the
+// script runs, followed by a line with the exit code and the stdout and stderr
+// of the script, each of which is a line with its size in bytes followed by
+// its contents.
+const char kWorkerProgram[] = R"(
+import os, runpy, sys, tempfile, traceback
+
+def opted_out(cwd, argv):
+  try:
+    with open(os.path.join(cwd, argv[0]), 'rb') as f:
+      return b'# gn: no-python-worker' in f.read()
+  except OSError:
+    return False  # Let runpy report the error.
+
+def run(cwd, argv):
+  saved = (os.getcwd(), dict(os.environ), list(sys.path), sys.argv,
+           sys.stdout, sys.stderr)
+  modules = set(sys.modules)
+  out = tempfile.TemporaryFile()
+  err = tempfile.TemporaryFile()
+  saved_fds = (os.dup(1), os.dup(2))
+  os.dup2(out.fileno(), 1)
+  os.dup2(err.fileno(), 2)
+  code = 0
+  try:
+    os.chdir(cwd)
+    sys.argv = list(argv)
+    sys.path.insert(0, os.path.dirname(os.path.abspath(argv[0])))
+    runpy.run_path(argv[0], run_name='__main__')
+  except SystemExit as e:
+    if e.code is None:
+      code = 0
+    elif isinstance(e.code, int):
+      code = e.code
+    else:
+      print(e.code, file=sys.stderr)
+      code = 1
+  except BaseException:
+    traceback.print_exc()
+    code = 1
+  finally:
+    for stream in (sys.stdout, sys.stderr):
+      try:
+        stream.flush()
+      except Exception:
+        pass
+    cwd, env, path, sys.argv, sys.stdout, sys.stderr = saved
+    os.dup2(saved_fds[0], 1)
+    os.dup2(saved_fds[1], 2)
+    os.close(saved_fds[0])
+    os.close(saved_fds[1])
+    os.chdir(cwd)
+    os.environ.clear()
+    os.environ.update(env)
+    sys.path[:] = path
+    # Forget the modules the script imported, since the next script may have
+    # its own modules with the same names.
+    for name in list(sys.modules):
+      if name not in modules:
+        del sys.modules[name]
+  out.seek(0)
+  err.seek(0)
+  return code & 0xff, out.read(), err.read()
+
+def main():
+  requests = os.fdopen(os.dup(0), 'rb')
+  replies = os.fdopen(os.dup(1), 'wb')
+  null = os.open(os.devnull, os.O_RDWR)
+  os.dup2(null, 0)
+  os.dup2(2, 1)
+  os.close(null)
+  if sys.path and sys.path[0] == '':
+    del sys.path[0]
+  while True:
+    line = requests.readline()
+    if not line:
+      return
+    fields = []
+    for _ in range(int(line)):
+      size = int(requests.readline())
+      fields.append(os.fsdecode(requests.read(size)))
+    if opted_out(fields[0], fields[1:]):
+      replies.write(b'skip\n')
+      replies.flush()
+      continue
+    replies.write(b'start\n')
+    replies.flush()
+    code, out, err = run(fields[0], fields[1:])
+    replies.write(b'%d\n%d\n' % (code, len(out)) + out +
+                  b'%d\n' % len(err) + err)
+    replies.flush()
+
+main()
+)";
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Creates a connected pair of sockets that aren't inherited by other
+// processes.
+bool MakeSocketPair(int fds[2]) {
+#if defined(SOCK_CLOEXEC)
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+    return false;
+#else
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    return false;
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+#if defined(SO_NOSIGPIPE)
+  // Writing to a worker that died must not kill us with SIGPIPE.
+  int on = 1;
+  setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  return true;
+}
+
+void AppendField(const std::string& field, std::string* request) {
+  request->append(base::NumberToString(field.size()));
+  request->push_back('\n');
+  request->append(field);
+}
+
+}  // namespace
+
+// One Python process and the socket connected to its stdin and stdout.
+class PythonWorkerPool::Worker {
+ public:
+  Worker() = default;
+
+  ~Worker() {
+    // Closing the socket makes the worker exit.
+    socket_.reset();
+    if (pid_ > 0)
+      HANDLE_EINTR(waitpid(pid_, nullptr, 0));
+  }
+
+  bool Start(const base::FilePath& python_path) {
+    int fds[2];
+    if (!MakeSocketPair(fds))
+      return false;
+    socket_.reset(fds[0]);
+    base::ScopedFD child_socket(fds[1]);
+
+    // Prepare everything before forking: the child must not allocate.
+    std::string python = FilePathToUTF8(python_path);
+    const char* const argv[] = {python.c_str(), "-u", "-c", kWorkerProgram,
+                                nullptr};
+
+    pid_ = fork();
+    if (pid_ < 0)
+      return false;
+    if (pid_ == 0) {
+      // Child. dup2() clears close-on-exec on the new descriptors.
+      if (dup2(child_socket.get(), STDIN_FILENO) < 0 ||
+          dup2(child_socket.get(), STDOUT_FILENO) < 0)
+        _exit(127);
+      execvp(argv[0], const_cast<char* const*>(argv));
+      _exit(127);
+    }
+    return true;
+  }
+
+  // Returns false if the worker failed, in which case it must not be reused.
+  // |started| tells whether the script started running before that.
+  bool Run(const std::vector<std::string>& argv,
+           const base::FilePath& startup_dir,
+           bool* skipped,
+           bool* started,
+           std::string* std_out,
+           std::string* std_err,
+           int* exit_code) {
+    std::string request = base::NumberToString(argv.size() + 1);
+    request.push_back('\n');
+    AppendField(FilePathToUTF8(startup_dir), &request);
+    for (const std::string& arg : argv)
+      AppendField(arg, &request);
+    if (!Write(request))
+      return false;
+
+    std::string line;
+    if (!ReadLine(&line))
+      return false;
+    if (line == "skip") {
+      *skipped = true;
+      return true;
+    }
+    *skipped = false;
+    if (line != "start")
+      return false;
+    *started = true;
+    return ReadLine(&line) && base::StringToInt(line, exit_code) &&
+           ReadField(std_out) && ReadField(std_err);
+  }
+
+ private:
+  bool Write(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+      ssize_t result = HANDLE_EINTR(send(socket_.get(), &data[written],
+                                         data.size() - written, kSendFlags));
+      if (result <= 0)
+        return false;
+      written += result;
+    }
+    return true;
+  }
+
+  // Reads more data into |buffer_|. Returns false on EOF or error.
+  bool Fill() {
+    char chunk[4096];
+    ssize_t result = HANDLE_EINTR(read(socket_.get(), chunk, sizeof(chunk)));
+    if (result <= 0)
+      return false;
+    buffer_.append(chunk, result);
+    return true;
+  }
+
+  bool ReadLine(std::string* line) {
+    size_t newline;
+    while ((newline = buffer_.find('\n')) == std::string::npos) {
+      if (!Fill())
+        return false;
+    }
+    line->assign(buffer_, 0, newline);
+    buffer_.erase(0, newline + 1);
+    return true;
+  }
+
+  bool ReadField(std::string* field) {
+    std::string line;
+    size_t size;
+    if (!ReadLine(&line) || !base::StringToSizeT(line, &size))
+      return false;
+    while (buffer_.size() < size) {
+      if (!Fill())
+        return false;
+    }
+    field->assign(buffer_, 0, size);
+    buffer_.erase(0, size);
+    return true;
+  }
+
+  pid_t pid_ = -1;
+  base::ScopedFD socket_;
+
+  // Data read from the socket but not consumed yet.
+  std::string buffer_;
+};
+
+PythonWorkerPool::PythonWorkerPool(const base::FilePath& python_path)
+    : python_path_(python_path) {}
+
+PythonWorkerPool::~PythonWorkerPool() = default;
+
+bool PythonWorkerPool::RunScript(const std::vector<std::string>& argv,
+                                 const base::FilePath& startup_dir,
+                                 std::string* std_out,
+                                 std::string* std_err,
+                                 int* exit_code) {
+  std::unique_ptr<Worker> worker = AcquireWorker();
+  if (!worker)
+    return false;
+
+  bool skipped = false;
+  bool started = false;
+  std::string out;
+  std::string err;
+  if (!worker->Run(argv, startup_dir, &skipped, &started, &out, &err,
+                   exit_code)) {
+    // Drops the worker, which may have died. A script that started may have
+    // had side effects already, so it's reported as failed rather than run
+    // again.
+    if (!started)
+      return false;
+    std_err->append("The Python worker exited while running the script.\n");
+    *exit_code = 1;
+    return true;
+  }
+  ReleaseWorker(std::move(worker));
+  if (skipped)
+    return false;
+
+  std_out->append(out);
+  std_err->append(err);
+  return true;
+}
+
+std::unique_ptr<PythonWorkerPool::Worker> PythonWorkerPool::AcquireWorker() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!idle_workers_.empty()) {
+      std::unique_ptr<Worker> worker = std::move(idle_workers_.back());
+      idle_workers_.pop_back();
+      return worker;
+    }
+  }
+
+  auto worker = std::make_unique<Worker>();
+  if (!worker->Start(python_path_))
+    return nullptr;
+  return worker;
+}
+
+void PythonWorkerPool::ReleaseWorker(std::unique_ptr<Worker> worker) {
+  std::lock_guard<std::mutex> lock(lock_);
+  idle_workers_.push_back(std::move(worker));
+}
+
+#else  // OS_WIN
+
+class PythonWorkerPool::Worker {};
+
+PythonWorkerPool::PythonWorkerPool(const base::FilePath& python_path)
+    : python_path_(python_path) {}
+
+PythonWorkerPool::~PythonWorkerPool() = default;
+
+bool PythonWorkerPool::RunScript(const std::vector<std::string>& argv,
+                                 const base::FilePath& startup_dir,
+                                 std::string* std_out,
+                                 std::string* std_err,
+                                 int* exit_code) {
+  return false;
+}
+
+std::unique_ptr<PythonWorkerPool::Worker> PythonWorkerPool::AcquireWorker() {
+  return nullptr;
+}
+
+void PythonWorkerPool::ReleaseWorker(std::unique_ptr<Worker> worker) {}
+
+#endif  // OS_WIN
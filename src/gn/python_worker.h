@@ -0,0 +1,76 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_PYTHON_WORKER_H_
+#define TOOLS_GN_PYTHON_WORKER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+
+// A pool of long-lived Python interpreters that run scripts for exec_script()
+// and internal::InvokePython(), enabled by the --python-worker switch.
+//
+// Starting an interpreter typically costs 50-100ms, which dominates the cost
+// of most scripts run at gen time. Each worker is a Python process that reads
+// requests from its stdin and runs each script with runpy in a fresh
+// namespace, as if it was the main module. Its working directory, sys.argv,
+// sys.path and os.environ are restored after each script, and the modules it
+// imported are removed from sys.modules. The stdout and
+// stderr file descriptors are redirected to temporary files while the script
+// runs, so the output of subprocesses started by the script is captured too.
+//
+// Workers are started on demand: there is at most one per thread running a
+// script at the same time. They exit when the pool is destroyed.
+//
+// Scripts that don't behave well when run this way (for example because they
+// rely on module-level state being fresh, or exit with os._exit()) can opt
+// out by containing the following comment, in which case RunScript() returns
+// false and the caller runs them as a separate process:
+//
+//   # gn: no-python-worker
+//
+// A worker that exits while running a script is not restarted to run it
+// again, since the script may have had side effects. The run is reported as
+// failed instead.
+//
+// Workers are only supported on POSIX systems. On Windows RunScript() always
+// returns false.
+class PythonWorkerPool {
+ public:
+  explicit PythonWorkerPool(const base::FilePath& python_path);
+  ~PythonWorkerPool();
+
+  // Runs the script |argv[0]| with the arguments |argv[1..]| from
+  // |startup_dir|. Returns true if the script was run, in which case its
+  // output and exit code are filled in. Returns false if the script opted out
+  // or if the worker couldn't start it. The caller should then run the
+  // script as a separate process.
+  bool RunScript(const std::vector<std::string>& argv,
+                 const base::FilePath& startup_dir,
+                 std::string* std_out,
+                 std::string* std_err,
+                 int* exit_code);
+
+ private:
+  class Worker;
+
+  // Returns an idle worker, starting a new one if needed. Returns null on
+  // failure.
+  std::unique_ptr<Worker> AcquireWorker();
+  void ReleaseWorker(std::unique_ptr<Worker> worker);
+
+  base::FilePath python_path_;
+
+  std::mutex lock_;
+  std::vector<std::unique_ptr<Worker>> idle_workers_;
+
+  PythonWorkerPool(const PythonWorkerPool&) = delete;
+  PythonWorkerPool& operator=(const PythonWorkerPool&) = delete;
+};
+
+#endif  // TOOLS_GN_PYTHON_WORKER_H_
@@ -0,0 +1,138 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/python_worker.h"
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/filesystem_utils.h"
+#include "util/build_config.h"
+#include "util/test/test.h"
+
+// Workers aren't supported on Windows.
+#if !defined(OS_WIN)
+namespace {
+
+class PythonWorkerTest : public testing::Test {
+ public:
+  PythonWorkerTest() : pool_(base::FilePath("python3")) {
+    CHECK(temp_dir_.CreateUniqueTempDir());
+  }
+
+  // Writes a script with the given contents and returns its path.
+  std::string WriteScript(const std::string& name,
+                          const std::string& contents) {
+    base::FilePath path = temp_dir_.GetPath().AppendASCII(name);
+    CHECK(base::CreateDirectory(path.DirName()));
+    CHECK_EQ(static_cast<int>(contents.size()),
+             base::WriteFile(path, contents.data(),
+                             static_cast<int>(contents.size())));
+    return FilePathToUTF8(path);
+  }
+
+  bool RunScript(const std::vector<std::string>& argv) {
+    std_out_.clear();
+    std_err_.clear();
+    exit_code_ = -1;
+    return pool_.RunScript(argv, temp_dir_.GetPath(), &std_out_, &std_err_,
+                           &exit_code_);
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  PythonWorkerPool pool_;
+
+  std::string std_out_;
+  std::string std_err_;
+  int exit_code_ = -1;
+};
+
+}  // namespace
+
+TEST_F(PythonWorkerTest, Basic) {
+  // The working directory is the one containing the script.
+  std::string script = WriteScript("script.py",
+                                   "import os, sys\n"
+                                   "print(' '.join(sys.argv[1:]))\n"
+                                   "print(os.path.exists('script.py'))\n"
+                                   "sys.stderr.write('err')\n");
+  ASSERT_TRUE(RunScript({script, "a", "b c"}));
+  EXPECT_EQ(0, exit_code_);
+  EXPECT_EQ("a b c\nTrue\n", std_out_);
+  EXPECT_EQ("err", std_err_);
+
+  // The same worker can run more scripts.
+  ASSERT_TRUE(RunScript({script, "d"}));
+  EXPECT_EQ("d\nTrue\n", std_out_);
+}
+
+TEST_F(PythonWorkerTest, ExitCodeAndErrors) {
+  ASSERT_TRUE(
+      RunScript({WriteScript("exit.py", "import sys\nsys.exit(3)\n")}));
+  EXPECT_EQ(3, exit_code_);
+
+  ASSERT_TRUE(
+      RunScript({WriteScript("raise.py", "raise ValueError('oops')\n")}));
+  EXPECT_EQ(1, exit_code_);
+  EXPECT_NE(std::string::npos, std_err_.find("ValueError: oops"));
+}
+
+// Output of subprocesses goes to the script's stdout, not the protocol.
+TEST_F(PythonWorkerTest, Subprocess) {
+  ASSERT_TRUE(RunScript({WriteScript(
+      "sub.py",
+      "import subprocess, sys\n"
+      "subprocess.check_call([sys.executable, '-c', 'print(42)'])\n")}));
+  EXPECT_EQ(0, exit_code_);
+  EXPECT_EQ("42\n", std_out_);
+}
+
+// Changes to the environment don't leak to the next script.
+TEST_F(PythonWorkerTest, Isolation) {
+  ASSERT_TRUE(RunScript({WriteScript(
+      "set.py", "import os\nos.environ['GN_WORKER_TEST'] = '1'\nx = 1\n")}));
+  ASSERT_TRUE(RunScript({WriteScript(
+      "get.py",
+      "import os\n"
+      "print(os.environ.get('GN_WORKER_TEST', 'unset'))\n"
+      "print('x' in globals())\n")}));
+  EXPECT_EQ("unset\nFalse\n", std_out_);
+}
+
+// Modules imported by a script are forgotten, so the next script gets its own
+// module of the same name.
+TEST_F(PythonWorkerTest, ModuleIsolation) {
+  WriteScript("one/helper.py", "NAME = 'one'\n");
+  WriteScript("two/helper.py", "NAME = 'two'\n");
+  ASSERT_TRUE(RunScript(
+      {WriteScript("one/script.py", "import helper\nprint(helper.NAME)\n")}));
+  EXPECT_EQ("one\n", std_out_);
+  ASSERT_TRUE(RunScript(
+      {WriteScript("two/script.py", "import helper\nprint(helper.NAME)\n")}));
+  EXPECT_EQ("two\n", std_out_);
+}
+
+TEST_F(PythonWorkerTest, Fallback) {
+  // Scripts can opt out.
+  EXPECT_FALSE(RunScript(
+      {WriteScript("optout.py", "# gn: no-python-worker\nprint('hi')\n")}));
+
+  // A script killing the worker fails without being run again, and later
+  // scripts still work.
+  std::string counter = FilePathToUTF8(temp_dir_.GetPath().AppendASCII("runs"));
+  ASSERT_TRUE(RunScript({WriteScript("kill.py",
+                                     "import os, sys\n"
+                                     "with open(sys.argv[1], 'a') as f:\n"
+                                     "  f.write('x')\n"
+                                     "os._exit(0)\n"),
+                         counter}));
+  EXPECT_EQ(1, exit_code_);
+  EXPECT_NE(std::string::npos, std_err_.find("Python worker exited"));
+  std::string runs;
+  ASSERT_TRUE(base::ReadFileToString(UTF8ToFilePath(counter), &runs));
+  EXPECT_EQ("x", runs);
+  ASSERT_TRUE(RunScript({WriteScript("ok.py", "print('ok')\n")}));
+  EXPECT_EQ("ok\n", std_out_);
+}
+#endif  // !defined(OS_WIN)
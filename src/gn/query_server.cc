@@ -0,0 +1,395 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/query_server.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/values.h"
+#include "gn/commands.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/graph/include/graph.h"
+#include "gn/innerapis_publicinfo_generator.h"
+#include "gn/ohos_components_checker.h"
+#include "gn/ohos_components_mapping.h"
+#include "gn/path_output.h"
+#include "gn/precise/precise.h"
+#include "gn/setup.h"
+#include "gn/standard_out.h"
+#include "gn/switches.h"
+#include "util/build_config.h"
+
+#if !defined(OS_WIN)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/posix/safe_strerror.h"
+#endif
+
+namespace {
+
+// The commands that only query the build graph.
+const char* const kQueryCommands[] = {
+    commands::kAnalyze, commands::kDesc, commands::kOutputs,
+    commands::kPath,    commands::kRefs,
+};
+
+const char kStopCommand[] = "stop";
+
+Err ParseRequest(const std::string& request,
+                 std::string* command,
+                 std::vector<std::string>* args) {
+  std::unique_ptr<base::Value> value = base::JSONReader::Read(request);
+  if (!value || !value->is_dict())
+    return Err(Location(), "The request is not a JSON object.");
+
+  const base::Value* command_value =
+      value->FindKeyOfType("command", base::Value::Type::STRING);
+  if (!command_value)
+    return Err(Location(), "The request has no \"command\" string.");
+  *command = command_value->GetString();
+
+  const base::Value* args_value = value->FindKey("args");
+  if (!args_value)
+    return Err();
+  if (!args_value->is_list())
+    return Err(Location(), "The \"args\" of the request are not a list.");
+  for (const base::Value& arg : args_value->GetList()) {
+    if (!arg.is_string()) {
+      return Err(Location(),
+                 "The \"args\" of the request must all be strings.");
+    }
+    args->push_back(arg.GetString());
+  }
+  return Err();
+}
+
+#if !defined(OS_WIN)
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Returns a Unix domain socket that isn't inherited by other processes.
+base::ScopedFD MakeSocket() {
+#if defined(SOCK_CLOEXEC)
+  base::ScopedFD fd(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+#else
+  base::ScopedFD fd(socket(AF_UNIX, SOCK_STREAM, 0));
+  if (fd.is_valid())
+    fcntl(fd.get(), F_SETFD, FD_CLOEXEC);
+#endif
+  return fd;
+}
+
+// Writing to a client that went away must not kill us with SIGPIPE.
+void DisableSigPipe(int fd) {
+#if defined(SO_NOSIGPIPE)
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t result = HANDLE_EINTR(
+        send(fd, &data[written], data.size() - written, kSendFlags));
+    if (result <= 0)
+      return false;
+    written += result;
+  }
+  return true;
+}
+
+#endif  // !defined(OS_WIN)
+
+// The OpenHarmony component checks keep what the first load of the process
+// found in singletons that are only ever set up once.
+bool UsesProcessWideState() {
+  return OhosComponentChecker::getInstance() ||
+         OhosComponentMapping::getInstance() ||
+         InnerApiPublicInfoGenerator::getInstance() ||
+         PreciseManager::GetInstance() || Graph::GetInstance();
+}
+
+}  // namespace
+
+QueryServer::QueryServer(const std::string& build_dir,
+                         const base::CommandLine& cmdline)
+    : build_dir_(build_dir), cmdline_(cmdline), inputs_(base::FilePath()) {}
+
+QueryServer::~QueryServer() = default;
+
+bool QueryServer::Load() {
+  // A second load would run with the state of the first one.
+  if (setup_ && UsesProcessWideState()) {
+    if (loaded_) {
+      loaded_ = false;
+      load_output_.clear();
+      {
+        ScopedOutputCapture capture(&load_output_);
+        Err(Location(), "The build can't be loaded again.",
+            "Its inputs changed, but the OpenHarmony component checks can "
+            "only be set up\nonce per process. Restart gn serve.")
+            .PrintToStdout();
+      }
+      OutputString(load_output_);
+    }
+    return false;
+  }
+
+  // The Setup owns the global scheduler, so the previous one must be gone
+  // before the next one is created. The paths cached for the previous build
+  // are dropped with it.
+  setup_.reset();
+  PathOutput::ClearCaches();
+  setup_ = std::make_unique<Setup>();
+  load_output_.clear();
+  {
+    ScopedOutputCapture capture(&load_output_);
+    loaded_ = setup_->DoSetup(build_dir_, false, cmdline_) &&
+              setup_->Run(cmdline_);
+  }
+  // The errors of the load are also shown where the server runs.
+  OutputString(load_output_);
+
+  inputs_.RecordInputs(commands::GetGenInputFiles());
+  return loaded_;
+}
+
+base::FilePath QueryServer::GetBuildDir() const {
+  DCHECK(loaded_);
+  return setup_->build_settings().GetFullPath(
+      setup_->build_settings().build_dir());
+}
+
+bool QueryServer::ReloadIfInputsChanged() {
+  if (inputs_.InputsUnchanged())
+    return false;
+
+  base::ElapsedTimer timer;
+  if (Load() && !cmdline_.HasSwitch(switches::kQuiet)) {
+    OutputString("Reloaded the build graph in " +
+                 base::Int64ToString(timer.Elapsed().InMilliseconds()) +
+                 "ms\n");
+  }
+  return true;
+}
+
+std::string QueryServer::HandleRequest(const std::string& request,
+                                       bool* stop) {
+  std::string command;
+  std::vector<std::string> args;
+  std::string output;
+  int exit_code = 1;
+  Err err = ParseRequest(request, &command, &args);
+  if (err.has_error()) {
+    ScopedOutputCapture capture(&output);
+    err.PrintToStdout();
+  } else if (command == kStopCommand) {
+    *stop = true;
+    exit_code = 0;
+  } else {
+    exit_code = RunCommand(command, args, &output);
+  }
+
+  base::DictionaryValue response;
+  response.SetKey("exit_code", base::Value(exit_code));
+  response.SetKey("output", base::Value(output));
+  std::string json;
+  base::JSONWriter::Write(response, &json);
+  return json;
+}
+
+int QueryServer::RunCommand(const std::string& command,
+                            const std::vector<std::string>& args,
+                            std::string* output) {
+  ScopedOutputCapture capture(output);
+
+  if (std::find(std::begin(kQueryCommands), std::end(kQueryCommands),
+                command) == std::end(kQueryCommands)) {
+    Err(Location(), "\"" + command + "\" can't be run by gn serve.",
+        "It runs analyze, desc, outputs, path and refs, or stops.")
+        .PrintToStdout();
+    return 1;
+  }
+  if (!loaded_) {
+    OutputString(load_output_);
+    return 1;
+  }
+
+  // Parse the arguments as the command line of the command.
+  base::CommandLine::StringVector argv = {
+      base::CommandLine::UTF8ToStringType("gn"),
+      base::CommandLine::UTF8ToStringType(command),
+      base::CommandLine::UTF8ToStringType(build_dir_)};
+  for (const std::string& arg : args)
+    argv.push_back(base::CommandLine::UTF8ToStringType(arg));
+  base::CommandLine cmdline(argv);
+
+  std::vector<std::string> command_args;
+  for (const auto& arg : cmdline.GetArgs())
+    command_args.push_back(base::CommandLine::StringTypeToUTF8(arg));
+  command_args.erase(command_args.begin());
+
+  if (command == commands::kAnalyze && command_args.size() > 1 &&
+      command_args[1] == "-") {
+    Err(Location(), "gn serve can't read the analyze input from stdin.",
+        "Pass the path of a file with the input instead.")
+        .PrintToStdout();
+    return 1;
+  }
+
+  commands::CommandSwitches switches;
+  if (!commands::CommandSwitches::InitFromCommandLine(cmdline, &switches))
+    return 1;
+
+  // Commands read their switches from the command line of the process, and
+  // load the build graph with commands::LoadBuildGraph().
+  base::CommandLine* process_cmdline = base::CommandLine::ForCurrentProcess();
+  base::CommandLine saved_cmdline = *process_cmdline;
+  *process_cmdline = cmdline;
+  commands::CommandSwitches saved_switches =
+      commands::CommandSwitches::Set(std::move(switches));
+  commands::SetResidentSetup(setup_.get());
+
+  int exit_code = commands::GetCommands().at(command).runner(command_args);
+
+  commands::SetResidentSetup(nullptr);
+  commands::CommandSwitches::Set(std::move(saved_switches));
+  *process_cmdline = saved_cmdline;
+  return exit_code;
+}
+
+#if !defined(OS_WIN)
+
+bool QueryServer::Serve(const base::FilePath& socket_path,
+                        int poll_interval_ms,
+                        int client_timeout_ms,
+                        Err* err) {
+  std::string path = FilePathToUTF8(socket_path);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    *err = Err(Location(), "The socket path is too long.",
+               "\"" + path + "\" doesn't fit in a socket address.\n" +
+                   "Use --socket to pick a shorter one.");
+    return false;
+  }
+  memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  const sockaddr* address_ptr = reinterpret_cast<const sockaddr*>(&address);
+
+  // An existing socket nothing listens on anymore was left behind by a server
+  // that didn't exit cleanly.
+  base::ScopedFD probe = MakeSocket();
+  if (probe.is_valid() &&
+      HANDLE_EINTR(connect(probe.get(), address_ptr, sizeof(address))) == 0) {
+    *err = Err(Location(), "Another gn serve is already using " + path + ".");
+    return false;
+  }
+  probe.reset();
+  unlink(path.c_str());
+
+  // Only the user running the server may connect. Nobody can connect before
+  // listen(), so the socket doesn't need to be created with the right mode.
+  base::ScopedFD listener = MakeSocket();
+  if (!listener.is_valid() ||
+      bind(listener.get(), address_ptr, sizeof(address)) != 0 ||
+      chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+      listen(listener.get(), SOMAXCONN) != 0) {
+    *err = Err(Location(), "Could not listen on " + path + ".",
+               base::safe_strerror(errno));
+    return false;
+  }
+
+  bool stop = false;
+  while (!stop) {
+    pollfd poll_fd = {listener.get(), POLLIN, 0};
+    int ready = HANDLE_EINTR(poll(&poll_fd, 1, poll_interval_ms));
+    if (ready < 0) {
+      *err = Err(Location(), "Could not wait for clients on " + path + ".",
+                 base::safe_strerror(errno));
+      break;
+    }
+    if (ready == 0) {
+      ReloadIfInputsChanged();
+      continue;
+    }
+
+    base::ScopedFD client(
+        HANDLE_EINTR(accept(listener.get(), nullptr, nullptr)));
+    if (!client.is_valid())
+      continue;
+    DisableSigPipe(client.get());
+
+    // Answer each line the client sends until it closes its end or goes
+    // quiet. The last request doesn't need a newline.
+    std::string buffer;
+    bool open = true;
+    while (open && !stop) {
+      pollfd client_fd = {client.get(), POLLIN, 0};
+      if (HANDLE_EINTR(poll(&client_fd, 1, client_timeout_ms)) <= 0)
+        break;
+
+      char chunk[4096];
+      ssize_t result = HANDLE_EINTR(read(client.get(), chunk, sizeof(chunk)));
+      if (result > 0) {
+        buffer.append(chunk, result);
+      } else {
+        open = false;
+        if (result == 0 && !buffer.empty())
+          buffer.push_back('\n');
+      }
+
+      size_t newline;
+      while (!stop && (newline = buffer.find('\n')) != std::string::npos) {
+        std::string request = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        if (request.empty())
+          continue;
+        ReloadIfInputsChanged();
+        if (!WriteAll(client.get(), HandleRequest(request, &stop) + "\n")) {
+          buffer.clear();
+          open = false;
+        }
+      }
+    }
+  }
+
+  unlink(path.c_str());
+  return !err->has_error();
+}
+
+#else  // OS_WIN
+
+bool QueryServer::Serve(const base::FilePath& socket_path,
+                        int poll_interval_ms,
+                        int client_timeout_ms,
+                        Err* err) {
+  *err = Err(Location(), "gn serve isn't supported on Windows.",
+             "It needs Unix domain sockets, which are only supported on POSIX "
+             "systems.");
+  return false;
+}
+
+#endif  // OS_WIN
@@ -0,0 +1,93 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_QUERY_SERVER_H_
+#define TOOLS_GN_QUERY_SERVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "gn/gen_inputs_manifest.h"
+
+class Err;
+class Setup;
+
+// Keeps the build graph of a build directory loaded and runs the commands
+// that only query it, like "gn desc" or "gn refs", against it. This is what
+// "gn serve" does for the clients of its socket.
+//
+// Each request is a JSON object on its own line, like
+//
+//   {"command": "refs", "args": ["//base", "--tree"]}
+//
+// The arguments are the ones the command takes on the command line, without
+// the build directory. The response is a JSON object on its own line, with
+// the exit code and the output the command would have printed:
+//
+//   {"exit_code": 0, "output": "//base:base_unittests\n"}
+//
+// The files read by the last load are checked for changes before each
+// request, and periodically while there are none. Only files whose
+// modification time changed are read again, see GenInputsManifest. If any
+// changed contents, the build is loaded again from scratch.
+class QueryServer {
+ public:
+  // |cmdline| is the one of "gn serve", with switches like --root and
+  // --dotfile that apply to loading the build.
+  QueryServer(const std::string& build_dir, const base::CommandLine& cmdline);
+  ~QueryServer();
+
+  // Loads the build. Returns false, after printing the error, if it failed.
+  // Queries are then answered with that error until the inputs change.
+  bool Load();
+
+  // Loads the build again if a file read by the last load changed contents.
+  // Returns true if it did.
+  bool ReloadIfInputsChanged();
+
+  // Returns the absolute path of the build directory. The build must have
+  // been loaded successfully.
+  base::FilePath GetBuildDir() const;
+
+  // Returns the JSON response to the JSON |request|. Sets |stop| if the
+  // request asks the server to stop.
+  std::string HandleRequest(const std::string& request, bool* stop);
+
+  // Answers the requests of the clients connecting to a Unix domain socket
+  // created at |socket_path| until one of them asks to stop, and checks the
+  // inputs every |poll_interval_ms| while idle. Clients are served one at a
+  // time, and disconnected if they send nothing for |client_timeout_ms|.
+  // Returns false on failure, in which case |err| is set.
+  bool Serve(const base::FilePath& socket_path,
+             int poll_interval_ms,
+             int client_timeout_ms,
+             Err* err);
+
+ private:
+  // Runs |command| with |args|, which don't include the build directory.
+  // Returns its exit code and appends what it printed to |output|.
+  int RunCommand(const std::string& command,
+                 const std::vector<std::string>& args,
+                 std::string* output);
+
+  std::string build_dir_;
+  base::CommandLine cmdline_;
+
+  std::unique_ptr<Setup> setup_;
+  bool loaded_ = false;
+
+  // What the last load printed, returned to queries if it failed.
+  std::string load_output_;
+
+  // The files read by the last load, only used in memory.
+  GenInputsManifest inputs_;
+
+  QueryServer(const QueryServer&) = delete;
+  QueryServer& operator=(const QueryServer&) = delete;
+};
+
+#endif  // TOOLS_GN_QUERY_SERVER_H_
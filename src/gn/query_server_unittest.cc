@@ -0,0 +1,250 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/query_server.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/values.h"
+#include "gn/commands.h"
+#include "gn/filesystem_utils.h"
+#include "gn/switches.h"
+#include "gn/test_with_scheduler.h"
+#include "util/build_config.h"
+#include "util/test/test.h"
+
+#if !defined(OS_WIN)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#endif
+
+namespace {
+
+const char kDotfile[] = "buildconfig = \"//BUILDCONFIG.gn\"\n";
+
+const char kBuildConfig[] = "set_default_toolchain(\"//:toolchain\")\n";
+
+const char kBuildGn[] = R"(
+group("foo") {
+  deps = [ ":bar" ]
+}
+
+group("bar") {
+}
+
+toolchain("toolchain") {
+  tool("stamp") {
+    command = "stamp"
+  }
+}
+)";
+
+void WriteFile(const base::FilePath& path, const std::string& contents) {
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.data(),
+                            static_cast<int>(contents.size())));
+}
+
+#if !defined(OS_WIN)
+// Connects to the socket at |path|, waiting for the server to listen.
+base::ScopedFD Connect(const base::FilePath& path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  std::string path_string = FilePathToUTF8(path);
+  memcpy(address.sun_path, path_string.c_str(), path_string.size() + 1);
+  for (int attempt = 0; attempt < 500; attempt++) {
+    base::ScopedFD fd(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (HANDLE_EINTR(connect(fd.get(),
+                             reinterpret_cast<const sockaddr*>(&address),
+                             sizeof(address))) == 0)
+      return fd;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return base::ScopedFD();
+}
+#endif
+
+class QueryServerTest : public TestWithScheduler {
+ public:
+  void SetUp() override {
+    // The commands need the global switches, which the tests don't set.
+    static bool switches_initialized = false;
+    if (!switches_initialized) {
+      ASSERT_TRUE(commands::CommandSwitches::Init(
+          base::CommandLine(base::CommandLine::NO_PROGRAM)));
+      switches_initialized = true;
+    }
+
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    root_ = base::MakeAbsoluteFilePath(temp_dir_.GetPath());
+    WriteFile(root_.AppendASCII(".gn"), kDotfile);
+    WriteFile(root_.AppendASCII("BUILDCONFIG.gn"), kBuildConfig);
+    WriteFile(root_.AppendASCII("BUILD.gn"), kBuildGn);
+    ASSERT_TRUE(base::CreateDirectory(root_.AppendASCII("out")));
+    WriteFile(root_.AppendASCII("out").AppendASCII("args.gn"), "");
+    WriteFile(root_.AppendASCII("out").AppendASCII("build.ninja"), "");
+
+    base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+    cmdline.AppendSwitch(switches::kRoot, FilePathToUTF8(root_));
+    cmdline.AppendSwitch(switches::kQuiet);
+    server_ = std::make_unique<QueryServer>("//out", cmdline);
+  }
+
+  // Sends |request| and returns the exit code, filling |output|.
+  int Query(const std::string& request, std::string* output) {
+    bool stop = false;
+    std::unique_ptr<base::Value> response =
+        base::JSONReader::Read(server_->HandleRequest(request, &stop));
+    EXPECT_TRUE(response && response->is_dict());
+    EXPECT_FALSE(stop);
+    if (!response || !response->is_dict())
+      return -1;
+    const base::Value* exit_code =
+        response->FindKeyOfType("exit_code", base::Value::Type::INTEGER);
+    const base::Value* output_value =
+        response->FindKeyOfType("output", base::Value::Type::STRING);
+    EXPECT_TRUE(exit_code && output_value);
+    if (!exit_code || !output_value)
+      return -1;
+    *output = output_value->GetString();
+    return exit_code->GetInt();
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath root_;
+  std::unique_ptr<QueryServer> server_;
+};
+
+}  // namespace
+
+TEST_F(QueryServerTest, Queries) {
+  ASSERT_TRUE(server_->Load());
+  EXPECT_FALSE(server_->ReloadIfInputsChanged());
+
+  std::string output;
+  EXPECT_EQ(0, Query(R"({"command": "refs", "args": ["//:bar"]})", &output));
+  EXPECT_EQ("//:foo\n", output);
+
+  // Switches are passed to the command.
+  EXPECT_EQ(0, Query(R"({"command": "refs", "args": ["//:bar", "--all"]})",
+                     &output));
+  EXPECT_EQ("//:foo\n", output);
+  EXPECT_EQ(0, Query(R"({"command": "desc", "args": ["//:foo", "deps"]})",
+                     &output));
+  EXPECT_EQ("//:bar\n", output);
+
+  EXPECT_EQ(1, Query(R"({"command": "gen"})", &output));
+  EXPECT_NE(std::string::npos, output.find("can't be run by gn serve"));
+
+  EXPECT_EQ(1, Query("{\"command\": \"refs\"", &output));
+  EXPECT_NE(std::string::npos, output.find("not a JSON object"));
+  EXPECT_EQ(1, Query(R"({"command": "refs", "args": [1]})", &output));
+
+  bool stop = false;
+  server_->HandleRequest(R"({"command": "stop"})", &stop);
+  EXPECT_TRUE(stop);
+}
+
+TEST_F(QueryServerTest, Reload) {
+  ASSERT_TRUE(server_->Load());
+
+  WriteFile(root_.AppendASCII("BUILD.gn"),
+            std::string(kBuildGn) + "group(\"baz\") { deps = [ \":bar\" ] }\n");
+  EXPECT_TRUE(server_->ReloadIfInputsChanged());
+  std::string output;
+  EXPECT_EQ(0, Query(R"({"command": "refs", "args": ["//:bar"]})", &output));
+  EXPECT_EQ("//:baz\n//:foo\n", output);
+
+  // Queries fail with the error of a failed load until it is fixed.
+  WriteFile(root_.AppendASCII("BUILD.gn"), std::string(kBuildGn) + "group(");
+  EXPECT_TRUE(server_->ReloadIfInputsChanged());
+  EXPECT_EQ(1, Query(R"({"command": "refs", "args": ["//:bar"]})", &output));
+  EXPECT_NE(std::string::npos, output.find("BUILD.gn"));
+
+  WriteFile(root_.AppendASCII("BUILD.gn"), kBuildGn);
+  EXPECT_TRUE(server_->ReloadIfInputsChanged());
+  EXPECT_EQ(0, Query(R"({"command": "refs", "args": ["//:bar"]})", &output));
+  EXPECT_EQ("//:foo\n", output);
+}
+
+// Directories read by glob_files() only count as changed when their entries
+// do.
+TEST_F(QueryServerTest, DirectoryInput) {
+  WriteFile(root_.AppendASCII("BUILD.gn"), std::string(kBuildGn) + R"(
+group("globbed") {
+  metadata = {
+    files = glob_files("src")
+  }
+}
+)");
+  ASSERT_TRUE(base::CreateDirectory(root_.AppendASCII("src")));
+  WriteFile(root_.AppendASCII("src").AppendASCII("a.cc"), "a");
+  ASSERT_TRUE(server_->Load());
+  EXPECT_FALSE(server_->ReloadIfInputsChanged());
+
+  WriteFile(root_.AppendASCII("src").AppendASCII("a.cc"), "b");
+  EXPECT_FALSE(server_->ReloadIfInputsChanged());
+
+  WriteFile(root_.AppendASCII("src").AppendASCII("b.cc"), "b");
+  EXPECT_TRUE(server_->ReloadIfInputsChanged());
+  EXPECT_FALSE(server_->ReloadIfInputsChanged());
+}
+
+#if !defined(OS_WIN)
+// A client that sends nothing doesn't keep the next one waiting. Only the
+// user may connect to the socket.
+TEST_F(QueryServerTest, ServeDisconnectsIdleClients) {
+  ASSERT_TRUE(server_->Load());
+  base::FilePath socket_path = root_.AppendASCII("gn.sock");
+
+  std::string responses;
+  std::thread client([&socket_path, &responses]() {
+    base::ScopedFD idle = Connect(socket_path);
+    ASSERT_TRUE(idle.is_valid());
+    struct stat socket_info;
+    ASSERT_EQ(0, stat(socket_path.value().c_str(), &socket_info));
+    mode_t permissions = socket_info.st_mode & 0777;
+    EXPECT_EQ(static_cast<mode_t>(S_IRUSR | S_IWUSR), permissions);
+    base::ScopedFD active = Connect(socket_path);
+    ASSERT_TRUE(active.is_valid());
+
+    std::string requests =
+        R"({"command": "refs", "args": ["//:bar"]})"
+        "\n"
+        R"({"command": "stop"})"
+        "\n";
+    ASSERT_EQ(static_cast<ssize_t>(requests.size()),
+              HANDLE_EINTR(
+                  write(active.get(), requests.data(), requests.size())));
+    char chunk[4096];
+    ssize_t result;
+    while ((result = HANDLE_EINTR(read(active.get(), chunk, sizeof(chunk)))) >
+           0)
+      responses.append(chunk, result);
+  });
+
+  Err err;
+  EXPECT_TRUE(server_->Serve(socket_path, 1000, 100, &err)) << err.message();
+  client.join();
+  EXPECT_EQ(R"({"exit_code":0,"output":"//:foo\n"})"
+            "\n"
+            R"({"exit_code":0,"output":""})"
+            "\n",
+            responses);
+  EXPECT_FALSE(base::PathExists(socket_path));
+}
+#endif  // !defined(OS_WIN)
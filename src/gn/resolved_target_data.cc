@@ -5,6 +5,33 @@
 #include "gn/resolved_target_data.h"
 
 #include "gn/config_values_extractors.h"
+#include "gn/memory_stats.h"
+
+size_t ResolvedTargetData::EstimateMemoryUsage() const {
+  std::shared_lock<std::shared_mutex> lock(map_mutex_);
+  size_t result = VectorHeapBytes(targets_.vector()) +
+                  2 * targets_.size() * sizeof(size_t) + VectorHeapBytes(infos_);
+  for (const auto& info : infos_) {
+    result += sizeof(TargetInfo) + info->deps.size() * sizeof(const Target*);
+    std::lock_guard<std::mutex> info_lock(info->mutex);
+    result += VectorHeapBytes(info->lib_dirs) + VectorHeapBytes(info->libs) +
+              VectorHeapBytes(info->framework_dirs) +
+              VectorHeapBytes(info->frameworks) +
+              VectorHeapBytes(info->weak_frameworks) +
+              VectorHeapBytes(info->weak_libraries) +
+              info->hard_deps.heap_bytes() +
+              VectorHeapBytes(info->inherited_libs) +
+              VectorHeapBytes(info->module_deps_information) +
+              VectorHeapBytes(info->rust_inherited_libs) +
+              VectorHeapBytes(info->rust_inheritable_libs);
+    if (info->swift_values) {
+      result += sizeof(TargetInfo::SwiftValues) +
+                VectorHeapBytes(info->swift_values->modules) +
+                VectorHeapBytes(info->swift_values->public_modules);
+    }
+  }
+  return result;
+}
 
 ResolvedTargetData::TargetInfo* ResolvedTargetData::GetTargetInfo(
     const Target* target) const {
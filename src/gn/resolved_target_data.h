@@ -45,6 +45,9 @@
 //
 class ResolvedTargetData {
  public:
+  // Returns the approximate number of bytes held by the data computed so far.
+  size_t EstimateMemoryUsage() const;
+
   // Return the public/private/data/dependencies of a given target
   // as a ResolvedTargetDeps instance.
   const ResolvedTargetDeps& GetTargetDeps(const Target* target) const {
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "gn/execution_record.h"
 #include "gn/standard_out.h"
 #include "gn/target.h"
 
@@ -29,7 +30,8 @@ bool Scheduler::Run() {
   CHECK(!is_running_);
 
   // Ensure there is at least one task, (or else this will wait forever).
-  if (is_failed_ || (work_count_.IsZero() && pool_work_count_.IsZero())) {
+  // Helper work doesn't count, since nothing signals when it's done.
+  if (is_failed_ || work_count_.IsZero()) {
     // Flush any posted tasks (that were posted from the UI thread).
     main_thread_run_loop_->PostQuit();
     main_thread_run_loop_->Run();
@@ -82,9 +84,23 @@ void Scheduler::ScheduleWork(std::function<void()> work) {
   });
 }
 
+void Scheduler::ScheduleHelperWork(std::function<void()> work) {
+  pool_work_count_.Increment();
+  worker_pool_.PostTask([this, work = std::move(work)]() {
+    work();
+    if (!pool_work_count_.Decrement()) {
+      std::unique_lock<std::mutex> auto_lock(pool_work_count_lock_);
+      pool_work_count_cv_.notify_one();
+    }
+  });
+}
+
 void Scheduler::AddGenDependency(const base::FilePath& file) {
+  if (ExecutionRecord* record = ExecutionRecord::Current())
+    record->AddGenDependency(file, SourceFile());
   std::lock_guard<std::mutex> lock(lock_);
   gen_dependencies_.push_back(file);
+  unattributed_gen_dependencies_.insert(file);
 }
 
 std::vector<base::FilePath> Scheduler::GetGenDependencies() const {
@@ -92,7 +108,30 @@ std::vector<base::FilePath> Scheduler::GetGenDependencies() const {
   return gen_dependencies_;
 }
 
+void Scheduler::AddGenDependency(const base::FilePath& file,
+                                 const SourceFile& reader) {
+  if (ExecutionRecord* record = ExecutionRecord::Current())
+    record->AddGenDependency(file, reader);
+  std::lock_guard<std::mutex> lock(lock_);
+  gen_dependencies_.push_back(file);
+  gen_dependency_readers_[file].insert(reader);
+}
+
+std::map<base::FilePath, SourceFileSet> Scheduler::GetGenDependencyReaders()
+    const {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::map<base::FilePath, SourceFileSet> result;
+  for (const auto& [file, readers] : gen_dependency_readers_) {
+    if (unattributed_gen_dependencies_.find(file) ==
+        unattributed_gen_dependencies_.end())
+      result.emplace(file, readers);
+  }
+  return result;
+}
+
 void Scheduler::AddWrittenFile(const SourceFile& file) {
+  if (ExecutionRecord* record = ExecutionRecord::Current())
+    record->AddWrittenFile(file);
   std::lock_guard<std::mutex> lock(lock_);
   written_files_.push_back(file);
 }
@@ -9,9 +9,11 @@
 #include <functional>
 #include <map>
 #include <mutex>
+#include <set>
 
 #include "base/atomic_ref_count.h"
 #include "base/files/file_path.h"
+#include "gn/file_system_cache.h"
 #include "gn/input_file_manager.h"
 #include "gn/label.h"
 #include "gn/source_file.h"
@@ -36,6 +38,10 @@ class Scheduler {
 
   InputFileManager* input_file_manager() { return input_file_manager_.get(); }
 
+  // Cache for the file system queries made by build files. Callers must
+  // still declare what they consult with AddGenDependency().
+  FileSystemCache* file_system_cache() { return &file_system_cache_; }
+
   bool verbose_logging() const { return verbose_logging_; }
   void set_verbose_logging(bool v) { verbose_logging_ = v; }
 
@@ -47,6 +53,15 @@ class Scheduler {
 
   void ScheduleWork(std::function<void()> work);
 
+  // Number of threads running the tasks posted by ScheduleWork().
+  size_t worker_thread_count() const { return worker_pool_.thread_count(); }
+
+  // Like ScheduleWork() but the task doesn't count as outstanding work that
+  // keeps Run() going. This is for tasks that only help with work another
+  // task is already doing and waiting for, which may be running outside of
+  // Run() (e.g. on the main thread while the dotfile is processed).
+  void ScheduleHelperWork(std::function<void()> work);
+
   void Shutdown();
 
   // Declares that the given file was read and affected the build output.
@@ -57,9 +72,21 @@ class Scheduler {
   // start using >1 build settings, then we probably want this to take a
   // BuildSettings object so we know the dependency on a per-build basis.
   // If moved, most of the Add/Get functions below should move as well.
+  //
+  // This and the other Add functions for what build files do also add it to
+  // the current ExecutionRecord of the thread, if any.
   void AddGenDependency(const base::FilePath& file);
   std::vector<base::FilePath> GetGenDependencies() const;
 
+  // Like AddGenDependency() for a file or directory consulted by the build
+  // file |reader|, so that only what depends on |reader| depends on |file|.
+  void AddGenDependency(const base::FilePath& file, const SourceFile& reader);
+
+  // Returns the build files that read each gen dependency added with a
+  // reader. Dependencies that were also added without one are left out, since
+  // anything may depend on them.
+  std::map<base::FilePath, SourceFileSet> GetGenDependencyReaders() const;
+
   // Tracks calls to write_file for resolving with the unknown generated
   // inputs (see AddUnknownGeneratedInput below).
   void AddWrittenFile(const SourceFile& file);
@@ -114,6 +141,8 @@ class Scheduler {
 
   scoped_refptr<InputFileManager> input_file_manager_;
 
+  FileSystemCache file_system_cache_;
+
   bool verbose_logging_ = false;
 
   base::AtomicRefCount work_count_;
@@ -145,6 +174,8 @@ class Scheduler {
 
   // Protected by the lock. See the corresponding Add/Get functions above.
   std::vector<base::FilePath> gen_dependencies_;
+  std::map<base::FilePath, SourceFileSet> gen_dependency_readers_;
+  std::set<base::FilePath> unattributed_gen_dependencies_;
   std::vector<SourceFile> written_files_;
   std::vector<const Target*> write_runtime_deps_targets_;
   std::multimap<SourceFile, const Target*> unknown_generated_inputs_;
@@ -0,0 +1,55 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/scheduler.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+#include "gn/test_with_scheduler.h"
+#include "util/test/test.h"
+
+using SchedulerTest = TestWithScheduler;
+
+// Helper work that is still running must not keep Run() waiting, since
+// nothing would tell it when that work is done.
+TEST_F(SchedulerTest, RunIgnoresHelperWork) {
+  std::mutex lock;
+  std::condition_variable cv;
+  bool released = false;
+  bool finished = false;
+  scheduler().ScheduleHelperWork([&]() {
+    std::unique_lock<std::mutex> auto_lock(lock);
+    cv.wait(auto_lock, [&]() { return released; });
+    finished = true;
+    cv.notify_all();
+  });
+
+  EXPECT_TRUE(scheduler().Run());
+
+  std::unique_lock<std::mutex> auto_lock(lock);
+  released = true;
+  cv.notify_all();
+  cv.wait(auto_lock, [&]() { return finished; });
+}
+
+// A gen dependency is only attributed to its readers if it was never added
+// without one.
+TEST_F(SchedulerTest, GenDependencyReaders) {
+  base::FilePath globbed(FILE_PATH_LITERAL("/src/dir"));
+  base::FilePath shared(FILE_PATH_LITERAL("/src/shared"));
+  scheduler().AddGenDependency(globbed, SourceFile("//a/BUILD.gn"));
+  scheduler().AddGenDependency(globbed, SourceFile("//b/BUILD.gn"));
+  scheduler().AddGenDependency(shared, SourceFile("//a/BUILD.gn"));
+  scheduler().AddGenDependency(shared);
+
+  std::map<base::FilePath, SourceFileSet> readers =
+      scheduler().GetGenDependencyReaders();
+  ASSERT_EQ(1u, readers.size());
+  EXPECT_EQ(SourceFileSet({SourceFile("//a/BUILD.gn"),
+                           SourceFile("//b/BUILD.gn")}),
+            readers[globbed]);
+  EXPECT_EQ(4u, scheduler().GetGenDependencies().size());
+}
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "base/logging.h"
+#include "gn/memory_stats.h"
 #include "gn/parse_tree.h"
 #include "gn/source_file.h"
 #include "gn/template.h"
@@ -73,6 +74,7 @@ void Scope::DetachFromContaining() {
   const_containing_ = nullptr;
   mutable_containing_ = nullptr;
   build_dependency_files_ = CollectBuildDependencyFiles();
+  InvalidateClosureSnapshot();
 }
 
 bool Scope::HasValues(SearchNested search_nested) const {
@@ -80,14 +82,24 @@ bool Scope::HasValues(SearchNested search_nested) const {
   return !values_.empty();
 }
 
-const Value* Scope::GetValue(std::string_view ident, bool counts_as_used) {
+const Value* Scope::GetValue(StringAtom ident, bool counts_as_used) const {
   const Scope* found_in_scope = nullptr;
   return GetValueWithScope(ident, counts_as_used, &found_in_scope);
 }
 
-const Value* Scope::GetValueWithScope(std::string_view ident,
+const Value* Scope::GetValueWithScope(StringAtom ident,
                                       bool counts_as_used,
-                                      const Scope** found_in_scope) {
+                                      const Scope** found_in_scope) const {
+  const Value* value =
+      FindValueWithScope(ident, counts_as_used, found_in_scope);
+  if (value && lookup_observer_)
+    lookup_observer_->OnValueFound(ident, *value, *found_in_scope);
+  return value;
+}
+
+const Value* Scope::FindValueWithScope(StringAtom ident,
+                                       bool counts_as_used,
+                                       const Scope** found_in_scope) const {
   // First check for programmatically-provided values.
   for (auto* provider : programmatic_providers_) {
     const Value* v = provider->GetProgrammaticValue(ident);
@@ -97,12 +109,12 @@ const Value* Scope::GetValueWithScope(std::string_view ident,
     }
   }
 
-  RecordMap::iterator found = values_.find(ident);
-  if (found != values_.end()) {
+  const Record* found = values_.Find(ident);
+  if (found) {
     if (counts_as_used)
-      found->second.used = true;
+      found->MarkUsed();
     *found_in_scope = this;
-    return &found->second.value;
+    return &found->value;
   }
 
   // Search in the parent scope.
@@ -115,15 +127,16 @@ const Value* Scope::GetValueWithScope(std::string_view ident,
   return nullptr;
 }
 
-Value* Scope::GetMutableValue(std::string_view ident,
+Value* Scope::GetMutableValue(StringAtom ident,
                               SearchNested search_mode,
                               bool counts_as_used) {
   // Don't do programmatic values, which are not mutable.
-  RecordMap::iterator found = values_.find(ident);
-  if (found != values_.end()) {
+  Record* found = values_.Find(ident);
+  if (found) {
     if (counts_as_used)
-      found->second.used = true;
-    return &found->second.value;
+      found->used = true;
+    NoteValueChanged(ident);
+    return &found->value;
   }
 
   // Search in the parent mutable scope if requested, but not const one.
@@ -135,9 +148,9 @@ Value* Scope::GetMutableValue(std::string_view ident,
 }
 
 std::string_view Scope::GetStorageKey(std::string_view ident) const {
-  RecordMap::const_iterator found = values_.find(ident);
-  if (found != values_.end())
-    return found->first;
+  StringAtom atom(ident);
+  if (values_.Find(atom))
+    return atom;
 
   // Search in parent scope.
   if (containing())
@@ -145,44 +158,50 @@ std::string_view Scope::GetStorageKey(std::string_view ident) const {
   return std::string_view();
 }
 
-const Value* Scope::GetValue(std::string_view ident) const {
+const Value* Scope::GetValue(StringAtom ident) const {
   const Scope* found_in_scope = nullptr;
   return GetValueWithScope(ident, &found_in_scope);
 }
 
-const Value* Scope::GetValueWithScope(std::string_view ident,
+const Value* Scope::GetValueWithScope(StringAtom ident,
                                       const Scope** found_in_scope) const {
-  RecordMap::const_iterator found = values_.find(ident);
-  if (found != values_.end()) {
+  const Value* value = FindValueWithScope(ident, found_in_scope);
+  if (value && lookup_observer_)
+    lookup_observer_->OnValueFound(ident, *value, *found_in_scope);
+  return value;
+}
+
+const Value* Scope::FindValueWithScope(StringAtom ident,
+                                       const Scope** found_in_scope) const {
+  const Record* found = values_.Find(ident);
+  if (found) {
     *found_in_scope = this;
-    return &found->second.value;
+    return &found->value;
   }
   if (containing())
     return containing()->GetValueWithScope(ident, found_in_scope);
   return nullptr;
 }
 
-Value* Scope::SetValue(std::string_view ident,
+Value* Scope::SetValue(StringAtom ident,
                        Value v,
                        const ParseNode* set_node) {
   Record& r = values_[ident];  // Clears any existing value.
   r.value = std::move(v);
   r.value.set_origin(set_node);
+  NoteValueChanged(ident);
   return &r.value;
 }
 
 void Scope::RemoveIdentifier(std::string_view ident) {
-  RecordMap::iterator found = values_.find(ident);
-  if (found != values_.end())
-    values_.erase(found);
+  values_.erase(StringAtom(ident));
+  InvalidateClosureSnapshot();
 }
 
 void Scope::RemovePrivateIdentifiers() {
-  // Do it in two phases to avoid mutating while iterating. Our hash map is
-  // currently backed by several different vendor-specific implementations and
-  // I'm not sure if all of them support mutating while iterating. Since this
-  // is not perf-critical, do the safe thing.
-  std::vector<std::string_view> to_remove;
+  // Do it in two phases to avoid mutating while iterating. Since this is not
+  // perf-critical, do the safe thing.
+  std::vector<StringAtom> to_remove;
   for (const auto& cur : values_) {
     if (IsPrivateVar(cur.first))
       to_remove.push_back(cur.first);
@@ -190,12 +209,15 @@ void Scope::RemovePrivateIdentifiers() {
 
   for (const auto& cur : to_remove)
     values_.erase(cur);
+  if (!to_remove.empty())
+    InvalidateClosureSnapshot();
 }
 
 bool Scope::AddTemplate(const std::string& name, const Template* templ) {
   if (GetTemplate(name))
     return false;
   templates_[name] = templ;
+  NoteTemplateChanged(name);
   return true;
 }
 
@@ -231,43 +253,43 @@ SourceFileSet Scope::CollectBuildDependencyFiles() const {
   return result;
 }
 
-void Scope::MarkUsed(std::string_view ident) {
-  RecordMap::iterator found = values_.find(ident);
-  if (found == values_.end()) {
+void Scope::MarkUsed(std::string_view ident) const {
+  const Record* found = values_.Find(StringAtom(ident));
+  if (!found) {
     NOTREACHED();
     return;
   }
-  found->second.used = true;
+  found->MarkUsed();
 }
 
-void Scope::MarkAllUsed() {
-  for (auto& cur : values_)
-    cur.second.used = true;
+void Scope::MarkAllUsed() const {
+  for (const auto& cur : values_)
+    cur.second.MarkUsed();
 }
 
-void Scope::MarkAllUsed(const std::set<std::string>& excluded_values) {
-  for (auto& cur : values_) {
+void Scope::MarkAllUsed(const std::set<std::string>& excluded_values) const {
+  for (const auto& cur : values_) {
     if (!excluded_values.empty() &&
-        excluded_values.find(std::string(cur.first)) != excluded_values.end()) {
+        excluded_values.find(cur.first.str()) != excluded_values.end()) {
       continue;  // Skip this excluded value.
     }
-    cur.second.used = true;
+    cur.second.MarkUsed();
   }
 }
 
 void Scope::MarkUnused(std::string_view ident) {
-  RecordMap::iterator found = values_.find(ident);
-  if (found == values_.end()) {
+  Record* found = values_.Find(StringAtom(ident));
+  if (!found) {
     NOTREACHED();
     return;
   }
-  found->second.used = false;
+  found->used = false;
 }
 
 bool Scope::IsSetButUnused(std::string_view ident) const {
-  RecordMap::const_iterator found = values_.find(ident);
-  if (found != values_.end()) {
-    if (!found->second.used) {
+  const Record* found = values_.Find(StringAtom(ident));
+  if (found) {
+    if (!found->used) {
       return true;
     }
   }
@@ -278,7 +300,7 @@ bool Scope::CheckForUnusedVars(Err* err) const {
   for (const auto& pair : values_) {
     if (!pair.second.used) {
       std::string help =
-          "You set the variable \"" + std::string(pair.first) +
+          "You set the variable \"" + pair.first.str() +
           "\" here and it was unused before it went\nout of scope.";
 
       // Gather the template invocations that led up to this scope.
@@ -335,11 +357,11 @@ bool Scope::NonRecursiveMergeTo(Scope* dest,
                                 Err* err) const {
   // Values.
   for (const auto& pair : values_) {
-    const std::string_view current_name = pair.first;
+    const StringAtom current_name = pair.first;
     if (options.skip_private_vars && IsPrivateVar(current_name))
       continue;  // Skip this private var.
     if (!options.excluded_values.empty() &&
-        options.excluded_values.find(std::string(current_name)) !=
+        options.excluded_values.find(current_name.str()) !=
             options.excluded_values.end()) {
       continue;  // Skip this excluded value.
     }
@@ -352,7 +374,7 @@ bool Scope::NonRecursiveMergeTo(Scope* dest,
         std::string desc_string(desc_for_err);
         *err = Err(node_for_err, "Value collision.",
                    "This " + desc_string + " contains \"" +
-                       std::string(current_name) + "\"");
+                       current_name.str() + "\"");
         err->AppendSubErr(
             Err(pair.second.value, "defined here.",
                 "Which would clobber the one in your current scope"));
@@ -365,6 +387,7 @@ bool Scope::NonRecursiveMergeTo(Scope* dest,
       }
     }
     dest->values_[current_name] = pair.second;
+    dest->NoteValueChanged(current_name);
 
     if (options.mark_dest_used)
       dest->MarkUsed(current_name);
@@ -410,6 +433,7 @@ bool Scope::NonRecursiveMergeTo(Scope* dest,
       }
     }
 
+    dest->InvalidateClosureSnapshot();
     std::unique_ptr<Scope>& dest_scope = dest->target_defaults_[current_name];
     dest_scope = std::make_unique<Scope>(settings_);
     pair.second->NonRecursiveMergeTo(dest_scope.get(), options, node_for_err,
@@ -452,6 +476,7 @@ bool Scope::NonRecursiveMergeTo(Scope* dest,
 
     // Be careful to delete any pointer we're about to clobber.
     dest->templates_[current_name] = pair.second;
+    dest->NoteTemplateChanged(current_name);
   }
 
   // Propagate build dependency files,
@@ -488,12 +513,67 @@ std::unique_ptr<Scope> Scope::MakeClosure() const {
   return result;
 }
 
+scoped_refptr<const ClosureSnapshot> Scope::MakeClosureSnapshot() {
+  // Beyond this many layers, lookups of values defined in the file scope or
+  // not defined at all walk too many scopes; take a full copy instead.
+  constexpr size_t kMaxClosureDepth = 8;
+
+  if (mutable_containing_) {
+    // The containing scopes can change without this scope knowing.
+    return base::MakeRefCounted<ClosureSnapshot>(MakeClosure(), nullptr);
+  }
+
+  if (last_closure_ && changed_values_.empty() && changed_templates_.empty())
+    return last_closure_;
+
+  if (last_closure_ && last_closure_->depth() < kMaxClosureDepth) {
+    auto layer = std::make_unique<Scope>(last_closure_->scope());
+    for (StringAtom ident : changed_values_) {
+      const Record* found = values_.Find(ident);
+      DCHECK(found);  // Removing a value invalidates the snapshot.
+      layer->values_[ident] = *found;
+    }
+    for (const std::string& name : changed_templates_)
+      layer->templates_[name] = templates_[name];
+    layer->build_dependency_files_ = build_dependency_files_;
+    last_closure_ =
+        base::MakeRefCounted<ClosureSnapshot>(std::move(layer), last_closure_);
+  } else {
+    last_closure_ = base::MakeRefCounted<ClosureSnapshot>(MakeClosure(), nullptr);
+  }
+  changed_values_.clear();
+  changed_templates_.clear();
+  return last_closure_;
+}
+
+void Scope::InvalidateClosureSnapshot() {
+  last_closure_ = nullptr;
+  changed_values_.clear();
+  changed_templates_.clear();
+}
+
 Scope* Scope::MakeTargetDefaults(const std::string& target_type) {
+  InvalidateClosureSnapshot();
   std::unique_ptr<Scope>& dest = target_defaults_[target_type];
   dest = std::make_unique<Scope>(settings_);
   return dest.get();
 }
 
+size_t Scope::EstimateMemoryUsage(std::unordered_set<const void*>* seen) const {
+  size_t result = sizeof(Scope);
+  for (const auto& pair : values_)
+    result += sizeof(pair) + pair.second.value.EstimateMemoryUsage(seen);
+  for (const auto& pair : target_defaults_) {
+    result += sizeof(pair) + StringHeapBytes(pair.first) +
+              pair.second->EstimateMemoryUsage(seen);
+  }
+  for (const auto& pair : templates_) {
+    result += sizeof(pair) + StringHeapBytes(pair.first) +
+              pair.second->EstimateMemoryUsage(seen);
+  }
+  return result;
+}
+
 const Scope* Scope::GetTargetDefaults(const std::string& target_type) const {
   NamedScopeMap::const_iterator found = target_defaults_.find(target_type);
   if (found != target_defaults_.end())
@@ -635,11 +715,19 @@ bool Scope::RecordMapValuesEqual(const RecordMap& a, const RecordMap& b) {
   if (a.size() != b.size())
     return false;
   for (const auto& pair : a) {
-    const auto& found_b = b.find(pair.first);
-    if (found_b == b.end())
+    const Record* found_b = b.Find(pair.first);
+    if (!found_b)
       return false;  // Item in 'a' but not 'b'.
-    if (pair.second.value != found_b->second.value)
+    if (pair.second.value != found_b->value)
       return false;  // Values for variable in 'a' and 'b' are different.
   }
   return true;
 }
+
+ClosureSnapshot::ClosureSnapshot(std::unique_ptr<const Scope> scope,
+                                 scoped_refptr<const ClosureSnapshot> base)
+    : base_(std::move(base)),
+      scope_(std::move(scope)),
+      depth_(base_ ? base_->depth() + 1 : 1) {}
+
+ClosureSnapshot::~ClosureSnapshot() = default;
@@ -5,12 +5,14 @@
 #ifndef TOOLS_GN_SCOPE_H_
 #define TOOLS_GN_SCOPE_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -20,8 +22,11 @@
 #include "gn/pattern.h"
 #include "gn/source_dir.h"
 #include "gn/source_file.h"
+#include "gn/string_atom.h"
+#include "gn/string_atom_map.h"
 #include "gn/value.h"
 
+class ClosureSnapshot;
 class Item;
 class ParseNode;
 class Settings;
@@ -33,11 +38,23 @@ class Template;
 // values recursively down the stack until a match is found or there are no
 // more containing scopes.
 //
+// Variable names are interned as StringAtoms and stored in a small map keyed
+// by atom pointer, so lookups never hash or compare the strings themselves.
+// Identifier tokens are interned when tokenizing (see Token::atom()), and the
+// StringAtom overloads below should be preferred on hot paths. The
+// std::string_view overloads intern their argument first.
+//
 // A containing scope can be const or non-const. The const containing scope is
 // used primarily to refer to the master build config which is shared across
 // many invocations. A const containing scope, however, prevents us from
 // marking variables "used" which prevents us from issuing errors on unused
 // variables. So you should use a non-const containing scope whenever possible.
+//
+// Whether a variable was used isn't part of its value: lookups that count as
+// a use and the MarkUsed() functions also work on const scopes. This lets
+// callers read from the scope of a Value through the const accessor, which
+// doesn't copy storage shared with other copies of the Value (see Value).
+// Shared storage may be read from several threads, so the marks are atomic.
 class Scope {
  public:
   using KeyValueMap = std::map<std::string_view, Value>;
@@ -66,6 +83,19 @@ class Scope {
     Scope* scope_;
   };
 
+  // Notified of the values found by the lookups made in a scope, see
+  // set_lookup_observer().
+  class LookupObserver {
+   public:
+    // |found_in_scope| is as for GetValueWithScope().
+    virtual void OnValueFound(StringAtom ident,
+                              const Value& value,
+                              const Scope* found_in_scope) = 0;
+
+   protected:
+    virtual ~LookupObserver() = default;
+  };
+
   // Options for configuring scope merges.
   struct MergeOptions {
     MergeOptions();
@@ -151,13 +181,19 @@ class Scope {
   // found_in_scope is set to the scope that contains the definition of the
   // ident. If the value was provided programmatically (like host_cpu),
   // found_in_scope will be set to null.
-  const Value* GetValue(std::string_view ident, bool counts_as_used);
-  const Value* GetValue(std::string_view ident) const;
-  const Value* GetValueWithScope(std::string_view ident,
+  const Value* GetValue(StringAtom ident, bool counts_as_used) const;
+  const Value* GetValue(std::string_view ident, bool counts_as_used) const {
+    return GetValue(StringAtom(ident), counts_as_used);
+  }
+  const Value* GetValue(StringAtom ident) const;
+  const Value* GetValue(std::string_view ident) const {
+    return GetValue(StringAtom(ident));
+  }
+  const Value* GetValueWithScope(StringAtom ident,
                                  const Scope** found_in_scope) const;
-  const Value* GetValueWithScope(std::string_view ident,
+  const Value* GetValueWithScope(StringAtom ident,
                                  bool counts_as_used,
-                                 const Scope** found_in_scope);
+                                 const Scope** found_in_scope) const;
 
   // Returns the requested value as a mutable one if possible. If the value
   // is not found in a mutable scope, then returns null. Note that the value
@@ -181,9 +217,19 @@ class Scope {
   //    }
   // The 6 should get set on the nested scope rather than modify the value
   // in the outer one.
-  Value* GetMutableValue(std::string_view ident,
+  //
+  // This is only for writing: the value is recorded as changed for
+  // MakeClosureSnapshot(), and a list or scope it holds stops sharing its
+  // storage when modified. Code that only reads a value, even if it marks it
+  // as used, should call GetValue().
+  Value* GetMutableValue(StringAtom ident,
                          SearchNested search_mode,
                          bool counts_as_used);
+  Value* GetMutableValue(std::string_view ident,
+                         SearchNested search_mode,
+                         bool counts_as_used) {
+    return GetMutableValue(StringAtom(ident), search_mode, counts_as_used);
+  }
 
   // Returns the std::string_view used to identify the value. This string piece
   // will have the same contents as "ident" passed in, but may point to a
@@ -196,7 +242,10 @@ class Scope {
   // The set_node indicates the statement that caused the set, for displaying
   // errors later. Returns a pointer to the value in the current scope (a copy
   // is made for storage).
-  Value* SetValue(std::string_view ident, Value v, const ParseNode* set_node);
+  Value* SetValue(StringAtom ident, Value v, const ParseNode* set_node);
+  Value* SetValue(std::string_view ident, Value v, const ParseNode* set_node) {
+    return SetValue(StringAtom(ident), std::move(v), set_node);
+  }
 
   // Removes the value with the given identifier if it exists on the current
   // scope. This does not search recursive scopes. Does nothing if not found.
@@ -214,9 +263,9 @@ class Scope {
   const Template* GetTemplate(const std::string& name) const;
 
   // Marks the given identifier as (un)used in the current scope.
-  void MarkUsed(std::string_view ident);
-  void MarkAllUsed();
-  void MarkAllUsed(const std::set<std::string>& excluded_values);
+  void MarkUsed(std::string_view ident) const;
+  void MarkAllUsed() const;
+  void MarkAllUsed(const std::set<std::string>& excluded_values) const;
   void MarkUnused(std::string_view ident);
 
   // Checks to see if the scope has a var set that hasn't been used. This is
@@ -262,6 +311,18 @@ class Scope {
   // change, we don't have to copy its values).
   std::unique_ptr<Scope> MakeClosure() const;
 
+  // Like MakeClosure(), but returns a shared, immutable closure for a template
+  // defined in this scope. When possible, the result is layered on the closure
+  // made for the previous template defined here and only holds the values and
+  // templates that changed since, so defining many templates in one file
+  // doesn't copy the whole file scope for each of them.
+  scoped_refptr<const ClosureSnapshot> MakeClosureSnapshot();
+
+  // Returns the approximate number of bytes held by this scope, its values,
+  // target defaults and templates, but not by its containing scopes. Shared
+  // storage already in |seen| isn't counted again.
+  size_t EstimateMemoryUsage(std::unordered_set<const void*>* seen) const;
+
   // Makes an empty scope with the given name. Overwrites any existing one.
   Scope* MakeTargetDefaults(const std::string& target_type);
 
@@ -323,6 +384,14 @@ class Scope {
   }
   ItemVector* GetItemCollector();
 
+  // Sets the observer of the values found by GetValue() and
+  // GetValueWithScope() called on this scope, not including the lookups
+  // forwarded from nested scopes. Null stops observing. The observer must
+  // outlive its use.
+  void set_lookup_observer(LookupObserver* observer) {
+    lookup_observer_ = observer;
+  }
+
   // Properties are opaque pointers that code can use to set state on a Scope
   // that it can retrieve later.
   //
@@ -348,15 +417,35 @@ class Scope {
  private:
   friend class ProgrammaticProvider;
 
+  // Backends for GetValueWithScope() that don't notify the lookup observer.
+  const Value* FindValueWithScope(StringAtom ident,
+                                  const Scope** found_in_scope) const;
+  const Value* FindValueWithScope(StringAtom ident,
+                                  bool counts_as_used,
+                                  const Scope** found_in_scope) const;
+
   struct Record {
-    Record() : used(false) {}
-    explicit Record(const Value& v) : used(false), value(v) {}
+    Record() = default;
+    explicit Record(const Value& v) : value(v) {}
+    Record(const Record& other) : used(other.used.load()), value(other.value) {}
+    Record& operator=(const Record& other) {
+      used = other.used.load();
+      value = other.value;
+      return *this;
+    }
 
-    bool used;  // Set to true when the variable is used.
+    // Sets |used|. Doesn't write if it's already set, so that threads
+    // reading a shared scope don't keep invalidating each other's caches.
+    void MarkUsed() const {
+      if (!used.load(std::memory_order_relaxed))
+        used.store(true, std::memory_order_relaxed);
+    }
+
+    mutable std::atomic<bool> used{false};  // Set when the variable is used.
     Value value;
   };
 
-  using RecordMap = std::unordered_map<std::string_view, Record>;
+  using RecordMap = StringAtomMap<Record>;
 
   void AddProvider(ProgrammaticProvider* p);
   void RemoveProvider(ProgrammaticProvider* p);
@@ -365,6 +454,19 @@ class Scope {
   // of the values may be different).
   static bool RecordMapValuesEqual(const RecordMap& a, const RecordMap& b);
 
+  // Bookkeeping for MakeClosureSnapshot(): records that a value or template
+  // of this scope may have changed since the last closure snapshot, or that
+  // something changed that a layered snapshot can't represent.
+  void NoteValueChanged(StringAtom ident) {
+    if (last_closure_)
+      changed_values_.push_back(ident);
+  }
+  void NoteTemplateChanged(const std::string& name) {
+    if (last_closure_)
+      changed_templates_.push_back(name);
+  }
+  void InvalidateClosureSnapshot();
+
   // Walk up the containing scopes and any "invoker" Value scopes to gather any
   // previous template invocations.
   void AppendTemplateInvocationEntries(
@@ -404,6 +506,8 @@ class Scope {
 
   ItemVector* item_collector_;
 
+  LookupObserver* lookup_observer_ = nullptr;
+
   // Opaque pointers. See SetProperty() above.
   using PropertyMap = std::map<const void*, void*>;
   PropertyMap properties_;
@@ -417,8 +521,43 @@ class Scope {
   // parent ones.
   SourceFileSet build_dependency_files_;
 
+  // The last snapshot returned by MakeClosureSnapshot(), and what changed
+  // since (possibly with duplicates).
+  scoped_refptr<const ClosureSnapshot> last_closure_;
+  std::vector<StringAtom> changed_values_;
+  std::vector<std::string> changed_templates_;
+
   Scope(const Scope&) = delete;
   Scope& operator=(const Scope&) = delete;
 };
 
+// An immutable closure made by Scope::MakeClosureSnapshot(). It is refcounted
+// so it can be shared by several templates, and keeps alive the snapshot its
+// scope is layered on, if any.
+class ClosureSnapshot : public base::RefCountedThreadSafe<ClosureSnapshot> {
+ public:
+  ClosureSnapshot(std::unique_ptr<const Scope> scope,
+                  scoped_refptr<const ClosureSnapshot> base);
+
+  const Scope* scope() const { return scope_.get(); }
+
+  // The snapshot this one is layered on, or null.
+  const ClosureSnapshot* base() const { return base_.get(); }
+
+  // Number of snapshots in the chain ending with this one.
+  size_t depth() const { return depth_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<ClosureSnapshot>;
+  ~ClosureSnapshot();
+
+  // Declared first so that |scope_|, which references it, is destroyed first.
+  scoped_refptr<const ClosureSnapshot> base_;
+  std::unique_ptr<const Scope> scope_;
+  size_t depth_;
+
+  ClosureSnapshot(const ClosureSnapshot&) = delete;
+  ClosureSnapshot& operator=(const ClosureSnapshot&) = delete;
+};
+
 #endif  // TOOLS_GN_SCOPE_H_
@@ -266,6 +266,89 @@ TEST(Scope, MakeClosure) {
   EXPECT_TRUE(HasStringValueEqualTo(result.get(), "on_two", "on_two2"));
 }
 
+TEST(Scope, MakeClosureSnapshot) {
+  TestWithScope setup;
+  LiteralNode assignment;
+
+  Scope file_scope(static_cast<const Scope*>(setup.scope()));
+  file_scope.SetValue("a", Value(&assignment, "a1"), &assignment);
+
+  // The first snapshot is a full closure.
+  scoped_refptr<const ClosureSnapshot> first = file_scope.MakeClosureSnapshot();
+  EXPECT_EQ(1u, first->depth());
+  EXPECT_EQ(setup.scope(), first->scope()->containing());
+  EXPECT_TRUE(HasStringValueEqualTo(first->scope(), "a", "a1"));
+
+  // Nothing changed: the snapshot is shared.
+  EXPECT_EQ(first, file_scope.MakeClosureSnapshot());
+
+  // Later snapshots only hold what changed, including in-place changes.
+  FunctionCallNode templ_definition;
+  scoped_refptr<Template> templ(new Template(&file_scope, &templ_definition));
+  EXPECT_TRUE(file_scope.AddTemplate("templ", templ.get()));
+  file_scope.SetValue("b", Value(&assignment, "b1"), &assignment);
+  *file_scope.GetMutableValue("a", Scope::SEARCH_CURRENT, false) =
+      Value(&assignment, "a2");
+
+  scoped_refptr<const ClosureSnapshot> second =
+      file_scope.MakeClosureSnapshot();
+  EXPECT_EQ(2u, second->depth());
+  EXPECT_EQ(first->scope(), second->scope()->containing());
+  EXPECT_TRUE(HasStringValueEqualTo(second->scope(), "a", "a2"));
+  EXPECT_TRUE(HasStringValueEqualTo(second->scope(), "b", "b1"));
+  EXPECT_EQ(templ.get(), second->scope()->GetTemplate("templ"));
+
+  // Earlier snapshots are unaffected.
+  EXPECT_TRUE(HasStringValueEqualTo(first->scope(), "a", "a1"));
+  EXPECT_FALSE(first->scope()->GetValue("b"));
+  EXPECT_FALSE(first->scope()->GetTemplate("templ"));
+
+  // Removing a value can't be layered, so a full closure is made.
+  file_scope.RemoveIdentifier("b");
+  scoped_refptr<const ClosureSnapshot> third = file_scope.MakeClosureSnapshot();
+  EXPECT_EQ(1u, third->depth());
+  EXPECT_FALSE(third->scope()->GetValue("b"));
+  EXPECT_TRUE(HasStringValueEqualTo(third->scope(), "a", "a2"));
+  EXPECT_EQ(templ.get(), third->scope()->GetTemplate("templ"));
+}
+
+// Reading values, even when that counts as a use, isn't a change.
+TEST(Scope, MakeClosureSnapshotIgnoresReads) {
+  TestWithScope setup;
+  Scope file_scope(static_cast<const Scope*>(setup.scope()));
+
+  TestParseInput define(
+      "s = { b = 1 }\n"
+      "l = [ 1 ]\n");
+  ASSERT_FALSE(define.has_error());
+  Err err;
+  define.parsed()->Execute(&file_scope, &err);
+  ASSERT_FALSE(err.has_error()) << err.message();
+  scoped_refptr<const ClosureSnapshot> first = file_scope.MakeClosureSnapshot();
+
+  TestParseInput read(
+      "assert(s.b == 1)\n"
+      "assert(l[0] == 1)\n"
+      "not_needed(s, \"*\")\n"
+      "not_needed([ \"l\" ])\n");
+  ASSERT_FALSE(read.has_error());
+  read.parsed()->Execute(&file_scope, &err);
+  ASSERT_FALSE(err.has_error()) << err.message();
+  EXPECT_EQ(first, file_scope.MakeClosureSnapshot());
+
+  // Writing to an element is a change.
+  TestParseInput write("l[0] = 2\n");
+  ASSERT_FALSE(write.has_error());
+  write.parsed()->Execute(&file_scope, &err);
+  ASSERT_FALSE(err.has_error()) << err.message();
+  scoped_refptr<const ClosureSnapshot> second =
+      file_scope.MakeClosureSnapshot();
+  EXPECT_NE(first, second);
+  const Value* l = second->scope()->GetValue("l");
+  ASSERT_TRUE(l);
+  EXPECT_EQ("[2]", l->ToString(false));
+}
+
 TEST(Scope, GetMutableValue) {
   TestWithScope setup;
 
@@ -21,16 +21,19 @@
 #include "gn/command_format.h"
 #include "gn/commands.h"
 #include "gn/exec_process.h"
+#include "gn/exec_script_cache.h"
 #include "gn/filesystem_utils.h"
 #include "gn/graph/include/graph.h"
 #include "gn/innerapis_publicinfo_generator.h"
 #include "gn/input_file.h"
 #include "gn/label_pattern.h"
 #include "gn/location.h"
+#include "gn/memory_stats.h"
 #include "gn/ohos_components_checker.h"
 #include "gn/parse_tree.h"
 #include "gn/parser.h"
 #include "gn/precise/precise.h"
+#include "gn/python_worker.h"
 #include "gn/source_dir.h"
 #include "gn/source_file.h"
 #include "gn/standard_out.h"
@@ -40,6 +43,7 @@
 #include "gn/value.h"
 #include "gn/value_extractors.h"
 #include "util/build_config.h"
+#include "util/task_stats.h"
 
 #if defined(OS_WIN)
 #include <windows.h>
@@ -277,27 +281,13 @@ base::FilePath FindDotFile(const base::FilePath& current_dir) {
   return FindDotFile(up_one_dir);
 }
 
-// Called on any thread. Post the item to the builder on the main thread.
-void ItemDefinedCallback(MsgLoop* task_runner,
-                         Builder* builder_call_on_main_thread_only,
-                         std::unique_ptr<Item> item) {
+// Called on the worker thread that loaded the item. The builder defines and
+// resolves it right there. Any loads it schedules are posted to the main
+// thread ahead of the loader's notification that the file is done, so the
+// build can't be considered complete before they start.
+void ItemDefinedCallback(Builder* builder, std::unique_ptr<Item> item) {
   DCHECK(item);
-
-  // Increment the work count for the duration of defining the item with the
-  // builder. Otherwise finishing this callback will race finishing loading
-  // files. If there is no other pending work at any point in the middle of
-  // this call completing on the main thread, the 'Complete' function will
-  // be signaled and we'll stop running with an incomplete build.
-  g_scheduler->IncrementWorkCount();
-
-  // Work around issue binding a unique_ptr with std::function by moving into a
-  // shared_ptr.
-  auto item_shared = std::make_shared<std::unique_ptr<Item>>(std::move(item));
-  task_runner->PostTask(
-      [builder_call_on_main_thread_only, item_shared]() mutable {
-        builder_call_on_main_thread_only->ItemDefined(std::move(*item_shared));
-        g_scheduler->DecrementWorkCount();
-      });
+  builder->ItemDefined(std::move(item));
 }
 
 void DecrementWorkCount() {
@@ -431,15 +421,18 @@ Setup::Setup()
       std::make_unique<ScopePerFileProvider>(&dotfile_scope_, false, true);
 
   build_settings_.set_item_defined_callback(
-      [task_runner = scheduler_.task_runner(),
-       builder = &builder_](std::unique_ptr<Item> item) {
-        ItemDefinedCallback(task_runner, builder, std::move(item));
+      [builder = &builder_](std::unique_ptr<Item> item) {
+        ItemDefinedCallback(builder, std::move(item));
       });
 
   loader_->set_complete_callback(&DecrementWorkCount);
   // The scheduler's task runner wasn't created when the Loader was created, so
   // we need to set it now.
   loader_->set_task_runner(scheduler_.task_runner());
+  // Keep a little more than one file per worker in flight so workers don't
+  // idle while the main thread starts the next loads, but few enough that
+  // the files most waited on can overtake the others.
+  loader_->set_max_loads_in_flight(2 * scheduler_.worker_thread_count());
 }
 
 bool Setup::DoSetup(const std::string& build_dir, bool force_create) {
@@ -527,8 +520,14 @@ bool Setup::DoSetupWithErr(const std::string& build_dir,
                            Err* err) {
   scheduler_.set_verbose_logging(cmdline.HasSwitch(switches::kVerbose));
   if (cmdline.HasSwitch(switches::kTime) ||
-      cmdline.HasSwitch(switches::kTracelog))
+      cmdline.HasSwitch(switches::kTracelog)) {
     EnableTracing();
+    EnableTaskStats();
+    if (cmdline.HasSwitch(switches::kTracelog))
+      StartTraceMemorySampling();
+  }
+  if (cmdline.HasSwitch(switches::kMemstats))
+    EnableMemoryStats();
 
   ScopedTrace setup_trace(TraceItem::TRACE_SETUP, "DoSetup");
 
@@ -543,6 +542,14 @@ bool Setup::DoSetupWithErr(const std::string& build_dir,
   if (!FillBuildDir(build_dir, !force_create, err))
     return false;
 
+  if (cmdline.HasSwitch(switches::kExecScriptCache)) {
+    auto cache = std::make_unique<ExecScriptCache>(
+        build_settings_.GetFullPath(SourceFile(
+            build_settings_.build_dir().value() + ExecScriptCache::kFileName)));
+    cache->Load();
+    build_settings_.set_exec_script_cache(std::move(cache));
+  }
+
   // Apply project-specific default (if specified).
   // Must happen before FillArguments().
   if (default_args_) {
@@ -563,6 +570,17 @@ bool Setup::DoSetupWithErr(const std::string& build_dir,
   if (!FillPythonPath(cmdline, err))
     return false;
 
+  if (cmdline.HasSwitch(switches::kPythonWorker) &&
+      !build_settings_.python_path().empty()) {
+    base::FilePath python_path = build_settings_.python_path();
+    if (build_settings_.python_path_is_relative_to_build_dir()) {
+      python_path = build_settings_.GetFullPath(build_settings_.build_dir())
+                        .Append(python_path);
+    }
+    build_settings_.set_python_worker_pool(
+        std::make_unique<PythonWorkerPool>(python_path));
+  }
+
   // Check for unused variables in the .gn file.
   if (!dotfile_scope_.CheckForUnusedVars(err)) {
     return false;
@@ -577,9 +595,20 @@ bool Setup::Run() {
 
 bool Setup::Run(const base::CommandLine& cmdline) {
   RunPreMessageLoop();
-  if (!scheduler_.Run())
-    return false;
-  return RunPostMessageLoop(cmdline);
+  bool success = scheduler_.Run() && RunPostMessageLoop(cmdline);
+
+  // Write out tracing and timing if requested. This is also done when the
+  // load failed, since that's when the trace is most useful.
+  if (cmdline.HasSwitch(switches::kTime)) {
+    std::string summary = SummarizeTraces();
+    if (ExecScriptCache* cache = build_settings_.exec_script_cache())
+      summary += "\n" + cache->Summarize();
+    PrintLongHelp(summary);
+  }
+  if (cmdline.HasSwitch(switches::kTracelog))
+    SaveTraces(cmdline.GetSwitchValuePath(switches::kTracelog));
+
+  return success;
 }
 
 SourceFile Setup::GetBuildArgFile() const {
@@ -595,6 +624,8 @@ void Setup::RunPreMessageLoop() {
 }
 
 bool Setup::RunPostMessageLoop(const base::CommandLine& cmdline) {
+  SampleMemoryStats("load");
+
   Err err;
   if (!builder_.CheckForBadItems(&err)) {
     err.PrintToStdout();
@@ -632,15 +663,17 @@ bool Setup::RunPostMessageLoop(const base::CommandLine& cmdline) {
     }
   }
 
-  // Write out tracing and timing if requested.
-  if (cmdline.HasSwitch(switches::kTime))
-    PrintLongHelp(SummarizeTraces());
-  if (cmdline.HasSwitch(switches::kTracelog))
-    SaveTraces(cmdline.GetSwitchValuePath(switches::kTracelog));
+  ExecScriptCache* exec_script_cache = build_settings_.exec_script_cache();
+  if (exec_script_cache && !exec_script_cache->Save()) {
+    Err(Location(), "Could not write the exec_script cache.",
+        "The results of this run won't be reused by the next one.")
+        .PrintNonfatalToStdout();
+  }
 
   Err result;
   InnerApiPublicInfoGenerator* instance = InnerApiPublicInfoGenerator::getInstance();
   if (instance != nullptr) {
+    ScopedTrace trace(TraceItem::TRACE_OHOS_POST_PASS, "Inner API public info");
     if (!instance->GeneratedInnerapiPublicInfo(builder_.GetAllResolvedTargets(), &result)) {
       result.PrintToStdout();
       return false;
@@ -649,20 +682,34 @@ bool Setup::RunPostMessageLoop(const base::CommandLine& cmdline) {
 
   PreciseManager* preciseManager = PreciseManager::GetInstance();
   if (preciseManager != nullptr) {
+      ScopedTrace trace(TraceItem::TRACE_OHOS_POST_PASS, "Precise targets");
       preciseManager->GeneratPreciseTargets();
   }
 
   Graph* graph = Graph::GetInstance();
   if (graph != nullptr) {
+    ScopedTrace trace(TraceItem::TRACE_OHOS_POST_PASS, "Graph");
     graph->GenGraph(builder_.GetAllResolvedItems());
   }
 
   // 写入拦截的目标列表（如果启用了白名单调试模式）
   OhosComponentChecker::WriteInterceptedListIfNeeded();
 
+  SampleMemoryStats("resolve");
   return true;
 }
 
+void Setup::SampleMemoryStats(const std::string& phase) {
+  if (!MemoryStatsEnabled())
+    return;
+  MemoryStatsSources sources;
+  sources.builder = &builder_;
+  sources.loader = loader_.get();
+  sources.input_file_manager = scheduler_.input_file_manager();
+  sources.resolved_target_data = resolved_target_data_;
+  RecordMemoryStats(phase, sources);
+}
+
 bool Setup::FillArguments(const base::CommandLine& cmdline, Err* err) {
   // Use the args on the command line if specified, and save them. Do this even
   // if the list is empty (this means clear any defaults).
@@ -892,6 +939,8 @@ bool Setup::FillBuildDir(const std::string& build_dir,
   }
 
   build_settings_.SetBuildDir(resolved);
+  scheduler_.file_system_cache()->SetBuildDir(
+      build_settings_.GetFullPath(resolved));
   return true;
 }
 
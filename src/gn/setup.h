@@ -23,6 +23,7 @@
 
 class InputFile;
 class ParseNode;
+class ResolvedTargetData;
 
 namespace base {
 class CommandLine;
@@ -66,7 +67,8 @@ class Setup {
 
   // Runs the load, returning true on success. On failure, prints the error
   // and returns false. This includes both RunPreMessageLoop() and
-  // RunPostMessageLoop().
+  // RunPostMessageLoop(). The --time and --tracelog output is written either
+  // way.
   //
   // cmdline is the gn invocation command, with flags like --root and --dotfile.
   // If no explicit cmdline is passed, base::CommandLine::ForCurrentProcess()
@@ -125,6 +127,16 @@ class Setup {
   Builder& builder() { return builder_; }
   LoaderImpl* loader() { return loader_.get(); }
 
+  // The target data shared by the ninja writers, if any, to include in the
+  // --memstats samples.
+  void set_resolved_target_data(const ResolvedTargetData* resolved) {
+    resolved_target_data_ = resolved;
+  }
+
+  // Takes a --memstats sample for the given phase. Does nothing unless
+  // --memstats was given.
+  void SampleMemoryStats(const std::string& phase);
+
   const SourceFile& GetDotFile() const { return dotfile_input_file_->name(); }
 
   // Name of the file in the root build directory that contains the build
@@ -179,6 +191,8 @@ class Setup {
   scoped_refptr<LoaderImpl> loader_;
   Builder builder_;
 
+  const ResolvedTargetData* resolved_target_data_ = nullptr;
+
   SourceFile root_build_file_;
 
   bool check_public_headers_ = false;
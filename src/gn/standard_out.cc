@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include <atomic>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
@@ -38,6 +40,24 @@ bool is_markdown = false;
 // True while output is going into a markdown ```...``` code block.
 bool in_body = false;
 
+// Where OutputString() appends while a ScopedOutputCapture is alive. Output
+// can come from any thread.
+std::atomic<std::string*> captured_output{nullptr};
+std::mutex captured_output_lock;
+
+// Appends |output| to the current capture, if any. Returns false if output
+// isn't being captured.
+bool AppendToCapturedOutput(const std::string& output) {
+  if (!captured_output.load(std::memory_order_acquire))
+    return false;
+  std::lock_guard<std::mutex> lock(captured_output_lock);
+  std::string* capture = captured_output.load(std::memory_order_relaxed);
+  if (!capture)
+    return false;
+  capture->append(output);
+  return true;
+}
+
 void EnsureInitialized() {
   if (initialized)
     return;
@@ -102,6 +122,8 @@ void OutputMarkdownDec(TextDecoration dec) {
 void OutputString(const std::string& output,
                   TextDecoration dec,
                   HtmlEscaping escaping) {
+  if (AppendToCapturedOutput(output))
+    return;
   EnsureInitialized();
   DWORD written = 0;
 
@@ -165,6 +187,8 @@ void OutputString(const std::string& output,
 void OutputString(const std::string& output,
                   TextDecoration dec,
                   HtmlEscaping escaping) {
+  if (AppendToCapturedOutput(output))
+    return;
   EnsureInitialized();
   if (is_markdown) {
     OutputMarkdownDec(dec);
@@ -352,3 +376,14 @@ void PrintLongHelp(const std::string& text, const std::string& tag) {
   if (is_markdown && in_body)
     OutputString("```\n");
 }
+
+ScopedOutputCapture::ScopedOutputCapture(std::string* output) {
+  std::lock_guard<std::mutex> lock(captured_output_lock);
+  DCHECK(!captured_output.load(std::memory_order_relaxed));
+  captured_output.store(output, std::memory_order_release);
+}
+
+ScopedOutputCapture::~ScopedOutputCapture() {
+  std::lock_guard<std::mutex> lock(captured_output_lock);
+  captured_output.store(nullptr, std::memory_order_release);
+}
@@ -59,4 +59,18 @@ void PrintShortHelp(const std::string& line,
 // be emitted. Used only in markdown mode.
 void PrintLongHelp(const std::string& text, const std::string& tag = "");
 
+// While alive, OutputString() appends the text it is given to |output|
+// instead of writing it to the standard output, without decorations. Used by
+// "gn serve" to send the output of commands to its clients. Captures can't be
+// nested.
+class ScopedOutputCapture {
+ public:
+  explicit ScopedOutputCapture(std::string* output);
+  ~ScopedOutputCapture();
+
+ private:
+  ScopedOutputCapture(const ScopedOutputCapture&) = delete;
+  ScopedOutputCapture& operator=(const ScopedOutputCapture&) = delete;
+};
+
 #endif  // TOOLS_GN_STANDARD_OUT_H_
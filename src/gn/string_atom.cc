@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "gn/hash_table_base.h"
+#include "gn/memory_stats.h"
 
 namespace {
 
@@ -146,9 +147,16 @@ class StringAtomSet {
     }
     std::string* result = slabs_.back()->init(slab_index_++, key);
     set_.Insert(node, hash, result);
+    string_heap_bytes_ += StringHeapBytes(*result);
     return result;
   }
 
+  size_t EstimateMemoryUsage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slabs_.size() * sizeof(Slab) + VectorHeapBytes(slabs_) +
+           set_.heap_bytes() + string_heap_bytes_;
+  }
+
  private:
   static constexpr unsigned int kStringsPerSlab = 128;
 
@@ -193,6 +201,7 @@ class StringAtomSet {
   KeySet set_;
   std::vector<Slab*> slabs_;
   unsigned int slab_index_ = kStringsPerSlab;
+  size_t string_heap_bytes_ = 0;
 };
 
 StringAtomSet& GetStringAtomSet() {
@@ -234,6 +243,11 @@ __tlssim<ThreadLocalCache*> __g_s_local_cache_impl(&s_tlc);
 
 StringAtom::StringAtom() : value_(kEmptyString) {}
 
+// static
+size_t StringAtom::EstimateTableMemoryUsage() {
+  return GetStringAtomSet().EstimateMemoryUsage();
+}
+
 StringAtom::StringAtom(std::string_view str) noexcept
 #ifndef OS_ZOS
     : value_(*s_local_cache.find(str)){}
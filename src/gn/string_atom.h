@@ -119,6 +119,10 @@ class StringAtom {
 
   size_t hash() const { return std::hash<std::string>()(value_); }
 
+  // Returns the approximate number of bytes held by the global table of all
+  // atoms. The per-thread lookup caches aren't counted.
+  static size_t EstimateTableMemoryUsage();
+
   // Use the following method and structs to implement containers that
   // use StringAtom values as keys, but only compare/hash the pointer
   // values for speed.
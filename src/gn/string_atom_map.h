@@ -0,0 +1,345 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_STRING_ATOM_MAP_H_
+#define TOOLS_GN_STRING_ATOM_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "gn/string_atom.h"
+
+// A map from StringAtom keys to values of type T that only ever compares
+// and hashes the atom pointers, never the string contents.
+//
+// This is tuned for the variables of a Scope: most maps hold only a handful
+// of keys, so the first |kSmallCapacity| entries are stored in one small
+// array and looked up with a linear scan of their key pointers. Larger maps
+// additionally build an open-addressing index (with linear probing) over the
+// entries. The small array is allocated on the first insertion, so that the
+// many scopes that never hold a variable stay small.
+//
+// Entries are never moved once inserted: pointers to values stay valid until
+// the corresponding key is erased or the map is destroyed, as with a
+// std::unordered_map. Erased entries are recycled by later insertions.
+//
+// Iteration visits entries in insertion order (modulo recycled entries).
+template <typename T, size_t kSmallCapacity = 8>
+class StringAtomMap {
+ public:
+  struct Entry {
+    Entry(StringAtom k) : first(k) {}
+
+    StringAtom first;
+    T second{};
+  };
+
+  class const_iterator;
+
+  class iterator {
+   public:
+    iterator(StringAtomMap* map, size_t index) : map_(map), index_(index) {
+      SkipDead();
+    }
+
+    Entry& operator*() const { return *map_->EntryAt(index_); }
+    Entry* operator->() const { return map_->EntryAt(index_); }
+
+    iterator& operator++() {
+      index_++;
+      SkipDead();
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    friend class const_iterator;
+
+    void SkipDead() {
+      while (index_ < map_->slot_count_ && !map_->SlotAt(index_)->live)
+        index_++;
+    }
+
+    StringAtomMap* map_;
+    size_t index_;
+  };
+
+  class const_iterator {
+   public:
+    const_iterator(const StringAtomMap* map, size_t index)
+        : map_(map), index_(index) {
+      SkipDead();
+    }
+    const_iterator(const iterator& it) : map_(it.map_), index_(it.index_) {}
+
+    const Entry& operator*() const { return *map_->EntryAt(index_); }
+    const Entry* operator->() const { return map_->EntryAt(index_); }
+
+    const_iterator& operator++() {
+      index_++;
+      SkipDead();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    void SkipDead() {
+      while (index_ < map_->slot_count_ && !map_->SlotAt(index_)->live)
+        index_++;
+    }
+
+    const StringAtomMap* map_;
+    size_t index_;
+  };
+
+  StringAtomMap() = default;
+  ~StringAtomMap() { clear(); }
+
+  StringAtomMap(const StringAtomMap&) = delete;
+  StringAtomMap& operator=(const StringAtomMap&) = delete;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, slot_count_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, slot_count_); }
+
+  // Returns the value associated with |key|, or nullptr if there is none.
+  T* Find(StringAtom key) {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? nullptr : &EntryAt(index)->second;
+  }
+  const T* Find(StringAtom key) const {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? nullptr : &EntryAt(index)->second;
+  }
+
+  // Returns the entry for |key|, or nullptr if there is none.
+  Entry* FindEntry(StringAtom key) {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? nullptr : EntryAt(index);
+  }
+  const Entry* FindEntry(StringAtom key) const {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? nullptr : EntryAt(index);
+  }
+
+  // Returns the value associated with |key|, inserting a value-initialized
+  // one if it doesn't exist yet.
+  T& operator[](StringAtom key) {
+    size_t index = FindIndex(key);
+    if (index != kNotFound)
+      return EntryAt(index)->second;
+    return EntryAt(Insert(key))->second;
+  }
+
+  // Removes |key| from the map. Returns true if it was present.
+  bool erase(StringAtom key) {
+    size_t index = FindIndex(key);
+    if (index == kNotFound)
+      return false;
+
+    if (!buckets_.empty())
+      RemoveFromIndex(index);
+    EntryAt(index)->~Entry();
+    SlotAt(index)->live = false;
+    free_slots_.push_back(index);
+    size_--;
+    return true;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slot_count_; i++) {
+      if (SlotAt(i)->live)
+        EntryAt(i)->~Entry();
+    }
+    overflow_.clear();
+    free_slots_.clear();
+    buckets_.clear();
+    slot_count_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  static_assert(kSmallCapacity > 0, "Small capacity can't be empty");
+
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+  static constexpr uint32_t kEmptyBucket = static_cast<uint32_t>(-1);
+
+  // Raw storage for one entry, which is constructed when the slot is live.
+  struct Slot {
+    alignas(Entry) unsigned char storage[sizeof(Entry)];
+    bool live;
+  };
+
+  // Slots beyond the small ones are allocated in fixed-size chunks that are
+  // never reallocated, so entries keep their addresses as the map grows.
+  static constexpr size_t kOverflowChunkSize = 32;
+
+  static size_t HashKey(StringAtom key) {
+    // Atoms are allocated in slabs so the low bits are mostly identical.
+    // Multiply by a large odd constant (Fibonacci hashing) to spread them
+    // and use the high bits.
+    uint64_t ptr = static_cast<uint64_t>(key.ptr_hash());
+    return static_cast<size_t>((ptr * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  Slot* SlotAt(size_t index) {
+    if (index < kSmallCapacity)
+      return &small_[index];
+    index -= kSmallCapacity;
+    return &overflow_[index / kOverflowChunkSize][index % kOverflowChunkSize];
+  }
+  const Slot* SlotAt(size_t index) const {
+    return const_cast<StringAtomMap*>(this)->SlotAt(index);
+  }
+
+  Entry* EntryAt(size_t index) {
+    return std::launder(reinterpret_cast<Entry*>(SlotAt(index)->storage));
+  }
+  const Entry* EntryAt(size_t index) const {
+    return std::launder(
+        reinterpret_cast<const Entry*>(SlotAt(index)->storage));
+  }
+
+  size_t FindIndex(StringAtom key) const {
+    if (buckets_.empty()) {
+      // Small map, linear scan over the small entries.
+      for (size_t i = 0; i < slot_count_; i++) {
+        if (small_[i].live && EntryAt(i)->first.SameAs(key))
+          return i;
+      }
+      return kNotFound;
+    }
+
+    size_t bucket = FindBucket(key);
+    return buckets_[bucket] == kEmptyBucket ? kNotFound : buckets_[bucket];
+  }
+
+  // Returns the index bucket holding |key|, or the empty bucket where it
+  // would be inserted.
+  size_t FindBucket(StringAtom key) const {
+    size_t mask = buckets_.size() - 1;
+    size_t bucket = HashKey(key) & mask;
+    while (buckets_[bucket] != kEmptyBucket &&
+           !EntryAt(buckets_[bucket])->first.SameAs(key)) {
+      bucket = (bucket + 1) & mask;
+    }
+    return bucket;
+  }
+
+  // Inserts a new entry for |key|, which must not be present, and returns
+  // its index.
+  size_t Insert(StringAtom key) {
+    size_t index;
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      index = slot_count_++;
+      if (!small_) {
+        small_ = std::make_unique<Slot[]>(kSmallCapacity);
+      } else if (index >= kSmallCapacity &&
+                 (index - kSmallCapacity) % kOverflowChunkSize == 0) {
+        overflow_.push_back(std::make_unique<Slot[]>(kOverflowChunkSize));
+      }
+    }
+    new (SlotAt(index)->storage) Entry(key);
+    SlotAt(index)->live = true;
+    size_++;
+
+    if (slot_count_ > kSmallCapacity) {
+      // Keep the load factor of the index under 1/2.
+      if (buckets_.size() < slot_count_ * 2)
+        RebuildIndex();
+      else
+        AddToIndex(index);
+    }
+    return index;
+  }
+
+  void AddToIndex(size_t index) {
+    size_t mask = buckets_.size() - 1;
+    size_t bucket = HashKey(EntryAt(index)->first) & mask;
+    while (buckets_[bucket] != kEmptyBucket)
+      bucket = (bucket + 1) & mask;
+    buckets_[bucket] = static_cast<uint32_t>(index);
+  }
+
+  // Removes the live entry |index| from the index. This uses backward shift
+  // deletion so that no tombstones are needed: following entries of the
+  // probe sequence are moved back into the hole when allowed by their ideal
+  // bucket.
+  void RemoveFromIndex(size_t index) {
+    size_t mask = buckets_.size() - 1;
+    size_t hole = FindBucket(EntryAt(index)->first);
+    DCHECK(buckets_[hole] == index);
+    size_t next = hole;
+    for (;;) {
+      buckets_[hole] = kEmptyBucket;
+      for (;;) {
+        next = (next + 1) & mask;
+        if (buckets_[next] == kEmptyBucket)
+          return;
+        size_t ideal = HashKey(EntryAt(buckets_[next])->first) & mask;
+        // The entry can fill the hole unless its ideal bucket lies
+        // (cyclically) in (hole, next].
+        bool stays = hole <= next ? (hole < ideal && ideal <= next)
+                                  : (hole < ideal || ideal <= next);
+        if (!stays)
+          break;
+      }
+      buckets_[hole] = buckets_[next];
+      hole = next;
+    }
+  }
+
+  void RebuildIndex() {
+    size_t bucket_count = buckets_.empty() ? kSmallCapacity * 4
+                                           : buckets_.size();
+    while (bucket_count < slot_count_ * 2)
+      bucket_count *= 2;
+    buckets_.assign(bucket_count, kEmptyBucket);
+    for (size_t i = 0; i < slot_count_; i++) {
+      if (SlotAt(i)->live)
+        AddToIndex(i);
+    }
+  }
+
+  // Only the first |slot_count_| slots have been used. Of those, the ones
+  // that aren't live have been erased and are listed in |free_slots_|.
+  // |small_| is null until the first insertion.
+  std::unique_ptr<Slot[]> small_;
+  std::vector<std::unique_ptr<Slot[]>> overflow_;
+  std::vector<size_t> free_slots_;
+
+  // Open-addressing index of slot numbers, only used once the map has grown
+  // beyond the small capacity. Its size is always a power of two.
+  std::vector<uint32_t> buckets_;
+
+  size_t slot_count_ = 0;
+  size_t size_ = 0;
+};
+
+#endif  // TOOLS_GN_STRING_ATOM_MAP_H_
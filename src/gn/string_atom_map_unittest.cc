@@ -0,0 +1,112 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/string_atom_map.h"
+
+#include <string>
+#include <vector>
+
+#include "util/test/test.h"
+
+TEST(StringAtomMapTest, InsertFindErase) {
+  StringAtomMap<int, 4> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.Find(StringAtom("foo")));
+
+  map[StringAtom("foo")] = 1;
+  map[StringAtom("bar")] = 2;
+  EXPECT_EQ(2u, map.size());
+
+  ASSERT_TRUE(map.Find(StringAtom("foo")));
+  EXPECT_EQ(1, *map.Find(StringAtom("foo")));
+  ASSERT_TRUE(map.FindEntry(StringAtom("bar")));
+  EXPECT_EQ("bar", map.FindEntry(StringAtom("bar"))->first.str());
+
+  // Existing entries are returned by operator[].
+  map[StringAtom("foo")] = 3;
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(3, *map.Find(StringAtom("foo")));
+
+  EXPECT_TRUE(map.erase(StringAtom("foo")));
+  EXPECT_FALSE(map.erase(StringAtom("foo")));
+  EXPECT_FALSE(map.Find(StringAtom("foo")));
+  EXPECT_EQ(1u, map.size());
+
+  // Re-inserting gives a value-initialized entry.
+  EXPECT_EQ(0, map[StringAtom("foo")]);
+}
+
+// Grows past the small capacity so the hashed index is used, and checks that
+// entries don't move and that erasing in any order keeps lookups working.
+TEST(StringAtomMapTest, Growth) {
+  constexpr int kCount = 200;
+  StringAtomMap<std::string, 4> map;
+  std::vector<StringAtom> keys;
+  std::vector<const std::string*> addresses;
+  for (int i = 0; i < kCount; i++) {
+    keys.push_back(StringAtom("key" + std::to_string(i)));
+    std::string& value = map[keys.back()];
+    value = std::to_string(i);
+    addresses.push_back(&value);
+  }
+  EXPECT_EQ(static_cast<size_t>(kCount), map.size());
+
+  for (int i = 0; i < kCount; i++) {
+    const std::string* found = map.Find(keys[i]);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(addresses[i], found);
+    EXPECT_EQ(std::to_string(i), *found);
+  }
+
+  // Erase every third key.
+  for (int i = 0; i < kCount; i += 3)
+    EXPECT_TRUE(map.erase(keys[i]));
+  for (int i = 0; i < kCount; i++) {
+    if (i % 3 == 0) {
+      EXPECT_FALSE(map.Find(keys[i]));
+    } else {
+      ASSERT_TRUE(map.Find(keys[i]));
+      EXPECT_EQ(std::to_string(i), *map.Find(keys[i]));
+    }
+  }
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.Find(keys[1]));
+
+  // The cleared map can be filled again.
+  map[keys[1]] = "again";
+  EXPECT_EQ(1u, map.size());
+  ASSERT_TRUE(map.Find(keys[1]));
+  EXPECT_EQ("again", *map.Find(keys[1]));
+}
+
+// Nothing is allocated before the first insertion, so an empty map must not
+// touch its slots.
+TEST(StringAtomMapTest, Empty) {
+  const StringAtomMap<int> map;
+  EXPECT_FALSE(map.Find(StringAtom("foo")));
+  EXPECT_TRUE(map.begin() == map.end());
+}
+
+TEST(StringAtomMapTest, IterationOrder) {
+  StringAtomMap<int, 2> map;
+  map[StringAtom("c")] = 0;
+  map[StringAtom("a")] = 1;
+  map[StringAtom("b")] = 2;
+  map[StringAtom("d")] = 3;
+  map.erase(StringAtom("a"));
+
+  std::vector<std::string> keys;
+  for (const auto& pair : map)
+    keys.push_back(pair.first.str());
+  EXPECT_EQ((std::vector<std::string>{"c", "b", "d"}), keys);
+
+  // The erased slot is recycled by the next insertion.
+  map[StringAtom("e")] = 4;
+  keys.clear();
+  for (const auto& pair : map)
+    keys.push_back(pair.first.str());
+  EXPECT_EQ((std::vector<std::string>{"c", "e", "b", "d"}), keys);
+}
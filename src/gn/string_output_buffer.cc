@@ -10,8 +10,44 @@
 #include "gn/file_writer.h"
 #include "gn/filesystem_utils.h"
 
+#include <atomic>
 #include <fstream>
 
+namespace {
+
+std::atomic<size_t> g_total_page_bytes{0};
+std::atomic<size_t> g_peak_total_page_bytes{0};
+
+}  // namespace
+
+StringOutputBuffer::~StringOutputBuffer() {
+  g_total_page_bytes.fetch_sub(pages_.size() * kPageSize,
+                               std::memory_order_relaxed);
+}
+
+// static
+size_t StringOutputBuffer::GetTotalPageBytes() {
+  return g_total_page_bytes.load(std::memory_order_relaxed);
+}
+
+// static
+size_t StringOutputBuffer::GetPeakTotalPageBytes() {
+  return g_peak_total_page_bytes.load(std::memory_order_relaxed);
+}
+
+void StringOutputBuffer::AddPage() {
+  pages_.push_back(std::make_unique<Page>());
+  pos_ = 0;
+
+  size_t total =
+      g_total_page_bytes.fetch_add(kPageSize, std::memory_order_relaxed) +
+      kPageSize;
+  size_t peak = g_peak_total_page_bytes.load(std::memory_order_relaxed);
+  while (total > peak && !g_peak_total_page_bytes.compare_exchange_weak(
+                             peak, total, std::memory_order_relaxed)) {
+  }
+}
+
 std::string StringOutputBuffer::str() const {
   std::string result;
   size_t data_size = size();
@@ -23,17 +59,24 @@ std::string StringOutputBuffer::str() const {
   return result;
 }
 
+void StringOutputBuffer::AppendPageViews(
+    std::vector<std::string_view>* views) const {
+  size_t data_size = size();
+  for (size_t nn = 0; nn < pages_.size(); ++nn) {
+    size_t wanted_size = std::min(kPageSize, data_size - nn * kPageSize);
+    if (wanted_size > 0)
+      views->emplace_back(pages_[nn]->data(), wanted_size);
+  }
+}
+
 void StringOutputBuffer::Append(const char* str, size_t len) {
   Append(std::string_view(str, len));
 }
 
 void StringOutputBuffer::Append(std::string_view str) {
   while (str.size() > 0) {
-    if (page_free_size() == 0) {
-      // Allocate a new page.
-      pages_.push_back(std::make_unique<Page>());
-      pos_ = 0;
-    }
+    if (page_free_size() == 0)
+      AddPage();
     size_t size = std::min(page_free_size(), str.size());
     memcpy(pages_.back()->data() + pos_, str.data(), size);
     pos_ += size;
@@ -42,11 +85,8 @@ void StringOutputBuffer::Append(std::string_view str) {
 }
 
 void StringOutputBuffer::Append(char c) {
-  if (page_free_size() == 0) {
-    // Allocate a new page.
-    pages_.push_back(std::make_unique<Page>());
-    pos_ = 0;
-  }
+  if (page_free_size() == 0)
+    AddPage();
   pages_.back()->data()[pos_] = c;
   pos_ += 1;
 }
@@ -42,7 +42,12 @@ class Err;
 //
 class StringOutputBuffer : public std::streambuf {
  public:
+  // The contents are held in pages of this size.
+  static constexpr size_t kPageSize = 65536;
+
   StringOutputBuffer() = default;
+  StringOutputBuffer(StringOutputBuffer&&) = default;
+  ~StringOutputBuffer() override;
 
   // Convert content to single std::string instance. Useful for unit-testing.
   std::string str() const;
@@ -60,6 +65,11 @@ class StringOutputBuffer : public std::streambuf {
     return *this;
   }
 
+  // Append views of the pages holding the content of this instance to
+  // |views|, in order. They stay valid until the instance is modified, e.g.
+  // for a vectored write of several instances.
+  void AppendPageViews(std::vector<std::string_view>* views) const;
+
   // Compare the content of this instance with that of the file at |file_path|.
   bool ContentsEqual(const base::FilePath& file_path) const;
 
@@ -72,6 +82,11 @@ class StringOutputBuffer : public std::streambuf {
 
   static size_t GetPageSizeForTesting() { return kPageSize; }
 
+  // Returns the number of bytes held by the pages of all instances alive now,
+  // and the most they ever held at once.
+  static size_t GetTotalPageBytes();
+  static size_t GetPeakTotalPageBytes();
+
  protected:
   // Called by std::ostream to write |n| chars from |s|.
   std::streamsize xsputn(const char* s, std::streamsize n) override {
@@ -89,7 +104,8 @@ class StringOutputBuffer : public std::streambuf {
   // Return the number of free bytes in the current page.
   size_t page_free_size() const { return kPageSize - pos_; }
 
-  static constexpr size_t kPageSize = 65536;
+  void AddPage();
+
   using Page = std::array<char, kPageSize>;
 
   size_t pos_ = kPageSize;
@@ -61,6 +61,25 @@ TEST(StringOutputBuffer, AppendWithPageSizeMultiples) {
   ASSERT_STREQ(data.c_str(), buffer.str().c_str());
 }
 
+TEST(StringOutputBuffer, AppendPageViews) {
+  StringOutputBuffer empty;
+  std::vector<std::string_view> views;
+  empty.AppendPageViews(&views);
+  EXPECT_TRUE(views.empty());
+
+  const size_t page_size = StringOutputBuffer::GetPageSizeForTesting();
+  std::string data = CreateTestString(page_size * 2 + 10);
+  StringOutputBuffer buffer;
+  buffer.Append(data);
+  buffer.AppendPageViews(&views);
+  ASSERT_EQ(3u, views.size());
+  EXPECT_EQ(10u, views[2].size());
+  std::string joined;
+  for (std::string_view view : views)
+    joined.append(view);
+  EXPECT_EQ(data, joined);
+}
+
 TEST(StringOutput, WrappedByStdOstream) {
   const size_t data_size = 100000;
   std::string data = CreateTestString(data_size);
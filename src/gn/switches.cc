@@ -65,6 +65,32 @@ const char kDotfile_Help[] =
   use a different file.
 )";
 
+const char kExecScriptCache[] = "exec-script-cache";
+const char kExecScriptCache_HelpShort[] =
+    "--exec-script-cache: Cache exec_script() results across runs.";
+const char kExecScriptCache_Help[] =
+    R"(--exec-script-cache: Cache exec_script() results across runs.
+
+  Normally every exec_script() call runs its script. With this flag, the
+  output of each successful call is saved in the build directory and later
+  calls reuse it instead of running the script again.
+
+  A cached result is reused only when all of the following are identical: the
+  interpreter, script and arguments, the working directory, whether the
+  exec_script allowlist is enforced, and the contents of the script and of the
+  file dependencies passed to exec_script(). Changing any of those files also
+  makes Ninja regenerate the build since they are listed in build.ninja.d.
+
+  The script must not depend on anything else, like environment variables or
+  files that aren't declared as dependencies, or stale results will be used.
+
+  Run with --time to see the hit rate and the time saved.
+
+Examples
+
+  gn gen out/Default --exec-script-cache
+)";
+
 const char kFailOnUnusedArgs[] = "fail-on-unused-args";
 const char kFailOnUnusedArgs_HelpShort[] =
     "--fail-on-unused-args: Treat unused build args as fatal errors.";
@@ -95,6 +121,32 @@ const char kMarkdown_HelpShort[] =
 const char kMarkdown_Help[] =
     "--markdown: Write help output in the Markdown format.\n";
 
+const char kMemstats[] = "memstats";
+const char kMemstats_HelpShort[] =
+    "--memstats: Reports which data structures hold memory.";
+const char kMemstats_Help[] =
+    R"(--memstats[=<file>]: Reports which data structures hold memory.
+
+  Prints the approximate number of bytes held by input files (contents,
+  tokens and parse trees), long-lived scopes and their values, targets,
+  resolved target data, the StringAtom table, the cache of rebased paths and
+  generated ninja text, next to the process's resident and allocated memory.
+  They are sampled at the end of each phase:
+
+    load     All build files are loaded and their targets resolved. GN does
+             these together, and writes each target's ninja rules as soon as
+             it resolves.
+    resolve  The checks and post-processing of resolved targets are done.
+    write    "gn gen" only: build.ninja and the other outputs are written.
+
+  If a file name is given, the samples are also written to it as JSON.
+
+Examples
+
+  gn gen out/Default --memstats
+  gn gen out/Default --memstats=memstats.json
+)";
+
 const char kNoColor[] = "nocolor";
 const char kNoColor_HelpShort[] = "--nocolor: Force non-colored output.";
 const char kNoColor_Help[] = COLOR_HELP_LONG;
@@ -123,6 +175,37 @@ const char kScriptExecutable_Help[] =
   targets and exec_script calls will be executed directly.
 )";
 
+const char kPythonWorker[] = "python-worker";
+const char kPythonWorker_HelpShort[] =
+    "--python-worker: Run Python scripts in long-lived interpreters.";
+const char kPythonWorker_Help[] =
+    R"(--python-worker: Run Python scripts in long-lived interpreters.
+
+  Normally each script run by exec_script() or by the --json-ide-script and
+  --ninja-outputs-script options of "gn gen" starts a new Python interpreter.
+  With this flag, scripts are run by a pool of long-lived interpreters instead,
+  which saves the interpreter startup time of each call. This requires script_executable (see
+  "gn help dotfile") to be a Python interpreter.
+
+  Each script is run with runpy in a fresh namespace as the main module. Its
+  working directory, sys.argv, sys.path and environment are restored
+  afterwards and its output is captured as usual. Modules imported by scripts
+  stay loaded between scripts, which is part of the speedup but means scripts
+  relying on fresh module-level state may misbehave.
+
+  Such scripts can opt out by containing the comment
+    # gn: no-python-worker
+  in which case they are run in a new process as usual. Scripts that make the
+  interpreter exit (for example with os._exit()) are run again in a new
+  process.
+
+  This is not supported on Windows, where the flag has no effect.
+
+Examples
+
+  gn gen out/Default --python-worker
+)";
+
 const char kQuiet[] = "q";
 const char kQuiet_HelpShort[] =
     "-q: Quiet mode. Don't print output on success.";
@@ -270,7 +353,10 @@ const char kTime_HelpShort[] =
 const char kTime_Help[] =
     R"(--time: Outputs a summary of how long everything took.
 
-  Hopefully self-explanatory.
+  Besides the time spent parsing, executing and running scripts, this shows
+  the total time per kind of work, how many tasks went through the main
+  thread's queue and the worker pool's queue, how long they waited before
+  running (mean and percentiles), and how long each thread sat idle.
 
 Examples
 
@@ -286,8 +372,17 @@ const char kTracelog_Help[] =
   The trace log will show file loads, executions, scripts, and writes. This
   allows performance analysis of the generation step.
 
-  To view the trace, open Chrome and navigate to "chrome://tracing/", then
-  press "Load" and specify the file you passed to this parameter.
+  The lengths of the main thread and worker pool queues are included as
+  counter tracks, and idle stretches of 1ms or more as "idle" slices on each
+  thread. The process's resident and allocated memory are sampled every 10ms
+  into a "memory" counter track.
+
+  Flow arrows link each target from the file that defined it to its
+  definition, resolution and ninja write. Target slices carry the target type,
+  source count and dependency count as arguments.
+
+  To view the trace, open https://ui.perfetto.dev or Chrome's
+  "chrome://tracing/", then load the file you passed to this parameter.
 
 Examples
 
@@ -333,13 +428,16 @@ const SwitchInfoMap& GetSwitches() {
     INSERT_VARIABLE(Args)
     INSERT_VARIABLE(Color)
     INSERT_VARIABLE(Dotfile)
+    INSERT_VARIABLE(ExecScriptCache)
     INSERT_VARIABLE(FailOnUnusedArgs)
     INSERT_VARIABLE(Markdown)
+    INSERT_VARIABLE(Memstats)
     INSERT_VARIABLE(NinjaExecutable)
     INSERT_VARIABLE(NoColor)
     INSERT_VARIABLE(Root)
     INSERT_VARIABLE(RootPattern)
     INSERT_VARIABLE(RootTarget)
+    INSERT_VARIABLE(PythonWorker)
     INSERT_VARIABLE(Quiet)
     INSERT_VARIABLE(RuntimeDepsListFile)
     INSERT_VARIABLE(ScriptExecutable)
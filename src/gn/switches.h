@@ -38,6 +38,10 @@ extern const char kDotfile[];
 extern const char kDotfile_HelpShort[];
 extern const char kDotfile_Help[];
 
+extern const char kExecScriptCache[];
+extern const char kExecScriptCache_HelpShort[];
+extern const char kExecScriptCache_Help[];
+
 extern const char kFailOnUnusedArgs[];
 extern const char kFailOnUnusedArgs_HelpShort[];
 extern const char kFailOnUnusedArgs_Help[];
@@ -46,6 +50,10 @@ extern const char kMarkdown[];
 extern const char kMarkdown_HelpShort[];
 extern const char kMarkdown_Help[];
 
+extern const char kMemstats[];
+extern const char kMemstats_HelpShort[];
+extern const char kMemstats_Help[];
+
 extern const char kNinjaExecutable[];
 extern const char kNinjaExecutable_HelpShort[];
 extern const char kNinjaExecutable_Help[];
@@ -58,6 +66,10 @@ extern const char kScriptExecutable[];
 extern const char kScriptExecutable_HelpShort[];
 extern const char kScriptExecutable_Help[];
 
+extern const char kPythonWorker[];
+extern const char kPythonWorker_HelpShort[];
+extern const char kPythonWorker_Help[];
+
 extern const char kQuiet[];
 extern const char kQuiet_HelpShort[];
 extern const char kQuiet_Help[];
@@ -0,0 +1,517 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/synthetic_project.h"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+
+const char kSyntheticProjectBuildDir[] = "out";
+
+namespace {
+
+// Subsystems group this many components, like the larger OHOS subsystems.
+constexpr int kComponentsPerSubsystem = 16;
+
+// splitmix64. Spelled out rather than using <random> since the standard
+// distributions aren't the same on every platform.
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(seed) {}
+
+  uint64_t Next() {
+    uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  // Returns |count| distinct numbers below |limit| in increasing order, or
+  // all of them if there are fewer.
+  std::vector<int> Pick(int count, int limit) {
+    std::vector<int> result;
+    if (count >= limit) {
+      for (int i = 0; i < limit; i++)
+        result.push_back(i);
+      return result;
+    }
+    while (static_cast<int>(result.size()) < count) {
+      int picked = static_cast<int>(Next() % limit);
+      if (std::find(result.begin(), result.end(), picked) == result.end())
+        result.push_back(picked);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+ private:
+  uint64_t state_;
+};
+
+std::string ComponentName(int component) {
+  return base::StringPrintf("component_%d", component);
+}
+
+std::string SubsystemName(int component) {
+  return base::StringPrintf("subsystem_%d", component / kComponentsPerSubsystem);
+}
+
+// Source-relative directory of the component, without the leading "//".
+std::string ComponentPath(int component) {
+  return SubsystemName(component) + "/" + ComponentName(component);
+}
+
+std::string CoreLabel(int component) {
+  return "//" + ComponentPath(component) + ":" + ComponentName(component) +
+         "_core";
+}
+
+std::string ApiLabel(int component) {
+  return "//" + ComponentPath(component) +
+         "/interfaces/innerapis:" + ComponentName(component) + "_api";
+}
+
+std::string ToolchainLabel(int toolchain) {
+  return base::StringPrintf("//build/toolchain:toolchain_%d", toolchain);
+}
+
+void WriteList(std::ostream& out,
+               const char* name,
+               const std::vector<std::string>& values) {
+  if (values.empty())
+    return;
+  out << "  " << name << " = [\n";
+  for (const std::string& value : values)
+    out << "    \"" << value << "\",\n";
+  out << "  ]\n";
+}
+
+void WriteJSONList(std::ostream& out, const std::vector<std::string>& values) {
+  out << "[";
+  for (size_t i = 0; i < values.size(); i++)
+    out << (i ? ", " : " ") << "\"" << values[i] << "\"";
+  out << (values.empty() ? "]" : " ]");
+}
+
+std::string GenerateDotfile(const SyntheticProjectOptions& options) {
+  std::string result = "buildconfig = \"//build/config/BUILDCONFIG.gn\"\n";
+  if (options.ohos)
+    result += "ohos_components_support = true\n";
+  return result;
+}
+
+std::string GenerateBuildConfig(const SyntheticProjectOptions& options) {
+  std::ostringstream out;
+  out << "if (target_os == \"\") {\n"
+         "  target_os = host_os\n"
+         "}\n"
+         "if (target_cpu == \"\") {\n"
+         "  target_cpu = host_cpu\n"
+         "}\n"
+         "if (current_os == \"\") {\n"
+         "  current_os = target_os\n"
+         "}\n"
+         "if (current_cpu == \"\") {\n"
+         "  current_cpu = target_cpu\n"
+         "}\n\n";
+  if (options.ohos) {
+    out << "declare_args() {\n"
+           "  ohos_graph_enable = false\n"
+           "  ohos_module_precise_build = false\n"
+           "  ohos_precise_config = \"\"\n"
+           "}\n\n";
+  }
+  out << "_binary_configs = [ \"//build/config:compiler_defaults\" ]\n";
+  for (const char* type : {"executable", "shared_library", "static_library"}) {
+    out << "set_defaults(\"" << type << "\") {\n"
+        << "  configs = _binary_configs\n"
+        << "}\n";
+  }
+  out << "\nset_default_toolchain(\"" << ToolchainLabel(0) << "\")\n";
+  return out.str();
+}
+
+std::string GenerateConfigBuildFile() {
+  return "config(\"compiler_defaults\") {\n"
+         "  cflags = [ \"-fPIC\" ]\n"
+         "  defines = [ \"SYNTHETIC_PROJECT\" ]\n"
+         "}\n";
+}
+
+std::string GenerateToolchainBuildFile(const SyntheticProjectOptions& options) {
+  std::ostringstream out;
+  out << R"(template("synthetic_toolchain") {
+  not_needed([ "invoker" ])
+  toolchain(target_name) {
+    tool("cc") {
+      depfile = "{{output}}.d"
+      command = "cc -MMD -MF $depfile {{defines}} {{include_dirs}} {{cflags}} {{cflags_c}} -c {{source}} -o {{output}}"
+      depsformat = "gcc"
+      outputs = [ "{{source_out_dir}}/{{target_output_name}}.{{source_name_part}}.o" ]
+    }
+    tool("cxx") {
+      depfile = "{{output}}.d"
+      command = "c++ -MMD -MF $depfile {{defines}} {{include_dirs}} {{cflags}} {{cflags_cc}} -c {{source}} -o {{output}}"
+      depsformat = "gcc"
+      outputs = [ "{{source_out_dir}}/{{target_output_name}}.{{source_name_part}}.o" ]
+    }
+    tool("alink") {
+      command = "ar rcs {{output}} {{inputs}}"
+      outputs = [ "{{target_out_dir}}/{{target_output_name}}{{output_extension}}" ]
+      default_output_extension = ".a"
+      output_prefix = "lib"
+    }
+    tool("solink") {
+      soname = "{{target_output_name}}{{output_extension}}"
+      sofile = "{{output_dir}}/$soname"
+      rspfile = soname + ".rsp"
+      rspfile_content = "{{inputs}} {{solibs}} {{libs}}"
+      command = "c++ -shared {{ldflags}} -o $sofile -Wl,-soname=$soname @$rspfile"
+      default_output_extension = ".so"
+      default_output_dir = "{{root_out_dir}}"
+      outputs = [ sofile ]
+      link_output = sofile
+      depend_output = sofile
+      output_prefix = "lib"
+    }
+    tool("link") {
+      outfile = "{{target_output_name}}{{output_extension}}"
+      rspfile = "$outfile.rsp"
+      rspfile_content = "{{inputs}}"
+      command = "c++ {{ldflags}} -o $outfile @$rspfile {{solibs}} {{libs}}"
+      default_output_dir = "{{root_out_dir}}"
+      outputs = [ outfile ]
+    }
+    tool("stamp") {
+      command = "touch {{output}}"
+    }
+    tool("copy") {
+      command = "cp -af {{source}} {{output}}"
+    }
+  }
+}
+)";
+  for (int i = 0; i < options.toolchains; i++)
+    out << "\nsynthetic_toolchain(\"toolchain_" << i << "\") {\n}\n";
+  return out.str();
+}
+
+// The ohos_* templates pass the target through |template_depth| internal
+// templates that each add a define, the innermost of which defines it.
+std::string GenerateTemplates(const SyntheticProjectOptions& options) {
+  const char kForwardToTarget[] =
+      "    forward_variables_from(invoker,\n"
+      "                           \"*\",\n"
+      "                           [\n"
+      "                             \"part_name\",\n"
+      "                             \"subsystem_name\",\n"
+      "                             \"target_type\",\n"
+      "                           ])\n";
+
+  std::ostringstream out;
+  for (int layer = 0; layer < options.template_depth; layer++) {
+    out << "template(\"_synthetic_layer_" << layer << "\") {\n";
+    if (layer == 0) {
+      out << "  target(invoker.target_type, target_name) {\n"
+          << kForwardToTarget;
+    } else {
+      out << "  _synthetic_layer_" << layer - 1 << "(target_name) {\n"
+          << "    forward_variables_from(invoker, \"*\")\n";
+    }
+    out << "    if (!defined(defines)) {\n"
+        << "      defines = []\n"
+        << "    }\n"
+        << "    defines += [ \"SYNTHETIC_LAYER_" << layer << "\" ]\n"
+        << "  }\n"
+        << "}\n\n";
+  }
+
+  const char* kTypes[] = {"executable", "shared_library", "static_library"};
+  for (size_t i = 0; i < std::size(kTypes); i++) {
+    if (i)
+      out << "\n";
+    out << "template(\"ohos_" << kTypes[i] << "\") {\n";
+    if (options.template_depth == 0) {
+      out << "  target(\"" << kTypes[i] << "\", target_name) {\n"
+          << kForwardToTarget;
+    } else {
+      out << "  _synthetic_layer_" << options.template_depth - 1
+          << "(target_name) {\n"
+          << "    target_type = \"" << kTypes[i] << "\"\n"
+          << "    forward_variables_from(invoker, \"*\")\n";
+    }
+    out << "  }\n"
+        << "}\n";
+  }
+  return out.str();
+}
+
+std::string GenerateRootBuildFile(const SyntheticProjectOptions& options) {
+  std::vector<std::string> deps;
+  for (int toolchain = 0; toolchain < options.toolchains; toolchain++) {
+    for (int i = 0; i < options.components; i++) {
+      std::string dep = "//" + ComponentPath(i);
+      if (toolchain > 0)
+        dep += "(" + ToolchainLabel(toolchain) + ")";
+      deps.push_back(dep);
+    }
+  }
+  std::ostringstream out;
+  out << "group(\"all\") {\n";
+  WriteList(out, "deps", deps);
+  out << "}\n";
+  return out.str();
+}
+
+struct ComponentDeps {
+  std::vector<int> direct;
+  std::vector<int> external;
+};
+
+std::string GenerateComponentBuildFile(const SyntheticProjectOptions& options,
+                                       int component,
+                                       const ComponentDeps& deps) {
+  std::string name = ComponentName(component);
+  std::string part_lines = "  part_name = \"" + name + "\"\n" +
+                           "  subsystem_name = \"" + SubsystemName(component) +
+                           "\"\n";
+
+  std::ostringstream out;
+  out << "import(\"//build/ohos.gni\")\n\n";
+  out << "config(\"" << name << "_config\") {\n"
+      << "  include_dirs = [ \"include\" ]\n"
+      << "  defines = [ \"" << base::ToUpperASCII(name) << "\" ]\n"
+      << "}\n\n";
+
+  std::vector<std::string> sources;
+  for (int i = 0; i < options.sources; i++)
+    sources.push_back(base::StringPrintf("src/%s_%d.cpp", name.c_str(), i));
+  std::vector<std::string> direct;
+  for (int dep : deps.direct)
+    direct.push_back(CoreLabel(dep));
+  std::vector<std::string> external;
+  for (int dep : deps.external) {
+    if (options.ohos)
+      external.push_back(ComponentName(dep) + ":" + ComponentName(dep) + "_api");
+    else
+      direct.push_back(ApiLabel(dep));
+  }
+
+  out << "ohos_static_library(\"" << name << "_core\") {\n";
+  WriteList(out, "sources", sources);
+  out << "  public_configs = [ \":" << name << "_config\" ]\n";
+  WriteList(out, "deps", direct);
+  WriteList(out, "external_deps", external);
+  out << part_lines << "}\n\n";
+
+  out << "ohos_executable(\"" << name << "_tool\") {\n"
+      << "  sources = [ \"tools/main.cpp\" ]\n"
+      << "  deps = [ \":" << name << "_core\" ]\n"
+      << part_lines << "}\n\n";
+
+  out << "group(\"" << name << "\") {\n";
+  WriteList(out, "deps",
+            {":" + name + "_core", ":" + name + "_tool", ApiLabel(component)});
+  out << "}\n";
+  return out.str();
+}
+
+std::string GenerateApiBuildFile(int component) {
+  std::string name = ComponentName(component);
+  std::ostringstream out;
+  out << "import(\"//build/ohos.gni\")\n\n";
+  out << "config(\"" << name << "_api_config\") {\n"
+      << "  include_dirs = [ \"include\" ]\n"
+      << "}\n\n";
+  out << "ohos_shared_library(\"" << name << "_api\") {\n"
+      << "  sources = [ \"src/" << name << "_api.cpp\" ]\n"
+      << "  public_configs = [ \":" << name << "_api_config\" ]\n"
+      << "  deps = [ \"" << CoreLabel(component) << "\" ]\n"
+      << "  part_name = \"" << name << "\"\n"
+      << "  subsystem_name = \"" << SubsystemName(component) << "\"\n"
+      << "}\n";
+  return out.str();
+}
+
+// The bundle.json each OHOS component has at its root. GN doesn't read these;
+// the OHOS build preprocesses them into the component list below.
+std::string GenerateBundle(int component, const ComponentDeps& deps) {
+  std::string name = ComponentName(component);
+  std::vector<std::string> dep_names;
+  for (int dep : deps.external)
+    dep_names.push_back(ComponentName(dep));
+
+  std::ostringstream out;
+  out << "{\n"
+      << "  \"name\": \"@ohos/" << name << "\",\n"
+      << "  \"version\": \"1.0.0\",\n"
+      << "  \"component\": {\n"
+      << "    \"name\": \"" << name << "\",\n"
+      << "    \"subsystem\": \"" << SubsystemName(component) << "\",\n"
+      << "    \"deps\": {\n"
+      << "      \"components\": ";
+  WriteJSONList(out, dep_names);
+  out << "\n"
+      << "    },\n"
+      << "    \"build\": {\n"
+      << "      \"sub_component\": [ \"//" << ComponentPath(component)
+      << ":" << name << "\" ],\n"
+      << "      \"inner_kits\": [\n"
+      << "        {\n"
+      << "          \"name\": \"" << ApiLabel(component) << "\",\n"
+      << "          \"header\": {\n"
+      << "            \"header_base\": \"//" << ComponentPath(component)
+      << "/interfaces/innerapis/include\",\n"
+      << "            \"header_files\": [ \"" << name << "_api.h\" ]\n"
+      << "          }\n"
+      << "        }\n"
+      << "      ]\n"
+      << "    }\n"
+      << "  }\n"
+      << "}\n";
+  return out.str();
+}
+
+// parts_info/components.json, which GN loads from the build directory.
+std::string GenerateComponentList(const SyntheticProjectOptions& options,
+                                  const std::vector<ComponentDeps>& deps) {
+  std::ostringstream out;
+  out << "{\n";
+  for (int i = 0; i < options.components; i++) {
+    std::string name = ComponentName(i);
+    std::vector<std::string> dep_names;
+    for (int dep : deps[i].external)
+      dep_names.push_back(ComponentName(dep));
+
+    out << "  \"" << name << "\": {\n"
+        << "    \"subsystem\": \"" << SubsystemName(i) << "\",\n"
+        << "    \"path\": \"" << ComponentPath(i) << "\",\n"
+        << "    \"innerapis\": [\n"
+        << "      {\n"
+        << "        \"name\": \"" << name << "_api\",\n"
+        << "        \"label\": \"" << ApiLabel(i) << "\"\n"
+        << "      }\n"
+        << "    ],\n"
+        << "    \"deps_components\": ";
+    WriteJSONList(out, dep_names);
+    out << "\n  }" << (i + 1 < options.components ? "," : "") << "\n";
+  }
+  out << "}\n";
+  return out.str();
+}
+
+// Config for the precise build post-pass, which looks for the targets
+// affected by a change to the first source of every 16th component. Like
+// real configs it limits the search to what the root group builds, without
+// which the pass walks every path up the graph.
+std::string GeneratePreciseConfig() {
+  return "{\n"
+         "  \"modify_files_path\": \"build/precise/modify_files.json\",\n"
+         "  \"precise_result_path\": \"precise_result.txt\",\n"
+         "  \"precise_log_path\": \"precise.log\",\n"
+         "  \"precise_log_level\": \"error\",\n"
+         "  \"c_file_depth\": 3,\n"
+         "  \"h_file_depth\": 3,\n"
+         "  \"gn_file_depth\": 3,\n"
+         "  \"gn_module_depth\": 3,\n"
+         "  \"other_file_depth\": 3,\n"
+         "  \"enable_header_checker\": false,\n"
+         "  \"include_parent_targets\": [ \"//:all\" ],\n"
+         "  \"target_type_list\": [ \"executable\", \"shared_library\", "
+         "\"static_library\" ]\n"
+         "}\n";
+}
+
+std::string GenerateModifiedFiles(const SyntheticProjectOptions& options) {
+  std::vector<std::string> files;
+  if (options.sources > 0) {
+    for (int i = 0; i < options.components; i += kComponentsPerSubsystem) {
+      files.push_back("//" + ComponentPath(i) + "/src/" + ComponentName(i) +
+                      "_0.cpp");
+    }
+  }
+  std::ostringstream out;
+  out << "{\n  \"c_file\": ";
+  WriteJSONList(out, files);
+  out << "\n}\n";
+  return out.str();
+}
+
+std::string GenerateArgs(const SyntheticProjectOptions& options) {
+  if (!options.ohos)
+    return std::string();
+  return "ohos_graph_enable = true\n"
+         "ohos_module_precise_build = true\n"
+         "ohos_precise_config = \"build/precise/precise_config.json\"\n";
+}
+
+}  // namespace
+
+int GetSyntheticProjectTargetCount(const SyntheticProjectOptions& options) {
+  // Four targets per component and toolchain, and the root group.
+  return options.components * options.toolchains * 4 + 1;
+}
+
+std::map<std::string, std::string> GenerateSyntheticProject(
+    const SyntheticProjectOptions& options) {
+  // Components only depend on ones with lower numbers, so there are no
+  // cycles.
+  Random random(options.seed);
+  std::vector<ComponentDeps> deps(options.components);
+  for (int i = 0; i < options.components; i++) {
+    deps[i].direct = random.Pick(options.fanout, i);
+    deps[i].external = random.Pick(options.external_deps, i);
+  }
+
+  std::map<std::string, std::string> files;
+  files[".gn"] = GenerateDotfile(options);
+  files["BUILD.gn"] = GenerateRootBuildFile(options);
+  files["build/config/BUILDCONFIG.gn"] = GenerateBuildConfig(options);
+  files["build/config/BUILD.gn"] = GenerateConfigBuildFile();
+  files["build/toolchain/BUILD.gn"] = GenerateToolchainBuildFile(options);
+  files["build/ohos.gni"] = GenerateTemplates(options);
+  for (int i = 0; i < options.components; i++) {
+    std::string path = ComponentPath(i);
+    files[path + "/BUILD.gn"] =
+        GenerateComponentBuildFile(options, i, deps[i]);
+    files[path + "/interfaces/innerapis/BUILD.gn"] = GenerateApiBuildFile(i);
+    files[path + "/bundle.json"] = GenerateBundle(i, deps[i]);
+  }
+
+  std::string build_dir = kSyntheticProjectBuildDir;
+  files[build_dir + "/args.gn"] = GenerateArgs(options);
+  if (options.ohos) {
+    files[build_dir + "/build_configs/parts_info/components.json"] =
+        GenerateComponentList(options, deps);
+    files["build/precise/precise_config.json"] = GeneratePreciseConfig();
+    files["build/precise/modify_files.json"] = GenerateModifiedFiles(options);
+  }
+  return files;
+}
+
+bool WriteSyntheticProject(const SyntheticProjectOptions& options,
+                           const base::FilePath& root,
+                           Err* err) {
+  for (const auto& [path, contents] : GenerateSyntheticProject(options)) {
+    base::FilePath file = root.Append(UTF8ToFilePath(path));
+    if (!base::CreateDirectory(file.DirName()) ||
+        base::WriteFile(file, contents.data(),
+                        static_cast<int>(contents.size())) !=
+            static_cast<int>(contents.size())) {
+      *err = Err(Location(), "Could not write the synthetic project.",
+                 "Unable to write \"" + FilePathToUTF8(file) + "\".");
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,82 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_SYNTHETIC_PROJECT_H_
+#define TOOLS_GN_SYNTHETIC_PROJECT_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+class Err;
+
+namespace base {
+class FilePath;
+}  // namespace base
+
+// Generates GN projects shaped like OpenHarmony source trees for benchmarks.
+//
+// Components are grouped into subsystems, "//subsystem_S/component_C", each
+// with a bundle.json describing it. A component has a static library with
+// the sources, a tool linking it, an inner API shared library other
+// components use through external_deps, and a group named after the
+// component. All of them are defined through ohos_* templates layered over
+// a few internal templates, and every component is built in every
+// toolchain.
+//
+// The output only depends on the options, so the same options always give
+// the same project.
+
+struct SyntheticProjectOptions {
+  int components = 200;
+
+  // Number of other components the static library of each component lists
+  // in its deps.
+  int fanout = 3;
+
+  // Number of internal templates between the ohos_* templates and the
+  // targets they define.
+  int template_depth = 3;
+
+  // Number of toolchains every component is built in.
+  int toolchains = 1;
+
+  // Number of inner APIs of other components the static library of each
+  // component uses.
+  int external_deps = 2;
+
+  // Number of sources of the static library of each component.
+  int sources = 10;
+
+  // Whether to enable OpenHarmony component support. This makes GN load the
+  // component list from the build directory, resolve external_deps through it
+  // and run the post-passes over the graph (inner API info, precise build
+  // and graph output). Otherwise external_deps are written as plain deps.
+  bool ohos = true;
+
+  // Seed for picking the dependencies of each component.
+  uint64_t seed = 1;
+};
+
+// The build directory the project is set up for, relative to its root. GN
+// should be run from the root with this as the build directory.
+extern const char kSyntheticProjectBuildDir[];
+
+// Returns the number of targets GN makes for the project.
+int GetSyntheticProjectTargetCount(const SyntheticProjectOptions& options);
+
+// Returns the contents of each file of the project by path relative to the
+// root, with '/' separators. This includes out/args.gn and the component
+// list under the build directory.
+std::map<std::string, std::string> GenerateSyntheticProject(
+    const SyntheticProjectOptions& options);
+
+// Writes the files of the project under |root|, creating directories as
+// needed.
+bool WriteSyntheticProject(const SyntheticProjectOptions& options,
+                           const base::FilePath& root,
+                           Err* err);
+
+#endif  // TOOLS_GN_SYNTHETIC_PROJECT_H_
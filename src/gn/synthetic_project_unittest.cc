@@ -0,0 +1,61 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/synthetic_project.h"
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/err.h"
+#include "gn/setup.h"
+#include "gn/switches.h"
+#include "gn/test_with_scheduler.h"
+#include "util/test/test.h"
+
+using SyntheticProjectTest = TestWithScheduler;
+
+TEST(SyntheticProject, Deterministic) {
+  SyntheticProjectOptions options;
+  options.components = 40;
+  std::map<std::string, std::string> files = GenerateSyntheticProject(options);
+  EXPECT_EQ(files, GenerateSyntheticProject(options));
+
+  // Three build files and a bundle.json per component, and the component
+  // list GN reads.
+  EXPECT_EQ(1u, files.count("subsystem_2/component_39/BUILD.gn"));
+  EXPECT_EQ(
+      1u, files.count("subsystem_2/component_39/interfaces/innerapis/BUILD.gn"));
+  EXPECT_EQ(1u, files.count("subsystem_2/component_39/bundle.json"));
+  EXPECT_EQ(1u, files.count("out/build_configs/parts_info/components.json"));
+
+  options.seed = 2;
+  EXPECT_NE(files["subsystem_2/component_39/BUILD.gn"],
+            GenerateSyntheticProject(options)["subsystem_2/component_39/"
+                                              "BUILD.gn"]);
+}
+
+TEST_F(SyntheticProjectTest, Loads) {
+  SyntheticProjectOptions options;
+  options.components = 20;
+  options.toolchains = 2;
+  options.template_depth = 2;
+  options.ohos = false;
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath root = base::MakeAbsoluteFilePath(temp_dir.GetPath());
+  Err err;
+  ASSERT_TRUE(WriteSyntheticProject(options, root, &err));
+
+  base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+  cmdline.AppendSwitchPath(switches::kRoot, root);
+  Setup setup;
+  ASSERT_TRUE(setup.DoSetupWithErr(std::string("//") + kSyntheticProjectBuildDir,
+                                   true, cmdline, &err))
+      << err.message();
+  ASSERT_TRUE(setup.Run(cmdline));
+  EXPECT_EQ(static_cast<size_t>(GetSyntheticProjectTargetCount(options)),
+            setup.builder().GetAllResolvedTargets().size());
+}
@@ -12,6 +12,7 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "gn/c_tool.h"
+#include "gn/compiled_substitution.h"
 #include "gn/config_values_extractors.h"
 #include "gn/deps_iterator.h"
 #include "gn/filesystem_utils.h"
@@ -126,9 +127,11 @@ bool EnsureFileIsGeneratedByDependency(const Target* target,
   // Check binary target intermediate files if requested.
   if (consider_object_files && target->IsBinary()) {
     std::vector<OutputFile> source_outputs;
+    SubstitutionExpanderCache expanders;
     for (const SourceFile& source : target->sources()) {
       const char* tool_name;
-      if (!target->GetOutputFilesForSource(source, &tool_name, &source_outputs))
+      if (!target->GetOutputFilesForSource(source, &tool_name, &source_outputs,
+                                           &expanders))
         continue;
       if (base::ContainsValue(source_outputs, file))
         return true;
@@ -571,6 +574,11 @@ bool Target::OnResolved(Err* err) {
 
   ScopedTrace trace(TraceItem::TRACE_ON_RESOLVED, label());
   trace.SetToolchain(settings()->toolchain_label());
+  if (TracingEnabled()) {
+    trace.AddFlow(TraceItem::FLOW_STEP, label());
+    trace.AddArg("deps", static_cast<int64_t>(private_deps_.size() +
+                                              public_deps_.size()));
+  }
 
   // Copy this target's own dependent and public configs to the list of configs
   // applying to it.
@@ -784,6 +792,16 @@ bool Target::GetOutputsAsSourceFiles(const LocationRange& loc_for_error,
 bool Target::GetOutputFilesForSource(const SourceFile& source,
                                      const char** computed_tool_type,
                                      std::vector<OutputFile>* outputs) const {
+  SubstitutionExpanderCache expanders;
+  return GetOutputFilesForSource(source, computed_tool_type, outputs,
+                                 &expanders);
+}
+
+bool Target::GetOutputFilesForSource(
+    const SourceFile& source,
+    const char** computed_tool_type,
+    std::vector<OutputFile>* outputs,
+    SubstitutionExpanderCache* expanders) const {
   DCHECK(toolchain());  // Should be resolved before calling.
 
   outputs->clear();
@@ -792,9 +810,10 @@ bool Target::GetOutputFilesForSource(const SourceFile& source,
   if (output_type() == Target::COPY_FILES ||
       output_type() == Target::ACTION_FOREACH) {
     // These target types apply the output pattern to the input.
-    std::vector<SourceFile> output_files;
-    SubstitutionWriter::ApplyListToSourceAsOutputFile(
-        this, settings(), action_values().outputs(), source, outputs);
+    expanders
+        ->Get(this, settings(), action_values().outputs(),
+              SubstitutionExpander::SOURCE)
+        .ApplyToSourceAsOutputFiles(source, outputs);
   } else if (!IsBinary()) {
     // All other non-binary target types just return the target outputs. We
     // don't know if the build is complete and it doesn't matter for non-binary
@@ -837,13 +856,16 @@ bool Target::GetOutputFilesForSource(const SourceFile& source,
         return false;
     }
 
-    const SubstitutionList& substitution_list =
-        file_type == SourceFile::SOURCE_SWIFT ? tool->partial_outputs()
-                                              : tool->outputs();
+    const CompiledSubstitutionList& substitution_list =
+        file_type == SourceFile::SOURCE_SWIFT
+            ? tool->compiled_partial_outputs()
+            : tool->compiled_outputs();
 
     // Figure out what output(s) this compiler produces.
-    SubstitutionWriter::ApplyListToCompilerAsOutputFile(
-        this, source, substitution_list, outputs);
+    expanders
+        ->Get(this, settings(), substitution_list,
+              SubstitutionExpander::COMPILER)
+        .ApplyToSourceAsOutputFiles(source, outputs);
   }
   return !outputs->empty();
 }
@@ -1085,6 +1107,7 @@ bool Target::HasRealInputs() const {
   // If any of this target's sources will result in output files, then this
   // target should be considered to have real inputs.
   std::vector<OutputFile> tool_outputs;
+  SubstitutionExpanderCache expanders;
   return std::any_of(
       sources().begin(), sources().end(), [&, this](const auto& source) {
         // Swift files always results in output files, but the name cannot
@@ -1093,7 +1116,8 @@ bool Target::HasRealInputs() const {
           return true;
         }
         const char* tool_name = Tool::kToolNone;
-        return GetOutputFilesForSource(source, &tool_name, &tool_outputs);
+        return GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                       &expanders);
       });
 }
 
@@ -31,6 +31,7 @@
 
 class DepsIteratorRange;
 class Settings;
+class SubstitutionExpanderCache;
 class Target;
 class Toolchain;
 
@@ -538,6 +539,13 @@ class Target : public Item {
                                const char** computed_tool_type,
                                std::vector<OutputFile>* outputs) const;
 
+  // Same, for callers that handle many sources of this target. The output
+  // patterns are bound to this target once and kept in |expanders|.
+  bool GetOutputFilesForSource(const SourceFile& source,
+                               const char** computed_tool_type,
+                               std::vector<OutputFile>* outputs,
+                               SubstitutionExpanderCache* expanders) const;
+
  private:
   FRIEND_TEST_ALL_PREFIXES(TargetTest, ResolvePrecompiledHeaders);
   FRIEND_TEST_ALL_PREFIXES(TargetTest, HasRealInputs);
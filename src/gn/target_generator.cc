@@ -17,6 +17,7 @@
 #include "gn/copy_target_generator.h"
 #include "gn/create_bundle_target_generator.h"
 #include "gn/err.h"
+#include "gn/execution_record.h"
 #include "gn/filesystem_utils.h"
 #include "gn/functions.h"
 #include "gn/generated_file_target_generator.h"
@@ -105,6 +106,7 @@ void TargetGenerator::GenerateTarget(Scope* scope,
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Defining target", label.GetUserVisibleName(true));
 
+  ExecutionRecord::ItemDefinition definition(scope, output_type);
   std::unique_ptr<Target> target = std::make_unique<Target>(
       scope->settings(), label, scope->CollectBuildDependencyFiles());
   target->set_defined_from(function_call);
@@ -178,6 +180,7 @@ void TargetGenerator::GenerateTarget(Scope* scope,
     *err = Err(function_call, "Can't define a target in this context.");
     return;
   }
+  definition.Done(target.get());
   collector->push_back(std::move(target));
 }
 
@@ -415,18 +418,20 @@ bool TargetGenerator::FillDependencies() {
 }
 
 bool TargetGenerator::FillMetadata() {
-  // Need to get a mutable value to mark all values in the scope as used. This
-  // cannot be done on a const Scope.
-  Value* value = scope_->GetMutableValue(variables::kMetadata,
-                                         Scope::SEARCH_CURRENT, true);
-
-  if (!value)
+  // Only read the value of the current scope. Its scope may be shared with
+  // the value it was forwarded from, so it is read through the const
+  // accessor, which doesn't copy it.
+  const Scope* found_in = nullptr;
+  const Value* value =
+      scope_->GetValueWithScope(StringAtom(variables::kMetadata), &found_in);
+  if (!value || found_in != scope_)
     return true;
+  scope_->MarkUsed(variables::kMetadata);
 
   if (!value->VerifyTypeIs(Value::SCOPE, err_))
     return false;
 
-  Scope* scope_value = value->scope_value();
+  const Scope* scope_value = value->scope_value();
 
   scope_value->GetCurrentScopeValues(&target_->metadata().contents());
   scope_value->MarkAllUsed();
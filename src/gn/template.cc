@@ -9,6 +9,7 @@
 
 #include "gn/err.h"
 #include "gn/functions.h"
+#include "gn/memory_stats.h"
 #include "gn/parse_tree.h"
 #include "gn/scope.h"
 #include "gn/scope_per_file_provider.h"
@@ -17,11 +18,12 @@
 #include "gn/value.h"
 #include "gn/variables.h"
 
-Template::Template(const Scope* scope, const FunctionCallNode* def)
-    : closure_(scope->MakeClosure()), definition_(def) {}
+Template::Template(Scope* scope, const FunctionCallNode* def)
+    : closure_(scope->MakeClosureSnapshot()), definition_(def) {}
 
 Template::Template(std::unique_ptr<Scope> scope, const FunctionCallNode* def)
-    : closure_(std::move(scope)), definition_(def) {}
+    : closure_(base::MakeRefCounted<ClosureSnapshot>(std::move(scope), nullptr)),
+      definition_(def) {}
 
 Template::~Template() = default;
 
@@ -66,7 +68,7 @@ Value Template::Invoke(Scope* scope,
   // This way, files don't have to be rebased and target_*_dir works the way
   // people expect (otherwise its to easy to be putting generated files in the
   // gen dir corresponding to an imported file).
-  Scope template_scope(closure_.get());
+  Scope template_scope(closure_->scope());
   template_scope.set_source_dir(scope->GetSourceDir());
 
   // Track the invocation of the template on the template's scope
@@ -120,10 +122,9 @@ Value Template::Invoke(Scope* scope,
   // to overwrite the value of "invoker" and free the Scope owned by the
   // value. So we need to look it up again and don't do anything if it doesn't
   // exist.
-  invoker_value = template_scope.GetMutableValue(variables::kInvoker,
-                                                 Scope::SEARCH_NESTED, false);
-  if (invoker_value && invoker_value->type() == Value::SCOPE) {
-    if (!invoker_value->scope_value()->CheckForUnusedVars(err)) {
+  const Value* invoker = template_scope.GetValue(variables::kInvoker, false);
+  if (invoker && invoker->type() == Value::SCOPE) {
+    if (!invoker->scope_value()->CheckForUnusedVars(err)) {
       // If there was an error, append the caller location so the error message
       // displays a stack trace of how it got here.
       err->AppendSubErr(Err(invocation, "whence it was called."));
@@ -145,3 +146,18 @@ Value Template::Invoke(Scope* scope,
 LocationRange Template::GetDefinitionRange() const {
   return definition_->GetRange();
 }
+
+size_t Template::EstimateMemoryUsage(
+    std::unordered_set<const void*>* seen) const {
+  if (!seen->insert(this).second)
+    return 0;
+  size_t result = sizeof(Template);
+  // Snapshots can be shared with other templates, so stop at the first one
+  // that was counted already.
+  for (const ClosureSnapshot* snapshot = closure_.get();
+       snapshot && seen->insert(snapshot).second; snapshot = snapshot->base()) {
+    result += sizeof(ClosureSnapshot) +
+              snapshot->scope()->EstimateMemoryUsage(seen);
+  }
+  return result;
+}
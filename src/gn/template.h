@@ -6,11 +6,13 @@
 #define TOOLS_GN_TEMPLATE_H_
 
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "base/memory/ref_counted.h"
 
 class BlockNode;
+class ClosureSnapshot;
 class Err;
 class FunctionCallNode;
 class LocationRange;
@@ -26,8 +28,9 @@ class Value;
 // execute the template in parallel.
 class Template : public base::RefCountedThreadSafe<Template> {
  public:
-  // Makes a new closure based on the given scope.
-  Template(const Scope* scope, const FunctionCallNode* def);
+  // Takes a closure snapshot of the given scope (see
+  // Scope::MakeClosureSnapshot()).
+  Template(Scope* scope, const FunctionCallNode* def);
 
   // Takes ownership of a previously-constructed closure.
   Template(std::unique_ptr<Scope> closure, const FunctionCallNode* def);
@@ -46,20 +49,24 @@ class Template : public base::RefCountedThreadSafe<Template> {
   // Returns the location range where this template was defined.
   LocationRange GetDefinitionRange() const;
 
+  // Returns the approximate number of bytes held by this template and its
+  // closure, or 0 if |seen| shows they were counted already.
+  size_t EstimateMemoryUsage(std::unordered_set<const void*>* seen) const;
+
  private:
   friend class base::RefCountedThreadSafe<Template>;
 
   Template();
   ~Template();
 
-  // It's important that this Scope is const. A template can be referenced by
+  // It's important that this closure is const. A template can be referenced by
   // the root BUILDCONFIG file and then duplicated to all threads. Therefore,
-  // this scope must be usable from multiple threads at the same time.
+  // its scope must be usable from multiple threads at the same time. It may
+  // also be shared with other templates defined in the same scope.
   //
-  // When executing a template, a new scope will be created as a child of this
-  // one, which will reference it as mutable or not according to the mutability
-  // of this value.
-  std::unique_ptr<const Scope> closure_;
+  // When executing a template, a new scope will be created as a child of the
+  // closure's scope, which will reference it as const.
+  scoped_refptr<const ClosureSnapshot> closure_;
 
   const FunctionCallNode* definition_;
 };
@@ -10,7 +10,10 @@
 Token::Token() : type_(INVALID), value_() {}
 
 Token::Token(const Location& location, Type t, std::string_view v)
-    : type_(t), value_(v), location_(location) {}
+    : type_(t),
+      value_(v),
+      atom_(t == IDENTIFIER ? StringAtom(v) : StringAtom()),
+      location_(location) {}
 
 // static
 Token Token::ClassifyAndMake(const Location& location, std::string_view v) {
@@ -8,6 +8,7 @@
 #include <string_view>
 
 #include "gn/location.h"
+#include "gn/string_atom.h"
 
 class Token {
  public:
@@ -64,6 +65,12 @@ class Token {
 
   Type type() const { return type_; }
   std::string_view value() const { return value_; }
+
+  // For IDENTIFIER tokens, the interned value. This allows scope lookups to
+  // compare pointers rather than hashing the identifier each time. Empty for
+  // other token types.
+  StringAtom atom() const { return atom_; }
+
   const Location& location() const { return location_; }
   void set_location(Location location) { location_ = location; }
   LocationRange range() const {
@@ -80,6 +87,7 @@ class Token {
  private:
   Type type_;
   std::string_view value_;
+  StringAtom atom_;
   Location location_;
 };
 
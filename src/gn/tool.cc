@@ -28,6 +28,9 @@ void Tool::SetToolComplete() {
   rspfile_.FillRequiredTypes(&substitution_bits_);
   rspfile_content_.FillRequiredTypes(&substitution_bits_);
   partial_outputs_.FillRequiredTypes(&substitution_bits_);
+
+  compiled_outputs_ = CompiledSubstitutionList(outputs_);
+  compiled_partial_outputs_ = CompiledSubstitutionList(partial_outputs_);
 }
 
 GeneralTool* Tool::AsGeneral() {
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "base/logging.h"
+#include "gn/compiled_substitution.h"
 #include "gn/label.h"
 #include "gn/label_ptr.h"
 #include "gn/scope.h"
@@ -189,6 +190,17 @@ class Tool {
     partial_outputs_ = std::move(partial_out);
   }
 
+  // The outputs and partial_outputs compiled for expansion, available once
+  // the tool is complete.
+  const CompiledSubstitutionList& compiled_outputs() const {
+    DCHECK(complete_);
+    return compiled_outputs_;
+  }
+  const CompiledSubstitutionList& compiled_partial_outputs() const {
+    DCHECK(complete_);
+    return compiled_partial_outputs_;
+  }
+
   const SubstitutionList& runtime_outputs() const { return runtime_outputs_; }
   void set_runtime_outputs(SubstitutionList run_out) {
     DCHECK(!complete_);
@@ -297,6 +309,8 @@ class Tool {
   std::string linker_arg_;
   SubstitutionList outputs_;
   SubstitutionList partial_outputs_;
+  CompiledSubstitutionList compiled_outputs_;
+  CompiledSubstitutionList compiled_partial_outputs_;
   SubstitutionList runtime_outputs_;
   std::string output_prefix_;
   bool restat_ = false;
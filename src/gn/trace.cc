@@ -7,6 +7,8 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <sstream>
@@ -20,11 +22,18 @@
 #include "base/strings/stringprintf.h"
 #include "gn/filesystem_utils.h"
 #include "gn/label.h"
+#include "util/sys_info.h"
+#include "util/task_stats.h"
 
 namespace {
 
 constexpr uint64_t kNanosecondsToMicroseconds = 1'000;
 
+// Trace viewers read numbers as doubles, so flow ids must fit in 53 bits.
+constexpr uint64_t kMaxTraceId = (uint64_t(1) << 53) - 1;
+
+constexpr std::chrono::milliseconds kMemorySampleInterval(10);
+
 class TraceLog {
  public:
   TraceLog() { events_.reserve(16384); }
@@ -56,6 +65,59 @@ class TraceLog {
 
 TraceLog* trace_log = nullptr;
 
+struct MemorySample {
+  Ticks time;
+  uint64_t resident;
+  uint64_t allocated;
+};
+
+// Samples the memory use of the process on its own thread.
+class MemorySampler {
+ public:
+  MemorySampler() : thread_(&MemorySampler::Run, this) {}
+
+  // Stops sampling and returns everything recorded. Can be called more than
+  // once.
+  std::vector<MemorySample> Stop() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      stop_ = true;
+    }
+    stop_notifier_.notify_one();
+    if (thread_.joinable())
+      thread_.join();
+    return samples_;
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(lock_);
+    while (true) {
+      MemorySample sample = {TicksNow(), ResidentMemoryBytes(),
+                             AllocatedMemoryBytes()};
+      samples_.push_back(sample);
+      if (stop_)
+        return;
+      stop_notifier_.wait_for(lock, kMemorySampleInterval,
+                              [this]() { return stop_; });
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable stop_notifier_;
+  bool stop_ = false;
+  std::vector<MemorySample> samples_;
+
+  // Last so that everything above is initialized before the thread runs.
+  std::thread thread_;
+
+  MemorySampler(const MemorySampler&) = delete;
+  MemorySampler& operator=(const MemorySampler&) = delete;
+};
+
+// Leaked like the trace log.
+MemorySampler* memory_sampler = nullptr;
+
 struct Coalesced {
   Coalesced() : name_ptr(nullptr), total_duration(0.0), count(0) {}
 
@@ -64,6 +126,57 @@ struct Coalesced {
   int count;
 };
 
+// Returns the category name used for the given type in trace files.
+const char* TraceTypeName(TraceItem::Type type) {
+  switch (type) {
+    case TraceItem::TRACE_SETUP:
+      return "setup";
+    case TraceItem::TRACE_FILE_LOAD:
+      return "load";
+    case TraceItem::TRACE_FILE_PARSE:
+      return "parse";
+    case TraceItem::TRACE_FILE_EXECUTE:
+      return "file_exec";
+    case TraceItem::TRACE_FILE_EXECUTE_TEMPLATE:
+      return "file_exec_template";
+    case TraceItem::TRACE_FILE_WRITE:
+      return "file_write";
+    case TraceItem::TRACE_FILE_WRITE_GENERATED:
+      return "file_write_generated";
+    case TraceItem::TRACE_FILE_WRITE_NINJA:
+      return "file_write_ninja";
+    case TraceItem::TRACE_IMPORT_LOAD:
+      return "import_load";
+    case TraceItem::TRACE_IMPORT_BLOCK:
+      return "import_block";
+    case TraceItem::TRACE_SCRIPT_EXECUTE:
+      return "script_exec";
+    case TraceItem::TRACE_DEFINE_TARGET:
+      return "define";
+    case TraceItem::TRACE_ON_RESOLVED:
+      return "onresolved";
+    case TraceItem::TRACE_CHECK_HEADER:
+      return "hdr";
+    case TraceItem::TRACE_CHECK_HEADERS:
+      return "header_check";
+    case TraceItem::TRACE_WALK_METADATA:
+      return "walk_metadata";
+    case TraceItem::TRACE_OHOS_POST_PASS:
+      return "ohos_post_pass";
+  }
+  return "";
+}
+
+const char* TaskQueueName(size_t queue) {
+  switch (static_cast<TaskQueue>(queue)) {
+    case TaskQueue::kMainThread:
+      return "main_thread";
+    case TaskQueue::kWorkerPool:
+      return "worker_pool";
+  }
+  return "";
+}
+
 bool DurationGreater(const TraceItem* a, const TraceItem* b) {
   return a->delta().raw() > b->delta().raw();
 }
@@ -118,6 +231,70 @@ void SummarizeScriptExecs(std::vector<const TraceItem*>& execs,
   SummarizeCoalesced(execs, out);
 }
 
+void SummarizeTypes(const std::vector<TraceItem*>& events, std::ostream& out) {
+  struct TypeTotal {
+    double total = 0;
+    double max = 0;
+    int count = 0;
+  };
+  std::map<std::string, TypeTotal> totals;
+  for (const TraceItem* event : events) {
+    TypeTotal& total = totals[TraceTypeName(event->type())];
+    double ms = event->delta().InMillisecondsF();
+    total.total += ms;
+    total.max = std::max(total.max, ms);
+    total.count++;
+  }
+
+  std::vector<std::pair<std::string, TypeTotal>> sorted(totals.begin(),
+                                                        totals.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second.total > b.second.total;
+  });
+
+  out << "Run times by type: (total time in ms, count, max time in ms, type)\n";
+  for (const auto& [name, total] : sorted) {
+    out << base::StringPrintf(" %8.2f  %d  %.2f  ", total.total, total.count,
+                              total.max);
+    out << name << std::endl;
+  }
+}
+
+void SummarizeTaskStats(const TaskStatsSnapshot& stats, std::ostream& out) {
+  out << "Task queues: (tasks, max length, wait in us: mean p50 p90 p99 max, "
+         "queue)\n";
+  for (size_t i = 0; i < kTaskQueueCount; i++) {
+    const TaskQueueStats& queue = stats.queues[i];
+    const TaskHistogram& wait = queue.wait;
+    double mean =
+        wait.count() ? wait.total().InMicrosecondsF() / wait.count() : 0;
+    out << base::StringPrintf(
+        " %8llu  %zu  %.1f %llu %llu %llu %llu  %s\n",
+        static_cast<unsigned long long>(wait.count()), queue.max_length, mean,
+        static_cast<unsigned long long>(wait.PercentileMicroseconds(50)),
+        static_cast<unsigned long long>(wait.PercentileMicroseconds(90)),
+        static_cast<unsigned long long>(wait.PercentileMicroseconds(99)),
+        static_cast<unsigned long long>(wait.max().InMicroseconds()),
+        TaskQueueName(i));
+  }
+  out << std::endl;
+
+  out << "Thread idle times: (idle time in ms, thread)\n";
+  std::thread::id main_thread = std::this_thread::get_id();
+  std::vector<std::pair<double, bool>> idle;
+  for (const auto& [thread, delta] : stats.idle)
+    idle.emplace_back(delta.InMillisecondsF(), thread == main_thread);
+  std::sort(idle.begin(), idle.end(), std::greater<>());
+  int worker = 0;
+  for (const auto& [ms, is_main] : idle) {
+    out << base::StringPrintf(" %8.2f  ", ms);
+    if (is_main)
+      out << "main thread" << std::endl;
+    else
+      out << "worker " << worker++ << std::endl;
+  }
+}
+
 }  // namespace
 
 TraceItem::TraceItem(Type type,
@@ -157,6 +334,24 @@ void ScopedTrace::SetCommandLine(const base::CommandLine& cmdline) {
     item_->set_cmdline(FilePathToUTF8(cmdline.GetArgumentsString()));
 }
 
+void ScopedTrace::AddFlow(TraceItem::FlowPhase phase, const Label& label) {
+  if (item_)
+    item_->add_flow({label.hash() & kMaxTraceId, phase});
+}
+
+void ScopedTrace::AddArg(const std::string& name, const std::string& value) {
+  if (item_) {
+    std::string json;
+    base::EscapeJSONString(value, true, &json);
+    item_->add_arg(name, std::move(json));
+  }
+}
+
+void ScopedTrace::AddArg(const std::string& name, int64_t value) {
+  if (item_)
+    item_->add_arg(name, std::to_string(value));
+}
+
 void ScopedTrace::Done() {
   if (!done_) {
     done_ = true;
@@ -172,6 +367,12 @@ void EnableTracing() {
     trace_log = new TraceLog;
 }
 
+void StartTraceMemorySampling() {
+  DCHECK(trace_log);
+  if (!memory_sampler)
+    memory_sampler = new MemorySampler;
+}
+
 bool TracingEnabled() {
   return !!trace_log;
 }
@@ -220,11 +421,18 @@ std::string SummarizeTraces() {
       case TraceItem::TRACE_DEFINE_TARGET:
       case TraceItem::TRACE_ON_RESOLVED:
       case TraceItem::TRACE_WALK_METADATA:
+      case TraceItem::TRACE_OHOS_POST_PASS:
         break;  // Ignore these for the summary.
     }
   }
 
   std::ostringstream out;
+  SummarizeTypes(events, out);
+  out << std::endl;
+  if (TaskStatsEnabled()) {
+    SummarizeTaskStats(GetTaskStats(), out);
+    out << std::endl;
+  }
   SummarizeParses(parses, out);
   out << std::endl;
   SummarizeFileExecs(file_execs, out);
@@ -263,6 +471,13 @@ void SaveTraces(const base::FilePath& file_name) {
     int id = tidmap.size();
     tidmap.emplace(item->thread_id(), id);
   }
+  TaskStatsSnapshot stats;
+  if (TaskStatsEnabled())
+    stats = GetTaskStats();
+  for (const auto& period : stats.long_idle_periods) {
+    int id = tidmap.size();
+    tidmap.emplace(period.thread, id);
+  }
 
   // Write main thread metadata (assume this is being written on the main
   // thread).
@@ -284,59 +499,10 @@ void SaveTraces(const base::FilePath& file_name) {
     base::EscapeJSONString(item.name(), true, &quote_buffer);
     out << ",\"name\":" << quote_buffer;
 
-    out << ",\"cat\":";
-    switch (item.type()) {
-      case TraceItem::TRACE_SETUP:
-        out << "\"setup\"";
-        break;
-      case TraceItem::TRACE_FILE_LOAD:
-        out << "\"load\"";
-        break;
-      case TraceItem::TRACE_FILE_PARSE:
-        out << "\"parse\"";
-        break;
-      case TraceItem::TRACE_FILE_EXECUTE:
-        out << "\"file_exec\"";
-        break;
-      case TraceItem::TRACE_FILE_EXECUTE_TEMPLATE:
-        out << "\"file_exec_template\"";
-        break;
-      case TraceItem::TRACE_FILE_WRITE:
-        out << "\"file_write\"";
-        break;
-      case TraceItem::TRACE_FILE_WRITE_GENERATED:
-        out << "\"file_write_generated\"";
-        break;
-      case TraceItem::TRACE_FILE_WRITE_NINJA:
-        out << "\"file_write_ninja\"";
-        break;
-      case TraceItem::TRACE_IMPORT_LOAD:
-        out << "\"import_load\"";
-        break;
-      case TraceItem::TRACE_IMPORT_BLOCK:
-        out << "\"import_block\"";
-        break;
-      case TraceItem::TRACE_SCRIPT_EXECUTE:
-        out << "\"script_exec\"";
-        break;
-      case TraceItem::TRACE_DEFINE_TARGET:
-        out << "\"define\"";
-        break;
-      case TraceItem::TRACE_ON_RESOLVED:
-        out << "\"onresolved\"";
-        break;
-      case TraceItem::TRACE_CHECK_HEADER:
-        out << "\"hdr\"";
-        break;
-      case TraceItem::TRACE_CHECK_HEADERS:
-        out << "\"header_check\"";
-        break;
-      case TraceItem::TRACE_WALK_METADATA:
-        out << "\"walk_metadata\"";
-        break;
-    }
+    out << ",\"cat\":\"" << TraceTypeName(item.type()) << "\"";
 
-    if (!item.toolchain().empty() || !item.cmdline().empty()) {
+    if (!item.toolchain().empty() || !item.cmdline().empty() ||
+        !item.args().empty()) {
       out << ",\"args\":{";
       bool needs_comma = false;
       if (!item.toolchain().empty()) {
@@ -353,9 +519,68 @@ void SaveTraces(const base::FilePath& file_name) {
         out << "\"cmdline\":" << quote_buffer;
         needs_comma = true;
       }
+      for (const auto& [name, value] : item.args()) {
+        quote_buffer.resize(0);
+        base::EscapeJSONString(name, true, &quote_buffer);
+        if (needs_comma)
+          out << ",";
+        out << quote_buffer << ":" << value;
+        needs_comma = true;
+      }
       out << "}";
     }
     out << "}";
+
+    // Flow events bind to the slice enclosing their timestamp on the same
+    // thread, which is this one.
+    for (const TraceItem::Flow& flow : item.flows()) {
+      out << ",{\"pid\":0,\"tid\":\"" << tidmap[item.thread_id()] << "\"";
+      out << ",\"ts\":" << item.begin() / kNanosecondsToMicroseconds;
+      switch (flow.phase) {
+        case TraceItem::FLOW_BEGIN:
+          out << ",\"ph\":\"s\"";
+          break;
+        case TraceItem::FLOW_STEP:
+          out << ",\"ph\":\"t\"";
+          break;
+        case TraceItem::FLOW_END:
+          out << ",\"ph\":\"f\"";
+          break;
+      }
+      out << ",\"bp\":\"e\",\"id\":" << flow.id
+          << ",\"name\":\"item\",\"cat\":\"item\"}";
+    }
+  }
+
+  // Idle stretches of each thread, and the queue lengths as counter tracks.
+  for (const auto& period : stats.long_idle_periods) {
+    out << ",{\"pid\":0,\"tid\":\"" << tidmap[period.thread] << "\"";
+    out << ",\"ts\":" << period.begin / kNanosecondsToMicroseconds;
+    out << ",\"ph\":\"X\",\"dur\":"
+        << TicksDelta(period.end, period.begin).InMicroseconds();
+    out << ",\"name\":\"idle\",\"cat\":\"idle\"}";
+  }
+  for (size_t i = 0; i < kTaskQueueCount; i++) {
+    for (const auto& sample : stats.queues[i].samples) {
+      out << ",{\"pid\":0,\"ts\":" << sample.time / kNanosecondsToMicroseconds;
+      out << ",\"ph\":\"C\",\"name\":\"" << TaskQueueName(i)
+          << "_queue\",\"args\":{\"length\":" << sample.length << "}}";
+    }
+  }
+
+  // Memory use as counter tracks, in MB.
+  if (memory_sampler) {
+    for (const MemorySample& sample : memory_sampler->Stop()) {
+      out << ",{\"pid\":0,\"ts\":" << sample.time / kNanosecondsToMicroseconds;
+      out << ",\"ph\":\"C\",\"name\":\"memory\",\"args\":{";
+      out << base::StringPrintf("\"resident_mb\":%.1f",
+                                sample.resident / (1024.0 * 1024.0));
+      if (sample.allocated) {
+        out << base::StringPrintf(",\"allocated_mb\":%.1f",
+                                  sample.allocated / (1024.0 * 1024.0));
+      }
+      out << "}}";
+    }
   }
 
   out << "]}";
@@ -363,3 +588,52 @@ void SaveTraces(const base::FilePath& file_name) {
   std::string out_str = out.str();
   base::WriteFile(file_name, out_str.data(), static_cast<int>(out_str.size()));
 }
+
+std::map<TraceItem::Type, TickDelta> ComputeTraceSelfTimes(
+    const std::vector<const TraceItem*>& items) {
+  // Traces on one thread come from scoped objects, so they nest. Walking each
+  // thread's traces by start time with a stack of the open ones finds the
+  // innermost enclosing trace of each, whose self time it is taken out of.
+  std::vector<const TraceItem*> sorted(items);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const TraceItem* a, const TraceItem* b) {
+              if (a->thread_id() != b->thread_id())
+                return a->thread_id() < b->thread_id();
+              if (a->begin() != b->begin())
+                return a->begin() < b->begin();
+              return a->end() > b->end();
+            });
+
+  std::map<TraceItem::Type, int64_t> self;
+  std::vector<const TraceItem*> open;
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const TraceItem* item = sorted[i];
+    if (i > 0 && sorted[i - 1]->thread_id() != item->thread_id())
+      open.clear();
+    while (!open.empty() && open.back()->end() <= item->begin())
+      open.pop_back();
+
+    int64_t duration = static_cast<int64_t>(item->delta().raw());
+    self[item->type()] += duration;
+    if (!open.empty()) {
+      // Clamp in case a trace was closed out of order.
+      int64_t nested = std::min<int64_t>(
+          duration, static_cast<int64_t>(open.back()->end() - item->begin()));
+      self[open.back()->type()] -= nested;
+    }
+    open.push_back(item);
+  }
+
+  std::map<TraceItem::Type, TickDelta> result;
+  for (const auto& [type, ticks] : self)
+    result.emplace(type, TickDelta(std::max<int64_t>(ticks, 0)));
+  return result;
+}
+
+std::map<TraceItem::Type, TickDelta> GetTraceSelfTimes() {
+  if (!trace_log)
+    return {};
+  std::vector<TraceItem*> events = trace_log->events();
+  return ComputeTraceSelfTimes(
+      std::vector<const TraceItem*>(events.begin(), events.end()));
+}
@@ -5,9 +5,14 @@
 #ifndef TOOLS_GN_TRACE_H_
 #define TOOLS_GN_TRACE_H_
 
+#include <stdint.h>
+
+#include <map>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "util/ticks.h"
 
@@ -37,6 +42,19 @@ class TraceItem {
     TRACE_CHECK_HEADER,   // One file.
     TRACE_CHECK_HEADERS,  // All files.
     TRACE_WALK_METADATA,
+    TRACE_OHOS_POST_PASS,  // Whole-graph passes run after the load.
+  };
+
+  // Flows draw arrows between the slices that handle the same item, e.g.
+  // from the file that defines a target to its resolution and ninja write.
+  enum FlowPhase {
+    FLOW_BEGIN,
+    FLOW_STEP,
+    FLOW_END,
+  };
+  struct Flow {
+    uint64_t id;
+    FlowPhase phase;
   };
 
   TraceItem(Type type, const std::string& name, std::thread::id thread_id);
@@ -61,6 +79,18 @@ class TraceItem {
   const std::string& cmdline() const { return cmdline_; }
   void set_cmdline(const std::string& c) { cmdline_ = c; }
 
+  // Optional flows passing through this item.
+  const std::vector<Flow>& flows() const { return flows_; }
+  void add_flow(const Flow& flow) { flows_.push_back(flow); }
+
+  // Optional extra arguments. The values are already encoded as JSON.
+  const std::vector<std::pair<std::string, std::string>>& args() const {
+    return args_;
+  }
+  void add_arg(const std::string& name, std::string json_value) {
+    args_.emplace_back(name, std::move(json_value));
+  }
+
  private:
   Type type_;
   std::string name_;
@@ -71,6 +101,9 @@ class TraceItem {
 
   std::string toolchain_;
   std::string cmdline_;
+
+  std::vector<Flow> flows_;
+  std::vector<std::pair<std::string, std::string>> args_;
 };
 
 class ScopedTrace {
@@ -82,6 +115,12 @@ class ScopedTrace {
   void SetToolchain(const Label& label);
   void SetCommandLine(const base::CommandLine& cmdline);
 
+  // Adds a step of the flow that follows the given item through the build.
+  void AddFlow(TraceItem::FlowPhase phase, const Label& label);
+
+  void AddArg(const std::string& name, const std::string& value);
+  void AddArg(const std::string& name, int64_t value);
+
   void Done();
 
  private:
@@ -92,6 +131,11 @@ class ScopedTrace {
 // Call to turn tracing on. It's off by default.
 void EnableTracing();
 
+// Starts recording the process's resident and allocated memory every few
+// milliseconds so that SaveTraces() can write them as counter tracks. Tracing
+// must be enabled.
+void StartTraceMemorySampling();
+
 // Returns whether tracing is enabled.
 bool TracingEnabled();
 
@@ -105,4 +149,15 @@ std::string SummarizeTraces();
 // Saves the current traces to the given filename in JSON format.
 void SaveTraces(const base::FilePath& file_name);
 
+// Returns the self time of the given traces by type: the time spent in each
+// trace minus the time spent in the traces nested in it on the same thread,
+// summed over all threads. Unlike the totals, these add up to the time the
+// threads were busy.
+std::map<TraceItem::Type, TickDelta> ComputeTraceSelfTimes(
+    const std::vector<const TraceItem*>& items);
+
+// ComputeTraceSelfTimes() over the current traces. Returns an empty map if
+// tracing is not enabled.
+std::map<TraceItem::Type, TickDelta> GetTraceSelfTimes();
+
 #endif  // TOOLS_GN_TRACE_H_
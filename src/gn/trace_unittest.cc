@@ -0,0 +1,108 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/trace.h"
+
+#include <thread>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/label.h"
+#include "util/msg_loop.h"
+#include "util/task_stats.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::unique_ptr<TraceItem> MakeItem(TraceItem::Type type,
+                                    std::thread::id thread,
+                                    Ticks begin,
+                                    Ticks end) {
+  auto item = std::make_unique<TraceItem>(type, "item", thread);
+  item->set_begin(begin);
+  item->set_end(end);
+  return item;
+}
+
+}  // namespace
+
+TEST(Trace, SelfTimes) {
+  std::thread::id main_thread = std::this_thread::get_id();
+  std::thread::id other_thread;
+  std::thread([&other_thread]() {
+    other_thread = std::this_thread::get_id();
+  }).join();
+
+  // A file execution on the main thread with a template and a target
+  // definition nested in it, the latter inside the template.
+  std::vector<std::unique_ptr<TraceItem>> items;
+  items.push_back(
+      MakeItem(TraceItem::TRACE_FILE_EXECUTE, main_thread, 1000, 2000));
+  items.push_back(MakeItem(TraceItem::TRACE_FILE_EXECUTE_TEMPLATE, main_thread,
+                           1100, 1500));
+  items.push_back(
+      MakeItem(TraceItem::TRACE_DEFINE_TARGET, main_thread, 1200, 1300));
+  items.push_back(
+      MakeItem(TraceItem::TRACE_DEFINE_TARGET, main_thread, 1600, 1700));
+  // Overlaps the above in time, but on another thread.
+  items.push_back(
+      MakeItem(TraceItem::TRACE_FILE_EXECUTE, other_thread, 1050, 1850));
+
+  std::vector<const TraceItem*> pointers;
+  for (const auto& item : items)
+    pointers.push_back(item.get());
+  std::map<TraceItem::Type, TickDelta> self = ComputeTraceSelfTimes(pointers);
+
+  ASSERT_EQ(3u, self.size());
+  EXPECT_EQ(1000u - 400u - 100u + 800u,
+            self.at(TraceItem::TRACE_FILE_EXECUTE).raw());
+  EXPECT_EQ(300u, self.at(TraceItem::TRACE_FILE_EXECUTE_TEMPLATE).raw());
+  EXPECT_EQ(200u, self.at(TraceItem::TRACE_DEFINE_TARGET).raw());
+}
+
+// The trace file has the slices with their arguments, the flows through them,
+// and the queue lengths and memory use as counters.
+TEST(Trace, SaveTraces) {
+  EnableTracing();
+  ResetTaskStatsForTesting();
+  EnableTaskStats();
+  StartTraceMemorySampling();
+
+  {
+    MsgLoop msg_loop;
+    msg_loop.PostTask([]() {});
+    msg_loop.RunUntilIdleForTesting();
+  }
+  Label label(SourceDir("//trace_test/"), "target");
+  {
+    ScopedTrace trace(TraceItem::TRACE_DEFINE_TARGET, label);
+    trace.AddFlow(TraceItem::FLOW_BEGIN, label);
+    trace.AddArg("type", "group");
+    trace.AddArg("sources", static_cast<int64_t>(3));
+  }
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.GetPath().AppendASCII("trace.json");
+  SaveTraces(path);
+  ResetTaskStatsForTesting();
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(path, &contents));
+  EXPECT_NE(std::string::npos,
+            contents.find("\"name\":\"//trace_test:target\",\"cat\":\"define\","
+                          "\"args\":{\"type\":\"group\",\"sources\":3}}"))
+      << contents;
+  EXPECT_NE(std::string::npos,
+            contents.find("\"ph\":\"s\",\"bp\":\"e\",\"id\":"))
+      << contents;
+  EXPECT_NE(std::string::npos,
+            contents.find("\"ph\":\"C\",\"name\":\"main_thread_queue\","
+                          "\"args\":{\"length\":"))
+      << contents;
+  EXPECT_NE(std::string::npos,
+            contents.find("\"ph\":\"C\",\"name\":\"memory\","
+                          "\"args\":{\"resident_mb\":"))
+      << contents;
+}
@@ -9,8 +9,22 @@
 
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "gn/memory_stats.h"
 #include "gn/scope.h"
 
+Value::ListStorage::ListStorage() = default;
+
+Value::ListStorage::ListStorage(const std::vector<Value>& v) : values(v) {}
+
+Value::ListStorage::~ListStorage() = default;
+
+Value::ScopeStorage::ScopeStorage(std::unique_ptr<Scope> s)
+    : scope(std::move(s)) {
+  DCHECK(scope);
+}
+
+Value::ScopeStorage::~ScopeStorage() = default;
+
 // NOTE: Cannot use = default here due to the use of a union member.
 Value::Value() {}
 
@@ -28,10 +42,11 @@ Value::Value(const ParseNode* origin, Type t) : type_(t), origin_(origin) {
       new (&string_value_) std::string();
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>();
+      new (&list_value_)
+          scoped_refptr<ListStorage>(base::MakeRefCounted<ListStorage>());
       break;
     case SCOPE:
-      new (&scope_value_) std::unique_ptr<Scope>();
+      new (&scope_value_) scoped_refptr<ScopeStorage>();
       break;
   }
 }
@@ -49,7 +64,9 @@ Value::Value(const ParseNode* origin, const char* str_val)
     : type_(STRING), origin_(origin), string_value_(str_val) {}
 
 Value::Value(const ParseNode* origin, std::unique_ptr<Scope> scope)
-    : type_(SCOPE), origin_(origin), scope_value_(std::move(scope)) {}
+    : type_(SCOPE), origin_(origin), scope_value_() {
+  SetScopeValue(std::move(scope));
+}
 
 Value::Value(const Value& other) : type_(other.type_), origin_(other.origin_) {
   switch (type_) {
@@ -65,12 +82,21 @@ Value::Value(const Value& other) : type_(other.type_), origin_(other.origin_) {
       new (&string_value_) std::string(other.string_value_);
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>(other.list_value_);
+      new (&list_value_) scoped_refptr<ListStorage>(other.list_value_);
       break;
     case SCOPE:
-      new (&scope_value_) std::unique_ptr<Scope>(
-          other.scope_value_.get() ? other.scope_value_->MakeClosure()
-                                   : nullptr);
+      // A scope that still refers to a mutable containing scope can't be
+      // shared: the copy must be flattened into a closure now since the
+      // containing scope (usually a stack-allocated one) may change or go
+      // away. Self-contained scopes are shared until mutated.
+      if (other.scope_value_ &&
+          other.scope_value_->scope->mutable_containing()) {
+        new (&scope_value_) scoped_refptr<ScopeStorage>(
+            base::MakeRefCounted<ScopeStorage>(
+                other.scope_value_->scope->MakeClosure()));
+      } else {
+        new (&scope_value_) scoped_refptr<ScopeStorage>(other.scope_value_);
+      }
       break;
   }
 }
@@ -90,10 +116,12 @@ Value::Value(Value&& other) noexcept
       new (&string_value_) std::string(std::move(other.string_value_));
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>(std::move(other.list_value_));
+      new (&list_value_)
+          scoped_refptr<ListStorage>(std::move(other.list_value_));
       break;
     case SCOPE:
-      new (&scope_value_) std::unique_ptr<Scope>(std::move(other.scope_value_));
+      new (&scope_value_)
+          scoped_refptr<ScopeStorage>(std::move(other.scope_value_));
       break;
   }
 }
@@ -121,10 +149,10 @@ Value::~Value() {
       string_value_.~string();
       break;
     case LIST:
-      list_value_.~vector<Value>();
+      list_value_.~scoped_refptr<ListStorage>();
       break;
     case SCOPE:
-      scope_value_.~unique_ptr<Scope>();
+      scope_value_.~scoped_refptr<ScopeStorage>();
       break;
     default:;
   }
@@ -153,7 +181,31 @@ const char* Value::DescribeType(Type t) {
 
 void Value::SetScopeValue(std::unique_ptr<Scope> scope) {
   DCHECK(type_ == SCOPE);
-  scope_value_ = std::move(scope);
+  if (scope)
+    scope_value_ = base::MakeRefCounted<ScopeStorage>(std::move(scope));
+  else
+    scope_value_ = nullptr;
+}
+
+void Value::DetachList() {
+  DCHECK(type_ == LIST);
+  if (list_value_)
+    list_value_ = base::MakeRefCounted<ListStorage>(list_value_->values);
+  else
+    list_value_ = base::MakeRefCounted<ListStorage>();
+}
+
+void Value::DetachScope() {
+  DCHECK(type_ == SCOPE);
+  DCHECK(scope_value_);
+  scope_value_ =
+      base::MakeRefCounted<ScopeStorage>(scope_value_->scope->MakeClosure());
+}
+
+// static
+const std::vector<Value>& Value::EmptyList() {
+  static const std::vector<Value> empty;
+  return empty;
 }
 
 std::string Value::ToString(bool quote_string) const {
@@ -191,17 +243,18 @@ std::string Value::ToString(bool quote_string) const {
       return string_value_;
     case LIST: {
       std::string result = "[";
-      for (size_t i = 0; i < list_value_.size(); i++) {
+      const std::vector<Value>& list = list_value();
+      for (size_t i = 0; i < list.size(); i++) {
         if (i > 0)
           result += ", ";
-        result += list_value_[i].ToString(true);
+        result += list[i].ToString(true);
       }
       result.push_back(']');
       return result;
     }
     case SCOPE: {
       Scope::KeyValueMap scope_values;
-      scope_value_->GetCurrentScopeValues(&scope_values);
+      scope_value()->GetCurrentScopeValues(&scope_values);
       if (scope_values.empty())
         return std::string("{ }");
 
@@ -218,6 +271,32 @@ std::string Value::ToString(bool quote_string) const {
   return std::string();
 }
 
+size_t Value::EstimateMemoryUsage(
+    std::unordered_set<const void*>* seen) const {
+  switch (type_) {
+    case STRING:
+      return StringHeapBytes(string_value_);
+    case LIST: {
+      if (!list_value_ || !seen->insert(list_value_.get()).second)
+        return 0;
+      size_t result = sizeof(ListStorage) + VectorHeapBytes(list_value_->values);
+      for (const Value& value : list_value_->values)
+        result += value.EstimateMemoryUsage(seen);
+      return result;
+    }
+    case SCOPE:
+      if (!scope_value_ || !seen->insert(scope_value_.get()).second)
+        return 0;
+      return sizeof(ScopeStorage) +
+             scope_value_->scope->EstimateMemoryUsage(seen);
+    case NONE:
+    case BOOLEAN:
+    case INTEGER:
+      break;
+  }
+  return 0;
+}
+
 bool Value::VerifyTypeIs(Type t, Err* err) const {
   if (type_ == t)
     return true;
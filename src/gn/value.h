@@ -9,14 +9,25 @@
 
 #include <map>
 #include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "gn/err.h"
 
 class ParseNode;
 class Scope;
 
 // Represents a variable value in the interpreter.
+//
+// LIST and SCOPE values are copy-on-write: copying a Value only takes a
+// reference to the underlying storage, which is shared until one of the
+// copies asks for mutable access. Large lists (sources, deps, ...) that are
+// forwarded through several layers of templates therefore don't get copied
+// unless they're actually modified. Use the const accessors when only reading
+// from a value that may be shared, since the non-const ones will make a
+// private copy of the storage if it's referenced by more than one Value.
 class Value {
  public:
   enum Type {
@@ -86,20 +97,26 @@ class Value {
 
   std::vector<Value>& list_value() {
     DCHECK(type_ == LIST);
-    return list_value_;
+    if (!list_value_ || !list_value_->HasOneRef())
+      DetachList();
+    return list_value_->values;
   }
   const std::vector<Value>& list_value() const {
     DCHECK(type_ == LIST);
-    return list_value_;
+    return list_value_ ? list_value_->values : EmptyList();
   }
 
   Scope* scope_value() {
     DCHECK(type_ == SCOPE);
-    return scope_value_.get();
+    if (!scope_value_)
+      return nullptr;
+    if (!scope_value_->HasOneRef())
+      DetachScope();
+    return scope_value_->scope.get();
   }
   const Scope* scope_value() const {
     DCHECK(type_ == SCOPE);
-    return scope_value_.get();
+    return scope_value_ ? scope_value_->scope.get() : nullptr;
   }
   void SetScopeValue(std::unique_ptr<Scope> scope);
 
@@ -108,6 +125,11 @@ class Value {
   // string is quoted, it will also enable escaping.
   std::string ToString(bool quote_strings) const;
 
+  // Returns the approximate number of bytes this value holds outside of the
+  // Value object. List and scope storage already in |seen| is shared with a
+  // value that was counted before and isn't counted again.
+  size_t EstimateMemoryUsage(std::unordered_set<const void*>* seen) const;
+
   // Verifies that the value is of the given type. If it isn't, returns
   // false and sets the error.
   bool VerifyTypeIs(Type t, Err* err) const;
@@ -121,6 +143,36 @@ class Value {
  private:
   void Deallocate();
 
+  // Shared storage for LIST values.
+  struct ListStorage : public base::RefCountedThreadSafe<ListStorage> {
+    ListStorage();
+    explicit ListStorage(const std::vector<Value>& v);
+
+    std::vector<Value> values;
+
+   private:
+    friend class base::RefCountedThreadSafe<ListStorage>;
+    ~ListStorage();
+  };
+
+  // Shared storage for SCOPE values. The scope is never null.
+  struct ScopeStorage : public base::RefCountedThreadSafe<ScopeStorage> {
+    explicit ScopeStorage(std::unique_ptr<Scope> s);
+
+    std::unique_ptr<Scope> scope;
+
+   private:
+    friend class base::RefCountedThreadSafe<ScopeStorage>;
+    ~ScopeStorage();
+  };
+
+  // Replaces the (possibly shared or null) storage with a private copy so
+  // that it can be modified without affecting other Values.
+  void DetachList();
+  void DetachScope();
+
+  static const std::vector<Value>& EmptyList();
+
   Type type_ = NONE;
   const ParseNode* origin_ = nullptr;
 
@@ -128,8 +180,8 @@ class Value {
     bool boolean_value_;
     int64_t int_value_;
     std::string string_value_;
-    std::vector<Value> list_value_;
-    std::unique_ptr<Scope> scope_value_;
+    scoped_refptr<ListStorage> list_value_;
+    scoped_refptr<ScopeStorage> scope_value_;
   };
 };
 
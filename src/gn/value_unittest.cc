@@ -4,6 +4,8 @@
 
 #include <stdint.h>
 
+#include <utility>
+
 #include "gn/test_with_scope.h"
 #include "gn/value.h"
 #include "util/test/test.h"
@@ -58,3 +60,58 @@ TEST(Value, ToString) {
   Value nested_scopeval(nullptr, std::unique_ptr<Scope>(nested_scope));
   EXPECT_FALSE(nested_scopeval == nested_scopeval);
 }
+
+TEST(Value, ListCopyOnWrite) {
+  Value original(nullptr, Value::LIST);
+  original.list_value().push_back(Value(nullptr, "a"));
+  original.list_value().push_back(Value(nullptr, "b"));
+
+  // Copies share storage until one of them is modified.
+  Value copy(original);
+  EXPECT_EQ(&std::as_const(original).list_value(),
+            &std::as_const(copy).list_value());
+
+  copy.list_value().push_back(Value(nullptr, "c"));
+  EXPECT_NE(&std::as_const(original).list_value(),
+            &std::as_const(copy).list_value());
+  ASSERT_EQ(2u, std::as_const(original).list_value().size());
+  ASSERT_EQ(3u, std::as_const(copy).list_value().size());
+  EXPECT_EQ("[\"a\", \"b\"]", original.ToString(false));
+  EXPECT_EQ("[\"a\", \"b\", \"c\"]", copy.ToString(false));
+
+  // A value that isn't shared is modified in place.
+  const std::vector<Value>* storage = &std::as_const(copy).list_value();
+  copy.list_value().pop_back();
+  EXPECT_EQ(storage, &std::as_const(copy).list_value());
+  EXPECT_TRUE(original == copy);
+}
+
+TEST(Value, ScopeCopyOnWrite) {
+  TestWithScope setup;
+  auto scope = std::make_unique<Scope>(setup.settings());
+  scope->SetValue("a", Value(nullptr, static_cast<int64_t>(1)), nullptr);
+  Value original(nullptr, std::move(scope));
+
+  // Self-contained scopes are shared between copies.
+  Value copy(original);
+  EXPECT_EQ(std::as_const(original).scope_value(),
+            std::as_const(copy).scope_value());
+
+  // Writing to one copy doesn't affect the other.
+  copy.scope_value()->SetValue("b", Value(nullptr, static_cast<int64_t>(2)),
+                               nullptr);
+  EXPECT_NE(std::as_const(original).scope_value(),
+            std::as_const(copy).scope_value());
+  EXPECT_FALSE(std::as_const(original).scope_value()->GetValue("b"));
+  ASSERT_TRUE(std::as_const(copy).scope_value()->GetValue("a"));
+  ASSERT_TRUE(std::as_const(copy).scope_value()->GetValue("b"));
+
+  // Scopes with a mutable containing scope are flattened into a closure when
+  // copied, as before.
+  Scope* nested = new Scope(setup.scope());
+  Value nested_value(nullptr, std::unique_ptr<Scope>(nested));
+  Value nested_copy(nested_value);
+  EXPECT_NE(std::as_const(nested_value).scope_value(),
+            std::as_const(nested_copy).scope_value());
+  EXPECT_FALSE(std::as_const(nested_copy).scope_value()->mutable_containing());
+}
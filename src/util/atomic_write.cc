@@ -4,10 +4,69 @@
 
 #include "util/atomic_write.h"
 
+#include <algorithm>
+
 #include "base/files/file_util.h"
+#include "util/build_config.h"
+
+#if !defined(OS_WIN)
+#include <limits.h>
+#include <sys/uio.h>
+
+#include "base/posix/eintr_wrapper.h"
+#endif
 
 namespace util {
 
+namespace {
+
+// Writes |chunks| at the current position of |file|.
+bool WriteChunks(base::File* file, std::vector<std::string_view> chunks) {
+#if defined(OS_WIN)
+  for (std::string_view chunk : chunks) {
+    if (file->WriteAtCurrentPos(chunk.data(), static_cast<int>(chunk.size())) !=
+        static_cast<int>(chunk.size()))
+      return false;
+  }
+  return true;
+#else
+#if defined(IOV_MAX)
+  constexpr size_t kMaxIovecs = IOV_MAX;
+#else
+  constexpr size_t kMaxIovecs = 1024;
+#endif
+  chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+                              [](std::string_view chunk) {
+                                return chunk.empty();
+                              }),
+               chunks.end());
+  std::vector<struct iovec> iovecs;
+  size_t first = 0;
+  while (first < chunks.size()) {
+    size_t count = std::min(chunks.size() - first, kMaxIovecs);
+    iovecs.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      iovecs[i].iov_base = const_cast<char*>(chunks[first + i].data());
+      iovecs[i].iov_len = chunks[first + i].size();
+    }
+    ssize_t written = HANDLE_EINTR(
+        writev(file->GetPlatformFile(), iovecs.data(), static_cast<int>(count)));
+    if (written <= 0)
+      return false;
+
+    // Skip what was written, which may end in the middle of a chunk.
+    size_t remaining = static_cast<size_t>(written);
+    while (remaining > 0 && remaining >= chunks[first].size())
+      remaining -= chunks[first++].size();
+    if (remaining > 0)
+      chunks[first].remove_prefix(remaining);
+  }
+  return true;
+#endif
+}
+
+}  // namespace
+
 int WriteFileAtomically(const base::FilePath& filename,
                         const char* data,
                         int size) {
@@ -31,4 +90,23 @@ int WriteFileAtomically(const base::FilePath& filename,
   return size;
 }
 
+bool WriteFileAtomically(const base::FilePath& filename,
+                         const std::vector<std::string_view>& chunks) {
+  base::FilePath temp_file_path;
+
+  {
+    base::File temp_file =
+        base::CreateAndOpenTemporaryFileInDir(filename.DirName(), &temp_file_path);
+    if (!temp_file.IsValid())
+      return false;
+    if (!WriteChunks(&temp_file, chunks)) {
+      temp_file.Close();
+      base::DeleteFile(temp_file_path, false);
+      return false;
+    }
+  }
+
+  return base::ReplaceFile(temp_file_path, filename, NULL);
+}
+
 }  // namespace util
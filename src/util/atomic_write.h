@@ -5,6 +5,9 @@
 #ifndef TOOLS_GN_ATOMIC_WRITE_H_
 #define TOOLS_GN_ATOMIC_WRITE_H_
 
+#include <string_view>
+#include <vector>
+
 #include "base/files/file_path.h"
 
 namespace util {
@@ -17,6 +20,12 @@ int WriteFileAtomically(const base::FilePath& filename,
                         const char* data,
                         int size);
 
+// Like the above, but writes the concatenation of |chunks| with vectored
+// writes, so contents assembled from several buffers needn't be copied
+// together first. Returns false on error.
+bool WriteFileAtomically(const base::FilePath& filename,
+                         const std::vector<std::string_view>& chunks);
+
 }  // namespace util
 
 #endif  // TOOLS_GN_ATOMIC_WRITE_H_
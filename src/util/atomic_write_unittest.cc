@@ -5,6 +5,8 @@
 #include "util/atomic_write.h"
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
@@ -34,3 +36,24 @@ TEST_F(ImportantFileWriterTest, Basic) {
   EXPECT_TRUE(ReadFileToString(file_, &actual));
   EXPECT_EQ(data, actual);
 }
+
+// Test writing more chunks than fit in one vectored write, some empty.
+TEST_F(ImportantFileWriterTest, Chunks) {
+  std::vector<std::string> strings;
+  for (int i = 0; i < 3000; i++)
+    strings.push_back(i % 7 == 0 ? std::string() : std::to_string(i) + ",");
+  std::vector<std::string_view> chunks(strings.begin(), strings.end());
+  std::string expected;
+  for (const std::string& string : strings)
+    expected += string;
+
+  EXPECT_TRUE(util::WriteFileAtomically(file_, chunks));
+  std::string actual;
+  EXPECT_TRUE(ReadFileToString(file_, &actual));
+  EXPECT_EQ(expected, actual);
+
+  // Existing files are replaced.
+  EXPECT_TRUE(util::WriteFileAtomically(file_, {"short"}));
+  EXPECT_TRUE(ReadFileToString(file_, &actual));
+  EXPECT_EQ("short", actual);
+}
@@ -5,6 +5,7 @@
 #include "util/msg_loop.h"
 
 #include "base/logging.h"
+#include "util/task_stats.h"
 
 namespace {
 
@@ -32,19 +33,28 @@ void MsgLoop::Run() {
 
   while (!should_quit_) {
     std::function<void()> task;
+    size_t remaining;
     {
       std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+      Ticks idle_begin = 0;
+      if (task_queue_.empty() && TaskStatsEnabled())
+        idle_begin = TicksNow();
       notifier_.wait(queue_lock, [this]() {
         return (!task_queue_.empty()) || should_quit_;
       });
+      if (idle_begin)
+        RecordThreadIdle(idle_begin, TicksNow());
 
       if (should_quit_)
         return;
 
       task = std::move(task_queue_.front());
       task_queue_.pop();
+      remaining = task_queue_.size();
     }
 
+    if (TaskStatsEnabled())
+      RecordTaskQueueLength(TaskQueue::kMainThread, remaining);
     task();
   }
 }
@@ -54,11 +64,23 @@ void MsgLoop::PostQuit() {
 }
 
 void MsgLoop::PostTask(std::function<void()> work) {
+  bool stats = TaskStatsEnabled();
+  if (stats) {
+    work = [posted = TicksNow(), work = std::move(work)]() {
+      RecordTaskWait(TaskQueue::kMainThread, TicksDelta(TicksNow(), posted));
+      work();
+    };
+  }
+
+  size_t length;
   {
     std::unique_lock<std::mutex> queue_lock(queue_mutex_);
     task_queue_.emplace(std::move(work));
+    length = task_queue_.size();
   }
 
+  if (stats)
+    RecordTaskQueueLength(TaskQueue::kMainThread, length);
   notifier_.notify_one();
 }
 
@@ -8,17 +8,27 @@
 #include "util/build_config.h"
 
 #if defined(OS_POSIX)
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/resource.h>
 #include <sys/utsname.h>
 #include <unistd.h>
 #endif
 
+#if defined(OS_LINUX) && defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 #if defined(OS_MACOSX)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
 #include <sys/sysctl.h>
 #include <sys/types.h>
 #endif
 
 #if defined(OS_WIN)
 #include <windows.h>
+#include <psapi.h>
 #include "base/win/registry.h"
 #endif
 
@@ -158,3 +168,74 @@ int NumberOfPerformanceProcessors() {
 #endif
   return NumberOfProcessors();
 }
+
+uint64_t ResidentMemoryBytes() {
+#if defined(OS_LINUX)
+  // The second field of statm is the resident size in pages.
+  int fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return 0;
+  char buffer[128];
+  ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (size <= 0)
+    return 0;
+  buffer[size] = 0;
+  unsigned long long total_pages = 0;
+  unsigned long long resident_pages = 0;
+  if (sscanf(buffer, "%llu %llu", &total_pages, &resident_pages) != 2)
+    return 0;
+  return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#elif defined(OS_MACOSX)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    return 0;
+  return info.resident_size;
+#elif defined(OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters)))
+    return 0;
+  return counters.WorkingSetSize;
+#else
+  return 0;
+#endif
+}
+
+uint64_t PeakResidentMemoryBytes() {
+#if defined(OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters)))
+    return 0;
+  return counters.PeakWorkingSetSize;
+#elif defined(OS_POSIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(OS_MACOSX)
+  // Reported in bytes on Apple platforms and in kilobytes elsewhere.
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+uint64_t AllocatedMemoryBytes() {
+#if defined(OS_LINUX) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#elif defined(OS_MACOSX)
+  malloc_statistics_t stats = {};
+  malloc_zone_statistics(nullptr, &stats);
+  return stats.size_in_use;
+#else
+  return 0;
+#endif
+}
@@ -5,6 +5,8 @@
 #ifndef UTIL_SYS_INFO_H_
 #define UTIL_SYS_INFO_H_
 
+#include <stdint.h>
+
 #include <string>
 
 bool IsLongPathsSupportEnabled();
@@ -16,4 +18,15 @@ int NumberOfProcessors();
 // On other platforms, returns NumberOfProcessors().
 int NumberOfPerformanceProcessors();
 
+// Returns the resident set size of this process in bytes, or 0 if unknown.
+uint64_t ResidentMemoryBytes();
+
+// Returns the largest resident set size this process has had, or 0 if
+// unknown.
+uint64_t PeakResidentMemoryBytes();
+
+// Returns the number of bytes currently allocated through malloc, or 0 if
+// the allocator can't tell.
+uint64_t AllocatedMemoryBytes();
+
 #endif  // UTIL_SYS_INFO_H_
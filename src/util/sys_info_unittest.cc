@@ -4,6 +4,8 @@
 
 #include "util/sys_info.h"
 
+#include <memory>
+
 #include "util/build_config.h"
 #include "util/test/test.h"
 
@@ -27,3 +29,21 @@ TEST(SysInfoTest, NumberOfPerformanceProcessors) {
   EXPECT_EQ(num_perf_processors, NumberOfProcessors());
 #endif
 }
+
+TEST(SysInfoTest, MemoryUse) {
+  uint64_t resident = ResidentMemoryBytes();
+  uint64_t peak = PeakResidentMemoryBytes();
+#if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_WIN)
+  EXPECT_GT(resident, 0u);
+  EXPECT_GE(peak, resident);
+#endif
+
+  // Whatever the allocator reports should grow with a live allocation.
+  uint64_t before = AllocatedMemoryBytes();
+  std::unique_ptr<char[]> block(new char[1 << 22]);
+  block[0] = 1;
+  uint64_t after = AllocatedMemoryBytes();
+  if (before) {
+    EXPECT_GE(after, before + (1 << 22));
+  }
+}
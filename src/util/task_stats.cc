@@ -0,0 +1,220 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/task_stats.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace internal {
+std::atomic<bool> g_task_stats_enabled(false);
+}  // namespace internal
+
+namespace {
+
+// Queue lengths change on every post and every run. Sampling them keeps
+// traces of large builds a reasonable size while still showing the shape.
+constexpr uint64_t kSampleIntervalNs = 100'000;
+
+// Idle periods shorter than this are only added to the totals.
+constexpr uint64_t kLongIdlePeriodNs = 1'000'000;
+
+// What one thread recorded. Only its own thread writes to it, so its lock is
+// only contended while the stats are being read.
+struct ThreadTaskStats {
+  std::mutex mutex;
+  std::thread::id thread;
+  TaskQueueStats queues[kTaskQueueCount];
+  TickDelta idle{0};
+  std::vector<ThreadIdlePeriod> long_idle_periods;
+};
+
+class TaskStatsLog {
+ public:
+  void RecordQueueLength(TaskQueue queue, size_t length) {
+    // Queue lengths are sampled across all threads: a thread records one only
+    // if none was taken yet or it's the first to claim the current interval.
+    // Always record a drain to zero so idle stretches show up as such.
+    std::atomic<Ticks>& last_sample = last_sample_[static_cast<size_t>(queue)];
+    Ticks now = TicksNow();
+    Ticks last = last_sample.load(std::memory_order_relaxed);
+    bool sample = length == 0 ||
+                  ((last == 0 || now - last >= kSampleIntervalNs) &&
+                   last_sample.compare_exchange_strong(
+                       last, now, std::memory_order_relaxed));
+
+    ThreadTaskStats* thread = GetThreadStats();
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    TaskQueueStats& stats = thread->queues[static_cast<size_t>(queue)];
+    stats.max_length = std::max(stats.max_length, length);
+    if (sample)
+      stats.samples.push_back({now, length});
+  }
+
+  void RecordWait(TaskQueue queue, TickDelta wait) {
+    ThreadTaskStats* thread = GetThreadStats();
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->queues[static_cast<size_t>(queue)].wait.Add(wait);
+  }
+
+  void RecordIdle(Ticks begin, Ticks end) {
+    ThreadTaskStats* thread = GetThreadStats();
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->idle = TickDelta(thread->idle.raw() + (end - begin));
+    if (end - begin >= kLongIdlePeriodNs)
+      thread->long_idle_periods.push_back({thread->thread, begin, end});
+  }
+
+  TaskStatsSnapshot GetSnapshot() {
+    TaskStatsSnapshot result;
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    for (const auto& thread : threads_) {
+      std::lock_guard<std::mutex> lock(thread->mutex);
+      for (size_t i = 0; i < kTaskQueueCount; i++) {
+        const TaskQueueStats& from = thread->queues[i];
+        TaskQueueStats& to = result.queues[i];
+        to.wait.Merge(from.wait);
+        to.max_length = std::max(to.max_length, from.max_length);
+        to.samples.insert(to.samples.end(), from.samples.begin(),
+                          from.samples.end());
+      }
+      if (thread->idle.raw()) {
+        // Ids of threads that exited may be reused.
+        auto found = result.idle.emplace(thread->thread, TickDelta(0)).first;
+        found->second = TickDelta(found->second.raw() + thread->idle.raw());
+      }
+      result.long_idle_periods.insert(result.long_idle_periods.end(),
+                                      thread->long_idle_periods.begin(),
+                                      thread->long_idle_periods.end());
+    }
+
+    // Put the samples of all threads back in order, dropping the ones that
+    // don't change the length.
+    for (TaskQueueStats& stats : result.queues) {
+      std::stable_sort(stats.samples.begin(), stats.samples.end(),
+                       [](const TaskQueueStats::Sample& a,
+                          const TaskQueueStats::Sample& b) {
+                         return a.time < b.time;
+                       });
+      stats.samples.erase(
+          std::unique(stats.samples.begin(), stats.samples.end(),
+                      [](const TaskQueueStats::Sample& a,
+                         const TaskQueueStats::Sample& b) {
+                        return a.length == b.length;
+                      }),
+          stats.samples.end());
+    }
+    std::sort(result.long_idle_periods.begin(), result.long_idle_periods.end(),
+              [](const ThreadIdlePeriod& a, const ThreadIdlePeriod& b) {
+                return a.begin < b.begin;
+              });
+    return result;
+  }
+
+  void Reset() {
+    for (std::atomic<Ticks>& last_sample : last_sample_)
+      last_sample.store(0);
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    for (const auto& thread : threads_) {
+      std::lock_guard<std::mutex> lock(thread->mutex);
+      for (TaskQueueStats& stats : thread->queues)
+        stats = TaskQueueStats();
+      thread->idle = TickDelta(0);
+      thread->long_idle_periods.clear();
+    }
+  }
+
+ private:
+  // Returns the stats of the current thread, registering them on first use.
+  // They are never freed, like the log, so a thread that exits keeps its
+  // stats in the report.
+  ThreadTaskStats* GetThreadStats() {
+    thread_local ThreadTaskStats* current = nullptr;
+    if (!current) {
+      auto stats = std::make_unique<ThreadTaskStats>();
+      stats->thread = std::this_thread::get_id();
+      current = stats.get();
+      std::lock_guard<std::mutex> lock(threads_mutex_);
+      threads_.push_back(std::move(stats));
+    }
+    return current;
+  }
+
+  std::atomic<Ticks> last_sample_[kTaskQueueCount] = {};
+
+  std::mutex threads_mutex_;
+  std::vector<std::unique_ptr<ThreadTaskStats>> threads_;
+};
+
+// Leaked intentionally, like the trace log, since worker threads may still
+// report while the process exits.
+TaskStatsLog* task_stats_log = nullptr;
+std::once_flag task_stats_log_once;
+
+TaskStatsLog* GetLog() {
+  std::call_once(task_stats_log_once,
+                 []() { task_stats_log = new TaskStatsLog; });
+  return task_stats_log;
+}
+
+}  // namespace
+
+void TaskHistogram::Add(TickDelta delta) {
+  uint64_t us = delta.InMicroseconds();
+  size_t bucket = 0;
+  while (bucket < kBucketCount - 1 && us >= BucketLimitMicroseconds(bucket))
+    bucket++;
+  buckets_[bucket]++;
+  count_++;
+  total_ += delta.raw();
+  max_ = std::max(max_, delta.raw());
+}
+
+void TaskHistogram::Merge(const TaskHistogram& other) {
+  for (size_t i = 0; i < kBucketCount; i++)
+    buckets_[i] += other.buckets_[i];
+  count_ += other.count_;
+  total_ += other.total_;
+  max_ = std::max(max_, other.max_);
+}
+
+uint64_t TaskHistogram::PercentileMicroseconds(double percentile) const {
+  if (!count_)
+    return 0;
+  uint64_t wanted = static_cast<uint64_t>(count_ * percentile / 100.0);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += buckets_[i];
+    if (seen > wanted || seen == count_)
+      return std::min(BucketLimitMicroseconds(i), max().InMicroseconds());
+  }
+  return max().InMicroseconds();
+}
+
+void EnableTaskStats() {
+  GetLog();
+  internal::g_task_stats_enabled.store(true);
+}
+
+void RecordTaskQueueLength(TaskQueue queue, size_t length) {
+  GetLog()->RecordQueueLength(queue, length);
+}
+
+void RecordTaskWait(TaskQueue queue, TickDelta wait) {
+  GetLog()->RecordWait(queue, wait);
+}
+
+void RecordThreadIdle(Ticks begin, Ticks end) {
+  GetLog()->RecordIdle(begin, end);
+}
+
+TaskStatsSnapshot GetTaskStats() {
+  return GetLog()->GetSnapshot();
+}
+
+void ResetTaskStatsForTesting() {
+  internal::g_task_stats_enabled.store(false);
+  GetLog()->Reset();
+}
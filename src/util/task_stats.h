@@ -0,0 +1,116 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_TASK_STATS_H_
+#define UTIL_TASK_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "util/ticks.h"
+
+// Statistics about how work queues up on the main thread's MsgLoop and on the
+// WorkerPool: queue lengths over time, how long tasks wait before they run,
+// and how long each thread sits idle. Collection is off by default, where it
+// costs one relaxed load per task. --time and --tracelog turn it on.
+//
+// Each thread records into its own buffer, which are merged when the stats
+// are read, so that the threads posting and running tasks don't contend on a
+// shared lock.
+
+enum class TaskQueue {
+  kMainThread,
+  kWorkerPool,
+};
+constexpr size_t kTaskQueueCount = 2;
+
+// Counts durations in power-of-two microsecond buckets.
+class TaskHistogram {
+ public:
+  static constexpr size_t kBucketCount = 32;
+
+  void Add(TickDelta delta);
+
+  // Adds the counts of |other| to this one.
+  void Merge(const TaskHistogram& other);
+
+  uint64_t count() const { return count_; }
+  TickDelta total() const { return TickDelta(total_); }
+  TickDelta max() const { return TickDelta(max_); }
+
+  // Returns an upper bound of the given percentile (0-100) in microseconds,
+  // capped at the longest duration seen.
+  uint64_t PercentileMicroseconds(double percentile) const;
+
+  // Bucket 0 counts durations under 1us, bucket i > 0 those in
+  // [2^(i-1), 2^i) us. The last bucket also counts anything longer.
+  uint64_t bucket(size_t i) const { return buckets_[i]; }
+  static uint64_t BucketLimitMicroseconds(size_t i) {
+    return uint64_t(1) << i;
+  }
+
+ private:
+  uint64_t buckets_[kBucketCount] = {};
+  uint64_t count_ = 0;
+  uint64_t total_ = 0;
+  uint64_t max_ = 0;
+};
+
+struct TaskQueueStats {
+  struct Sample {
+    Ticks time;
+    size_t length;
+  };
+
+  TaskHistogram wait;
+  size_t max_length = 0;
+
+  // Queue length over time, sampled at most every 100us.
+  std::vector<Sample> samples;
+};
+
+struct ThreadIdlePeriod {
+  std::thread::id thread;
+  Ticks begin;
+  Ticks end;
+};
+
+struct TaskStatsSnapshot {
+  TaskQueueStats queues[kTaskQueueCount];
+
+  // Total idle time of each thread that reported any.
+  std::map<std::thread::id, TickDelta> idle;
+
+  // Idle periods of 1ms or more, for drawing in traces.
+  std::vector<ThreadIdlePeriod> long_idle_periods;
+};
+
+namespace internal {
+extern std::atomic<bool> g_task_stats_enabled;
+}  // namespace internal
+
+// Turns collection on. It's off by default.
+void EnableTaskStats();
+
+inline bool TaskStatsEnabled() {
+  return internal::g_task_stats_enabled.load(std::memory_order_relaxed);
+}
+
+// Called by the queues when enabled.
+void RecordTaskQueueLength(TaskQueue queue, size_t length);
+void RecordTaskWait(TaskQueue queue, TickDelta wait);
+void RecordThreadIdle(Ticks begin, Ticks end);
+
+// Returns a copy of everything collected so far.
+TaskStatsSnapshot GetTaskStats();
+
+// Clears everything collected and turns collection off. For tests.
+void ResetTaskStatsForTesting();
+
+#endif  // UTIL_TASK_STATS_H_
@@ -0,0 +1,65 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/task_stats.h"
+
+#include "util/auto_reset_event.h"
+#include "util/msg_loop.h"
+#include "util/test/test.h"
+#include "util/worker_pool.h"
+
+TEST(TaskStats, Histogram) {
+  TaskHistogram histogram;
+  EXPECT_EQ(0u, histogram.PercentileMicroseconds(50));
+
+  // 90 short waits and 10 long ones.
+  for (int i = 0; i < 90; i++)
+    histogram.Add(TickDelta(500));  // 0.5us
+  for (int i = 0; i < 10; i++)
+    histogram.Add(TickDelta(3'000'000));  // 3ms
+
+  EXPECT_EQ(100u, histogram.count());
+  EXPECT_EQ(90u, histogram.bucket(0));
+  EXPECT_EQ(3000u, histogram.max().InMicroseconds());
+  EXPECT_EQ(1u, histogram.PercentileMicroseconds(50));
+  EXPECT_EQ(1u, histogram.PercentileMicroseconds(89));
+  // The long waits land in [2048, 4096)us, capped by the maximum.
+  EXPECT_EQ(3000u, histogram.PercentileMicroseconds(95));
+}
+
+TEST(TaskStats, Queues) {
+  ResetTaskStatsForTesting();
+  EnableTaskStats();
+
+  MsgLoop msg_loop;
+  {
+    WorkerPool pool(2);
+    AutoResetEvent done;
+    for (int i = 0; i < 10; i++) {
+      pool.PostTask([&done, i]() {
+        if (i == 9)
+          done.Signal();
+      });
+    }
+    done.Wait();
+  }
+  for (int i = 0; i < 5; i++)
+    msg_loop.PostTask([]() {});
+  msg_loop.RunUntilIdleForTesting();
+
+  TaskStatsSnapshot stats = GetTaskStats();
+  ResetTaskStatsForTesting();
+
+  const TaskQueueStats& main_queue =
+      stats.queues[static_cast<size_t>(TaskQueue::kMainThread)];
+  EXPECT_EQ(5u, main_queue.wait.count());
+  EXPECT_EQ(5u, main_queue.max_length);
+  ASSERT_FALSE(main_queue.samples.empty());
+
+  const TaskQueueStats& pool_queue =
+      stats.queues[static_cast<size_t>(TaskQueue::kWorkerPool)];
+  EXPECT_EQ(10u, pool_queue.wait.count());
+  EXPECT_GE(pool_queue.max_length, 1u);
+  EXPECT_FALSE(pool_queue.samples.empty());
+}
@@ -4,11 +4,14 @@
 
 #include "util/worker_pool.h"
 
+#include <algorithm>
+
 #include "base/command_line.h"
 #include "base/strings/string_number_conversions.h"
 #include "gn/switches.h"
 #include "util/build_config.h"
 #include "util/sys_info.h"
+#include "util/task_stats.h"
 
 namespace {
 
@@ -56,57 +59,229 @@ int GetThreadCount() {
 #endif
 }
 
+// The pool and index of the worker running on the current thread, if any.
+thread_local WorkerPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+// Initial number of slots in a worker's deque.
+constexpr int64_t kInitialDequeCapacity = 256;
+
+uint32_t NextRandom(uint32_t* state) {
+  // xorshift32.
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
 }  // namespace
 
+WorkerPool::WorkDeque::Buffer::Buffer(int64_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<WorkerTask*>[capacity]) {
+  DCHECK((capacity & mask) == 0);
+}
+
+WorkerPool::WorkDeque::WorkDeque() {
+  buffers_.push_back(std::make_unique<Buffer>(kInitialDequeCapacity));
+  buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+WorkerPool::WorkDeque::~WorkDeque() = default;
+
+void WorkerPool::WorkDeque::Push(WorkerTask* task) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  int64_t top = top_.load(std::memory_order_acquire);
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (bottom - top > buffer->mask)
+    buffer = Grow(buffer, top, bottom);
+  buffer->Put(bottom, task);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+WorkerTask* WorkerPool::WorkDeque::Pop() {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  WorkerTask* task = buffer->Get(bottom);
+  if (top == bottom) {
+    // Last item, race against thieves for it.
+    if (!top_.compare_exchange_strong(top, top + 1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      task = nullptr;
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+WorkerTask* WorkerPool::WorkDeque::Steal() {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  Buffer* buffer = buffer_.load(std::memory_order_acquire);
+  WorkerTask* task = buffer->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return nullptr;  // Lost to the owner or another thief.
+  return task;
+}
+
+WorkerPool::WorkDeque::Buffer* WorkerPool::WorkDeque::Grow(Buffer* buffer,
+                                                          int64_t top,
+                                                          int64_t bottom) {
+  auto grown = std::make_unique<Buffer>(2 * (buffer->mask + 1));
+  for (int64_t i = top; i < bottom; i++)
+    grown->Put(i, buffer->Get(i));
+  Buffer* result = grown.get();
+  buffers_.push_back(std::move(grown));
+  buffer_.store(result, std::memory_order_release);
+  return result;
+}
+
 WorkerPool::WorkerPool() : WorkerPool(GetThreadCount()) {}
 
-WorkerPool::WorkerPool(size_t thread_count) : should_stop_processing_(false) {
+WorkerPool::WorkerPool(size_t thread_count) {
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i)
+    workers_.push_back(std::make_unique<WorkerState>());
+
   threads_.reserve(thread_count);
   for (size_t i = 0; i < thread_count; ++i)
-    threads_.emplace_back([this]() { Worker(); });
+    threads_.emplace_back([this, i]() { Worker(i); });
 }
 
 WorkerPool::~WorkerPool() {
   {
-    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
-    should_stop_processing_ = true;
+    std::unique_lock<std::mutex> park_lock(park_mutex_);
+    should_stop_processing_.store(true);
   }
 
-  pool_notifier_.notify_all();
+  park_notifier_.notify_all();
 
   for (auto& task_thread : threads_) {
     task_thread.join();
   }
 }
 
-void WorkerPool::PostTask(std::function<void()> work) {
-  {
-    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
-    CHECK(!should_stop_processing_);
-    task_queue_.emplace(std::move(work));
+void WorkerPool::PostTask(WorkerTask work) {
+  CHECK(!should_stop_processing_.load(std::memory_order_relaxed));
+  bool stats = TaskStatsEnabled();
+  if (stats) {
+    work = [posted = TicksNow(), work = std::move(work)]() mutable {
+      RecordTaskWait(TaskQueue::kWorkerPool, TicksDelta(TicksNow(), posted));
+      work();
+    };
   }
+  WorkerTask* task = new WorkerTask(std::move(work));
+
+  // Count the task before it's visible so the count never goes negative.
+  // This and the sleeper count update in Worker() are both sequentially
+  // consistent, so either a parking worker sees the new task or we see the
+  // sleeper below.
+  int64_t queued = queued_count_.fetch_add(1) + 1;
+  if (stats)
+    RecordTaskQueueLength(TaskQueue::kWorkerPool, static_cast<size_t>(queued));
 
-  pool_notifier_.notify_one();
+  if (current_pool == this) {
+    workers_[current_index]->deque.Push(task);
+  } else {
+    std::unique_lock<std::mutex> injection_lock(injection_mutex_);
+    injection_queue_.push(task);
+    injection_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Taking the lock guarantees a sleeper seen here is already waiting when
+  // notified.
+  if (sleeper_count_.load() > 0) {
+    { std::unique_lock<std::mutex> park_lock(park_mutex_); }
+    park_notifier_.notify_one();
+  }
 }
 
-void WorkerPool::Worker() {
-  for (;;) {
-    std::function<void()> task;
+WorkerTask* WorkerPool::FindTask(size_t index, uint32_t* random_state) {
+  if (WorkerTask* task = workers_[index]->deque.Pop())
+    return task;
 
-    {
-      std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+  if (injection_count_.load(std::memory_order_relaxed) > 0) {
+    std::unique_lock<std::mutex> injection_lock(injection_mutex_);
+    if (!injection_queue_.empty()) {
+      WorkerTask* task = injection_queue_.front();
+      injection_queue_.pop();
+      injection_count_.fetch_sub(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+
+  size_t count = workers_.size();
+  size_t start = NextRandom(random_state) % count;
+  for (size_t i = 0; i < count; i++) {
+    size_t victim = (start + i) % count;
+    if (victim == index)
+      continue;
+    if (WorkerTask* task = workers_[victim]->deque.Steal())
+      return task;
+  }
+  return nullptr;
+}
+
+void WorkerPool::Worker(size_t index) {
+  current_pool = this;
+  current_index = index;
+  uint32_t random_state = static_cast<uint32_t>(index) * 2654435761u + 1;
 
-      pool_notifier_.wait(queue_lock, [this]() {
-        return (!task_queue_.empty()) || should_stop_processing_;
-      });
+  // When task stats are on, the time since this worker last ran out of work.
+  Ticks idle_begin = 0;
 
-      if (should_stop_processing_ && task_queue_.empty())
-        return;
+  for (;;) {
+    if (WorkerTask* task = FindTask(index, &random_state)) {
+      int64_t remaining = queued_count_.fetch_sub(1) - 1;
+      if (TaskStatsEnabled()) {
+        if (idle_begin)
+          RecordThreadIdle(idle_begin, TicksNow());
+        RecordTaskQueueLength(TaskQueue::kWorkerPool,
+                              static_cast<size_t>(remaining));
+      }
+      idle_begin = 0;
+      (*task)();
+      delete task;
+      continue;
+    }
+
+    if (!idle_begin && TaskStatsEnabled())
+      idle_begin = TicksNow();
 
-      task = std::move(task_queue_.front());
-      task_queue_.pop();
+    if (queued_count_.load() > 0) {
+      // A task is queued but isn't visible yet, or a steal lost a race for
+      // it. Try again.
+      std::this_thread::yield();
+      continue;
     }
 
-    task();
+    std::unique_lock<std::mutex> park_lock(park_mutex_);
+    sleeper_count_.fetch_add(1);
+    park_notifier_.wait(park_lock, [this]() {
+      return queued_count_.load() > 0 || should_stop_processing_.load();
+    });
+    sleeper_count_.fetch_sub(1);
+
+    if (should_stop_processing_.load() && queued_count_.load() == 0)
+      break;
   }
+
+  current_pool = nullptr;
 }
@@ -5,30 +5,211 @@
 #ifndef UTIL_WORKER_POOL_H_
 #define UTIL_WORKER_POOL_H_
 
+#include <stdint.h>
+
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <queue>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "base/logging.h"
 
+// A move-only "void()" callable. Callables up to kInlineSize bytes (which
+// covers the lambdas GN posts) are stored inline rather than on the heap.
+class WorkerTask {
+ public:
+  static constexpr size_t kInlineSize = 6 * sizeof(void*);
+
+  WorkerTask() = default;
+
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, WorkerTask>::value>>
+  WorkerTask(F&& f) {  // NOLINT(google-explicit-constructor)
+    using Callable = std::decay_t<F>;
+    if constexpr (sizeof(Callable) <= kInlineSize &&
+                  alignof(Callable) <= alignof(std::max_align_t) &&
+                  std::is_nothrow_move_constructible<Callable>::value) {
+      new (&storage_) Callable(std::forward<F>(f));
+      ops_ = &InlineOps<Callable>::kOps;
+    } else {
+      *reinterpret_cast<Callable**>(&storage_) =
+          new Callable(std::forward<F>(f));
+      ops_ = &HeapOps<Callable>::kOps;
+    }
+  }
+
+  WorkerTask(WorkerTask&& other) noexcept { MoveFrom(&other); }
+  WorkerTask& operator=(WorkerTask&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  ~WorkerTask() { Reset(); }
+
+  explicit operator bool() const { return !!ops_; }
+
+  void operator()() {
+    DCHECK(ops_);
+    ops_->invoke(&storage_);
+  }
+
+ private:
+  using Storage = std::aligned_storage_t<kInlineSize, alignof(std::max_align_t)>;
+
+  struct Ops {
+    void (*invoke)(Storage* storage);
+    // Move-constructs |to| from |from| and destroys |from|.
+    void (*relocate)(Storage* from, Storage* to);
+    void (*destroy)(Storage* storage);
+  };
+
+  template <typename Callable>
+  struct InlineOps {
+    static Callable* Get(Storage* s) { return reinterpret_cast<Callable*>(s); }
+    static void Invoke(Storage* s) { (*Get(s))(); }
+    static void Relocate(Storage* from, Storage* to) {
+      new (to) Callable(std::move(*Get(from)));
+      Get(from)->~Callable();
+    }
+    static void Destroy(Storage* s) { Get(s)->~Callable(); }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename Callable>
+  struct HeapOps {
+    static Callable*& Get(Storage* s) {
+      return *reinterpret_cast<Callable**>(s);
+    }
+    static void Invoke(Storage* s) { (*Get(s))(); }
+    static void Relocate(Storage* from, Storage* to) {
+      *reinterpret_cast<Callable**>(to) = Get(from);
+    }
+    static void Destroy(Storage* s) { delete Get(s); }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  void MoveFrom(WorkerTask* other) {
+    ops_ = other->ops_;
+    if (ops_) {
+      ops_->relocate(&other->storage_, &storage_);
+      other->ops_ = nullptr;
+    }
+  }
+
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  Storage storage_;
+  const Ops* ops_ = nullptr;
+
+  WorkerTask(const WorkerTask&) = delete;
+  WorkerTask& operator=(const WorkerTask&) = delete;
+};
+
+// Runs tasks on a fixed set of threads.
+//
+// Every worker has its own deque (see WorkDeque below). Tasks posted from a
+// worker go to the bottom of that worker's deque and are popped from there in
+// LIFO order, so a worker mostly runs the follow-up work it generated itself
+// without touching shared state. Tasks posted from other threads go through a
+// locked injection queue. Idle workers take from the injection queue, then
+// steal from the top of the other workers' deques, starting at a random one.
 class WorkerPool {
  public:
   WorkerPool();
   WorkerPool(size_t thread_count);
   ~WorkerPool();
 
-  void PostTask(std::function<void()> work);
+  // Can be called from any thread, including from tasks running on the pool.
+  void PostTask(WorkerTask work);
+
+  size_t thread_count() const { return threads_.size(); }
 
  private:
-  void Worker();
+  // A Chase-Lev work-stealing deque ("Dynamic Circular Work-Stealing Deque",
+  // with the memory orderings from Lê et al., "Correct and Efficient
+  // Work-Stealing for Weak Memory Models"). Push() and Pop() may only be
+  // called by the owning worker; Steal() may be called from any thread.
+  //
+  // The buffer grows when full. Old buffers are kept until the deque is
+  // destroyed since a concurrent thief may still be reading them.
+  class WorkDeque {
+   public:
+    WorkDeque();
+    ~WorkDeque();
+
+    void Push(WorkerTask* task);
+    WorkerTask* Pop();
+    WorkerTask* Steal();
+
+   private:
+    struct Buffer {
+      explicit Buffer(int64_t capacity);
+
+      int64_t mask;
+      std::unique_ptr<std::atomic<WorkerTask*>[]> slots;
+
+      WorkerTask* Get(int64_t i) const {
+        return slots[i & mask].load(std::memory_order_relaxed);
+      }
+      void Put(int64_t i, WorkerTask* task) {
+        slots[i & mask].store(task, std::memory_order_relaxed);
+      }
+    };
+
+    Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom);
 
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Buffer*> buffer_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+
+    WorkDeque(const WorkDeque&) = delete;
+    WorkDeque& operator=(const WorkDeque&) = delete;
+  };
+
+  // Padded so neighbouring workers' deque indices don't share a cache line.
+  struct alignas(64) WorkerState {
+    WorkDeque deque;
+  };
+
+  void Worker(size_t index);
+
+  // Returns the next task for the given worker, or null if none was found.
+  WorkerTask* FindTask(size_t index, uint32_t* random_state);
+
+  std::vector<std::unique_ptr<WorkerState>> workers_;
   std::vector<std::thread> threads_;
-  std::queue<std::function<void()>> task_queue_;
-  std::mutex queue_mutex_;
-  std::condition_variable_any pool_notifier_;
-  bool should_stop_processing_;
+
+  // Tasks posted from threads that aren't workers of this pool.
+  std::mutex injection_mutex_;
+  std::queue<WorkerTask*> injection_queue_;
+  std::atomic<size_t> injection_count_{0};
+
+  // Number of tasks posted but not yet taken by a worker.
+  std::atomic<int64_t> queued_count_{0};
+
+  // Idle workers sleep on |park_notifier_|. |sleeper_count_| lets PostTask()
+  // skip the lock and notification when every worker is busy.
+  std::mutex park_mutex_;
+  std::condition_variable park_notifier_;
+  std::atomic<int> sleeper_count_{0};
+  std::atomic<bool> should_stop_processing_{false};
 
   WorkerPool(const WorkerPool&) = delete;
   WorkerPool& operator=(const WorkerPool&) = delete;
@@ -0,0 +1,99 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/worker_pool_benchmark.h"
+
+#include <stdio.h>
+
+#include <atomic>
+
+#include "util/auto_reset_event.h"
+#include "util/ticks.h"
+#include "util/worker_pool.h"
+
+namespace {
+
+// Simulates a small amount of work so tasks aren't entirely free.
+void Spin(int iterations) {
+  volatile int sink = 0;
+  for (int i = 0; i < iterations; i++)
+    sink = sink + i;
+}
+
+struct Counter {
+  explicit Counter(int expected) : expected(expected) {}
+
+  void Done() {
+    if (count.fetch_add(1, std::memory_order_acq_rel) + 1 == expected)
+      finished.Signal();
+  }
+
+  const int expected;
+  std::atomic<int> count{0};
+  AutoResetEvent finished;
+};
+
+double TimeInject(size_t threads, int tasks) {
+  Counter counter(tasks);
+  WorkerPool pool(threads);
+  ElapsedTimer timer;
+  for (int i = 0; i < tasks; i++) {
+    pool.PostTask([&counter]() {
+      Spin(100);
+      counter.Done();
+    });
+  }
+  counter.finished.Wait();
+  return timer.Elapsed().InMillisecondsF();
+}
+
+void PostFanout(WorkerPool* pool, Counter* counter, int depth) {
+  pool->PostTask([pool, counter, depth]() {
+    if (depth > 0) {
+      for (int i = 0; i < 4; i++)
+        PostFanout(pool, counter, depth - 1);
+    }
+    Spin(100);
+    counter->Done();
+  });
+}
+
+double TimeFanout(size_t threads, int tasks) {
+  // Pick the depth of a 4-ary tree with at least |tasks| nodes.
+  int depth = 0;
+  int nodes = 1;
+  for (int level = 1; nodes < tasks; depth++) {
+    level *= 4;
+    nodes += level;
+  }
+
+  Counter counter(nodes);
+  WorkerPool pool(threads);
+  ElapsedTimer timer;
+  PostFanout(&pool, &counter, depth);
+  counter.finished.Wait();
+  // Normalize to the requested task count so the columns are comparable.
+  return timer.Elapsed().InMillisecondsF() * tasks / nodes;
+}
+
+}  // namespace
+
+void RunWorkerPoolBenchmark(size_t max_threads, int tasks) {
+  printf("%d tasks per run\n", tasks);
+  printf("%8s %12s %12s %12s %12s\n", "threads", "inject ms", "speedup",
+         "fanout ms", "speedup");
+
+  double inject_base = 0;
+  double fanout_base = 0;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    double inject = TimeInject(threads, tasks);
+    double fanout = TimeFanout(threads, tasks);
+    if (threads == 1) {
+      inject_base = inject;
+      fanout_base = fanout;
+    }
+    printf("%8zu %12.1f %12.2f %12.1f %12.2f\n", threads, inject,
+           inject_base / inject, fanout, fanout_base / fanout);
+  }
+}
@@ -0,0 +1,20 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_WORKER_POOL_BENCHMARK_H_
+#define UTIL_WORKER_POOL_BENCHMARK_H_
+
+#include <stddef.h>
+
+// Measures WorkerPool throughput for thread counts doubling up to
+// |max_threads| and prints a table.
+//
+// Two workloads of |tasks| tasks are timed, both made of tiny tasks so that
+// the cost is dominated by the pool rather than the work:
+//
+//   inject: the main thread posts every task, like the loader does.
+//   fanout: tasks post more tasks, like file writes scheduled from workers.
+void RunWorkerPoolBenchmark(size_t max_threads, int tasks);
+
+#endif  // UTIL_WORKER_POOL_BENCHMARK_H_
@@ -0,0 +1,103 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/worker_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "util/auto_reset_event.h"
+#include "util/test/test.h"
+
+namespace {
+
+// Posts a binary tree of tasks of the given depth, each counting itself.
+void PostTree(WorkerPool* pool,
+              int depth,
+              std::atomic<int>* count,
+              int expected,
+              AutoResetEvent* done) {
+  pool->PostTask([pool, depth, count, expected, done]() {
+    if (depth > 0) {
+      PostTree(pool, depth - 1, count, expected, done);
+      PostTree(pool, depth - 1, count, expected, done);
+    }
+    if (count->fetch_add(1) + 1 == expected)
+      done->Signal();
+  });
+}
+
+}  // namespace
+
+TEST(WorkerTask, Inline) {
+  int value = 0;
+  WorkerTask task([&value]() { value++; });
+  ASSERT_TRUE(task);
+  task();
+  EXPECT_EQ(1, value);
+
+  WorkerTask moved(std::move(task));
+  EXPECT_FALSE(task);  // NOLINT(bugprone-use-after-move)
+  moved();
+  EXPECT_EQ(2, value);
+}
+
+TEST(WorkerTask, MoveOnlyAndHeap) {
+  // Move-only captures work, as do captures too large to store inline.
+  auto owned = std::make_unique<int>(5);
+  std::string big(WorkerTask::kInlineSize * 4, 'x');
+  char padding[WorkerTask::kInlineSize] = {};
+  int result = 0;
+  WorkerTask task([owned = std::move(owned), big, padding, &result]() {
+    result = *owned + static_cast<int>(big.size()) + padding[0];
+  });
+
+  WorkerTask other;
+  other = std::move(task);
+  other();
+  EXPECT_EQ(5 + static_cast<int>(WorkerTask::kInlineSize) * 4, result);
+}
+
+TEST(WorkerPool, PostFromOutside) {
+  constexpr int kTaskCount = 1000;
+  std::atomic<int> count(0);
+  AutoResetEvent done;
+  {
+    WorkerPool pool(4);
+    for (int i = 0; i < kTaskCount; i++) {
+      pool.PostTask([&count, &done]() {
+        if (count.fetch_add(1) + 1 == kTaskCount)
+          done.Signal();
+      });
+    }
+    done.Wait();
+  }
+  EXPECT_EQ(kTaskCount, count.load());
+}
+
+TEST(WorkerPool, PostFromWorkers) {
+  // Tasks posted from workers go to the posting worker's own deque and must
+  // be picked up by it or stolen by the others.
+  constexpr int kDepth = 12;
+  constexpr int kExpected = (1 << (kDepth + 1)) - 1;
+  for (size_t threads : {1u, 3u, 8u}) {
+    std::atomic<int> count(0);
+    AutoResetEvent done;
+    WorkerPool pool(threads);
+    PostTree(&pool, kDepth, &count, kExpected, &done);
+    done.Wait();
+    EXPECT_EQ(kExpected, count.load());
+  }
+}
+
+TEST(WorkerPool, DestructorRunsQueuedTasks) {
+  std::atomic<int> count(0);
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 100; i++)
+      pool.PostTask([&count]() { count++; });
+  }
+  EXPECT_EQ(100, count.load());
+}